@@ -54,9 +54,50 @@
 
 int main(int argc, char* argv[]) {
     repl_config config = {0};
+    const char *eval_str = NULL;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--force-prompts") == 0) {
             config.force_prompt = 1;
+        } else if (strcmp(argv[i], "--dump-ast") == 0) {
+            config.dump_ast = 1;
+        } else if (strncmp(argv[i], "--parser=", 9) == 0) {
+            if (!expresso_parser_backend_from_name(argv[i] + 9, &config.parser_backend)) {
+                fprintf(stderr, "Fatal Error: Unknown parser '%s' (expected 'antlr' or 'fast').\n", argv[i] + 9);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "--max-depth=", 12) == 0) {
+            char* end;
+            long long depth = strtoll(argv[i] + 12, &end, 10);
+            if (end == argv[i] + 12 || *end != '\0' || depth <= 0) {
+                fprintf(stderr, "Fatal Error: Invalid maximum depth '%s'.\n", argv[i] + 12);
+                return EXIT_FAILURE;
+            }
+            config.max_depth = (size_t)depth;
+        } else if (strncmp(argv[i], "--memo-cache=", 13) == 0) {
+            char* end;
+            long long entries = strtoll(argv[i] + 13, &end, 10);
+            if (end == argv[i] + 13 || *end != '\0' || entries < 0) {
+                fprintf(stderr, "Fatal Error: Invalid memo cache size '%s'.\n", argv[i] + 13);
+                return EXIT_FAILURE;
+            }
+            config.memo_cache = (size_t)entries;
+        } else if (strcmp(argv[i], "--intern") == 0) {
+            config.intern = 1;
+        } else if (strcmp(argv[i], "--no-parse-cache") == 0) {
+            config.no_parse_cache = 1;
+        } else if (strncmp(argv[i], "--parse-cache=", 14) == 0 || strncmp(argv[i], "--parse-cache-bytes=", 20) == 0) {
+            int bytes = argv[i][13] == '-';
+            const char* number = argv[i] + (bytes ? 20 : 14);
+            char* end;
+            long long size = strtoll(number, &end, 10);
+            if (end == number || *end != '\0' || size <= 0) {
+                fprintf(stderr, "Fatal Error: Invalid parse cache size '%s'.\n", number);
+                return EXIT_FAILURE;
+            }
+            if (bytes) config.parse_cache_bytes = (size_t)size;
+            else config.parse_cache_entries = (size_t)size;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            eval_str = argv[++i];
         }
     }
 
@@ -68,14 +109,14 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    if ((argc != 3) || (strcmp(argv[1], "-e") != 0))
+    if (eval_str == NULL)
     {
         while(repl_read_eval_print() != 0)
             ;
 	}
 	else
 	{
-		repl_eval_print(argv[2]);
+		repl_eval_print(eval_str);
 	}
 
     repl_shutdown(); // Clean up CLI interface
@@ -49,6 +49,10 @@
 #include "repl.h"
 #include "parser_wrapper.h" // For C++ parser interface
 #include "evaluator.h"      // For evaluator
+#include "optimizer.h"      // For the optimisation pass
+#include "memo_cache.h"     // For the constant subexpression cache
+#include "parse_cache.h"    // For reusing the trees of repeated lines
+#include "intern.h"         // For sharing repeated strings
 #include "value.h"          // For Value type
 #include "history.h"
 #include <stdio.h>
@@ -58,6 +62,11 @@
 
 static	History				*g_repl_history = NULL;
 static	int					 g_force_prompt = 0;
+static	int					 g_dump_ast = 0;
+static	ExpressoAst			*g_optimized_ast = NULL; // Reused for every evaluation
+static	ExpressoAst			*g_shared_ast = NULL;    // The optimised tree with subtrees shared again
+static	ExpressoMemoCache	*g_memo_cache = NULL;    // Values of constant subexpressions, if enabled
+static	ParseCache			*g_parse_cache = NULL;   // Trees ready to evaluate, by normalised text
 
 void print_value(Value *val);
 
@@ -89,8 +98,17 @@ static ExpressoParserContext* g_parser_ctx = NULL;
 
 const char* repl_init(repl_config* config) {
 
-    if(config != NULL)
+    if(config != NULL) {
         g_force_prompt = config->force_prompt;
+        g_dump_ast = config->dump_ast;
+        evaluator_set_max_depth(config->max_depth);
+        if (config->memo_cache > 0) {
+            g_memo_cache = expresso_memo_cache_create(config->memo_cache);
+            expresso_optimizer_set_memo_cache(g_memo_cache);
+            evaluator_set_memo_cache(g_memo_cache);
+        }
+        expresso_intern_set_enabled(config->intern);
+    }
 
     g_repl_history = history_create(10); // Create history with capacity 10 (FR-007)
     if (!g_repl_history) {
@@ -101,6 +119,20 @@ const char* repl_init(repl_config* config) {
     if (!g_parser_ctx) {
         return	"Could not initialize parser context.";
     }
+    if (config != NULL)
+        expresso_parser_set_backend(g_parser_ctx, config->parser_backend);
+
+    g_optimized_ast = expresso_ast_create();
+    g_shared_ast = expresso_ast_create();
+
+    if (config == NULL || !config->no_parse_cache) {
+        size_t entries = config && config->parse_cache_entries ? config->parse_cache_entries : PARSE_CACHE_DEFAULT_ENTRIES;
+        size_t bytes = config && config->parse_cache_bytes ? config->parse_cache_bytes : PARSE_CACHE_DEFAULT_BYTES;
+        g_parse_cache = parse_cache_create(entries, bytes);
+        if (!g_parse_cache) {
+            return	"Could not create parse cache.";
+        }
+    }
 
 	return NULL;
 }
@@ -116,24 +148,93 @@ void repl_shutdown() {
         history_destroy(g_repl_history);
         g_repl_history = NULL;
     }
+
+    expresso_ast_destroy(g_optimized_ast);
+    g_optimized_ast = NULL;
+    expresso_ast_destroy(g_shared_ast);
+    g_shared_ast = NULL;
+
+    expresso_optimizer_set_memo_cache(NULL);
+    evaluator_set_memo_cache(NULL);
+    expresso_memo_cache_destroy(g_memo_cache);
+    g_memo_cache = NULL;
+
+    // Nothing refers to interned strings once the memo cache is gone
+    expresso_intern_set_enabled(false);
+    expresso_intern_reset();
+
+    parse_cache_destroy(g_parse_cache);
+    g_parse_cache = NULL;
 }
 
 Value repl_evaluate_expression(const char* input_line) {
     if (!g_parser_ctx) {
-        return value_create_error("CLI interface not initialized.");
+        return value_create_error_code(EXPRESSO_ERROR_NOT_INITIALIZED);
     }
     if (!input_line || strlen(input_line) == 0) {
-        return value_create_error("Empty input provided for evaluation.");
+        return value_create_error_code(EXPRESSO_ERROR_EMPTY_INPUT);
+    }
+
+    // A line seen before is evaluated from the tree it compiled to
+    char* key = NULL;
+    size_t key_length = 0;
+    if (g_parse_cache) {
+        key = (char*)malloc(strlen(input_line) + 1);
+        if (!key) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for parse cache key.\n");
+            exit(EXIT_FAILURE);
+        }
+        key_length = parse_cache_normalize(input_line, key);
+        const ExpressoAst* cached = parse_cache_lookup(g_parse_cache, key, key_length);
+        if (cached) {
+            free(key);
+            if (g_dump_ast) {
+                fputs("cached: ", stderr);
+                expresso_ast_dump(stderr, cached);
+            }
+            return evaluate_ast(cached);
+        }
     }
 
     ExpressoParseTree* tree = expresso_parser_parse(g_parser_ctx, input_line);
     if (tree != NULL) { // No syntax errors
-        Value eval_result = evaluate_expression(tree);
+        const ExpressoAst* ast = expresso_tree_get_ast(tree);
+        expresso_optimize(ast, g_optimized_ast, NULL, 0);
+        const ExpressoAst* evaluated = g_optimized_ast;
+        ExpressoAst* compiled = NULL;
+        if (g_parse_cache) {
+            // Kept by the cache, so shared into a tree of its own
+            compiled = expresso_ast_create();
+            expresso_ast_share(g_optimized_ast, compiled);
+            evaluated = compiled;
+        } else if (ast->sharing) {
+            // Optimising expands shared subtrees; share them again so that
+            // each is evaluated once
+            expresso_ast_share(g_optimized_ast, g_shared_ast);
+            evaluated = g_shared_ast;
+        }
+        if (g_dump_ast) {
+            expresso_optimizer_dump(stderr, ast, g_optimized_ast);
+            ExpressoSharingStats stats;
+            expresso_ast_sharing_stats(ast, &stats);
+            fprintf(stderr, "sharing: %zu nodes built as %zu (%zu shared)\n",
+                    stats.nodes_added, stats.nodes_stored, stats.shared_nodes);
+        }
+        Value eval_result = evaluate_ast(evaluated);
         expresso_tree_destroy(tree);
+        if (compiled && !parse_cache_insert(g_parse_cache, key, key_length, compiled)) {
+            expresso_ast_destroy(compiled);
+        }
+        free(key);
         return eval_result;
     } else {
+        free(key);
         // Error already printed by parser_wrapper
-        return value_create_error("Syntax error during parsing.");
+        ExpressoSyntaxError error;
+        if (expresso_parser_get_syntax_error(g_parser_ctx, &error)) {
+            return value_create_error_at(error.code, error.position, error.length);
+        }
+        return value_create_error_code(EXPRESSO_ERROR_SYNTAX);
     }
 }
 
@@ -156,6 +257,17 @@ int read_eval_print(History *const h) {
                 // FR-008: "**[ 1]:** <line text>"
                 printf("**[ %zu]:** %s\n", i + 1, history_get(h, i));
             }
+        } else if (strcmp(input_line, "!memo") == 0) {
+            ExpressoMemoStats stats;
+            expresso_memo_cache_get_stats(g_memo_cache, &stats);
+            printf("Memo cache: %zu/%zu entries, %llu hits, %llu misses, %llu evictions\n",
+                   stats.entries, stats.capacity, stats.hits, stats.misses, stats.evictions);
+        } else if (strcmp(input_line, "!cache") == 0) {
+            ParseCacheStats stats;
+            parse_cache_get_stats(g_parse_cache, &stats);
+            printf("Parse cache: %zu/%zu entries, %zu/%zu bytes, %llu hits, %llu misses, %llu evictions\n",
+                   stats.entries, stats.max_entries, stats.bytes, stats.max_bytes,
+                   stats.hits, stats.misses, stats.evictions);
         } else if (strcmp(input_line, "!clear") == 0) {
             history_clear(h);
             printf("Session history cleared.\n");
@@ -164,9 +276,12 @@ int read_eval_print(History *const h) {
             if (index > 0 && index <= history_size(h)) {
                 const char* history_entry = history_get(h, index - 1);
                 if (history_entry) {
+                    // Served from the parse cache when the entry was evaluated before
                     printf("Re-inputting: %s\n", history_entry);
-                    // In a real implementation, this would re-evaluate the expression
-                    // For now, just print it.
+                    Value eval_result = repl_evaluate_expression(history_entry);
+                    print_value(&eval_result);
+                    printf("\n");
+                    value_destroy(eval_result);
                 }
             } else {
                 fprintf(stderr, "Error: history index out of bounds\n");
@@ -196,11 +311,12 @@ void repl_eval_print(const char *eval_str) {
 
 void print_value(Value *val) {
 
-    switch (val->type) {
-        case VALUE_TYPE_INTEGER: printf("%lld", val->data.integer_value); break;
-        case VALUE_TYPE_FLOAT: printf("%f", val->data.float_value); break;
-        case VALUE_TYPE_CHARACTER: printf("'%c'", val->data.char_value); break;
-        case VALUE_TYPE_STRING: printf("\"%s\"", val->data.string_value); break;
-        case VALUE_TYPE_ERROR: fprintf(stderr, "Error: %s", val->data.string_value); break;
+    switch (value_get_type(*val)) {
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_FLOAT:
+        case VALUE_TYPE_BIGINT: value_print(*val); break; // Shortest round-trip numbers
+        case VALUE_TYPE_CHARACTER: printf("'%c'", value_get_character(*val)); break;
+        case VALUE_TYPE_STRING:
+        case VALUE_TYPE_ERROR: value_print(*val); break;
     }
 }
@@ -50,9 +50,18 @@
 #define EXPRESSO_CLI_INTERFACE_H
 
 #include "value.h" // For Value type
+#include "parser_wrapper.h" // For ExpressoParserBackend
 
 typedef struct {
     int force_prompt;
+    int dump_ast; // Print each tree before and after optimisation to stderr
+    ExpressoParserBackend parser_backend;
+    size_t max_depth; // Deepest nesting the evaluator follows; 0 for its default
+    size_t memo_cache; // Constant subexpression values kept across lines; 0 for none
+    int no_parse_cache; // Parse and optimise every line, even repeated ones
+    size_t parse_cache_entries; // Bounds of the parse cache; 0 for the defaults
+    size_t parse_cache_bytes;
+    int intern; // Share one copy of each repeated long string literal and cached result
 } repl_config;
 
 // Initialize the CLI interface (e.g., parser context)
@@ -0,0 +1,158 @@
+/*
+ * Expresso
+ * arena.c
+ *
+ * Implementation of the evaluation arena: a stack of chunks per thread, bump
+ * allocated and released back to a mark.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Chunk {
+    struct Chunk* previous;
+    size_t capacity; // In words
+    size_t used;
+    uint64_t words[];
+} Chunk;
+
+// 32 KiB, enough for the working storage of most evaluations
+#define CHUNK_WORDS 4096
+
+static _Thread_local Chunk* arena; // Newest chunk
+static _Thread_local unsigned arena_depth; // Evaluations entered
+
+// Not thread-safe; for measuring workloads
+static ExpressoArenaStats arena_stats;
+
+static Chunk* allocate_chunk(size_t capacity, Chunk* previous) {
+    Chunk* chunk = (Chunk*)malloc(sizeof(Chunk) + capacity * sizeof(uint64_t));
+    if (!chunk) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for evaluation arena.\n");
+        exit(EXIT_FAILURE);
+    }
+    chunk->previous = previous;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena_stats.chunk_allocations++;
+    return chunk;
+}
+
+void* expresso_arena_allocate(size_t size) {
+    size_t count = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (!arena || arena->capacity - arena->used < count) {
+        arena = allocate_chunk(count > CHUNK_WORDS ? count : CHUNK_WORDS, arena);
+    }
+    uint64_t* words = arena->words + arena->used;
+    arena->used += count;
+    return words;
+}
+
+ExpressoArenaMark expresso_arena_mark(void) {
+    return (ExpressoArenaMark){ arena, arena ? arena->used : 0 };
+}
+
+void expresso_arena_release(ExpressoArenaMark mark) {
+    while (arena != (Chunk*)mark.chunk) {
+        // The bottom chunk is kept for the next evaluation
+        if (!arena->previous) {
+            arena->used = 0;
+            return;
+        }
+        Chunk* previous = arena->previous;
+        free(arena);
+        arena_stats.chunk_releases++;
+        arena = previous;
+    }
+    if (arena) arena->used = mark.used;
+}
+
+// Empty the arena after the outermost evaluation. If it overflowed into
+// more chunks, they are replaced by one as large as all of them, so the
+// next evaluation like it fits.
+static void release_all(void) {
+    if (!arena || !arena->previous) {
+        if (arena) arena->used = 0;
+        return;
+    }
+    size_t total = 0;
+    while (arena) {
+        Chunk* previous = arena->previous;
+        total += arena->capacity;
+        free(arena);
+        arena_stats.chunk_releases++;
+        arena = previous;
+    }
+    arena = allocate_chunk(total, NULL);
+}
+
+ExpressoArenaMark expresso_arena_enter(void) {
+    arena_depth++;
+    return expresso_arena_mark();
+}
+
+Value expresso_arena_leave(ExpressoArenaMark mark, Value result) {
+    if (value_in_arena(result)) result = value_promote(result);
+    if (--arena_depth == 0) {
+        release_all();
+    } else {
+        expresso_arena_release(mark);
+    }
+    return result;
+}
+
+bool expresso_arena_active(void) {
+    return arena_depth > 0;
+}
+
+void expresso_arena_stats(ExpressoArenaStats* stats) {
+    *stats = arena_stats;
+}
+
+void expresso_arena_reset_stats(void) {
+    arena_stats = (ExpressoArenaStats){ 0 };
+}
@@ -0,0 +1,102 @@
+/*
+ * Expresso
+ * arena.h
+ *
+ * Header file for the evaluation arena, from which the strings, errors, big
+ * integers and working storage made while an expression is evaluated are
+ * bump-allocated and then released together.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EXPRESSO_ARENA_H
+#define EXPRESSO_ARENA_H
+
+#include "value.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory made while an evaluation runs comes from an arena of the calling
+// thread, and dropping it costs nothing. The evaluation enters the arena
+// before it starts and leaves it with its result, which is copied to the
+// heap if it lives in the arena; everything allocated since entering is
+// released at once. Entries nest. Outside any evaluation, values are
+// allocated on the heap.
+//
+// The bottom chunk is kept between evaluations, and grows to the most an
+// evaluation has needed, so in a steady state an evaluation takes nothing
+// from the system and leaving is O(1).
+typedef struct {
+    void* chunk;
+    size_t used;
+} ExpressoArenaMark;
+
+ExpressoArenaMark expresso_arena_enter(void);
+Value expresso_arena_leave(ExpressoArenaMark mark, Value result);
+
+// Whether an evaluation is running on this thread
+bool expresso_arena_active(void);
+
+// size bytes, 8-byte aligned, valid until the arena is released past them.
+// Scratch space can be taken between a mark and a release whether or not an
+// evaluation is running.
+void* expresso_arena_allocate(size_t size);
+ExpressoArenaMark expresso_arena_mark(void);
+void expresso_arena_release(ExpressoArenaMark mark);
+
+// Chunks the arenas have taken from and returned to the system
+typedef struct {
+    unsigned long long chunk_allocations;
+    unsigned long long chunk_releases;
+} ExpressoArenaStats;
+
+void expresso_arena_stats(ExpressoArenaStats* stats);
+void expresso_arena_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_ARENA_H
@@ -0,0 +1,441 @@
+/*
+ * Expresso
+ * batch.c
+ *
+ * Columnar batch evaluation of compiled expressions.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "batch.h"
+#include "operations.h" // For value_result_type
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VALIDITY_BYTES (EXPRESSO_BATCH_CHUNK / 8)
+
+_Static_assert(EXPRESSO_OPCODE_BITWISE_OR - EXPRESSO_OPCODE_MULTIPLY == EXPRESSO_OP_BITWISE_OR - EXPRESSO_OP_MULTIPLY,
+               "binary opcodes must follow the order of the binary operators");
+
+// A batch runs the program as a list of steps over registers, each holding
+// one chunk of values and their validity bits. Registers are numbered by
+// the operand stack depth at which the bytecode produces them.
+typedef enum {
+    STEP_LOAD,            // out = columns[index]
+    STEP_BROADCAST,       // out = constants[index]
+    STEP_INTEGER,         // out = a op b (or op a) through an integer kernel
+    STEP_CHECKED,         // As STEP_INTEGER, but rows can fail
+    STEP_FLOAT_COMPARE,   // out = a op b for comparisons of floats
+    STEP_FLOAT,           // out = a op b (or op a) through a float kernel
+    STEP_FLOAT_CHECKED,   // As STEP_FLOAT, but rows can fail
+    STEP_SELECT           // out = a ? b : c
+} StepKind;
+
+typedef struct {
+    uint8_t kind;  // StepKind
+    uint8_t op;    // ExpressoOperator
+    uint16_t out, a, b, c;
+    uint32_t index;
+} BatchStep;
+
+struct ExpressoBatch {
+    const ExpressoProgram* program;
+    const ExpressoKernelTable* kernels;
+    BatchStep* steps;
+    size_t step_count;
+    size_t register_count;
+    unsigned char* values;    // register_count chunks of 64-bit lanes
+    uint8_t* validity;        // register_count chunks of validity bits
+    uint8_t condition[VALIDITY_BYTES]; // Scratch bits for STEP_SELECT
+    ExpressoColumnType result_type;
+};
+
+// --- Planning ---
+
+typedef struct {
+    ExpressoBatch* batch;
+    const ExpressoColumnType* column_types;
+    ValueType* types; // Type held by each register
+    size_t step_capacity;
+    size_t depth;
+} Planner;
+
+static uint32_t read_operand(const uint8_t* code) {
+    uint32_t operand;
+    memcpy(&operand, code, sizeof operand);
+    return operand;
+}
+
+static void add_step(Planner* planner, BatchStep step) {
+    ExpressoBatch* batch = planner->batch;
+    if (batch->step_count == planner->step_capacity) {
+        planner->step_capacity = planner->step_capacity ? planner->step_capacity * 2 : 16;
+        BatchStep* steps = (BatchStep*)realloc(batch->steps, planner->step_capacity * sizeof(BatchStep));
+        if (!steps) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for batch steps.\n");
+            exit(EXIT_FAILURE);
+        }
+        batch->steps = steps;
+    }
+    batch->steps[batch->step_count++] = step;
+}
+
+// Claim the register above the current top of the stack
+static uint16_t push_register(Planner* planner, ValueType type) {
+    size_t reg = planner->depth++;
+    if (planner->depth > planner->batch->register_count) {
+        ValueType* types = (ValueType*)realloc(planner->types, planner->depth * sizeof(ValueType));
+        if (!types) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for batch registers.\n");
+            exit(EXIT_FAILURE);
+        }
+        planner->types = types;
+        planner->batch->register_count = planner->depth;
+    }
+    planner->types[reg] = type;
+    return (uint16_t)reg;
+}
+
+static bool is_column_type(ValueType type) {
+    return type == VALUE_TYPE_INTEGER || type == VALUE_TYPE_FLOAT;
+}
+
+static bool plan_operator(Planner* planner, ExpressoOperator op, bool binary) {
+    uint16_t b = (uint16_t)(planner->depth - 1);
+    uint16_t a = binary ? (uint16_t)(planner->depth - 2) : b;
+    ValueType left = planner->types[a];
+    ValueType right = planner->types[b];
+    ValueType result = value_result_type(op, left, right);
+    if (!is_column_type(result)) return false;
+    // The kernels take two integers or two floats; promotion is left to the VM
+    if (left != right) return false;
+
+    const ExpressoKernelTable* kernels = planner->batch->kernels;
+    BatchStep step = { STEP_INTEGER, (uint8_t)op, a, a, b, 0, 0 };
+    if (left == VALUE_TYPE_INTEGER) {
+        if (kernels->checked[op]) step.kind = STEP_CHECKED;
+    } else if (kernels->float_compare[op]) {
+        step.kind = STEP_FLOAT_COMPARE;
+    } else if (kernels->float_arithmetic[op]) {
+        step.kind = STEP_FLOAT;
+    } else if (kernels->float_checked[op]) {
+        step.kind = STEP_FLOAT_CHECKED;
+    } else {
+        return false; // Float conditions for !, && and || stay with the VM
+    }
+    add_step(planner, step);
+
+    if (binary) planner->depth--;
+    planner->types[a] = result;
+    return true;
+}
+
+// Plan the bytecode in [start, end), which leaves one more value on the stack
+static bool plan_range(Planner* planner, size_t start, size_t end) {
+    const ExpressoProgram* program = planner->batch->program;
+    const uint8_t* code = program->code;
+    size_t pc = start;
+
+    while (pc < end) {
+        ExpressoOpcode opcode = (ExpressoOpcode)code[pc];
+        switch (opcode) {
+            case EXPRESSO_OPCODE_CONSTANT: {
+                uint32_t index = read_operand(code + pc + 1);
+                ValueType type = value_get_type(program->constants[index]);
+                if (!is_column_type(type)) return false;
+                uint16_t out = push_register(planner, type);
+                add_step(planner, (BatchStep){ STEP_BROADCAST, EXPRESSO_OP_NONE, out, 0, 0, 0, index });
+                pc += 1 + sizeof(uint32_t);
+                break;
+            }
+            case EXPRESSO_OPCODE_PARAMETER: {
+                uint32_t slot = read_operand(code + pc + 1);
+                ValueType type = planner->column_types[slot] == EXPRESSO_COLUMN_FLOAT ? VALUE_TYPE_FLOAT : VALUE_TYPE_INTEGER;
+                uint16_t out = push_register(planner, type);
+                add_step(planner, (BatchStep){ STEP_LOAD, EXPRESSO_OP_NONE, out, 0, 0, 0, slot });
+                pc += 1 + sizeof(uint32_t);
+                break;
+            }
+            case EXPRESSO_OPCODE_NEGATE:
+                if (!plan_operator(planner, EXPRESSO_OP_NEGATE, false)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_LOGICAL_NOT:
+                if (!plan_operator(planner, EXPRESSO_OP_LOGICAL_NOT, false)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_BITWISE_NOT:
+                if (!plan_operator(planner, EXPRESSO_OP_BITWISE_NOT, false)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_BRANCH: {
+                // Both branches are evaluated for every row, then selected
+                // between; failures in the branch not taken are discarded.
+                size_t else_start = read_operand(code + pc + 1);
+                size_t branch_end = read_operand(code + pc + 1 + sizeof(uint32_t));
+                size_t then_end = else_start - (1 + sizeof(uint32_t));
+                if (code[then_end] != EXPRESSO_OPCODE_JUMP) return false;
+
+                uint16_t condition = (uint16_t)(planner->depth - 1);
+                if (planner->types[condition] != VALUE_TYPE_INTEGER) return false;
+                if (!plan_range(planner, pc + 1 + 2 * sizeof(uint32_t), then_end)) return false;
+                if (!plan_range(planner, else_start, branch_end)) return false;
+
+                ValueType type = planner->types[condition + 1];
+                if (planner->types[condition + 2] != type) return false;
+                add_step(planner, (BatchStep){ STEP_SELECT, EXPRESSO_OP_NONE, condition, condition,
+                                               (uint16_t)(condition + 1), (uint16_t)(condition + 2), 0 });
+                planner->depth -= 2;
+                planner->types[condition] = type;
+                pc = branch_end;
+                break;
+            }
+            case EXPRESSO_OPCODE_AND_THEN:
+            case EXPRESSO_OPCODE_OR_ELSE: {
+                // As with branches, the right operand is computed for every
+                // row and the left one selects whether it is used.
+                size_t right_end = read_operand(code + pc + 1);
+                uint16_t left = (uint16_t)(planner->depth - 1);
+                if (planner->types[left] != VALUE_TYPE_INTEGER) return false;
+                if (!plan_range(planner, pc + 1 + sizeof(uint32_t), right_end)) return false;
+
+                if (opcode == EXPRESSO_OPCODE_AND_THEN) {
+                    // A zero left operand is already the result
+                    add_step(planner, (BatchStep){ STEP_SELECT, EXPRESSO_OP_NONE, left, left,
+                                                   (uint16_t)(left + 1), left, 0 });
+                } else {
+                    // A non-zero left operand becomes the result once normalised to 1
+                    add_step(planner, (BatchStep){ STEP_INTEGER, EXPRESSO_OP_LOGICAL_AND, left, left, left, 0, 0 });
+                    add_step(planner, (BatchStep){ STEP_SELECT, EXPRESSO_OP_NONE, left, left,
+                                                   left, (uint16_t)(left + 1), 0 });
+                }
+                planner->depth--;
+                pc = right_end;
+                break;
+            }
+            case EXPRESSO_OPCODE_LOGICAL_AND:
+            case EXPRESSO_OPCODE_LOGICAL_OR:
+                // x && x normalises the right operand to 0 or 1
+                if (!plan_operator(planner, EXPRESSO_OP_LOGICAL_AND, false)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_RETURN:
+                pc++;
+                break;
+            default: {
+                // Binary operators are laid out in ExpressoOperator order
+                if (opcode < EXPRESSO_OPCODE_MULTIPLY || opcode > EXPRESSO_OPCODE_BITWISE_OR) return false;
+                ExpressoOperator op = (ExpressoOperator)(EXPRESSO_OP_MULTIPLY + (opcode - EXPRESSO_OPCODE_MULTIPLY));
+                if (!plan_operator(planner, op, true)) return false;
+                pc++;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+ExpressoBatch* expresso_batch_prepare(const ExpressoCompiled* compiled, const ExpressoColumnType* types) {
+    const ExpressoProgram* program = expresso_compiled_program(compiled);
+    if (!program || (program->parameter_count > 0 && !types)) return NULL;
+
+    ExpressoBatch* batch = (ExpressoBatch*)calloc(1, sizeof(ExpressoBatch));
+    if (!batch) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for batch.\n");
+        exit(EXIT_FAILURE);
+    }
+    batch->program = program;
+    batch->kernels = expresso_kernels(expresso_simd_detect());
+
+    Planner planner = { batch, types, NULL, 0, 0 };
+    bool planned = plan_range(&planner, 0, program->code_size) && planner.depth == 1;
+    if (planned) {
+        batch->result_type = planner.types[0] == VALUE_TYPE_FLOAT ? EXPRESSO_COLUMN_FLOAT : EXPRESSO_COLUMN_INTEGER;
+    }
+    free(planner.types);
+    if (!planned) {
+        expresso_batch_destroy(batch);
+        return NULL;
+    }
+
+    batch->values = (unsigned char*)malloc(batch->register_count * EXPRESSO_BATCH_CHUNK * 8);
+    batch->validity = (uint8_t*)malloc(batch->register_count * VALIDITY_BYTES);
+    if (!batch->values || !batch->validity) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for batch registers.\n");
+        exit(EXIT_FAILURE);
+    }
+    return batch;
+}
+
+void expresso_batch_destroy(ExpressoBatch* batch) {
+    if (!batch) return;
+
+    free(batch->steps);
+    free(batch->values);
+    free(batch->validity);
+    free(batch);
+}
+
+ExpressoColumnType expresso_batch_result_type(const ExpressoBatch* batch) {
+    return batch ? batch->result_type : EXPRESSO_COLUMN_INTEGER;
+}
+
+bool expresso_batch_set_simd_level(ExpressoBatch* batch, ExpressoSimdLevel level) {
+    const ExpressoKernelTable* kernels = expresso_kernels(level);
+    if (!batch || !kernels) return false;
+    batch->kernels = kernels;
+    return true;
+}
+
+ExpressoSimdLevel expresso_batch_simd_level(const ExpressoBatch* batch) {
+    return batch ? batch->kernels->level : EXPRESSO_SIMD_SCALAR;
+}
+
+// --- Evaluation ---
+
+static void* register_values(ExpressoBatch* batch, uint16_t reg) {
+    return batch->values + (size_t)reg * EXPRESSO_BATCH_CHUNK * 8;
+}
+
+static uint8_t* register_validity(ExpressoBatch* batch, uint16_t reg) {
+    return batch->validity + (size_t)reg * VALIDITY_BYTES;
+}
+
+static void and_validity(uint8_t* out, const uint8_t* other, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) out[i] &= other[i];
+}
+
+static void run_chunk(ExpressoBatch* batch, const ExpressoColumn* columns, size_t first, size_t n) {
+    const ExpressoKernelTable* kernels = batch->kernels;
+    size_t bytes = (n + 7) / 8;
+
+    for (size_t s = 0; s < batch->step_count; s++) {
+        const BatchStep* step = &batch->steps[s];
+        void* out = register_values(batch, step->out);
+        uint8_t* out_validity = register_validity(batch, step->out);
+
+        switch ((StepKind)step->kind) {
+            case STEP_LOAD: {
+                const ExpressoColumn* column = &columns[step->index];
+                memcpy(out, (const char*)column->values + first * 8, n * 8);
+                if (column->validity) {
+                    memcpy(out_validity, column->validity + first / 8, bytes);
+                } else {
+                    memset(out_validity, 0xFF, bytes);
+                }
+                break;
+            }
+            case STEP_BROADCAST: {
+                Value constant = batch->program->constants[step->index];
+                if (value_get_type(constant) == VALUE_TYPE_FLOAT) {
+                    double* lanes = (double*)out;
+                    double lane = value_get_float(constant);
+                    for (size_t i = 0; i < n; i++) lanes[i] = lane;
+                } else {
+                    long long* lanes = (long long*)out;
+                    long long lane = value_get_integer(constant);
+                    for (size_t i = 0; i < n; i++) lanes[i] = lane;
+                }
+                memset(out_validity, 0xFF, bytes);
+                break;
+            }
+            case STEP_INTEGER:
+                kernels->integer[step->op]((long long*)out, (const long long*)register_values(batch, step->a),
+                                           (const long long*)register_values(batch, step->b), n);
+                and_validity(out_validity, register_validity(batch, step->b), bytes);
+                break;
+            case STEP_CHECKED:
+                and_validity(out_validity, register_validity(batch, step->b), bytes);
+                kernels->checked[step->op]((long long*)out, out_validity, (const long long*)register_values(batch, step->a),
+                                           (const long long*)register_values(batch, step->b), n);
+                break;
+            case STEP_FLOAT_COMPARE:
+                kernels->float_compare[step->op]((long long*)out, (const double*)register_values(batch, step->a),
+                                                 (const double*)register_values(batch, step->b), n);
+                and_validity(out_validity, register_validity(batch, step->b), bytes);
+                break;
+            case STEP_FLOAT:
+                kernels->float_arithmetic[step->op]((double*)out, (const double*)register_values(batch, step->a),
+                                                    (const double*)register_values(batch, step->b), n);
+                and_validity(out_validity, register_validity(batch, step->b), bytes);
+                break;
+            case STEP_FLOAT_CHECKED:
+                and_validity(out_validity, register_validity(batch, step->b), bytes);
+                kernels->float_checked[step->op]((double*)out, out_validity, (const double*)register_values(batch, step->a),
+                                                 (const double*)register_values(batch, step->b), n);
+                break;
+            case STEP_SELECT: {
+                // A row is valid if its condition is, and so is the branch it selects
+                const long long* condition = (const long long*)register_values(batch, step->a);
+                const uint8_t* if_true = register_validity(batch, step->b);
+                const uint8_t* if_false = register_validity(batch, step->c);
+                memset(batch->condition, 0, bytes);
+                for (size_t i = 0; i < n; i++) {
+                    batch->condition[i >> 3] |= (uint8_t)((condition[i] != 0) << (i & 7));
+                }
+                for (size_t i = 0; i < bytes; i++) {
+                    uint8_t taken = (uint8_t)((batch->condition[i] & if_true[i]) | (~batch->condition[i] & if_false[i]));
+                    out_validity[i] &= taken;
+                }
+                kernels->select(out, condition, register_values(batch, step->b), register_values(batch, step->c), n);
+                break;
+            }
+        }
+    }
+}
+
+void expresso_batch_eval(ExpressoBatch* batch, const ExpressoColumn* columns, size_t rows, ExpressoColumn* result) {
+    if (!batch || !result || (batch->program->parameter_count > 0 && !columns)) return;
+
+    for (size_t first = 0; first < rows; first += EXPRESSO_BATCH_CHUNK) {
+        size_t n = rows - first < EXPRESSO_BATCH_CHUNK ? rows - first : EXPRESSO_BATCH_CHUNK;
+        run_chunk(batch, columns, first, n);
+
+        size_t bytes = (n + 7) / 8;
+        memcpy((char*)result->values + first * 8, register_values(batch, 0), n * 8);
+        memcpy(result->validity + first / 8, register_validity(batch, 0), bytes);
+        if (n % 8) {
+            result->validity[first / 8 + bytes - 1] &= (uint8_t)((1u << (n % 8)) - 1);
+        }
+    }
+    result->type = batch->result_type;
+}
@@ -0,0 +1,111 @@
+/*
+ * Expresso
+ * batch.h
+ *
+ * Columnar batch evaluation of compiled expressions.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_BATCH_H
+#define EXPRESSO_BATCH_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+#include "expresso.h"
+#include "kernels.h" // For ExpressoSimdLevel
+
+// Rows are evaluated this many at a time, one kernel call per operator
+#define EXPRESSO_BATCH_CHUNK 1024
+
+typedef enum {
+    EXPRESSO_COLUMN_INTEGER, // values is long long[rows]
+    EXPRESSO_COLUMN_FLOAT    // values is double[rows]
+} ExpressoColumnType;
+
+// A column of values. Bit i of validity (least significant bit first) is set
+// if row i holds a value; a NULL validity means every row does.
+typedef struct {
+    ExpressoColumnType type;
+    void* values;
+    uint8_t* validity;
+} ExpressoColumn;
+
+// An expression prepared for columns of particular types (opaque)
+typedef struct ExpressoBatch ExpressoBatch;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Prepare compiled for columns of the given types, one per parameter.
+// Returns NULL if the expression cannot be evaluated column-wise: it uses
+// characters or strings, or a row would always be a type error. Operators
+// take two integers or two floats, so an operator mixing the two, or a float
+// used as a condition, also returns NULL.
+// Such expressions are evaluated row by row with expresso_eval() instead.
+ExpressoBatch* expresso_batch_prepare(const ExpressoCompiled* compiled, const ExpressoColumnType* types);
+
+// Destroy a prepared batch (not the compiled expression)
+void expresso_batch_destroy(ExpressoBatch* batch);
+
+// The type of the result column
+ExpressoColumnType expresso_batch_result_type(const ExpressoBatch* batch);
+
+// Kernels default to the best level the CPU supports. Returns false, leaving
+// the level unchanged, if the CPU or build cannot run the requested one.
+bool expresso_batch_set_simd_level(ExpressoBatch* batch, ExpressoSimdLevel level);
+ExpressoSimdLevel expresso_batch_simd_level(const ExpressoBatch* batch);
+
+// Evaluate rows of columns (one per parameter) into result, whose values
+// and validity buffers the caller provides for rows entries. A result row is
+// invalid if an input it depends on is invalid or its evaluation fails
+// (division by zero, or a value on the way that needs more than 64 bits,
+// which expresso_eval() would promote to a big integer). A batch runs one
+// evaluation at a time: use one per thread.
+void expresso_batch_eval(ExpressoBatch* batch, const ExpressoColumn* columns, size_t rows, ExpressoColumn* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_BATCH_H
@@ -0,0 +1,609 @@
+/*
+ * Expresso
+ * bigint.c
+ *
+ * Arbitrary-precision integers for results that do not fit in 64 bits
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "bigint.h"
+#include "arena.h" // For the evaluation arena and scratch space
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> // For LLONG_MAX
+#include <math.h> // For ldexp
+
+typedef unsigned __int128 DoubleLimb;
+
+// Below this many limbs in the shorter operand, schoolbook multiplication
+// beats Karatsuba's extra additions
+#define KARATSUBA_THRESHOLD 32
+
+// 10^19, the largest power of ten in a limb; decimal conversion works in
+// chunks of 19 digits
+#define DECIMAL_CHUNK 10000000000000000000ULL
+#define DECIMAL_CHUNK_DIGITS 19
+
+static void* checked_malloc(size_t size) {
+    void* memory = malloc(size);
+    if (!memory) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for big integer.\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// Scratch space is taken from the arena between a mark and a release
+static uint64_t* scratch_limbs(size_t count) {
+    return (uint64_t*)expresso_arena_allocate(count * sizeof(uint64_t));
+}
+
+// --- Results ---
+
+static ExpressoBigint* allocate_bigint(size_t length) {
+    size_t size = sizeof(ExpressoBigint) + length * sizeof(uint64_t);
+    ExpressoBigint* value;
+    if (expresso_arena_active()) {
+        value = (ExpressoBigint*)expresso_arena_allocate(size);
+        value->in_arena = true;
+    } else {
+        value = (ExpressoBigint*)checked_malloc(size);
+        value->in_arena = false;
+    }
+    value->length = (uint32_t)length;
+    value->negative = false;
+    return value;
+}
+
+// Trim the leading zero limbs of a result, and return it as an integer if
+// it then fits in one
+static Value finish(ExpressoBigint* value, size_t length, bool negative) {
+    while (length > 0 && value->limbs[length - 1] == 0) length--;
+    if (length <= 1) {
+        uint64_t magnitude = length ? value->limbs[0] : 0;
+        if (magnitude <= (uint64_t)LLONG_MAX || (negative && magnitude == (uint64_t)LLONG_MAX + 1)) {
+            expresso_bigint_free(value);
+            return value_create_integer(negative ? (long long)(0 - magnitude) : (long long)magnitude);
+        }
+    }
+    value->length = (uint32_t)length;
+    value->negative = negative;
+    return value_create_bigint(value);
+}
+
+static Value too_large(void) {
+    return value_create_error_code(EXPRESSO_ERROR_NUMERIC_OVERFLOW);
+}
+
+// --- Operands ---
+
+// The magnitude and sign of an integer, character or big integer value; a
+// small value's single limb is held in the operand itself
+typedef struct {
+    const uint64_t* limbs;
+    size_t length; // 0 for zero
+    bool negative;
+    uint64_t small;
+} Operand;
+
+static void operand_of(Value value, Operand* operand) {
+    ValueType type = value_get_type(value);
+    if (type == VALUE_TYPE_BIGINT) {
+        const ExpressoBigint* bigint = value_get_bigint(value);
+        operand->limbs = bigint->limbs;
+        operand->length = bigint->length;
+        operand->negative = bigint->negative;
+        return;
+    }
+    long long v = type == VALUE_TYPE_CHARACTER ? value_get_character(value) : value_get_integer(value);
+    operand->small = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+    operand->limbs = &operand->small;
+    operand->length = v != 0;
+    operand->negative = v < 0;
+}
+
+// --- Magnitudes ---
+//
+// Magnitudes are limb arrays with explicit lengths. Results are written to
+// arrays sized for the largest possible value; callers trim them.
+
+static int compare_magnitudes(const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (an != bn) return an < bn ? -1 : 1;
+    while (an-- > 0) {
+        if (a[an] != b[an]) return a[an] < b[an] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r = a + b, where an >= bn; r has an + 1 limbs
+static void add_magnitudes(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        uint64_t sum;
+        uint64_t overflow = __builtin_add_overflow(a[i], b[i], &sum);
+        overflow |= __builtin_add_overflow(sum, carry, &sum);
+        r[i] = sum;
+        carry = overflow;
+    }
+    for (; i < an; i++) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    r[an] = carry;
+}
+
+// r = a - b, where a >= b (so an >= bn); r has an limbs and may be a
+static void subtract_magnitudes(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        uint64_t difference;
+        uint64_t underflow = __builtin_sub_overflow(a[i], b[i], &difference);
+        underflow |= __builtin_sub_overflow(difference, borrow, &difference);
+        r[i] = difference;
+        borrow = underflow;
+    }
+    for (; i < an; i++) {
+        uint64_t limb = a[i];
+        r[i] = limb - borrow;
+        borrow = limb < borrow;
+    }
+}
+
+// r += x in place, where r has room for the sum (rn >= xn)
+static void add_into(uint64_t* r, size_t rn, const uint64_t* x, size_t xn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < xn; i++) {
+        uint64_t sum;
+        uint64_t overflow = __builtin_add_overflow(r[i], x[i], &sum);
+        overflow |= __builtin_add_overflow(sum, carry, &sum);
+        r[i] = sum;
+        carry = overflow;
+    }
+    for (; carry && i < rn; i++) {
+        r[i] += carry;
+        carry = r[i] == 0;
+    }
+}
+
+static void multiply_basecase(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    memset(r, 0, (an + bn) * sizeof(uint64_t));
+    for (size_t j = 0; j < bn; j++) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < an; i++) {
+            DoubleLimb t = (DoubleLimb)a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[an + j] = carry;
+    }
+}
+
+static void multiply_magnitudes(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn);
+
+// r = a * b by Karatsuba's method, where bn <= an < 2 * bn. With a and b
+// split at m limbs into a1:a0 and b1:b0,
+//   a * b = a1 b1 B^2m + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B^m + a0 b0
+// which takes three half-size products rather than four.
+static void multiply_karatsuba(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    size_t m = an / 2;
+    const uint64_t *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+    size_t a1n = an - m, b1n = bn - m; // a1n >= m > 0 and b1n > 0
+    size_t rn = an + bn;
+
+    // a0 b0 and a1 b1 go straight to the low and high halves of r
+    multiply_magnitudes(r, a0, m, b0, m);
+    multiply_magnitudes(r + 2 * m, a1, a1n, b1, b1n);
+
+    ExpressoArenaMark mark = expresso_arena_mark();
+    size_t san = a1n + 1, sbn = (b1n > m ? b1n : m) + 1;
+    uint64_t* sa = scratch_limbs(san);
+    uint64_t* sb = scratch_limbs(sbn);
+    add_magnitudes(sa, a1, a1n, a0, m);
+    if (b1n >= m) {
+        add_magnitudes(sb, b1, b1n, b0, m);
+    } else {
+        add_magnitudes(sb, b0, m, b1, b1n);
+    }
+
+    size_t middle_n = san + sbn;
+    uint64_t* middle = scratch_limbs(middle_n);
+    multiply_magnitudes(middle, sa, san, sb, sbn);
+    subtract_magnitudes(middle, middle, middle_n, r, 2 * m);
+    subtract_magnitudes(middle, middle, middle_n, r + 2 * m, rn - 2 * m);
+    // a0 b1 + a1 b0 < B^(rn - m), so the limbs above that are zero
+    if (middle_n > rn - m) middle_n = rn - m;
+    add_into(r + m, rn - m, middle, middle_n);
+    expresso_arena_release(mark);
+}
+
+// r = a * b; r has an + bn limbs and is distinct from a and b
+static void multiply_magnitudes(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (an < bn) {
+        const uint64_t* t = a;
+        a = b;
+        b = t;
+        size_t tn = an;
+        an = bn;
+        bn = tn;
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        multiply_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (an < 2 * bn) {
+        multiply_karatsuba(r, a, an, b, bn);
+        return;
+    }
+
+    // Much longer a: multiply b by slices of a the length of b
+    ExpressoArenaMark mark = expresso_arena_mark();
+    uint64_t* product = scratch_limbs(2 * bn);
+    memset(r, 0, (an + bn) * sizeof(uint64_t));
+    for (size_t i = 0; i < an; i += bn) {
+        size_t n = an - i < bn ? an - i : bn;
+        multiply_magnitudes(product, a + i, n, b, bn);
+        add_into(r + i, an + bn - i, product, n + bn);
+    }
+    expresso_arena_release(mark);
+}
+
+// (high:low) / divisor, where high < divisor so the quotient fits in a limb
+static inline uint64_t divide_double_limb(uint64_t high, uint64_t low, uint64_t divisor, uint64_t* remainder) {
+#if defined(__x86_64__)
+    uint64_t quotient;
+    __asm__("divq %4" : "=a"(quotient), "=d"(*remainder) : "a"(low), "d"(high), "rm"(divisor));
+    return quotient;
+#else
+    DoubleLimb dividend = ((DoubleLimb)high << 64) | low;
+    *remainder = (uint64_t)(dividend % divisor);
+    return (uint64_t)(dividend / divisor);
+#endif
+}
+
+// q = u / divisor, returning the remainder; q has un limbs and may be u
+static uint64_t divide_by_limb(uint64_t* q, const uint64_t* u, size_t un, uint64_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = un; i-- > 0;) {
+        q[i] = divide_double_limb(remainder, u[i], divisor, &remainder);
+    }
+    return remainder;
+}
+
+// q = u / v and r = u % v by Knuth's algorithm D (TAOCP 4.3.1), where
+// un >= vn >= 2 and v's top limb is nonzero. q has un - vn + 1 limbs and r
+// has vn.
+static void divide_magnitudes(uint64_t* q, uint64_t* r, const uint64_t* u, size_t un, const uint64_t* v, size_t vn) {
+    ExpressoArenaMark mark = expresso_arena_mark();
+    uint64_t* vs = scratch_limbs(vn);
+    uint64_t* us = scratch_limbs(un + 1);
+
+    // Shift both so the divisor's top bit is set, which keeps each quotient
+    // limb estimate within 2 of the truth
+    int shift = __builtin_clzll(v[vn - 1]);
+    for (size_t i = vn - 1; i > 0; i--) {
+        vs[i] = shift ? (v[i] << shift) | (v[i - 1] >> (64 - shift)) : v[i];
+    }
+    vs[0] = v[0] << shift;
+    us[un] = shift ? u[un - 1] >> (64 - shift) : 0;
+    for (size_t i = un - 1; i > 0; i--) {
+        us[i] = shift ? (u[i] << shift) | (u[i - 1] >> (64 - shift)) : u[i];
+    }
+    us[0] = u[0] << shift;
+
+    for (size_t j = un - vn + 1; j-- > 0;) {
+        DoubleLimb dividend = ((DoubleLimb)us[j + vn] << 64) | us[j + vn - 1];
+        DoubleLimb estimate = dividend / vs[vn - 1];
+        DoubleLimb rest = dividend % vs[vn - 1];
+        while ((estimate >> 64) != 0 ||
+               estimate * vs[vn - 2] > ((rest << 64) | us[j + vn - 2])) {
+            estimate--;
+            rest += vs[vn - 1];
+            if ((rest >> 64) != 0) break;
+        }
+
+        // us[j .. j + vn] -= estimate * vs
+        uint64_t carry = 0, borrow = 0;
+        for (size_t i = 0; i < vn; i++) {
+            DoubleLimb product = estimate * vs[i] + carry;
+            carry = (uint64_t)(product >> 64);
+            uint64_t difference;
+            uint64_t underflow = __builtin_sub_overflow(us[i + j], (uint64_t)product, &difference);
+            underflow |= __builtin_sub_overflow(difference, borrow, &difference);
+            us[i + j] = difference;
+            borrow = underflow;
+        }
+        bool negative = (DoubleLimb)us[j + vn] < (DoubleLimb)carry + borrow;
+        us[j + vn] -= carry + borrow;
+
+        // The estimate was one too large: add the divisor back
+        if (negative) {
+            estimate--;
+            uint64_t add_carry = 0;
+            for (size_t i = 0; i < vn; i++) {
+                uint64_t sum;
+                uint64_t overflow = __builtin_add_overflow(us[i + j], vs[i], &sum);
+                overflow |= __builtin_add_overflow(sum, add_carry, &sum);
+                us[i + j] = sum;
+                add_carry = overflow;
+            }
+            us[j + vn] += add_carry;
+        }
+        q[j] = (uint64_t)estimate;
+    }
+
+    if (r) {
+        for (size_t i = 0; i < vn; i++) {
+            r[i] = shift ? (us[i] >> shift) | (us[i + 1] << (64 - shift)) : us[i];
+        }
+    }
+    expresso_arena_release(mark);
+}
+
+// --- Arithmetic ---
+
+// a + b, or a - b when subtract is set
+static Value add_operands(const Operand* a, const Operand* b, bool subtract) {
+    bool a_negative = a->negative, b_negative = b->negative != subtract;
+    if (a->length < b->length ||
+        (a_negative != b_negative && compare_magnitudes(a->limbs, a->length, b->limbs, b->length) < 0)) {
+        const Operand* t = a;
+        a = b;
+        b = t;
+        bool tn = a_negative;
+        a_negative = b_negative;
+        b_negative = tn;
+    }
+
+    // The sign is that of the operand with the larger magnitude
+    if (a_negative == b_negative) {
+        if (a->length + 1 > EXPRESSO_BIGINT_MAX_LIMBS) return too_large();
+        ExpressoBigint* result = allocate_bigint(a->length + 1);
+        add_magnitudes(result->limbs, a->limbs, a->length, b->limbs, b->length);
+        return finish(result, a->length + 1, a_negative);
+    }
+    ExpressoBigint* result = allocate_bigint(a->length);
+    subtract_magnitudes(result->limbs, a->limbs, a->length, b->limbs, b->length);
+    return finish(result, a->length, a_negative);
+}
+
+Value expresso_bigint_add(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    return add_operands(&a, &b, false);
+}
+
+Value expresso_bigint_subtract(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    return add_operands(&a, &b, true);
+}
+
+Value expresso_bigint_multiply(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    if (a.length == 0 || b.length == 0) return value_create_integer(0);
+    if (a.length + b.length > EXPRESSO_BIGINT_MAX_LIMBS) return too_large();
+
+    ExpressoBigint* result = allocate_bigint(a.length + b.length);
+    multiply_magnitudes(result->limbs, a.limbs, a.length, b.limbs, b.length);
+    return finish(result, a.length + b.length, a.negative != b.negative);
+}
+
+// a / b, or a % b when remainder is set; both truncate toward zero
+static Value divide_operands(const Operand* a, const Operand* b, bool remainder) {
+    if (b->length == 0) return value_create_error_code(EXPRESSO_ERROR_DIVISION_BY_ZERO);
+
+    bool negative = remainder ? a->negative : a->negative != b->negative;
+    if (compare_magnitudes(a->limbs, a->length, b->limbs, b->length) < 0) {
+        if (!remainder) return value_create_integer(0);
+        ExpressoBigint* result = allocate_bigint(a->length);
+        memcpy(result->limbs, a->limbs, a->length * sizeof(uint64_t));
+        return finish(result, a->length, negative);
+    }
+
+    size_t qn = a->length - b->length + 1;
+    ExpressoBigint* result = allocate_bigint(remainder ? b->length : qn);
+    ExpressoArenaMark mark = expresso_arena_mark();
+    if (b->length == 1) {
+        uint64_t* q = remainder ? scratch_limbs(a->length) : result->limbs;
+        uint64_t r = divide_by_limb(q, a->limbs, a->length, b->limbs[0]);
+        if (remainder) result->limbs[0] = r;
+    } else if (remainder) {
+        divide_magnitudes(scratch_limbs(qn), result->limbs, a->limbs, a->length, b->limbs, b->length);
+    } else {
+        divide_magnitudes(result->limbs, NULL, a->limbs, a->length, b->limbs, b->length);
+    }
+    expresso_arena_release(mark);
+    return finish(result, remainder ? b->length : qn, negative);
+}
+
+Value expresso_bigint_divide(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    return divide_operands(&a, &b, false);
+}
+
+Value expresso_bigint_modulo(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    return divide_operands(&a, &b, true);
+}
+
+Value expresso_bigint_negate(Value value) {
+    Operand a;
+    operand_of(value, &a);
+    ExpressoBigint* result = allocate_bigint(a.length);
+    memcpy(result->limbs, a.limbs, a.length * sizeof(uint64_t));
+    return finish(result, a.length, !a.negative);
+}
+
+int expresso_bigint_compare(Value leftValue, Value rightValue) {
+    Operand a, b;
+    operand_of(leftValue, &a);
+    operand_of(rightValue, &b);
+    if (a.negative != b.negative) return a.negative ? -1 : 1;
+    int order = compare_magnitudes(a.limbs, a.length, b.limbs, b.length);
+    return a.negative ? -order : order;
+}
+
+double expresso_bigint_to_double(const ExpressoBigint* value) {
+    size_t low = value->length > 3 ? value->length - 3 : 0;
+    double d = 0;
+    for (size_t i = value->length; i-- > low;) {
+        d = d * 18446744073709551616.0 + (double)value->limbs[i];
+    }
+    d = ldexp(d, (int)(64 * low));
+    return value->negative ? -d : d;
+}
+
+// --- Conversion and ownership ---
+
+// Sixteen hex digits to a limb, filled from the least significant end
+static Value parse_hex(const char* digits, bool negative) {
+    size_t count = strspn(digits, "0123456789abcdefABCDEF");
+    if (count == 0 || digits[count] != '\0') return value_create_error_code(EXPRESSO_ERROR_INVALID_INTEGER);
+
+    size_t capacity = (count + 15) / 16;
+    if (capacity > EXPRESSO_BIGINT_MAX_LIMBS) return too_large();
+    ExpressoBigint* result = allocate_bigint(capacity);
+    for (size_t limb = 0; limb < capacity; limb++) {
+        size_t end = count - limb * 16;
+        uint64_t value = 0;
+        for (size_t i = end > 16 ? end - 16 : 0; i < end; i++) {
+            char c = digits[i];
+            value = value << 4 | (uint64_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        result->limbs[limb] = value;
+    }
+    return finish(result, capacity, negative);
+}
+
+Value expresso_bigint_parse(const char* text) {
+    bool negative = *text == '-';
+    const char* digits = text + negative;
+    if (digits[0] == '0' && digits[1] == 'x') return parse_hex(digits + 2, negative);
+    size_t count = strspn(digits, "0123456789");
+    if (count == 0 || digits[count] != '\0') return value_create_error_code(EXPRESSO_ERROR_INVALID_INTEGER);
+
+    // Each limb holds more than 19 decimal digits
+    size_t capacity = count / DECIMAL_CHUNK_DIGITS + 1;
+    if (capacity > EXPRESSO_BIGINT_MAX_LIMBS) return too_large();
+    ExpressoBigint* result = allocate_bigint(capacity);
+
+    // Fold in 19 digits at a time, the first chunk taking the odd ones
+    size_t length = 0, chunk = count % DECIMAL_CHUNK_DIGITS;
+    if (chunk == 0) chunk = DECIMAL_CHUNK_DIGITS;
+    for (const char* p = digits; *p; chunk = DECIMAL_CHUNK_DIGITS) {
+        uint64_t value = 0, scale = 1;
+        for (size_t i = 0; i < chunk; i++, p++) {
+            value = value * 10 + (uint64_t)(*p - '0');
+            scale *= 10;
+        }
+        uint64_t carry = value;
+        for (size_t i = 0; i < length; i++) {
+            DoubleLimb t = (DoubleLimb)result->limbs[i] * scale + carry;
+            result->limbs[i] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        if (carry) result->limbs[length++] = carry;
+    }
+    return finish(result, length, negative);
+}
+
+// Write the digits of a chunk below 10^19, padded with zeros to width
+static char* write_chunk(char* out, uint64_t chunk, int width) {
+    for (int i = width; i-- > 0;) {
+        out[i] = (char)('0' + chunk % 10);
+        chunk /= 10;
+    }
+    return out + width;
+}
+
+char* expresso_bigint_to_string(const ExpressoBigint* value) {
+    size_t n = value->length;
+    // A limb has fewer than 20 decimal digits
+    char* text = (char*)checked_malloc(n * 20 + 2);
+    char* out = text;
+    if (value->negative) *out++ = '-';
+
+    // Peel 19 digits at a time off the low end, one limb division per limb
+    ExpressoArenaMark mark = expresso_arena_mark();
+    uint64_t* chunks = scratch_limbs(n * 20 / DECIMAL_CHUNK_DIGITS + 1);
+    uint64_t* quotient = scratch_limbs(n);
+    memcpy(quotient, value->limbs, n * sizeof(uint64_t));
+    size_t count = 0;
+    while (n > 0) {
+        chunks[count++] = divide_by_limb(quotient, quotient, n, DECIMAL_CHUNK);
+        while (n > 0 && quotient[n - 1] == 0) n--;
+    }
+
+    int width = 1;
+    for (uint64_t top = chunks[count - 1]; top >= 10; top /= 10) width++;
+    out = write_chunk(out, chunks[count - 1], width);
+    for (size_t i = count - 1; i-- > 0;) {
+        out = write_chunk(out, chunks[i], DECIMAL_CHUNK_DIGITS);
+    }
+    *out = '\0';
+    expresso_arena_release(mark);
+    return text;
+}
+
+ExpressoBigint* expresso_bigint_copy(const ExpressoBigint* value) {
+    size_t size = sizeof(ExpressoBigint) + value->length * sizeof(uint64_t);
+    ExpressoBigint* copy = (ExpressoBigint*)checked_malloc(size);
+    memcpy(copy, value, size);
+    copy->in_arena = false;
+    return copy;
+}
+
+void expresso_bigint_free(ExpressoBigint* value) {
+    if (value && !value->in_arena) free(value);
+}
@@ -0,0 +1,117 @@
+/*
+ * Expresso
+ * bigint.h
+ *
+ * Arbitrary-precision integers for results that do not fit in 64 bits
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_BIGINT_H
+#define EXPRESSO_BIGINT_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint64_t
+#include "value.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Integer arithmetic is 64-bit, and a result that does not fit is promoted
+// to a VALUE_TYPE_BIGINT value. Results that fit are always returned as
+// VALUE_TYPE_INTEGER, so a big integer never holds a value a long long
+// could, and ordinary arithmetic stays on the unboxed path.
+//
+// The magnitude is held in 64-bit limbs, least significant first, with a
+// nonzero top limb; the sign is kept apart from it.
+struct ExpressoBigint {
+    uint32_t length;
+    bool negative;
+    bool in_arena; // Freed with the evaluation arena (see arena.h) rather than by value_destroy()
+    uint64_t limbs[];
+};
+
+// Results that could need more limbs than this are a "Numeric overflow."
+// error
+#define EXPRESSO_BIGINT_MAX_LIMBS 65536
+
+// --- Arithmetic ---
+//
+// The operands are integers, characters or big integers; they are not
+// destroyed. Division truncates toward zero, as for integers.
+Value expresso_bigint_add(Value leftValue, Value rightValue);
+Value expresso_bigint_subtract(Value leftValue, Value rightValue);
+Value expresso_bigint_multiply(Value leftValue, Value rightValue);
+Value expresso_bigint_divide(Value leftValue, Value rightValue);
+Value expresso_bigint_modulo(Value leftValue, Value rightValue);
+Value expresso_bigint_negate(Value value);
+
+// Negative, zero or positive as leftValue is less than, equal to or greater
+// than rightValue
+int expresso_bigint_compare(Value leftValue, Value rightValue);
+
+// value as a double, rounded from its top 192 bits (infinite past DBL_MAX)
+double expresso_bigint_to_double(const ExpressoBigint* value);
+
+// --- Conversion and ownership ---
+
+// Value of an optional '-' followed by decimal digits, or by "0x" and hex
+// digits, as an integer if it fits; an error if the text is not such a
+// number
+Value expresso_bigint_parse(const char* text);
+
+// Decimal digits of value, with a leading '-' if negative. The caller
+// frees the string.
+char* expresso_bigint_to_string(const ExpressoBigint* value);
+
+// Copy value onto the heap, where it outlives any evaluation
+ExpressoBigint* expresso_bigint_copy(const ExpressoBigint* value);
+
+// Free a heap-allocated big integer; those in the arena are left to it
+void expresso_bigint_free(ExpressoBigint* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_BIGINT_H
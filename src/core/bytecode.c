@@ -0,0 +1,425 @@
+/*
+ * Expresso
+ * bytecode.c
+ *
+ * Compiler from the native expression tree to VM bytecode.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "bytecode.h"
+#include "intern.h" // For interned literals
+#include "bigint.h" // For big integer literals
+#include "evaluator.h" // For evaluator_max_depth
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    ExpressoProgram* program;
+    const ExpressoAst* ast;
+    size_t depth; // Operand stack depth at the current point of the code
+    bool valid;   // Cleared if the tree holds an unknown operator
+} Compiler;
+
+static void emit_byte(ExpressoProgram* program, uint8_t byte) {
+    if (program->code_size == program->code_capacity) {
+        size_t capacity = program->code_capacity ? program->code_capacity * 2 : 64;
+        uint8_t* code = (uint8_t*)realloc(program->code, capacity);
+        if (!code) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode.\n");
+            exit(EXIT_FAILURE);
+        }
+        program->code = code;
+        program->code_capacity = capacity;
+    }
+    program->code[program->code_size++] = byte;
+}
+
+// Emit an operand and return its offset so jumps can be patched later
+static size_t emit_operand(ExpressoProgram* program, uint32_t operand) {
+    size_t offset = program->code_size;
+    uint8_t bytes[sizeof operand];
+    memcpy(bytes, &operand, sizeof operand);
+    for (size_t i = 0; i < sizeof operand; i++) {
+        emit_byte(program, bytes[i]);
+    }
+    return offset;
+}
+
+static void patch_operand(ExpressoProgram* program, size_t offset, uint32_t operand) {
+    memcpy(program->code + offset, &operand, sizeof operand);
+}
+
+static uint32_t add_constant(ExpressoProgram* program, Value value) {
+    if (program->constant_count == program->constant_capacity) {
+        size_t capacity = program->constant_capacity ? program->constant_capacity * 2 : 16;
+        Value* constants = (Value*)realloc(program->constants, capacity * sizeof(Value));
+        if (!constants) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode constants.\n");
+            exit(EXIT_FAILURE);
+        }
+        program->constants = constants;
+        program->constant_capacity = capacity;
+    }
+    program->constants[program->constant_count] = value;
+    return (uint32_t)program->constant_count++;
+}
+
+static uint32_t parameter_slot(ExpressoProgram* program, const char* name) {
+    size_t slot;
+    if (expresso_program_parameter_slot(program, name, &slot)) return (uint32_t)slot;
+
+    char** parameters = (char**)realloc(program->parameters, (program->parameter_count + 1) * sizeof(char*));
+    if (!parameters) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode parameters.\n");
+        exit(EXIT_FAILURE);
+    }
+    program->parameters = parameters;
+    program->parameters[program->parameter_count] = strdup(name);
+    if (!program->parameters[program->parameter_count]) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode parameter name.\n");
+        exit(EXIT_FAILURE);
+    }
+    return (uint32_t)program->parameter_count++;
+}
+
+static void push_depth(Compiler* compiler) {
+    compiler->depth++;
+    if (compiler->depth > compiler->program->max_stack) {
+        compiler->program->max_stack = compiler->depth;
+    }
+}
+
+static void emit_operator(Compiler* compiler, ExpressoOperator op) {
+    ExpressoOpcode opcode;
+
+    switch (op) {
+        case EXPRESSO_OP_NEGATE:        opcode = EXPRESSO_OPCODE_NEGATE; break;
+        case EXPRESSO_OP_LOGICAL_NOT:   opcode = EXPRESSO_OPCODE_LOGICAL_NOT; break;
+        case EXPRESSO_OP_BITWISE_NOT:   opcode = EXPRESSO_OPCODE_BITWISE_NOT; break;
+        case EXPRESSO_OP_MULTIPLY:      opcode = EXPRESSO_OPCODE_MULTIPLY; break;
+        case EXPRESSO_OP_DIVIDE:        opcode = EXPRESSO_OPCODE_DIVIDE; break;
+        case EXPRESSO_OP_MODULO:        opcode = EXPRESSO_OPCODE_MODULO; break;
+        case EXPRESSO_OP_ADD:           opcode = EXPRESSO_OPCODE_ADD; break;
+        case EXPRESSO_OP_SUBTRACT:      opcode = EXPRESSO_OPCODE_SUBTRACT; break;
+        case EXPRESSO_OP_SHIFT_LEFT:    opcode = EXPRESSO_OPCODE_SHIFT_LEFT; break;
+        case EXPRESSO_OP_SHIFT_RIGHT:   opcode = EXPRESSO_OPCODE_SHIFT_RIGHT; break;
+        case EXPRESSO_OP_LESS:          opcode = EXPRESSO_OPCODE_LESS; break;
+        case EXPRESSO_OP_GREATER:       opcode = EXPRESSO_OPCODE_GREATER; break;
+        case EXPRESSO_OP_LESS_EQUAL:    opcode = EXPRESSO_OPCODE_LESS_EQUAL; break;
+        case EXPRESSO_OP_GREATER_EQUAL: opcode = EXPRESSO_OPCODE_GREATER_EQUAL; break;
+        case EXPRESSO_OP_EQUAL:         opcode = EXPRESSO_OPCODE_EQUAL; break;
+        case EXPRESSO_OP_NOT_EQUAL:     opcode = EXPRESSO_OPCODE_NOT_EQUAL; break;
+        case EXPRESSO_OP_BITWISE_AND:   opcode = EXPRESSO_OPCODE_BITWISE_AND; break;
+        case EXPRESSO_OP_BITWISE_XOR:   opcode = EXPRESSO_OPCODE_BITWISE_XOR; break;
+        case EXPRESSO_OP_BITWISE_OR:    opcode = EXPRESSO_OPCODE_BITWISE_OR; break;
+        default:
+            compiler->valid = false;
+            return;
+    }
+    emit_byte(compiler->program, (uint8_t)opcode);
+}
+
+static void compile_constant(Compiler* compiler, Value value) {
+    emit_byte(compiler->program, EXPRESSO_OPCODE_CONSTANT);
+    emit_operand(compiler->program, add_constant(compiler->program, value));
+    push_depth(compiler);
+}
+
+static bool is_addition(const ExpressoNode* node) {
+    return node->kind == EXPRESSO_NODE_BINARY && node->op == EXPRESSO_OP_ADD;
+}
+
+// Whether a chain of + down the left of node, as in "a" + s + "b" + t, is
+// worth adding in one step: it has three terms or more, and a string
+// literal, so it concatenates once rather than copying at every +. Numeric
+// chains are left as single additions, which the JIT and batch paths take.
+static bool is_concatenation(const ExpressoAst* ast, const ExpressoNode* node) {
+    size_t terms = 1;
+    bool has_string = false;
+    for (; is_addition(node); node = &ast->nodes[node->children[0]]) {
+        has_string |= ast->nodes[node->children[1]].kind == EXPRESSO_NODE_STRING;
+        terms++;
+    }
+    has_string |= node->kind == EXPRESSO_NODE_STRING;
+    return terms >= 3 && has_string;
+}
+
+// The compiler walks the tree with an explicit stack of tasks rather than
+// recursing, so deep trees cannot exhaust the native stack. Tasks run in the
+// reverse of the order they are pushed.
+typedef enum {
+    TASK_NODE,        // Compile node, nested level interior nodes deep
+    TASK_UNARY,       // Emit node's unary operator
+    TASK_BINARY,      // Emit node's binary operator
+    TASK_TEST,        // Emit the test of node's left operand of && or ||
+    TASK_LOGICAL,     // Emit node's LOGICAL_AND or LOGICAL_OR; first is the test's end operand
+    TASK_BRANCH,      // Emit the branch on node's condition
+    TASK_ELSE,        // Emit the jump over node's else branch; first and second
+                      // are the branch's else and end operands
+    TASK_END,         // Patch first and second, the end operands, to here
+    TASK_ADD_CHAIN    // Emit ADD_CHAIN of first terms
+} TaskKind;
+
+typedef struct {
+    TaskKind kind;
+    ExpressoNodeIndex node;
+    size_t level;
+    size_t first;
+    size_t second;
+} Task;
+
+typedef struct {
+    Task* tasks;
+    size_t count;
+    size_t capacity;
+} TaskStack;
+
+static void push_task(TaskStack* stack, TaskKind kind, ExpressoNodeIndex node, size_t level, size_t first, size_t second) {
+    if (stack->count == stack->capacity) {
+        size_t capacity = stack->capacity ? stack->capacity * 2 : 64;
+        Task* tasks = (Task*)realloc(stack->tasks, capacity * sizeof(Task));
+        if (!tasks) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode compiler tasks.\n");
+            exit(EXIT_FAILURE);
+        }
+        stack->tasks = tasks;
+        stack->capacity = capacity;
+    }
+    stack->tasks[stack->count++] = (Task){ kind, node, level, first, second };
+}
+
+// Compile a leaf, or push the tasks that compile an interior node: its
+// operands first, then the code that combines them. Returns false if the
+// node nests deeper than evaluate_ast() would go.
+static bool compile_node(Compiler* compiler, TaskStack* stack, ExpressoNodeIndex index, size_t level) {
+    const ExpressoAst* ast = compiler->ast;
+    const ExpressoNode* node = &ast->nodes[index];
+
+    switch ((ExpressoNodeKind)node->kind) {
+        case EXPRESSO_NODE_INTEGER:
+            compile_constant(compiler, value_create_integer(node->data.integer_value));
+            return true;
+        case EXPRESSO_NODE_FLOAT:
+            compile_constant(compiler, value_create_float(node->data.float_value));
+            return true;
+        case EXPRESSO_NODE_CHARACTER:
+            compile_constant(compiler, value_create_character(node->data.char_value));
+            return true;
+        case EXPRESSO_NODE_STRING:
+            if (expresso_intern_enabled()) {
+                compile_constant(compiler, value_create_interned_string(expresso_ast_string(ast, node), node->data.text.length));
+            } else {
+                compile_constant(compiler, value_create_string_from(expresso_ast_string(ast, node), node->data.text.length));
+            }
+            return true;
+        case EXPRESSO_NODE_BIGINT:
+            compile_constant(compiler, expresso_bigint_parse(expresso_ast_string(ast, node)));
+            return true;
+        case EXPRESSO_NODE_PARAMETER:
+            emit_byte(compiler->program, EXPRESSO_OPCODE_PARAMETER);
+            emit_operand(compiler->program, parameter_slot(compiler->program, expresso_ast_string(ast, node)));
+            push_depth(compiler);
+            return true;
+        default:
+            break;
+    }
+
+    if (++level > evaluator_max_depth()) return false;
+
+    switch ((ExpressoNodeKind)node->kind) {
+        case EXPRESSO_NODE_UNARY:
+            // Unary plus is a no-op
+            if (node->op != EXPRESSO_OP_PLUS) push_task(stack, TASK_UNARY, index, level, 0, 0);
+            push_task(stack, TASK_NODE, node->children[0], level, 0, 0);
+            break;
+        case EXPRESSO_NODE_BINARY:
+            if (node->op == EXPRESSO_OP_LOGICAL_AND || node->op == EXPRESSO_OP_LOGICAL_OR) {
+                push_task(stack, TASK_TEST, index, level, 0, 0);
+                push_task(stack, TASK_NODE, node->children[0], level, 0, 0);
+                break;
+            }
+            if (is_concatenation(ast, node)) {
+                // The terms of the chain of + down the left, leftmost first
+                size_t terms = 1;
+                size_t add_chain = stack->count;
+                push_task(stack, TASK_ADD_CHAIN, index, level, 0, 0);
+                for (; is_addition(node); node = &ast->nodes[node->children[0]]) {
+                    push_task(stack, TASK_NODE, node->children[1], level, 0, 0);
+                    terms++;
+                }
+                push_task(stack, TASK_NODE, (ExpressoNodeIndex)(node - ast->nodes), level, 0, 0);
+                stack->tasks[add_chain].first = terms;
+                break;
+            }
+            push_task(stack, TASK_BINARY, index, level, 0, 0);
+            push_task(stack, TASK_NODE, node->children[1], level, 0, 0);
+            push_task(stack, TASK_NODE, node->children[0], level, 0, 0);
+            break;
+        case EXPRESSO_NODE_CONDITIONAL:
+            push_task(stack, TASK_BRANCH, index, level, 0, 0);
+            push_task(stack, TASK_NODE, node->children[0], level, 0, 0);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+// Run one task. The right operand of && and || is skipped when the left one
+// decides the result, and each branch of ?: leaves one value, starting from
+// the same depth. Returns false if the tree nests too deeply.
+static bool run_task(Compiler* compiler, TaskStack* stack, Task task) {
+    ExpressoProgram* program = compiler->program;
+    const ExpressoNode* node = &compiler->ast->nodes[task.node];
+    bool is_and = node->op == EXPRESSO_OP_LOGICAL_AND;
+
+    switch (task.kind) {
+        case TASK_NODE:
+            return compile_node(compiler, stack, task.node, task.level);
+        case TASK_UNARY:
+            emit_operator(compiler, (ExpressoOperator)node->op);
+            break;
+        case TASK_BINARY:
+            emit_operator(compiler, (ExpressoOperator)node->op);
+            compiler->depth--;
+            break;
+        case TASK_TEST: {
+            emit_byte(program, is_and ? EXPRESSO_OPCODE_AND_THEN : EXPRESSO_OPCODE_OR_ELSE);
+            size_t end_operand = emit_operand(program, 0);
+            compiler->depth--;
+            push_task(stack, TASK_LOGICAL, task.node, task.level, end_operand, 0);
+            push_task(stack, TASK_NODE, node->children[1], task.level, 0, 0);
+            break;
+        }
+        case TASK_LOGICAL:
+            emit_byte(program, is_and ? EXPRESSO_OPCODE_LOGICAL_AND : EXPRESSO_OPCODE_LOGICAL_OR);
+            patch_operand(program, task.first, (uint32_t)program->code_size);
+            break;
+        case TASK_BRANCH: {
+            emit_byte(program, EXPRESSO_OPCODE_BRANCH);
+            size_t else_operand = emit_operand(program, 0);
+            size_t end_operand = emit_operand(program, 0);
+            compiler->depth--;
+            push_task(stack, TASK_ELSE, task.node, task.level, else_operand, end_operand);
+            push_task(stack, TASK_NODE, node->children[1], task.level, 0, 0);
+            break;
+        }
+        case TASK_ELSE: {
+            emit_byte(program, EXPRESSO_OPCODE_JUMP);
+            size_t jump_operand = emit_operand(program, 0);
+            compiler->depth--;
+            patch_operand(program, task.first, (uint32_t)program->code_size);
+            push_task(stack, TASK_END, task.node, task.level, task.second, jump_operand);
+            push_task(stack, TASK_NODE, node->children[2], task.level, 0, 0);
+            break;
+        }
+        case TASK_END:
+            patch_operand(program, task.first, (uint32_t)program->code_size);
+            patch_operand(program, task.second, (uint32_t)program->code_size);
+            break;
+        case TASK_ADD_CHAIN:
+            emit_byte(program, EXPRESSO_OPCODE_ADD_CHAIN);
+            emit_operand(program, (uint32_t)task.first);
+            compiler->depth -= task.first - 1;
+            break;
+    }
+    return true;
+}
+
+ExpressoProgram* expresso_program_compile(const ExpressoAst* ast, ExpressoErrorCode* error) {
+    if (!ast || ast->root == EXPRESSO_NODE_NONE) {
+        if (error) *error = EXPRESSO_ERROR_EMPTY_TREE;
+        return NULL;
+    }
+
+    ExpressoProgram* program = (ExpressoProgram*)calloc(1, sizeof(ExpressoProgram));
+    if (!program) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for bytecode program.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Compiler compiler = { program, ast, 0, true };
+    TaskStack stack = { NULL, 0, 0 };
+    bool nested_too_deeply = false;
+    push_task(&stack, TASK_NODE, ast->root, 0, 0, 0);
+    while (stack.count > 0 && !nested_too_deeply) {
+        nested_too_deeply = !run_task(&compiler, &stack, stack.tasks[--stack.count]);
+    }
+    free(stack.tasks);
+
+    if (nested_too_deeply || !compiler.valid) {
+        if (error) *error = nested_too_deeply ? EXPRESSO_ERROR_TOO_DEEP : EXPRESSO_ERROR_UNKNOWN_OPERATOR;
+        expresso_program_destroy(program);
+        return NULL;
+    }
+    emit_byte(program, EXPRESSO_OPCODE_RETURN);
+    return program;
+}
+
+bool expresso_program_parameter_slot(const ExpressoProgram* program, const char* name, size_t* slot) {
+    if (!program || !name) return false;
+
+    for (size_t i = 0; i < program->parameter_count; i++) {
+        if (strcmp(program->parameters[i], name) == 0) {
+            if (slot) *slot = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void expresso_program_destroy(ExpressoProgram* program) {
+    if (!program) return;
+
+    for (size_t i = 0; i < program->parameter_count; i++) {
+        free(program->parameters[i]);
+    }
+    free(program->parameters);
+
+    for (size_t i = 0; i < program->constant_count; i++) {
+        value_destroy(program->constants[i]);
+    }
+    free(program->constants);
+    free(program->code);
+    free(program);
+}
@@ -0,0 +1,144 @@
+/*
+ * Expresso
+ * bytecode.h
+ *
+ * Compact bytecode for expressions, compiled from the native expression tree.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_BYTECODE_H
+#define EXPRESSO_BYTECODE_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint8_t, uint32_t
+#include "value.h"
+#include "ast.h"
+
+// Instruction set of the expression VM. Each instruction is an opcode byte
+// followed by its 32-bit operands, if any, in native byte order.
+typedef enum {
+    EXPRESSO_OPCODE_CONSTANT,      // [index] Push a copy of constants[index]
+    EXPRESSO_OPCODE_PARAMETER,     // [slot] Push a copy of bindings[slot]
+
+    // Unary operators pop one value and push the result
+    EXPRESSO_OPCODE_NEGATE,
+    EXPRESSO_OPCODE_LOGICAL_NOT,
+    EXPRESSO_OPCODE_BITWISE_NOT,
+
+    // Binary operators pop the right then the left operand and push the result
+    EXPRESSO_OPCODE_MULTIPLY,
+    EXPRESSO_OPCODE_DIVIDE,
+    EXPRESSO_OPCODE_MODULO,
+    EXPRESSO_OPCODE_ADD,
+    EXPRESSO_OPCODE_SUBTRACT,
+    EXPRESSO_OPCODE_SHIFT_LEFT,
+    EXPRESSO_OPCODE_SHIFT_RIGHT,
+    EXPRESSO_OPCODE_LESS,
+    EXPRESSO_OPCODE_GREATER,
+    EXPRESSO_OPCODE_LESS_EQUAL,
+    EXPRESSO_OPCODE_GREATER_EQUAL,
+    EXPRESSO_OPCODE_EQUAL,
+    EXPRESSO_OPCODE_NOT_EQUAL,
+    EXPRESSO_OPCODE_BITWISE_AND,
+    EXPRESSO_OPCODE_BITWISE_XOR,
+    EXPRESSO_OPCODE_BITWISE_OR,
+
+    // && and || compile to a test of the left operand that may skip the
+    // right one, then an opcode that turns the right operand into the result
+    EXPRESSO_OPCODE_AND_THEN,      // [end] If the top value is zero replace it with 0 and
+                                   // jump to end; if it is not a condition (integer, bigint
+                                   // or float) replace it with a type error and jump to end;
+                                   // otherwise pop it
+    EXPRESSO_OPCODE_OR_ELSE,       // [end] If the top value is non-zero replace it with 1 and
+                                   // jump to end; if it is not a condition (integer, bigint
+                                   // or float) replace it with a type error and jump to end;
+                                   // otherwise pop it
+    EXPRESSO_OPCODE_LOGICAL_AND,   // Replace the top value with 0 or 1, or a type error
+    EXPRESSO_OPCODE_LOGICAL_OR,    // As LOGICAL_AND, for ||
+
+    EXPRESSO_OPCODE_ADD_CHAIN,     // [count] Replace the top count values with their sum,
+                                   // as value_by_adding_all_values() adds them
+
+    EXPRESSO_OPCODE_BRANCH,        // [else, end] Pop the condition; continue if non-zero,
+                                   // otherwise jump to else. A value that is not a
+                                   // condition (integer, bigint or float) pushes a type
+                                   // error and jumps to end.
+    EXPRESSO_OPCODE_JUMP,          // [target] Continue at target
+    EXPRESSO_OPCODE_RETURN         // Pop and return the result
+} ExpressoOpcode;
+
+// A compiled expression: code plus the constants it pushes
+typedef struct {
+    uint8_t* code;
+    size_t code_size;
+    size_t code_capacity;
+    Value* constants;
+    size_t constant_count;
+    size_t constant_capacity;
+    char** parameters;      // Parameter names without the '$', indexed by slot
+    size_t parameter_count; // Slots are numbered in order of first use
+    size_t max_stack; // Deepest the operand stack can grow while running code
+} ExpressoProgram;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compile a native expression tree. The program does not refer to the tree
+// afterwards. Returns NULL, and sets error (if not NULL), if the tree is
+// empty, holds an unknown operator or nests more deeply than
+// evaluator_max_depth() allows.
+ExpressoProgram* expresso_program_compile(const ExpressoAst* ast, ExpressoErrorCode* error);
+
+// Find the slot of a parameter by name (without the '$')
+// Returns false if the program does not use the parameter
+bool expresso_program_parameter_slot(const ExpressoProgram* program, const char* name, size_t* slot);
+
+// Destroy a program and its constants
+void expresso_program_destroy(ExpressoProgram* program);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_BYTECODE_H
@@ -0,0 +1,149 @@
+/*
+ * Expresso
+ * errors.h
+ *
+ * Header file with the catalogue of the errors the Expresso runtime system
+ * reports: a code for each, its category and its message.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EXPRESSO_ERRORS_H
+#define EXPRESSO_ERRORS_H
+
+#include <stddef.h> // For NULL
+
+// The categories of the specification's error types
+typedef enum {
+    EXPRESSO_ERROR_CATEGORY_SYNTAX,  // SyntaxError: malformed input, with its position
+    EXPRESSO_ERROR_CATEGORY_TYPE,    // TypeError: operands an operator does not accept
+    EXPRESSO_ERROR_CATEGORY_RUNTIME  // RuntimeError: everything else
+} ExpressoErrorCategory;
+
+// Every error Expresso reports: code, category and message. Messages are
+// static and are only looked up when an error is printed or inspected.
+#define EXPRESSO_ERRORS(X) \
+    X(UNRECOGNISED_TOKEN,       SYNTAX,  "Unrecognised token.") \
+    X(EXPECTED_EXPRESSION,      SYNTAX,  "Expected an expression.") \
+    X(EXPECTED_RPAREN,          SYNTAX,  "Expected ')'.") \
+    X(EXPECTED_COLON,           SYNTAX,  "Expected ':'.") \
+    X(CHARACTER_LITERAL,        SYNTAX,  "Character literal must hold one character.") \
+    X(UNEXPECTED_INPUT,         SYNTAX,  "Unexpected input after expression.") \
+    X(PARSE_TOO_DEEP,           SYNTAX,  "Expression nested too deeply.") \
+    X(SYNTAX,                   SYNTAX,  "Syntax error during parsing.") \
+    X(TYPE,                     TYPE,    "Type error.") \
+    X(TYPE_NEGATION,            TYPE,    "Type error for negation.") \
+    X(TYPE_LOGICAL_NOT,         TYPE,    "Type error for logical NOT.") \
+    X(TYPE_BITWISE_NOT,         TYPE,    "Type error for bitwise NOT.") \
+    X(TYPE_LOGICAL_AND,         TYPE,    "Type error for logical AND.") \
+    X(TYPE_LOGICAL_OR,          TYPE,    "Type error for logical OR.") \
+    X(TYPE_CONDITIONAL,         TYPE,    "Type error for conditional.") \
+    X(DIVISION_BY_ZERO,         RUNTIME, "Division by zero.") \
+    X(NUMERIC_OVERFLOW,         RUNTIME, "Numeric overflow.") \
+    X(INVALID_INTEGER,          RUNTIME, "Invalid integer.") \
+    X(TOO_DEEP,                 RUNTIME, "Expression nested too deeply.") \
+    X(UNBOUND_PARAMETER,        RUNTIME, "Unbound parameter.") \
+    X(MISSING_BINDINGS,         RUNTIME, "Missing parameter bindings.") \
+    X(UNKNOWN_OPERATOR,         RUNTIME, "Unknown operator.") \
+    X(UNKNOWN_UNARY_OPERATOR,   RUNTIME, "Unknown unary operator.") \
+    X(UNKNOWN_VALUE_TYPE,       RUNTIME, "Unknown value type.") \
+    X(NOT_A_CONSTANT,           RUNTIME, "Not a constant.") \
+    X(INVALID_NODE,             RUNTIME, "Invalid expression tree node.") \
+    X(INVALID_BYTECODE,         RUNTIME, "Invalid bytecode.") \
+    X(EMPTY_TREE,               RUNTIME, "Cannot evaluate empty expression tree.") \
+    X(NULL_TREE,                RUNTIME, "Cannot evaluate NULL parse tree.") \
+    X(NULL_COMPILED,            RUNTIME, "Cannot evaluate NULL compiled expression.") \
+    X(EMPTY_PROGRAM,            RUNTIME, "Cannot run empty program.") \
+    X(EMPTY_INPUT,              RUNTIME, "Empty input provided for evaluation.") \
+    X(NOT_INITIALIZED,          RUNTIME, "CLI interface not initialized.") \
+    X(INVALID_ACCEPT_ARGUMENTS, RUNTIME, "Invalid arguments to accept") \
+    X(VISITOR_RESULT,           RUNTIME, "Visitor did not return a Value") \
+    X(UNKNOWN,                  RUNTIME, "Unknown Error")
+
+typedef enum {
+    EXPRESSO_ERROR_NONE,
+#define EXPRESSO_ERROR_ENUMERATOR(name, category, message) EXPRESSO_ERROR_##name,
+    EXPRESSO_ERRORS(EXPRESSO_ERROR_ENUMERATOR)
+#undef EXPRESSO_ERROR_ENUMERATOR
+    EXPRESSO_ERROR_CUSTOM // An error whose message was made at run time
+} ExpressoErrorCode;
+
+// Message of a catalogued error; NULL for EXPRESSO_ERROR_NONE and
+// EXPRESSO_ERROR_CUSTOM
+static inline const char* expresso_error_message(ExpressoErrorCode code) {
+    switch (code) {
+#define EXPRESSO_ERROR_MESSAGE(name, category, message) case EXPRESSO_ERROR_##name: return message;
+        EXPRESSO_ERRORS(EXPRESSO_ERROR_MESSAGE)
+#undef EXPRESSO_ERROR_MESSAGE
+        default: return NULL;
+    }
+}
+
+static inline ExpressoErrorCategory expresso_error_category(ExpressoErrorCode code) {
+    switch (code) {
+#define EXPRESSO_ERROR_CATEGORY(name, category, message) \
+        case EXPRESSO_ERROR_##name: return EXPRESSO_ERROR_CATEGORY_##category;
+        EXPRESSO_ERRORS(EXPRESSO_ERROR_CATEGORY)
+#undef EXPRESSO_ERROR_CATEGORY
+        default: return EXPRESSO_ERROR_CATEGORY_RUNTIME;
+    }
+}
+
+// "SyntaxError", "TypeError" or "RuntimeError"
+static inline const char* expresso_error_category_name(ExpressoErrorCategory category) {
+    switch (category) {
+        case EXPRESSO_ERROR_CATEGORY_SYNTAX: return "SyntaxError";
+        case EXPRESSO_ERROR_CATEGORY_TYPE:   return "TypeError";
+        default:                             return "RuntimeError";
+    }
+}
+
+#endif // EXPRESSO_ERRORS_H
@@ -2,9 +2,9 @@
  * Expresso
  * evaluator.c
  *
- * The functions which interact with the parse tree to determine the value of
- * an expression. Functions here are driven by traversing the parse tree as
- * well as initiate the traversal.
+ * The functions which walk the native expression tree to determine the value
+ * of an expression. The tree is lowered from the parse tree by the parser
+ * wrapper; the evaluator reads its nodes directly by index.
  *
  * Expresso is an interactive command-line tool for evaluating expressions.
  * Expresso supports basic data types (integers, characters, strings),
@@ -51,185 +51,303 @@
 #include "parser_wrapper.h"
 #include "value.h"
 #include "operations.h"
+#include "arena.h" // For the evaluation arena
+#include "memo_cache.h"
+#include "intern.h" // For interned literals
+#include "bigint.h" // For big integer literals
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Token types from Expresso.tokens
-#define OP_ADD 15
-#define OP_SUB 16
-#define OP_MUL 17
-#define OP_DIV 18
-#define OP_MOD 19
-#define OP_NOT 20
-#define OP_BIT_NOT 21
-
-// Forward declarations
-Value visit_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree);
-Value visit_additive_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree);
-Value visit_multiplicative_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree);
-Value visit_unary_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree);
-Value visit_primary_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree);
-Value visit_literal(CExpressoVisitor* visitor, ExpressoParseTree* tree);
+// The evaluator walks the tree with its own work stack rather than the C
+// stack: each frame is a node whose operands are still being evaluated, and
+// finished operands wait on a value stack. Native stack use is therefore the
+// same however deeply the input nests.
+typedef struct {
+    ExpressoNodeIndex index;
+    uint32_t next; // Number of children already evaluated
+} Frame;
+
+// Shallow trees run without touching the arena
+#define INLINE_DEPTH 64
+
+typedef struct {
+    Frame* frames;
+    Value* values; // Holds at most one more value than there are frames
+    size_t frame_count;
+    size_t value_count;
+    size_t capacity;
+    Frame inline_frames[INLINE_DEPTH];
+    Value inline_values[INLINE_DEPTH + 1];
+
+    // Values of shared nodes, indexed by node, so that a subtree used in
+    // several places is evaluated once. Only allocated for shared trees.
+    Value* memo;
+    uint8_t* memo_done;
+
+    // Values of constant subtrees kept across evaluations, looked up for the
+    // outermost constant subtrees only. constant is set only with a cache.
+    ExpressoMemoCache* cache;
+    uint8_t* constant;
+} WorkStack;
+
+static size_t max_depth = EXPRESSO_EVAL_DEFAULT_MAX_DEPTH;
+static ExpressoMemoCache* memo_cache = NULL;
+
+void evaluator_set_memo_cache(ExpressoMemoCache* cache) {
+    memo_cache = cache;
+}
+
+ExpressoMemoCache* evaluator_memo_cache(void) {
+    return memo_cache;
+}
+
+void evaluator_set_max_depth(size_t depth) {
+    max_depth = depth ? depth : EXPRESSO_EVAL_DEFAULT_MAX_DEPTH;
+}
+
+size_t evaluator_max_depth(void) {
+    return max_depth;
+}
 
 Value evaluate_expression(ExpressoParseTree* tree) {
     if (tree == NULL) {
-        return value_create_error("Cannot evaluate NULL parse tree.");
+        return value_create_error_code(EXPRESSO_ERROR_NULL_TREE);
     }
+    return evaluate_ast(expresso_tree_get_ast(tree));
+}
 
-    CExpressoVisitor visitor = {
-        .user_data = NULL,
-        .visit_expression = visit_expression,
-        .visit_additive_expression = visit_additive_expression,
-        .visit_multiplicative_expression = visit_multiplicative_expression,
-        .visit_unary_expression = visit_unary_expression,
-        .visit_primary_expression = visit_primary_expression,
-        .visit_literal = visit_literal,
-    };
+static void grow_work_stack(WorkStack* work) {
+    // Deep trees are rare but need many frames, so grow steeply, up to the
+    // limit; the outgrown stacks are left to the arena
+    size_t capacity = work->capacity * 8 < max_depth ? work->capacity * 8 : max_depth;
+    Frame* frames = (Frame*)expresso_arena_allocate(capacity * sizeof(Frame));
+    Value* values = (Value*)expresso_arena_allocate((capacity + 1) * sizeof(Value));
+    memcpy(frames, work->frames, work->frame_count * sizeof(Frame));
+    memcpy(values, work->values, work->value_count * sizeof(Value));
+    work->frames = frames;
+    work->values = values;
+    work->capacity = capacity;
+}
 
-    return expresso_tree_accept(tree, &visitor);
+// Returns false once the tree nests deeper than the configured limit
+static bool push_frame(WorkStack* work, ExpressoNodeIndex index) {
+    if (work->frame_count >= max_depth) return false;
+    if (work->frame_count == work->capacity) grow_work_stack(work);
+    work->frames[work->frame_count++] = (Frame){ index, 0 };
+    return true;
 }
 
-Value visit_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    ExpressoParseTree* child = expresso_tree_get_child(tree, 0);
-    Value result = expresso_tree_accept(child, visitor);
-    expresso_tree_destroy(child);
-    return result;
+static void push_value(WorkStack* work, Value value) {
+    work->values[work->value_count++] = value;
 }
 
-Value visit_literal(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    const char* text = expresso_tree_get_text(tree);
-    if (text[0] == '"') {
-        size_t len = strlen(text);
-        char* str = malloc(len - 1);
-        strncpy(str, text + 1, len - 2);
-        str[len - 2] = '\0';
-        Value val = value_create_string(str);
-        free(str);
-        return val;
-    } else {
-        return value_create_integer(atoi(text));
-    }
+static Value pop_value(WorkStack* work) {
+    return work->values[--work->value_count];
 }
 
-Value visit_additive_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    int child_count = expresso_tree_get_child_count(tree);
-    if (child_count == 1) {
-        return expresso_tree_accept(expresso_tree_get_child(tree, 0), visitor);
-    }
+static Value apply_unary_operator(ExpressoOperator op, Value operand) {
+    // Unary plus is a no-op; the operand is passed through without a copy
+    if (op == EXPRESSO_OP_PLUS) return operand;
 
-    Value result = expresso_tree_accept(expresso_tree_get_child(tree, 0), visitor);
-
-    for (int i = 1; i < child_count; i += 2) {
-        int op_type = expresso_tree_get_terminal_type(expresso_tree_get_child(tree, i));
-        Value right = expresso_tree_accept(expresso_tree_get_child(tree, i + 1), visitor);
-        Value nextResult;
-
-        if (op_type == OP_ADD) {
-            nextResult = value_by_adding_values(result, right);
-            value_destroy(result);
-            result = nextResult;
-        } else if (op_type == OP_SUB) {
-            nextResult = value_by_subtracting_values(result, right);
-            value_destroy(result);
-            result = nextResult;
-        } else {
-            i = child_count;
-            value_destroy(result);
-            result = value_create_error("Unknown operator.");
-        }
-        value_destroy(right);
-    }
+    Value result = value_by_applying_unary_operator(op, operand);
+    value_destroy(operand);
+    return result;
+}
 
+static Value apply_binary_operator(ExpressoOperator op, Value left, Value right) {
+    Value result = value_by_applying_binary_operator(op, left, right);
+    value_destroy(left);
+    value_destroy(right);
     return result;
 }
 
-Value visit_multiplicative_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    int child_count = expresso_tree_get_child_count(tree);
-    if (child_count == 1) {
-        return expresso_tree_accept(expresso_tree_get_child(tree, 0), visitor);
+static Value leaf_value(const ExpressoAst* ast, const ExpressoNode* node) {
+    switch ((ExpressoNodeKind)node->kind) {
+        case EXPRESSO_NODE_INTEGER:
+            return value_create_integer(node->data.integer_value);
+        case EXPRESSO_NODE_FLOAT:
+            return value_create_float(node->data.float_value);
+        case EXPRESSO_NODE_CHARACTER:
+            return value_create_character(node->data.char_value);
+        case EXPRESSO_NODE_STRING:
+            if (expresso_intern_enabled()) {
+                return value_create_interned_string(expresso_ast_string(ast, node), node->data.text.length);
+            }
+            return value_create_string_from(expresso_ast_string(ast, node), node->data.text.length);
+        case EXPRESSO_NODE_BIGINT:
+            return expresso_bigint_parse(expresso_ast_string(ast, node));
+        case EXPRESSO_NODE_PARAMETER:
+            // Parameters are only bound by expresso_eval()
+            return value_create_error_code(EXPRESSO_ERROR_UNBOUND_PARAMETER);
+        default:
+            return value_create_error_code(EXPRESSO_ERROR_INVALID_NODE);
     }
+}
+
+// Is the node constant while the node whose frame is on top is not? The
+// parent is on top both when descending into a node and after its frame
+// was popped.
+static bool outermost_constant(const WorkStack* work, ExpressoNodeIndex index) {
+    return work->constant && work->constant[index] &&
+           (work->frame_count == 0 || !work->constant[work->frames[work->frame_count - 1].index]);
+}
 
-    Value result = expresso_tree_accept(expresso_tree_get_child(tree, 0), visitor);
-
-    for (int i = 1; i < child_count; i += 2) {
-        int op_type = expresso_tree_get_terminal_type(expresso_tree_get_child(tree, i));
-        Value right = expresso_tree_accept(expresso_tree_get_child(tree, i + 1), visitor);
-        Value nextResult;
-
-        if (op_type == OP_MUL) {
-            nextResult = value_by_multiplying_values(result, right);
-            value_destroy(result);
-            result = nextResult;
-        } else if (op_type == OP_DIV) {
-            nextResult = value_by_dividing_values(result, right);
-            value_destroy(result);
-            result = nextResult;
-        } else if (op_type == OP_MOD) {
-            nextResult = value_by_modulasing_values(result, right);
-            value_destroy(result);
-            result = nextResult;
-        } else {
-            i = child_count;
-            value_destroy(result);
-            result = value_create_error("Unknown operator.");
+// Is the value of the top frame's node cached across evaluations?
+static bool records_value(const WorkStack* work) {
+    size_t top = work->frame_count - 1;
+    return work->constant && work->constant[work->frames[top].index] &&
+           (top == 0 || !work->constant[work->frames[top - 1].index]);
+}
+
+// Start evaluating a child. Leaves are evaluated on the spot rather than
+// given a frame, as are shared nodes that already have a value. Returns
+// false if the child would nest too deeply.
+static bool descend(const ExpressoAst* ast, WorkStack* work, ExpressoNodeIndex index) {
+    const ExpressoNode* node = &ast->nodes[index];
+    if (node->kind < EXPRESSO_NODE_UNARY) {
+        push_value(work, leaf_value(ast, node));
+        return true;
+    }
+    if (work->memo && work->memo_done[index]) {
+        push_value(work, value_copy(work->memo[index]));
+        return true;
+    }
+    if (outermost_constant(work, index)) {
+        Value cached;
+        if (expresso_memo_cache_lookup(work->cache, ast, index, &cached)) {
+            push_value(work, cached);
+            return true;
         }
-        value_destroy(right);
     }
-
-    return result;
+    return push_frame(work, index);
 }
 
-Value visit_unary_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    int child_count = expresso_tree_get_child_count(tree);
-    if (child_count == 1) {
-        return expresso_tree_accept(expresso_tree_get_child(tree, 0), visitor);
+// Pop the top frame, leaving its value on the value stack
+static void complete_frame(const ExpressoAst* ast, WorkStack* work, Value value) {
+    ExpressoNodeIndex index = work->frames[--work->frame_count].index;
+    if (work->memo && expresso_ast_is_shared(ast, index)) {
+        work->memo[index] = value_copy(value);
+        work->memo_done[index] = 1;
     }
+    if (outermost_constant(work, index)) expresso_memo_cache_store(work->cache, ast, index, value);
+    push_value(work, value);
+}
 
-    int op_type = expresso_tree_get_terminal_type(expresso_tree_get_child(tree, 0));
-    Value operand = expresso_tree_accept(expresso_tree_get_child(tree, 1), visitor);
-    Value result;
-
-    switch (op_type) {
-        case OP_ADD:
-            // Unary plus, no-op
-            result = operand;
-            break;
-        case OP_SUB:
-            result = value_by_negating_value(operand);
-            value_destroy(operand);
-            break;
-        case OP_NOT:
-            result = value_by_logical_negating_value(operand);
-            value_destroy(operand);
-            break;
-        case OP_BIT_NOT:
-            result = value_by_bitwise_complementing_value(operand);
-            value_destroy(operand);
-            break;
-        default:
-            value_destroy(operand);
-            result = value_create_error("Unknown unary operator.");
-            break;
+static Value run_work_stack(const ExpressoAst* ast, WorkStack* work) {
+    if (!descend(ast, work, ast->root)) return value_create_error_code(EXPRESSO_ERROR_TOO_DEEP);
+
+    while (work->frame_count > 0) {
+        Frame* frame = &work->frames[work->frame_count - 1];
+        const ExpressoNode* node = &ast->nodes[frame->index];
+        ExpressoOperator op = (ExpressoOperator)node->op;
+
+        switch ((ExpressoNodeKind)node->kind) {
+            case EXPRESSO_NODE_UNARY:
+                if (frame->next++ == 0) {
+                    if (!descend(ast, work, node->children[0])) goto too_deep;
+                    break;
+                }
+                complete_frame(ast, work, apply_unary_operator(op, pop_value(work)));
+                break;
+
+            case EXPRESSO_NODE_BINARY:
+                if (frame->next == 1 && (op == EXPRESSO_OP_LOGICAL_AND || op == EXPRESSO_OP_LOGICAL_OR)) {
+                    // && and || only evaluate their right operand when the left one
+                    // does not decide the result, e.g. $b != 0 && $a / $b > 3 never
+                    // divides by zero.
+                    Value left = work->values[work->value_count - 1];
+                    if (!value_is_condition(left) || value_is_true(left) == (op == EXPRESSO_OP_LOGICAL_OR)) {
+                        complete_frame(ast, work, apply_binary_operator(op, pop_value(work), value_create_integer(0)));
+                        break;
+                    }
+                }
+                if (frame->next < 2) {
+                    if (!descend(ast, work, node->children[frame->next++])) goto too_deep;
+                    break;
+                }
+                {
+                    Value right = pop_value(work);
+                    Value left = pop_value(work);
+                    complete_frame(ast, work, apply_binary_operator(op, left, right));
+                }
+                break;
+
+            case EXPRESSO_NODE_CONDITIONAL: {
+                if (frame->next == 2) {
+                    // A conditional whose value is recorded keeps its frame
+                    complete_frame(ast, work, pop_value(work));
+                    break;
+                }
+                if (frame->next++ == 0) {
+                    if (!descend(ast, work, node->children[0])) goto too_deep;
+                    break;
+                }
+                Value condition = pop_value(work);
+                if (!value_is_condition(condition)) {
+                    value_destroy(condition);
+                    complete_frame(ast, work, value_create_error_code(EXPRESSO_ERROR_TYPE_CONDITIONAL));
+                    break;
+                }
+                ExpressoNodeIndex branch = value_is_true(condition) ? node->children[1] : node->children[2];
+                value_destroy(condition);
+                if ((work->memo && expresso_ast_is_shared(ast, frame->index)) || records_value(work)) {
+                    if (!descend(ast, work, branch)) goto too_deep;
+                    break;
+                }
+                // Only the selected branch is evaluated, and it takes over this
+                // frame, so chains of conditionals do not deepen the stack
+                *frame = (Frame){ branch, 0 };
+                break;
+            }
+
+            default:
+                complete_frame(ast, work, leaf_value(ast, node));
+                break;
+        }
     }
+    return pop_value(work);
 
-    return result;
+too_deep:
+    while (work->value_count > 0) value_destroy(pop_value(work));
+    return value_create_error_code(EXPRESSO_ERROR_TOO_DEEP);
 }
 
-Value visit_primary_expression(CExpressoVisitor* visitor, ExpressoParseTree* tree) {
-    ExpressoParseTree* child = expresso_tree_get_child(tree, 0);
-    int child_type = expresso_tree_get_type(child);
+Value evaluate_ast(const ExpressoAst* ast) {
+    if (ast == NULL || ast->root == EXPRESSO_NODE_NONE) {
+        return value_create_error_code(EXPRESSO_ERROR_EMPTY_TREE);
+    }
+
+    WorkStack work;
+    work.frames = work.inline_frames;
+    work.values = work.inline_values;
+    work.frame_count = 0;
+    work.value_count = 0;
+    work.capacity = INLINE_DEPTH;
+    work.memo = NULL;
+    work.memo_done = NULL;
+    work.cache = memo_cache;
+    work.constant = NULL;
 
-    // If the child is a literal, visit it.
-    if (child_type == RuleLiteral) {
-        return expresso_tree_accept(child, visitor);
-    } else if (expresso_tree_get_child_count(tree) == 3) {
-        // If it's a parenthesized expression, visit the expression inside.
-        ExpressoParseTree* inner_expression = expresso_tree_get_child(tree, 1);
-        Value result = expresso_tree_accept(inner_expression, visitor);
-        expresso_tree_destroy(inner_expression);
-        return result;
+    // Working storage, and the strings, errors and big integers made on the
+    // way, are dropped with the arena
+    ExpressoArenaMark arena = expresso_arena_enter();
+    if (memo_cache) {
+        work.constant = (uint8_t*)expresso_arena_allocate(ast->count);
+        expresso_memo_find_constants(ast, work.constant);
+    }
+    if (ast->shared > 0) {
+        work.memo = (Value*)expresso_arena_allocate(ast->count * sizeof(Value));
+        work.memo_done = (uint8_t*)expresso_arena_allocate(ast->count);
+        memset(work.memo_done, 0, ast->count);
     }
 
-    return value_create_error("Invalid primary expression");
+    Value result = run_work_stack(ast, &work);
+    if (work.memo) {
+        // Memoised values may still hold references to heap text
+        for (size_t i = 0; i < ast->count; i++) {
+            if (work.memo_done[i]) value_destroy(work.memo[i]);
+        }
+    }
+    return expresso_arena_leave(arena, result);
 }
@@ -48,16 +48,41 @@
 #ifndef EXPRESSO_EVALUATOR_H
 #define EXPRESSO_EVALUATOR_H
 
+#include <stddef.h> // For size_t
 #include "value.h"
 #include "parser_wrapper.h"
+#include "memo_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Nesting depth evaluate_ast() follows by default before giving up
+#define EXPRESSO_EVAL_DEFAULT_MAX_DEPTH 100000
+
 // Evaluate a parsed expression tree
 Value evaluate_expression(ExpressoParseTree* tree);
 
+// Evaluate a native expression tree. Evaluation keeps its work on the heap
+// rather than the C stack; a tree nested deeper than the maximum depth
+// evaluates to an error value.
+Value evaluate_ast(const ExpressoAst* ast);
+
+// Set the maximum nesting depth for evaluate_ast(); 0 restores the default.
+// The fast parser gives up beyond EXPRESSO_FAST_PARSER_MAX_DEPTH (4096)
+// levels of parentheses, unary operators, conditionals and '|', so its trees
+// only reach the default through a long chain of left-associative binary
+// operators. The ANTLR parser has no such limit: its descent and the
+// lowering of its parse tree recurse on the native stack, so deeply nested
+// input can exhaust that before evaluation starts.
+void evaluator_set_max_depth(size_t depth);
+size_t evaluator_max_depth(void);
+
+// Look up and remember the values of constant subtrees in cache, which the
+// caller owns; NULL (the default) evaluates everything afresh
+void evaluator_set_memo_cache(ExpressoMemoCache* cache);
+ExpressoMemoCache* evaluator_memo_cache(void);
+
 #ifdef __cplusplus
 }
 #endif
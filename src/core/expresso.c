@@ -0,0 +1,154 @@
+/*
+ * Expresso
+ * expresso.c
+ *
+ * Compile-once, evaluate-many API for expressions with named parameters.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "expresso.h"
+#include "vm.h"
+#include "jit.h"
+#include "optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ExpressoCompiled {
+    ExpressoProgram* program;
+    Value* stack; // Operand stack sized for the program, reused by every evaluation
+    char* source; // Expression text, naming the native code in perf maps
+    ExpressoJitCode* jit; // Native code specialised to the first bindings seen
+    bool jit_attempted;
+};
+
+ExpressoCompiled* expresso_compile(const char* expression, ExpressoSyntaxError* error) {
+    if (!expression) return NULL;
+
+    ExpressoAst* ast = expresso_ast_create();
+    if (!expresso_fast_parse(expression, ast, error)) {
+        expresso_ast_destroy(ast);
+        return NULL;
+    }
+    ExpressoAst* optimized = expresso_ast_create();
+    expresso_optimize(ast, optimized, NULL, 0);
+    ExpressoErrorCode code = EXPRESSO_ERROR_NONE;
+    ExpressoProgram* program = expresso_program_compile(optimized, &code);
+    expresso_ast_destroy(optimized);
+    expresso_ast_destroy(ast);
+    if (!program) {
+        // The tree parsed but cannot be run, e.g. it nests too deeply; the
+        // error covers the whole expression
+        if (error) {
+            error->code = code;
+            error->message = expresso_error_message(code);
+            error->position = 0;
+            error->length = strlen(expression);
+        }
+        return NULL;
+    }
+
+    ExpressoCompiled* compiled = (ExpressoCompiled*)malloc(sizeof(ExpressoCompiled));
+    if (!compiled) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for compiled expression.\n");
+        exit(EXIT_FAILURE);
+    }
+    compiled->program = program;
+    compiled->source = strdup(expression);
+    if (!compiled->source) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for compiled expression source.\n");
+        exit(EXIT_FAILURE);
+    }
+    compiled->jit = NULL;
+    compiled->jit_attempted = false;
+    compiled->stack = (Value*)malloc(program->max_stack * sizeof(Value));
+    if (!compiled->stack) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for compiled expression stack.\n");
+        exit(EXIT_FAILURE);
+    }
+    return compiled;
+}
+
+void expresso_compiled_destroy(ExpressoCompiled* compiled) {
+    if (!compiled) return;
+
+    expresso_program_destroy(compiled->program);
+    expresso_jit_destroy(compiled->jit);
+    free(compiled->stack);
+    free(compiled->source);
+    free(compiled);
+}
+
+size_t expresso_parameter_count(const ExpressoCompiled* compiled) {
+    return compiled ? compiled->program->parameter_count : 0;
+}
+
+const char* expresso_parameter_name(const ExpressoCompiled* compiled, size_t index) {
+    if (!compiled || index >= compiled->program->parameter_count) return NULL;
+    return compiled->program->parameters[index];
+}
+
+bool expresso_parameter_index(const ExpressoCompiled* compiled, const char* name, size_t* index) {
+    return compiled && expresso_program_parameter_slot(compiled->program, name, index);
+}
+
+const ExpressoProgram* expresso_compiled_program(const ExpressoCompiled* compiled) {
+    return compiled ? compiled->program : NULL;
+}
+
+Value expresso_eval(ExpressoCompiled* compiled, const Value* bindings) {
+    if (!compiled) {
+        return value_create_error_code(EXPRESSO_ERROR_NULL_COMPILED);
+    }
+    const ExpressoProgram* program = compiled->program;
+
+    if (expresso_jit_enabled()) {
+        // Generate code on first use, once the parameter types are known
+        if (!compiled->jit_attempted && (bindings || program->parameter_count == 0)) {
+            compiled->jit = expresso_jit_compile(program, bindings, compiled->source);
+            compiled->jit_attempted = true;
+        }
+        Value result;
+        if (compiled->jit && expresso_jit_run(compiled->jit, bindings, &result)) return result;
+    }
+    return expresso_vm_execute(program, bindings, compiled->stack);
+}
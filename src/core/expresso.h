@@ -0,0 +1,99 @@
+/*
+ * Expresso
+ * expresso.h
+ *
+ * Compile-once, evaluate-many API for expressions with named parameters.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_EXPRESSO_H
+#define EXPRESSO_EXPRESSO_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h>  // For size_t
+#include "value.h"
+#include "fast_parser.h" // For ExpressoSyntaxError
+#include "bytecode.h"    // For ExpressoProgram
+
+// An expression compiled for repeated evaluation (opaque)
+typedef struct ExpressoCompiled ExpressoCompiled;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compile an expression such as "$price * $qty". Constant subexpressions
+// are folded first (see optimizer.h). Parameters are numbered in order of
+// first appearance; parameters that folding removes, such as those in the
+// untaken branch of a constant ?:, are not counted. Returns NULL on a syntax error and fills error
+// (if not NULL). An expression that parses but nests more deeply than
+// evaluator_max_depth() allows also returns NULL, with a TOO_DEEP error
+// spanning the whole expression.
+ExpressoCompiled* expresso_compile(const char* expression, ExpressoSyntaxError* error);
+
+// Destroy a compiled expression
+void expresso_compiled_destroy(ExpressoCompiled* compiled);
+
+// Get the number of parameters, and the name (without the '$') of each
+size_t expresso_parameter_count(const ExpressoCompiled* compiled);
+const char* expresso_parameter_name(const ExpressoCompiled* compiled, size_t index);
+
+// Find the index of a parameter by name (without the '$')
+// Returns false if the expression does not use the parameter
+bool expresso_parameter_index(const ExpressoCompiled* compiled, const char* name, size_t* index);
+
+// Get the bytecode of a compiled expression, for other evaluation modes
+const ExpressoProgram* expresso_compiled_program(const ExpressoCompiled* compiled);
+
+// Evaluate with bindings[i] as the value of parameter i. bindings may be NULL
+// if there are no parameters; they are only read, never destroyed. Nothing
+// is parsed, and nothing is allocated unless string values are involved.
+// Integer and float expressions run as native code where the JIT is
+// available and enabled (see jit.h), otherwise on the bytecode VM.
+// A compiled expression runs one evaluation at a time: use one per thread.
+Value expresso_eval(ExpressoCompiled* compiled, const Value* bindings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_EXPRESSO_H
@@ -0,0 +1,368 @@
+/*
+ * Expresso
+ * format.c
+ *
+ * Implementation of number formatting. Doubles use the Ryu algorithm (Ulf
+ * Adams, "Ryu: fast float-to-string conversion"): the interval of decimals
+ * that round to the double is computed exactly from 128-bit powers of five,
+ * and digits are removed while the interval still holds a candidate. Digits
+ * are written two at a time from a table of pairs.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "format.h"
+#include "format_tables.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_EXPONENT_BIAS 1023
+
+static const char digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+// --- Integers ---
+
+static const uint64_t powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// Number of decimal digits, one for zero: log10 estimated from the bit
+// length (1233/4096 is just above log10(2)), corrected by one comparison.
+// Setting the low bit changes neither but makes zero count as one.
+static inline unsigned decimal_length(uint64_t value) {
+    value |= 1;
+    unsigned bits = 64 - (unsigned)__builtin_clzll(value);
+    unsigned estimate = (bits * 1233) >> 12;
+    return estimate + 1 - (value < powers_of_ten[estimate]);
+}
+
+// Write the length digits of value ending at out + length
+static inline void write_digits(char* out, uint64_t value, unsigned length) {
+    char* end = out + length;
+    while (value >= 100) {
+        uint64_t pair = value % 100;
+        value /= 100;
+        end -= 2;
+        memcpy(end, digit_pairs + pair * 2, 2);
+    }
+    if (value >= 10) {
+        memcpy(end - 2, digit_pairs + value * 2, 2);
+    } else {
+        end[-1] = (char)('0' + value);
+    }
+}
+
+size_t expresso_format_integer(long long value, char* buffer) {
+    char* out = buffer;
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    unsigned length = decimal_length(magnitude);
+    write_digits(out, magnitude, length);
+    out[length] = '\0';
+    return (size_t)(out - buffer) + length;
+}
+
+// --- Doubles: Ryu ---
+
+// ceil(log2(5^e)) for 0 <= e <= 3528, except 1 for e = 0
+static inline int32_t pow5_bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650
+static inline uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620
+static inline uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static inline bool multiple_of_power_of_5(uint64_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static inline bool multiple_of_power_of_2(uint64_t value, uint32_t p) {
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// (m * mul) >> j for a 55-bit m, a 125-bit mul and 64 < j < 128
+static inline uint64_t multiply_shift(uint64_t m, const uint64_t* mul, int32_t j) {
+    unsigned __int128 low = (unsigned __int128)m * mul[0];
+    unsigned __int128 high = (unsigned __int128)m * mul[1];
+    return (uint64_t)(((low >> 64) + high) >> (j - 64));
+}
+
+typedef struct {
+    uint64_t digits;
+    int32_t exponent;
+} Decimal;
+
+// The shortest decimal digits * 10^exponent in the rounding interval of
+// the finite, nonzero double with the given fields, nearest the double
+static Decimal shortest(uint64_t mantissa_field, uint32_t exponent_field) {
+    int32_t e2;
+    uint64_t m2;
+    if (exponent_field == 0) {
+        e2 = 1 - DOUBLE_EXPONENT_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = mantissa_field;
+    } else {
+        e2 = (int32_t)exponent_field - DOUBLE_EXPONENT_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = (1ULL << DOUBLE_MANTISSA_BITS) | mantissa_field;
+    }
+    // Ties round to even, so an even mantissa owns the ends of its interval
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // The interval is (mv - 2 - mm_shift, mv + 2) in units of 2^e2 / 4.
+    // It is asymmetric below the powers of two.
+    uint64_t mv = 4 * m2;
+    uint32_t mm_shift = mantissa_field != 0 || exponent_field <= 1;
+
+    // Scale the midpoint and both ends by a power of ten, keeping track of
+    // whether the digits dropped by the scaling were all zeros
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        int32_t k = FORMAT_POWER_BITS + pow5_bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        const uint64_t* power = format_inverse_powers_of_five[q];
+        vr = multiply_shift(4 * m2, power, i);
+        vp = multiply_shift(4 * m2 + 2, power, i);
+        vm = multiply_shift(4 * m2 - 1 - mm_shift, power, i);
+        if (q <= 21) {
+            // Only one of mv, mv + 2 and mv - 1 - mm_shift can be a
+            // multiple of 5 when it is, and only then can digits be exact
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_power_of_5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_power_of_5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_power_of_5(mv + 2, q);
+            }
+        }
+    } else {
+        uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5_bits(i) - FORMAT_POWER_BITS;
+        int32_t j = (int32_t)q - k;
+        const uint64_t* power = format_powers_of_five[i];
+        vr = multiply_shift(4 * m2, power, j);
+        vp = multiply_shift(4 * m2 + 2, power, j);
+        vm = multiply_shift(4 * m2 - 1 - mm_shift, power, j);
+        if (q <= 1) {
+            // mv has at least q trailing zero bits, so vr is exact
+            vr_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = multiple_of_power_of_2(mv, q);
+        }
+    }
+
+    // Remove digits while the interval still holds a shorter candidate
+    int32_t removed = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // Rare: the exact ends matter
+        uint8_t last_removed = 0;
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (uint8_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+            // Exactly halfway: round to even
+            last_removed = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        // Common: two digits at a time first
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+
+    Decimal result = { output, e10 + removed };
+    return result;
+}
+
+// --- Doubles: notation ---
+
+static size_t format_special(const char* text, char* buffer) {
+    size_t length = strlen(text);
+    memcpy(buffer, text, length + 1);
+    return length;
+}
+
+size_t expresso_format_double(double value, char* buffer) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool negative = bits >> 63;
+    uint64_t mantissa_field = bits & ((1ULL << DOUBLE_MANTISSA_BITS) - 1);
+    uint32_t exponent_field = (uint32_t)(bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1);
+
+    if (exponent_field == (1u << DOUBLE_EXPONENT_BITS) - 1) {
+        if (mantissa_field != 0) return format_special("nan", buffer);
+        return format_special(negative ? "-inf" : "inf", buffer);
+    }
+
+    char* out = buffer;
+    if (negative) *out++ = '-';
+    if (exponent_field == 0 && mantissa_field == 0) {
+        memcpy(out, "0.0", 4);
+        return (size_t)(out - buffer) + 3;
+    }
+
+    Decimal decimal = shortest(mantissa_field, exponent_field);
+    unsigned length = decimal_length(decimal.digits);
+    // Exponent of the leading digit
+    int32_t scientific = decimal.exponent + (int32_t)length - 1;
+
+    if (scientific >= 0 && scientific < 16) {
+        // ddd.ddd or ddd000.0
+        if ((int32_t)length <= scientific + 1) {
+            write_digits(out, decimal.digits, length);
+            out += length;
+            memset(out, '0', (size_t)(scientific + 1) - length);
+            out += scientific + 1 - (int32_t)length;
+            memcpy(out, ".0", 2);
+            out += 2;
+        } else {
+            write_digits(out + 1, decimal.digits, length);
+            memmove(out, out + 1, (size_t)scientific + 1);
+            out[scientific + 1] = '.';
+            out += length + 1;
+        }
+    } else if (scientific < 0 && scientific >= -4) {
+        // 0.000ddd
+        size_t zeros = (size_t)(-scientific - 1);
+        memcpy(out, "0.", 2);
+        memset(out + 2, '0', zeros);
+        out += 2 + zeros;
+        write_digits(out, decimal.digits, length);
+        out += length;
+    } else {
+        // d.ddde+XX
+        write_digits(out + 1, decimal.digits, length);
+        out[0] = out[1];
+        if (length > 1) {
+            out[1] = '.';
+            out += length + 1;
+        } else {
+            out += 1;
+        }
+        *out++ = 'e';
+        *out++ = scientific < 0 ? '-' : '+';
+        unsigned magnitude = (unsigned)(scientific < 0 ? -scientific : scientific);
+        if (magnitude < 100) {
+            memcpy(out, digit_pairs + magnitude * 2, 2);
+            out += 2;
+        } else {
+            write_digits(out, magnitude, 3);
+            out += 3;
+        }
+    }
+    *out = '\0';
+    return (size_t)(out - buffer);
+}
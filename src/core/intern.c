@@ -0,0 +1,200 @@
+/*
+ * Expresso
+ * intern.c
+ *
+ * Implementation of the process-wide pool of interned strings.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "intern.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The pool is split by hash into stripes, each an open-addressed table of
+// its own behind its own spin lock, so threads interning different texts
+// seldom wait for each other. Critical sections are a probe and, rarely, a
+// rehash of one stripe.
+#define STRIPE_BITS 4
+#define STRIPE_COUNT (1 << STRIPE_BITS)
+#define STRIPE_INITIAL_CAPACITY 64 // Slots; a power of two
+
+typedef struct {
+    uint64_t hash;
+    ExpressoString* string; // NULL for an empty slot
+} Slot;
+
+typedef struct {
+    atomic_bool locked;
+    Slot* slots;
+    size_t capacity; // Zero until the first string arrives
+    size_t count;
+    ExpressoInternStats stats;
+} Stripe;
+
+static Stripe stripes[STRIPE_COUNT];
+static atomic_bool enabled;
+
+void expresso_intern_set_enabled(bool on) {
+    atomic_store_explicit(&enabled, on, memory_order_relaxed);
+}
+
+bool expresso_intern_enabled(void) {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+static void lock(Stripe* stripe) {
+    while (atomic_exchange_explicit(&stripe->locked, true, memory_order_acquire)) {
+        while (atomic_load_explicit(&stripe->locked, memory_order_relaxed)) {
+        }
+    }
+}
+
+static void unlock(Stripe* stripe) {
+    atomic_store_explicit(&stripe->locked, false, memory_order_release);
+}
+
+static uint64_t hash_text(const char* text, size_t length) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Keep the stripe at most three quarters full
+static void reserve(Stripe* stripe) {
+    if ((stripe->count + 1) * 4 <= stripe->capacity * 3) return;
+
+    size_t capacity = stripe->capacity ? stripe->capacity * 2 : STRIPE_INITIAL_CAPACITY;
+    Slot* slots = (Slot*)calloc(capacity, sizeof(Slot));
+    if (!slots) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for intern pool.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < stripe->capacity; i++) {
+        if (!stripe->slots[i].string) continue;
+        size_t j = stripe->slots[i].hash & (capacity - 1);
+        while (slots[j].string) j = (j + 1) & (capacity - 1);
+        slots[j] = stripe->slots[i];
+    }
+    free(stripe->slots);
+    stripe->slots = slots;
+    stripe->capacity = capacity;
+}
+
+ExpressoString* expresso_intern(const char* text, size_t length) {
+    uint64_t hash = hash_text(text, length);
+    // Slots are chosen by the low bits, so stripes take the high ones
+    Stripe* stripe = &stripes[hash >> (64 - STRIPE_BITS)];
+
+    lock(stripe);
+    stripe->stats.lookups++;
+    reserve(stripe);
+    size_t mask = stripe->capacity - 1;
+    size_t i = hash & mask;
+    for (; stripe->slots[i].string; i = (i + 1) & mask) {
+        ExpressoString* string = stripe->slots[i].string;
+        if (stripe->slots[i].hash == hash && string->length == length && memcmp(string->text, text, length) == 0) {
+            stripe->stats.hits++;
+            unlock(stripe);
+            return string;
+        }
+    }
+
+    size_t size = sizeof(ExpressoString) + length + 1;
+    ExpressoString* string = (ExpressoString*)malloc(size);
+    if (!string) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for interned string.\n");
+        exit(EXIT_FAILURE);
+    }
+    string->references = EXPRESSO_INTERNED_REFERENCES;
+    string->length = length;
+    string->rope = NULL;
+    memcpy(string->text, text, length);
+    string->text[length] = '\0';
+
+    stripe->slots[i].hash = hash;
+    stripe->slots[i].string = string;
+    stripe->count++;
+    stripe->stats.strings++;
+    stripe->stats.bytes += size;
+    unlock(stripe);
+    return string;
+}
+
+void expresso_intern_stats(ExpressoInternStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (size_t s = 0; s < STRIPE_COUNT; s++) {
+        Stripe* stripe = &stripes[s];
+        lock(stripe);
+        stats->lookups += stripe->stats.lookups;
+        stats->hits += stripe->stats.hits;
+        stats->strings += stripe->stats.strings;
+        stats->bytes += stripe->stats.bytes;
+        unlock(stripe);
+    }
+}
+
+void expresso_intern_reset(void) {
+    for (size_t s = 0; s < STRIPE_COUNT; s++) {
+        Stripe* stripe = &stripes[s];
+        for (size_t i = 0; i < stripe->capacity; i++) free(stripe->slots[i].string);
+        free(stripe->slots);
+        stripe->slots = NULL;
+        stripe->capacity = 0;
+        stripe->count = 0;
+        memset(&stripe->stats, 0, sizeof(stripe->stats));
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Expresso
+ * intern.h
+ *
+ * Header file for the process-wide pool of interned strings, which holds
+ * one immutable copy of each distinct text put in it.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EXPRESSO_INTERN_H
+#define EXPRESSO_INTERN_H
+
+#include "value.h"
+#include <stdbool.h> // For bool
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For SIZE_MAX
+
+// The reference count of an interned string. Copies share it without
+// counting, and it is only freed by expresso_intern_reset.
+#define EXPRESSO_INTERNED_REFERENCES (SIZE_MAX - 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Whether literals and cached results should be interned. Off by default;
+// the pool itself works either way.
+void expresso_intern_set_enabled(bool enabled);
+bool expresso_intern_enabled(void);
+
+// The pooled string with this text, added if it is new. Equal texts give
+// the same string, so interned strings are equal exactly when they are the
+// same pointer. Safe to call from several threads at once.
+ExpressoString* expresso_intern(const char* text, size_t length);
+
+typedef struct {
+    unsigned long long lookups;
+    unsigned long long hits; // Lookups that found the text already pooled
+    size_t strings;
+    size_t bytes;            // Held by the pooled strings
+} ExpressoInternStats;
+
+void expresso_intern_stats(ExpressoInternStats* stats);
+
+// Free every pooled string and clear the statistics. No value may still
+// refer to an interned string, and no other thread may be using the pool.
+void expresso_intern_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_INTERN_H
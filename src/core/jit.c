@@ -0,0 +1,687 @@
+/*
+ * Expresso
+ * jit.c
+ *
+ * Translates bytecode programs into x86-64 machine code.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "jit.h"
+#include "operations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h> // For offsetof
+#include <stdint.h>
+
+#ifdef EXPRESSO_JIT_X86_64
+#include <sys/mman.h> // For mmap, mprotect, munmap
+#include <unistd.h>   // For getpid, sysconf
+#endif
+
+#define PERF_MAP_NAME_MAX 200
+
+// Generated functions store the result's bits and return 1, or return 0 to
+// send the evaluation back to the VM
+typedef int (*JitFunction)(const Value* bindings, uint64_t* result);
+
+struct ExpressoJitCode {
+    void* memory;       // Executable mapping holding the function
+    size_t mapped_size;
+    JitFunction function;
+    ValueType result_type;
+    size_t parameter_count;
+};
+
+// -1 until read from the environment
+static int jit_enabled = -1;
+static int perf_map_enabled = -1;
+
+static int read_setting(const char* variable, bool fallback) {
+    const char* setting = getenv(variable);
+    if (!setting) return fallback;
+    return !(strcmp(setting, "0") == 0 || strcmp(setting, "off") == 0);
+}
+
+bool expresso_jit_available(void) {
+#ifdef EXPRESSO_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+void expresso_jit_set_enabled(bool enabled) {
+    jit_enabled = enabled;
+}
+
+bool expresso_jit_enabled(void) {
+    if (jit_enabled < 0) jit_enabled = read_setting("EXPRESSO_JIT", true);
+    return jit_enabled && expresso_jit_available();
+}
+
+void expresso_jit_set_perf_map(bool enabled) {
+    perf_map_enabled = enabled;
+}
+
+#ifdef EXPRESSO_JIT_X86_64
+
+// --- Code emission ---
+
+// Register use: rax holds the top of the operand stack and the values below
+// it live on the machine stack; rcx holds a popped right operand. rbx keeps
+// the bindings pointer and r12 the result pointer across helper calls.
+typedef struct {
+    const ExpressoProgram* program;
+    const Value* bindings;
+    uint8_t* code;
+    size_t size;
+    size_t capacity;
+    ValueType* types; // Static type of each operand stack slot
+    size_t depth;
+    bool constant_top; // The top of stack was just loaded from constant_value
+    long long constant_value;
+    size_t* bail_patches; // rel32 operands of jumps to the bail-out block
+    size_t bail_count;
+    size_t bail_capacity;
+} Jit;
+
+static void emit_bytes(Jit* jit, const uint8_t* bytes, size_t count) {
+    if (jit->size + count > jit->capacity) {
+        size_t capacity = jit->capacity ? jit->capacity * 2 : 256;
+        while (capacity < jit->size + count) capacity *= 2;
+        uint8_t* code = (uint8_t*)realloc(jit->code, capacity);
+        if (!code) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for JIT code.\n");
+            exit(EXIT_FAILURE);
+        }
+        jit->code = code;
+        jit->capacity = capacity;
+    }
+    memcpy(jit->code + jit->size, bytes, count);
+    jit->size += count;
+}
+
+#define EMIT(jit, ...) \
+    emit_bytes(jit, (const uint8_t[]){ __VA_ARGS__ }, sizeof((const uint8_t[]){ __VA_ARGS__ }))
+
+static void emit_u32(Jit* jit, uint32_t value) {
+    emit_bytes(jit, (const uint8_t*)&value, sizeof value);
+}
+
+static void emit_u64(Jit* jit, uint64_t value) {
+    emit_bytes(jit, (const uint8_t*)&value, sizeof value);
+}
+
+// Emit a rel32 placeholder and return its offset for patch_jump()
+static size_t emit_rel32(Jit* jit) {
+    size_t at = jit->size;
+    emit_u32(jit, 0);
+    return at;
+}
+
+static void patch_jump(Jit* jit, size_t at, size_t target) {
+    int32_t rel = (int32_t)((long long)target - (long long)(at + 4));
+    memcpy(jit->code + at, &rel, sizeof rel);
+}
+
+// Conditional jump (0x80 jo, 0x83 jae, 0x84 je, 0x85 jne) to the bail-out block
+static void emit_bail_if(Jit* jit, uint8_t condition) {
+    EMIT(jit, 0x0F, condition);
+    if (jit->bail_count == jit->bail_capacity) {
+        jit->bail_capacity = jit->bail_capacity ? jit->bail_capacity * 2 : 8;
+        jit->bail_patches = (size_t*)realloc(jit->bail_patches, jit->bail_capacity * sizeof(size_t));
+        if (!jit->bail_patches) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for JIT patches.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    jit->bail_patches[jit->bail_count++] = emit_rel32(jit);
+}
+
+#ifdef EXPRESSO_NAN_BOXING
+
+// Bail unless parameter slot has the tag of type: a 48-bit integer, or any
+// untagged word, which is a double. Boxed integers are left to the VM.
+static void emit_guard_parameter(Jit* jit, size_t slot, ValueType type) {
+    EMIT(jit, 0x48, 0x8B, 0x83); // mov rax, [rbx + disp32]
+    emit_u32(jit, (uint32_t)(slot * sizeof(Value)));
+    EMIT(jit, 0x48, 0xC1, 0xE8, VALUE_TAG_SHIFT, // shr rax, 48
+              0x3D);                             // cmp eax, imm32
+    emit_u32(jit, VALUE_TAG_INTEGER);
+    emit_bail_if(jit, type == VALUE_TYPE_INTEGER ? 0x85 : 0x83); // jne / jae bail
+}
+
+// rax = the integer or double in parameter slot
+static void emit_load_parameter(Jit* jit, uint32_t slot) {
+    EMIT(jit, 0x48, 0x8B, 0x83); // mov rax, [rbx + disp32]
+    emit_u32(jit, (uint32_t)(slot * sizeof(Value)));
+    if (value_get_type(jit->bindings[slot]) == VALUE_TYPE_INTEGER) {
+        EMIT(jit, 0x48, 0xC1, 0xE0, 64 - VALUE_TAG_SHIFT,  // shl rax, 16
+                  0x48, 0xC1, 0xF8, 64 - VALUE_TAG_SHIFT); // sar rax, 16
+    }
+}
+
+#else
+
+// Bail unless parameter slot has type
+static void emit_guard_parameter(Jit* jit, size_t slot, ValueType type) {
+    EMIT(jit, 0x81, 0xBB); // cmp dword [rbx + disp32], imm32
+    emit_u32(jit, (uint32_t)(slot * sizeof(Value) + offsetof(Value, type)));
+    emit_u32(jit, (uint32_t)type);
+    emit_bail_if(jit, 0x85); // jne bail
+}
+
+// rax = the integer or double in parameter slot
+static void emit_load_parameter(Jit* jit, uint32_t slot) {
+    EMIT(jit, 0x48, 0x8B, 0x83); // mov rax, [rbx + disp32]
+    emit_u32(jit, (uint32_t)(slot * sizeof(Value) + offsetof(Value, data)));
+}
+
+#endif // EXPRESSO_NAN_BOXING
+
+// Make room for a new top of stack
+static void push_value(Jit* jit, ValueType type) {
+    if (jit->depth > 0) EMIT(jit, 0x50); // push rax
+    jit->types[jit->depth++] = type;
+}
+
+// Set eax to the flag of setcc opcode (0x94 sete, 0x9C setl, ...)
+static void emit_set_flag(Jit* jit, uint8_t setcc) {
+    EMIT(jit, 0x0F, setcc, 0xC0,  // setcc al
+              0x0F, 0xB6, 0xC0);  // movzx eax, al
+}
+
+// rax = function(rax, rcx) for a helper taking and returning long long
+static void emit_call(Jit* jit, long long (*function)(long long, long long)) {
+    // Values pushed below the top of stack may leave rsp off 16-byte alignment
+    bool misaligned = (jit->depth - 1) % 2 != 0;
+    EMIT(jit, 0x48, 0x89, 0xC7,  // mov rdi, rax
+              0x48, 0x89, 0xCE); // mov rsi, rcx
+    if (misaligned) EMIT(jit, 0x48, 0x83, 0xEC, 0x08); // sub rsp, 8
+    EMIT(jit, 0x48, 0xB8);                                  // mov rax, imm64
+    emit_u64(jit, (uint64_t)(uintptr_t)function);
+    EMIT(jit, 0xFF, 0xD0);                                  // call rax
+    if (misaligned) EMIT(jit, 0x48, 0x83, 0xC4, 0x08); // add rsp, 8
+}
+
+// 64-bit division as in operations.c. A zero divisor, and LLONG_MIN / -1,
+// bail out to the VM to report the error; -1 is handled without idiv,
+// which traps on LLONG_MIN.
+static void emit_divide(Jit* jit, bool remainder) {
+    EMIT(jit, 0x48, 0x85, 0xC9);       // test rcx, rcx
+    emit_bail_if(jit, 0x84);           // je bail
+    EMIT(jit, 0x48, 0x83, 0xF9, 0xFF); // cmp rcx, -1
+    if (remainder) {
+        EMIT(jit, 0x75, 0x04,          // jne divide
+                  0x31, 0xC0,          // xor eax, eax
+                  0xEB, 0x08,          // jmp done
+                  0x48, 0x99,          // divide: cqo
+                  0x48, 0xF7, 0xF9,    // idiv rcx
+                  0x48, 0x89, 0xD0);   // mov rax, rdx
+    } else {
+        EMIT(jit, 0x75, 0x0B,          // jne divide
+                  0x48, 0xF7, 0xD8);   // neg rax
+        emit_bail_if(jit, 0x80);       // jo bail
+        EMIT(jit, 0xEB, 0x05,          // jmp done
+                  0x48, 0x99,          // divide: cqo
+                  0x48, 0xF7, 0xF9);   // idiv rcx
+    }                                  // done:
+}
+
+static bool compile_unary(Jit* jit, ExpressoOperator op) {
+    ValueType type = jit->types[jit->depth - 1];
+    ValueType result = value_result_type(op, type, VALUE_TYPE_INTEGER);
+    if (result != VALUE_TYPE_INTEGER && result != VALUE_TYPE_FLOAT) return false;
+    bool is_float = type == VALUE_TYPE_FLOAT;
+
+    switch (op) {
+        case EXPRESSO_OP_NEGATE:
+            if (is_float) {
+                EMIT(jit, 0x48, 0x0F, 0xBA, 0xF8, 0x3F); // btc rax, 63
+                break;
+            }
+            EMIT(jit, 0x48, 0xF7, 0xD8); // neg rax
+            emit_bail_if(jit, 0x80);     // jo bail
+            break;
+        case EXPRESSO_OP_BITWISE_NOT: EMIT(jit, 0x48, 0xF7, 0xD0); break; // not rax
+        case EXPRESSO_OP_LOGICAL_NOT:
+        case EXPRESSO_OP_LOGICAL_AND:
+        case EXPRESSO_OP_LOGICAL_OR:
+            // A float is tested without its sign bit, so -0.0 is false as
+            // 0.0 is. The right operand of && or || becomes 0 or 1.
+            if (is_float) {
+                EMIT(jit, 0x48, 0xD1, 0xE0); // shl rax, 1
+            } else {
+                EMIT(jit, 0x48, 0x85, 0xC0); // test rax, rax
+            }
+            emit_set_flag(jit, op == EXPRESSO_OP_LOGICAL_NOT ? 0x94 : 0x95);
+            break;
+        default:
+            return false;
+    }
+    jit->types[jit->depth - 1] = result;
+    return true;
+}
+
+// rax = rax op rcx for two floats, in xmm0 and xmm1 with SSE2. A comparison
+// sets eax to 0 or 1; NaN compares unordered, so it is unequal to everything
+// and neither less nor greater. The remainder (fmod) is left to the VM.
+static bool emit_float_binary(Jit* jit, ExpressoOperator op) {
+    EMIT(jit, 0x66, 0x48, 0x0F, 0x6E, 0xC0,  // movq xmm0, rax
+              0x66, 0x48, 0x0F, 0x6E, 0xC9); // movq xmm1, rcx
+
+    switch (op) {
+        case EXPRESSO_OP_ADD:      EMIT(jit, 0xF2, 0x0F, 0x58, 0xC1); break; // addsd xmm0, xmm1
+        case EXPRESSO_OP_SUBTRACT: EMIT(jit, 0xF2, 0x0F, 0x5C, 0xC1); break; // subsd xmm0, xmm1
+        case EXPRESSO_OP_MULTIPLY: EMIT(jit, 0xF2, 0x0F, 0x59, 0xC1); break; // mulsd xmm0, xmm1
+        case EXPRESSO_OP_DIVIDE:
+            // A zero divisor bails out to the VM to report the error, as
+            // does a NaN one, which compares unordered
+            EMIT(jit, 0x66, 0x0F, 0x57, 0xD2,  // xorpd xmm2, xmm2
+                      0x66, 0x0F, 0x2E, 0xCA); // ucomisd xmm1, xmm2
+            emit_bail_if(jit, 0x84);           // je bail
+            EMIT(jit, 0xF2, 0x0F, 0x5E, 0xC1); // divsd xmm0, xmm1
+            break;
+        case EXPRESSO_OP_EQUAL:
+        case EXPRESSO_OP_NOT_EQUAL:
+            EMIT(jit, 0x66, 0x0F, 0x2E, 0xC1); // ucomisd xmm0, xmm1
+            if (op == EXPRESSO_OP_EQUAL) {
+                EMIT(jit, 0x0F, 0x94, 0xC0,  // sete al
+                          0x0F, 0x9B, 0xC1,  // setnp cl
+                          0x20, 0xC8);       // and al, cl
+            } else {
+                EMIT(jit, 0x0F, 0x95, 0xC0,  // setne al
+                          0x0F, 0x9A, 0xC1,  // setp cl
+                          0x08, 0xC8);       // or al, cl
+            }
+            EMIT(jit, 0x0F, 0xB6, 0xC0);     // movzx eax, al
+            return true;
+        // seta and setae are false when unordered, so the operands of < and
+        // <= are swapped rather than using setb and setbe
+        case EXPRESSO_OP_LESS:
+            EMIT(jit, 0x66, 0x0F, 0x2E, 0xC8); // ucomisd xmm1, xmm0
+            emit_set_flag(jit, 0x97);          // seta
+            return true;
+        case EXPRESSO_OP_GREATER:
+            EMIT(jit, 0x66, 0x0F, 0x2E, 0xC1); // ucomisd xmm0, xmm1
+            emit_set_flag(jit, 0x97);          // seta
+            return true;
+        case EXPRESSO_OP_LESS_EQUAL:
+            EMIT(jit, 0x66, 0x0F, 0x2E, 0xC8); // ucomisd xmm1, xmm0
+            emit_set_flag(jit, 0x93);          // setae
+            return true;
+        case EXPRESSO_OP_GREATER_EQUAL:
+            EMIT(jit, 0x66, 0x0F, 0x2E, 0xC1); // ucomisd xmm0, xmm1
+            emit_set_flag(jit, 0x93);          // setae
+            return true;
+        default:
+            return false;
+    }
+    EMIT(jit, 0x66, 0x48, 0x0F, 0x7E, 0xC0); // movq rax, xmm0
+    return true;
+}
+
+// constant_right is set when the right operand was just loaded from a constant
+static bool compile_binary(Jit* jit, ExpressoOperator op, bool constant_right) {
+    ValueType left = jit->types[jit->depth - 2];
+    ValueType right = jit->types[jit->depth - 1];
+    ValueType result = value_result_type(op, left, right);
+    if (result != VALUE_TYPE_INTEGER && result != VALUE_TYPE_FLOAT) return false;
+    // Only integers, and floats with floats, are compiled; promotion stays in the VM
+    if (left != right || (left == VALUE_TYPE_FLOAT && op == EXPRESSO_OP_MODULO)) return false;
+
+    // Shifts by a constant in range need none of the helpers' edge cases
+    bool constant_count = constant_right && jit->constant_value >= 0 && jit->constant_value < 64;
+    uint8_t count = (uint8_t)jit->constant_value;
+
+    EMIT(jit, 0x48, 0x89, 0xC1, // mov rcx, rax
+              0x58);            // pop rax
+    jit->depth--;
+    jit->types[jit->depth - 1] = result;
+
+    if (left == VALUE_TYPE_FLOAT) return emit_float_binary(jit, op);
+    if (op == EXPRESSO_OP_EQUAL || op == EXPRESSO_OP_NOT_EQUAL) {
+        EMIT(jit, 0x48, 0x39, 0xC8); // cmp rax, rcx
+        emit_set_flag(jit, op == EXPRESSO_OP_EQUAL ? 0x94 : 0x95);
+        return true;
+    }
+
+    switch (op) {
+        // Overflow bails out to the VM, which promotes to a big integer
+        case EXPRESSO_OP_ADD:      EMIT(jit, 0x48, 0x01, 0xC8); emit_bail_if(jit, 0x80); break;       // add rax, rcx; jo
+        case EXPRESSO_OP_SUBTRACT: EMIT(jit, 0x48, 0x29, 0xC8); emit_bail_if(jit, 0x80); break;       // sub rax, rcx; jo
+        case EXPRESSO_OP_MULTIPLY: EMIT(jit, 0x48, 0x0F, 0xAF, 0xC1); emit_bail_if(jit, 0x80); break; // imul rax, rcx; jo
+        case EXPRESSO_OP_DIVIDE:   emit_divide(jit, false); break;
+        case EXPRESSO_OP_MODULO:   emit_divide(jit, true); break;
+        case EXPRESSO_OP_SHIFT_LEFT:
+            if (constant_count) {
+                EMIT(jit, 0x48, 0xC1, 0xE0, count); // shl rax, imm8
+            } else {
+                emit_call(jit, shift_integer_left);
+            }
+            break;
+        case EXPRESSO_OP_SHIFT_RIGHT:
+            if (constant_count) {
+                EMIT(jit, 0x48, 0xC1, 0xF8, count); // sar rax, imm8
+            } else {
+                emit_call(jit, shift_integer_right);
+            }
+            break;
+        case EXPRESSO_OP_BITWISE_AND: EMIT(jit, 0x48, 0x21, 0xC8); break; // and rax, rcx
+        case EXPRESSO_OP_BITWISE_XOR: EMIT(jit, 0x48, 0x31, 0xC8); break; // xor rax, rcx
+        case EXPRESSO_OP_BITWISE_OR:  EMIT(jit, 0x48, 0x09, 0xC8); break; // or rax, rcx
+        case EXPRESSO_OP_LESS:          EMIT(jit, 0x48, 0x39, 0xC8); emit_set_flag(jit, 0x9C); break;
+        case EXPRESSO_OP_GREATER:       EMIT(jit, 0x48, 0x39, 0xC8); emit_set_flag(jit, 0x9F); break;
+        case EXPRESSO_OP_LESS_EQUAL:    EMIT(jit, 0x48, 0x39, 0xC8); emit_set_flag(jit, 0x9E); break;
+        case EXPRESSO_OP_GREATER_EQUAL: EMIT(jit, 0x48, 0x39, 0xC8); emit_set_flag(jit, 0x9D); break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+static bool compile_range(Jit* jit, size_t start, size_t end) {
+    const ExpressoProgram* program = jit->program;
+    const uint8_t* code = program->code;
+    size_t pc = start;
+
+    while (pc < end) {
+        ExpressoOpcode opcode = (ExpressoOpcode)code[pc];
+        bool after_constant = jit->constant_top;
+        jit->constant_top = false;
+        uint32_t operand = 0;
+        if (opcode == EXPRESSO_OPCODE_CONSTANT || opcode == EXPRESSO_OPCODE_PARAMETER) {
+            memcpy(&operand, code + pc + 1, sizeof operand);
+        }
+
+        switch (opcode) {
+            case EXPRESSO_OPCODE_CONSTANT: {
+                Value constant = program->constants[operand];
+                ValueType type = value_get_type(constant);
+                if (type != VALUE_TYPE_INTEGER && type != VALUE_TYPE_FLOAT) return false;
+                uint64_t bits;
+                if (type == VALUE_TYPE_FLOAT) {
+                    double d = value_get_float(constant);
+                    memcpy(&bits, &d, sizeof bits);
+                } else {
+                    bits = (uint64_t)value_get_integer(constant);
+                }
+                push_value(jit, type);
+                EMIT(jit, 0x48, 0xB8); // mov rax, imm64
+                emit_u64(jit, bits);
+                jit->constant_top = type == VALUE_TYPE_INTEGER;
+                jit->constant_value = (long long)bits;
+                pc += 1 + sizeof(uint32_t);
+                break;
+            }
+            case EXPRESSO_OPCODE_PARAMETER:
+                push_value(jit, value_get_type(jit->bindings[operand]));
+                emit_load_parameter(jit, operand);
+                pc += 1 + sizeof(uint32_t);
+                break;
+            case EXPRESSO_OPCODE_NEGATE:
+                if (!compile_unary(jit, EXPRESSO_OP_NEGATE)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_LOGICAL_NOT:
+                if (!compile_unary(jit, EXPRESSO_OP_LOGICAL_NOT)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_BITWISE_NOT:
+                if (!compile_unary(jit, EXPRESSO_OP_BITWISE_NOT)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_BRANCH: {
+                uint32_t else_start, branch_end;
+                memcpy(&else_start, code + pc + 1, sizeof else_start);
+                memcpy(&branch_end, code + pc + 1 + sizeof(uint32_t), sizeof branch_end);
+                size_t then_end = else_start - (1 + sizeof(uint32_t));
+                if (code[then_end] != EXPRESSO_OPCODE_JUMP) return false;
+                if (jit->types[jit->depth - 1] != VALUE_TYPE_INTEGER) return false;
+
+                EMIT(jit, 0x48, 0x85, 0xC0); // test rax, rax
+                jit->depth--;
+                if (jit->depth > 0) EMIT(jit, 0x58); // pop rax, keeping the flags
+                EMIT(jit, 0x0F, 0x84);       // je else
+                size_t else_jump = emit_rel32(jit);
+
+                if (!compile_range(jit, pc + 1 + 2 * sizeof(uint32_t), then_end)) return false;
+                ValueType then_type = jit->types[--jit->depth];
+                EMIT(jit, 0xE9);             // jmp end
+                size_t end_jump = emit_rel32(jit);
+
+                patch_jump(jit, else_jump, jit->size);
+                if (!compile_range(jit, else_start, branch_end)) return false;
+                // The result must have one static type whichever branch runs
+                if (jit->types[jit->depth - 1] != then_type) return false;
+                patch_jump(jit, end_jump, jit->size);
+                jit->constant_top = false;
+                pc = branch_end;
+                break;
+            }
+            case EXPRESSO_OPCODE_AND_THEN:
+            case EXPRESSO_OPCODE_OR_ELSE: {
+                // The left operand stays in rax as the result when it decides it
+                bool is_and = opcode == EXPRESSO_OPCODE_AND_THEN;
+                uint32_t right_end;
+                memcpy(&right_end, code + pc + 1, sizeof right_end);
+                if (jit->types[jit->depth - 1] != VALUE_TYPE_INTEGER) return false;
+
+                EMIT(jit, 0x48, 0x85, 0xC0); // test rax, rax
+                if (!is_and) emit_set_flag(jit, 0x95);
+                EMIT(jit, 0x0F, is_and ? 0x84 : 0x85); // je/jne end
+                size_t end_jump = emit_rel32(jit);
+                jit->depth--;
+                if (jit->depth > 0) EMIT(jit, 0x58); // pop rax
+
+                if (!compile_range(jit, pc + 1 + sizeof(uint32_t), right_end)) return false;
+                patch_jump(jit, end_jump, jit->size);
+                jit->constant_top = false;
+                pc = right_end;
+                break;
+            }
+            case EXPRESSO_OPCODE_LOGICAL_AND:
+                if (!compile_unary(jit, EXPRESSO_OP_LOGICAL_AND)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_LOGICAL_OR:
+                if (!compile_unary(jit, EXPRESSO_OP_LOGICAL_OR)) return false;
+                pc++;
+                break;
+            case EXPRESSO_OPCODE_RETURN:
+                pc++;
+                break;
+            default: {
+                // Binary operators are laid out in ExpressoOperator order
+                if (opcode < EXPRESSO_OPCODE_MULTIPLY || opcode > EXPRESSO_OPCODE_BITWISE_OR) return false;
+                ExpressoOperator op = (ExpressoOperator)(EXPRESSO_OP_MULTIPLY + (opcode - EXPRESSO_OPCODE_MULTIPLY));
+                if (!compile_binary(jit, op, after_constant)) return false;
+                pc++;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static bool compile_function(Jit* jit) {
+    const ExpressoProgram* program = jit->program;
+
+    EMIT(jit, 0x55,              // push rbp
+              0x48, 0x89, 0xE5,  // mov rbp, rsp
+              0x53,              // push rbx
+              0x41, 0x54,        // push r12 (rsp is now 16-byte aligned)
+              0x48, 0x89, 0xFB,  // mov rbx, rdi
+              0x49, 0x89, 0xF4); // mov r12, rsi
+
+    // Guard on the parameter types the code is specialised to
+    for (size_t slot = 0; slot < program->parameter_count; slot++) {
+        ValueType type = value_get_type(jit->bindings[slot]);
+        if (type != VALUE_TYPE_INTEGER && type != VALUE_TYPE_FLOAT) return false;
+        emit_guard_parameter(jit, slot, type);
+    }
+
+    if (!compile_range(jit, 0, program->code_size) || jit->depth != 1) return false;
+
+    EMIT(jit, 0x49, 0x89, 0x04, 0x24,  // mov [r12], rax
+              0xB8, 0x01, 0x00, 0x00, 0x00); // mov eax, 1
+    size_t exit = jit->size;
+    EMIT(jit, 0x48, 0x8D, 0x65, 0xF0,  // exit: lea rsp, [rbp - 16]
+              0x41, 0x5C,              // pop r12
+              0x5B,                    // pop rbx
+              0x5D,                    // pop rbp
+              0xC3);                   // ret
+
+    if (jit->bail_count > 0) {
+        size_t bail = jit->size;
+        EMIT(jit, 0x31, 0xC0,          // bail: xor eax, eax
+                  0xE9);               // jmp exit
+        patch_jump(jit, emit_rel32(jit), exit);
+        for (size_t i = 0; i < jit->bail_count; i++) patch_jump(jit, jit->bail_patches[i], bail);
+    }
+    return true;
+}
+
+static void write_perf_map_entry(const void* start, size_t size, const char* name) {
+    if (perf_map_enabled < 0) perf_map_enabled = read_setting("EXPRESSO_PERF_MAP", false);
+    if (!perf_map_enabled) return;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%ld.map", (long)getpid());
+    FILE* map = fopen(path, "a");
+    if (!map) return;
+
+    // One line per symbol: start and size in hex, then the name
+    fprintf(map, "%lx %zx expresso:", (unsigned long)(uintptr_t)start, size);
+    const char* text = name ? name : "expression";
+    for (size_t i = 0; text[i] && i < PERF_MAP_NAME_MAX; i++) {
+        fputc(text[i] == '\n' || text[i] == '\r' ? ' ' : text[i], map);
+    }
+    fputc('\n', map);
+    fclose(map);
+}
+
+ExpressoJitCode* expresso_jit_compile(const ExpressoProgram* program, const Value* bindings, const char* name) {
+    if (!program || program->code_size == 0 || (program->parameter_count > 0 && !bindings)) return NULL;
+
+    Jit jit = { 0 };
+    jit.program = program;
+    jit.bindings = bindings;
+    jit.types = (ValueType*)malloc(program->max_stack * sizeof(ValueType));
+    if (!jit.types) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for JIT types.\n");
+        exit(EXIT_FAILURE);
+    }
+    bool compiled = compile_function(&jit);
+    ValueType result_type = compiled ? jit.types[0] : VALUE_TYPE_ERROR;
+    free(jit.types);
+    free(jit.bail_patches);
+    if (!compiled) {
+        free(jit.code);
+        return NULL;
+    }
+
+    // Write the code, then flip the pages to executable; a system that
+    // refuses executable mappings just leaves evaluation to the VM
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapped_size = (jit.size + page - 1) / page * page;
+    void* memory = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        free(jit.code);
+        return NULL;
+    }
+    memcpy(memory, jit.code, jit.size);
+    free(jit.code);
+    if (mprotect(memory, mapped_size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mapped_size);
+        return NULL;
+    }
+
+    ExpressoJitCode* code = (ExpressoJitCode*)malloc(sizeof(ExpressoJitCode));
+    if (!code) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for JIT code handle.\n");
+        exit(EXIT_FAILURE);
+    }
+    code->memory = memory;
+    code->mapped_size = mapped_size;
+    code->function = (JitFunction)memory;
+    code->result_type = result_type;
+    code->parameter_count = program->parameter_count;
+    write_perf_map_entry(memory, jit.size, name);
+    return code;
+}
+
+#else
+
+ExpressoJitCode* expresso_jit_compile(const ExpressoProgram* program, const Value* bindings, const char* name) {
+    (void)program;
+    (void)bindings;
+    (void)name;
+    return NULL;
+}
+
+#endif // EXPRESSO_JIT_X86_64
+
+bool expresso_jit_run(const ExpressoJitCode* code, const Value* bindings, Value* result) {
+    if (!code || (code->parameter_count > 0 && !bindings)) return false;
+
+    uint64_t bits;
+    if (!code->function(bindings, &bits)) return false;
+    if (code->result_type == VALUE_TYPE_FLOAT) {
+        double d;
+        memcpy(&d, &bits, sizeof d);
+        *result = value_create_float(d);
+    } else {
+        *result = value_create_integer((long long)bits);
+    }
+    return true;
+}
+
+void expresso_jit_destroy(ExpressoJitCode* code) {
+    if (!code) return;
+
+#ifdef EXPRESSO_JIT_X86_64
+    munmap(code->memory, code->mapped_size);
+#endif
+    free(code);
+}
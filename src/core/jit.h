@@ -0,0 +1,103 @@
+/*
+ * Expresso
+ * jit.h
+ *
+ * Native x86-64 code generation for integer and float expressions.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_JIT_H
+#define EXPRESSO_JIT_H
+
+#include <stdbool.h> // For bool
+#include "value.h"
+#include "bytecode.h"
+
+// Machine code is generated for the System V x86-64 ABI on Linux, which also
+// provides perf's /tmp/perf-<pid>.map convention; elsewhere nothing is JIT'd
+#if defined(__x86_64__) && defined(__linux__)
+#define EXPRESSO_JIT_X86_64 1
+#endif
+
+// Native code for one program, specialised to the types of its parameters
+typedef struct ExpressoJitCode ExpressoJitCode;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Whether this build can generate native code at all
+bool expresso_jit_available(void);
+
+// Turn the JIT on or off at runtime. It starts on unless the environment
+// variable EXPRESSO_JIT is "0" or "off". Code that is already generated
+// stays valid but expresso_eval() stops using it while the JIT is off.
+void expresso_jit_set_enabled(bool enabled);
+bool expresso_jit_enabled(void);
+
+// Append an entry to /tmp/perf-<pid>.map for each generated function, so
+// perf can attribute samples to it. Off unless EXPRESSO_PERF_MAP is set.
+void expresso_jit_set_perf_map(bool enabled);
+
+// Generate code for a program whose parameters have the types of bindings.
+// name labels the code in the perf map. Returns NULL if the JIT is
+// unavailable or the program uses anything but integers and floats, or
+// could produce an error value; such programs stay with the VM. Floats are
+// computed with SSE2 where both operands are floats; the remainder, a
+// float condition for ?: or && and ||, and operands promoted from integers
+// are not compiled.
+ExpressoJitCode* expresso_jit_compile(const ExpressoProgram* program, const Value* bindings, const char* name);
+
+// Run generated code. Returns false without touching result if bindings do
+// not have the types the code was generated for, or an operation fails or
+// overflows (and the VM would return an error or a big integer); the caller
+// should run the VM instead.
+bool expresso_jit_run(const ExpressoJitCode* code, const Value* bindings, Value* result);
+
+// Release generated code
+void expresso_jit_destroy(ExpressoJitCode* code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_JIT_H
@@ -0,0 +1,250 @@
+/*
+ * Expresso
+ * kernels.c
+ *
+ * Portable column kernels and runtime selection of the SIMD variants.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "kernels.h"
+#include "operations.h" // For the shift helpers
+#include <limits.h>
+#include <math.h>   // For fmod
+#include <string.h>
+
+// Loops are kept simple so compilers can auto-vectorise them where the
+// explicit SIMD tables have no better variant
+#define INTEGER_KERNEL(name, expression) \
+    void name(long long* out, const long long* a, const long long* b, size_t n) { \
+        (void)b; \
+        for (size_t i = 0; i < n; i++) out[i] = (expression); \
+    }
+
+INTEGER_KERNEL(expresso_kernel_shift_left, shift_integer_left(a[i], b[i]))
+INTEGER_KERNEL(expresso_kernel_shift_right, shift_integer_right(a[i], b[i]))
+INTEGER_KERNEL(expresso_kernel_less, a[i] < b[i])
+INTEGER_KERNEL(expresso_kernel_greater, a[i] > b[i])
+INTEGER_KERNEL(expresso_kernel_less_equal, a[i] <= b[i])
+INTEGER_KERNEL(expresso_kernel_greater_equal, a[i] >= b[i])
+INTEGER_KERNEL(expresso_kernel_equal, a[i] == b[i])
+INTEGER_KERNEL(expresso_kernel_not_equal, a[i] != b[i])
+INTEGER_KERNEL(expresso_kernel_bitwise_and, a[i] & b[i])
+INTEGER_KERNEL(expresso_kernel_bitwise_xor, a[i] ^ b[i])
+INTEGER_KERNEL(expresso_kernel_bitwise_or, a[i] | b[i])
+INTEGER_KERNEL(expresso_kernel_logical_and, a[i] != 0 && b[i] != 0)
+INTEGER_KERNEL(expresso_kernel_logical_or, a[i] != 0 || b[i] != 0)
+INTEGER_KERNEL(expresso_kernel_logical_not, a[i] == 0)
+INTEGER_KERNEL(expresso_kernel_bitwise_not, ~a[i])
+
+#define VALID(validity, i) (((validity)[(i) >> 3] >> ((i) & 7)) & 1)
+#define INVALIDATE(validity, i) ((validity)[(i) >> 3] &= (uint8_t)~(1u << ((i) & 7)))
+
+// Rows that overflow have their bits cleared a validity byte at a time, so
+// the loop has no branch per row; whole bytes have a fixed trip count that
+// compilers unroll
+#define OVERFLOW_BLOCK(first, second, overflows, start, end) \
+    do { \
+        unsigned overflow = 0; \
+        for (size_t i = (start); i < (end); i++) { \
+            long long result; \
+            overflow |= (unsigned)overflows(first, second, &result) << (i - (start)); \
+            out[i] = result; \
+        } \
+        validity[(start) >> 3] &= (uint8_t)~overflow; \
+    } while (0)
+
+#define OVERFLOW_KERNEL(name, first, second, overflows) \
+    void name(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n) { \
+        size_t block = 0; \
+        (void)b; \
+        for (; block + 8 <= n; block += 8) OVERFLOW_BLOCK(first, second, overflows, block, block + 8); \
+        if (block < n) OVERFLOW_BLOCK(first, second, overflows, block, n); \
+    }
+
+OVERFLOW_KERNEL(expresso_kernel_multiply, a[i], b[i], __builtin_mul_overflow)
+OVERFLOW_KERNEL(expresso_kernel_add, a[i], b[i], __builtin_add_overflow)
+OVERFLOW_KERNEL(expresso_kernel_subtract, a[i], b[i], __builtin_sub_overflow)
+OVERFLOW_KERNEL(expresso_kernel_negate, 0LL, a[i], __builtin_sub_overflow)
+
+// Division by zero and LLONG_MIN / -1 have no integer result
+void expresso_kernel_divide(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (!VALID(validity, i)) continue;
+        if (b[i] == 0 || (a[i] == LLONG_MIN && b[i] == -1)) {
+            INVALIDATE(validity, i);
+            out[i] = 0;
+        } else {
+            out[i] = a[i] / b[i];
+        }
+    }
+}
+
+// LLONG_MIN % -1 is 0, but computing it traps on x86
+void expresso_kernel_modulo(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (!VALID(validity, i)) continue;
+        if (b[i] == 0) {
+            INVALIDATE(validity, i);
+            out[i] = 0;
+        } else {
+            out[i] = b[i] == -1 ? 0 : a[i] % b[i];
+        }
+    }
+}
+
+#define FLOAT_COMPARE_KERNEL(name, expression) \
+    void name(long long* out, const double* a, const double* b, size_t n) { \
+        for (size_t i = 0; i < n; i++) out[i] = (expression); \
+    }
+
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_less, a[i] < b[i])
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_greater, a[i] > b[i])
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_less_equal, a[i] <= b[i])
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_greater_equal, a[i] >= b[i])
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_equal, a[i] == b[i])
+FLOAT_COMPARE_KERNEL(expresso_kernel_float_not_equal, !(a[i] == b[i]))
+
+#define FLOAT_KERNEL(name, expression) \
+    void name(double* out, const double* a, const double* b, size_t n) { \
+        (void)b; \
+        for (size_t i = 0; i < n; i++) out[i] = (expression); \
+    }
+
+FLOAT_KERNEL(expresso_kernel_float_multiply, a[i] * b[i])
+FLOAT_KERNEL(expresso_kernel_float_add, a[i] + b[i])
+FLOAT_KERNEL(expresso_kernel_float_subtract, a[i] - b[i])
+FLOAT_KERNEL(expresso_kernel_float_negate, -a[i])
+
+// A zero divisor, of either sign, is the only failure; as in operations.c,
+// NaN and infinite operands give NaN or infinite results
+#define FLOAT_DIVISION_KERNEL(name, expression) \
+    void name(double* out, uint8_t* validity, const double* a, const double* b, size_t n) { \
+        for (size_t i = 0; i < n; i++) { \
+            if (!VALID(validity, i)) continue; \
+            if (b[i] == 0) { \
+                INVALIDATE(validity, i); \
+                out[i] = 0; \
+            } else { \
+                out[i] = (expression); \
+            } \
+        } \
+    }
+
+FLOAT_DIVISION_KERNEL(expresso_kernel_float_divide, a[i] / b[i])
+FLOAT_DIVISION_KERNEL(expresso_kernel_float_modulo, fmod(a[i], b[i]))
+
+void expresso_kernel_select(void* out, const long long* condition, const void* if_true, const void* if_false, size_t n) {
+    // Lanes may hold doubles, so they are moved as bytes
+    for (size_t i = 0; i < n; i++) {
+        const void* lane = condition[i] ? (const char*)if_true + i * 8 : (const char*)if_false + i * 8;
+        memcpy((char*)out + i * 8, lane, 8);
+    }
+}
+
+static const ExpressoKernelTable scalar_kernels = {
+    .level = EXPRESSO_SIMD_SCALAR,
+    .integer = {
+        [EXPRESSO_OP_LOGICAL_NOT] = expresso_kernel_logical_not,
+        [EXPRESSO_OP_BITWISE_NOT] = expresso_kernel_bitwise_not,
+        [EXPRESSO_OP_SHIFT_LEFT] = expresso_kernel_shift_left,
+        [EXPRESSO_OP_SHIFT_RIGHT] = expresso_kernel_shift_right,
+        [EXPRESSO_OP_LESS] = expresso_kernel_less,
+        [EXPRESSO_OP_GREATER] = expresso_kernel_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = expresso_kernel_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = expresso_kernel_greater_equal,
+        [EXPRESSO_OP_EQUAL] = expresso_kernel_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = expresso_kernel_not_equal,
+        [EXPRESSO_OP_BITWISE_AND] = expresso_kernel_bitwise_and,
+        [EXPRESSO_OP_BITWISE_XOR] = expresso_kernel_bitwise_xor,
+        [EXPRESSO_OP_BITWISE_OR] = expresso_kernel_bitwise_or,
+        [EXPRESSO_OP_LOGICAL_AND] = expresso_kernel_logical_and,
+        [EXPRESSO_OP_LOGICAL_OR] = expresso_kernel_logical_or,
+    },
+    .checked = {
+        [EXPRESSO_OP_NEGATE] = expresso_kernel_negate,
+        [EXPRESSO_OP_MULTIPLY] = expresso_kernel_multiply,
+        [EXPRESSO_OP_DIVIDE] = expresso_kernel_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_modulo,
+        [EXPRESSO_OP_ADD] = expresso_kernel_add,
+        [EXPRESSO_OP_SUBTRACT] = expresso_kernel_subtract,
+    },
+    .float_compare = {
+        [EXPRESSO_OP_LESS] = expresso_kernel_float_less,
+        [EXPRESSO_OP_GREATER] = expresso_kernel_float_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = expresso_kernel_float_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = expresso_kernel_float_greater_equal,
+        [EXPRESSO_OP_EQUAL] = expresso_kernel_float_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = expresso_kernel_float_not_equal,
+    },
+    .float_arithmetic = {
+        [EXPRESSO_OP_NEGATE] = expresso_kernel_float_negate,
+        [EXPRESSO_OP_MULTIPLY] = expresso_kernel_float_multiply,
+        [EXPRESSO_OP_ADD] = expresso_kernel_float_add,
+        [EXPRESSO_OP_SUBTRACT] = expresso_kernel_float_subtract,
+    },
+    .float_checked = {
+        [EXPRESSO_OP_DIVIDE] = expresso_kernel_float_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_float_modulo,
+    },
+    .select = expresso_kernel_select,
+};
+
+ExpressoSimdLevel expresso_simd_detect(void) {
+#ifdef EXPRESSO_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return EXPRESSO_SIMD_AVX2;
+    return EXPRESSO_SIMD_SSE2;
+#else
+    return EXPRESSO_SIMD_SCALAR;
+#endif
+}
+
+const ExpressoKernelTable* expresso_kernels(ExpressoSimdLevel level) {
+    if (level > expresso_simd_detect()) return NULL;
+
+    switch (level) {
+        case EXPRESSO_SIMD_SCALAR: return &scalar_kernels;
+        case EXPRESSO_SIMD_SSE2:   return expresso_kernels_sse2();
+        case EXPRESSO_SIMD_AVX2:   return expresso_kernels_avx2();
+    }
+    return NULL;
+}
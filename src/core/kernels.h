@@ -0,0 +1,158 @@
+/*
+ * Expresso
+ * kernels.h
+ *
+ * Column kernels for batch evaluation, with SIMD variants chosen at runtime.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_KERNELS_H
+#define EXPRESSO_KERNELS_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+#include "ast.h"     // For ExpressoOperator
+
+// SSE2 and AVX2 kernels are built for x86-64, where SSE2 is baseline, with
+// GCC-compatible compilers, which can target each function at AVX2
+#if defined(__x86_64__) && defined(__GNUC__)
+#define EXPRESSO_KERNELS_X86 1
+#endif
+
+// Instruction set levels that kernels are written for
+typedef enum {
+    EXPRESSO_SIMD_SCALAR, // Portable C
+    EXPRESSO_SIMD_SSE2,
+    EXPRESSO_SIMD_AVX2
+} ExpressoSimdLevel;
+
+// Integer kernels compute out[i] = a[i] op b[i] (b is ignored by unary
+// operators) for operators that cannot fail. out may alias a or b.
+typedef void (*ExpressoIntegerKernel)(long long* out, const long long* a, const long long* b, size_t n);
+
+// Kernels for operations that can fail per row (arithmetic that overflows,
+// division by zero). Rows that fail get their validity bit cleared; rows
+// whose bit is already clear may be skipped.
+typedef void (*ExpressoCheckedKernel)(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+
+// Float comparisons producing 0 or 1. NaN is unequal to everything, as in
+// value_equals(), and neither less nor greater.
+typedef void (*ExpressoFloatCompareKernel)(long long* out, const double* a, const double* b, size_t n);
+
+// Float kernels compute out[i] = a[i] op b[i] (b is ignored by unary
+// operators). out may alias a or b.
+typedef void (*ExpressoFloatKernel)(double* out, const double* a, const double* b, size_t n);
+
+// Float division and remainder, which fail per row where the divisor is zero
+// as ExpressoCheckedKernel rows do
+typedef void (*ExpressoFloatCheckedKernel)(double* out, uint8_t* validity, const double* a, const double* b, size_t n);
+
+// out[i] = condition[i] ? if_true[i] : if_false[i] over 64-bit lanes of any type
+typedef void (*ExpressoSelectKernel)(void* out, const long long* condition, const void* if_true, const void* if_false, size_t n);
+
+typedef struct {
+    ExpressoSimdLevel level;
+    ExpressoIntegerKernel integer[EXPRESSO_OP_LOGICAL_OR + 1]; // By operator; NULL if checked
+    ExpressoCheckedKernel checked[EXPRESSO_OP_LOGICAL_OR + 1]; // Arithmetic only
+    ExpressoFloatCompareKernel float_compare[EXPRESSO_OP_LOGICAL_OR + 1]; // Comparisons only
+    ExpressoFloatKernel float_arithmetic[EXPRESSO_OP_LOGICAL_OR + 1];     // +, - and *
+    ExpressoFloatCheckedKernel float_checked[EXPRESSO_OP_LOGICAL_OR + 1]; // / and %
+    ExpressoSelectKernel select;
+} ExpressoKernelTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Best level supported by both this build and the running CPU
+ExpressoSimdLevel expresso_simd_detect(void);
+
+// Kernels for a level, or NULL if this build or CPU cannot run it
+const ExpressoKernelTable* expresso_kernels(ExpressoSimdLevel level);
+
+// Kernel tables built in kernels_x86.c, or NULL on other targets
+const ExpressoKernelTable* expresso_kernels_sse2(void);
+const ExpressoKernelTable* expresso_kernels_avx2(void);
+
+// Scalar kernels, also used by the SIMD tables where the instruction set
+// has nothing better (e.g. 64-bit division)
+void expresso_kernel_shift_left(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_shift_right(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_less(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_greater(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_less_equal(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_greater_equal(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_equal(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_not_equal(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_bitwise_and(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_bitwise_xor(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_bitwise_or(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_logical_and(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_logical_or(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_logical_not(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_bitwise_not(long long* out, const long long* a, const long long* b, size_t n);
+void expresso_kernel_multiply(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_add(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_subtract(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_negate(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_divide(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_modulo(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n);
+void expresso_kernel_float_less(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_greater(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_less_equal(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_greater_equal(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_equal(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_not_equal(long long* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_multiply(double* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_add(double* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_subtract(double* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_negate(double* out, const double* a, const double* b, size_t n);
+void expresso_kernel_float_divide(double* out, uint8_t* validity, const double* a, const double* b, size_t n);
+void expresso_kernel_float_modulo(double* out, uint8_t* validity, const double* a, const double* b, size_t n);
+void expresso_kernel_select(void* out, const long long* condition, const void* if_true, const void* if_false, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_KERNELS_H
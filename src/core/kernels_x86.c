@@ -0,0 +1,476 @@
+/*
+ * Expresso
+ * kernels_x86.c
+ *
+ * SSE2 and AVX2 column kernels, selected at runtime by kernels.c.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "kernels.h"
+
+#ifdef EXPRESSO_KERNELS_X86
+
+#include <immintrin.h>
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Each kernel runs whole vectors, then hands the remaining rows to the
+// scalar kernel of the same operation.
+#define VECTOR_KERNEL(target, name, vector, lanes, load, store, op, scalar) \
+    static target void name(long long* out, const long long* a, const long long* b, size_t n) { \
+        size_t i = 0; \
+        for (; i + (lanes) <= n; i += (lanes)) { \
+            vector x = load((const vector*)(a + i)); \
+            vector y = load((const vector*)(b + i)); \
+            store((vector*)(out + i), op(x, y)); \
+        } \
+        scalar(out + i, a + i, b + i, n - i); \
+    }
+
+#define VECTOR_UNARY_KERNEL(target, name, vector, lanes, load, store, op, scalar) \
+    static target void name(long long* out, const long long* a, const long long* b, size_t n) { \
+        size_t i = 0; \
+        (void)b; \
+        for (; i + (lanes) <= n; i += (lanes)) { \
+            store((vector*)(out + i), op(load((const vector*)(a + i)))); \
+        } \
+        scalar(out + i, a + i, a + i, n - i); \
+    }
+
+// Checked kernels run eight rows, one validity byte, at a time. lanes_overflow
+// gives a bit per lane that overflowed, as from movemask; the bits of a block
+// clear its rows' validity at once. second is b, or a for unary operators.
+#define VECTOR_CHECKED_KERNEL(target, name, vector, lanes, load, store, op, lanes_overflow, second, scalar) \
+    static target void name(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n) { \
+        size_t i = 0; \
+        (void)b; \
+        for (; i + 8 <= n; i += 8) { \
+            unsigned overflow = 0; \
+            for (size_t j = 0; j < 8; j += (lanes)) { \
+                vector x = load((const vector*)(a + i + j)); \
+                vector y = load((const vector*)(second + i + j)); \
+                vector r = op(x, y); \
+                overflow |= (unsigned)lanes_overflow(x, y, r) << j; \
+                store((vector*)(out + i + j), r); \
+            } \
+            validity[i >> 3] &= (uint8_t)~overflow; \
+        } \
+        scalar(out + i, validity + (i >> 3), a + i, second + i, n - i); \
+    }
+
+#define VECTOR_FLOAT_COMPARE_KERNEL(target, name, lanes, load, store, op, scalar) \
+    static target void name(long long* out, const double* a, const double* b, size_t n) { \
+        size_t i = 0; \
+        for (; i + (lanes) <= n; i += (lanes)) { \
+            store(out + i, op(load(a + i), load(b + i))); \
+        } \
+        scalar(out + i, a + i, b + i, n - i); \
+    }
+
+// second is b, or a for unary operators
+#define VECTOR_FLOAT_KERNEL(target, name, lanes, load, store, op, second, scalar) \
+    static target void name(double* out, const double* a, const double* b, size_t n) { \
+        size_t i = 0; \
+        (void)b; \
+        for (; i + (lanes) <= n; i += (lanes)) { \
+            store(out + i, op(load(a + i), load(second + i))); \
+        } \
+        scalar(out + i, a + i, second + i, n - i); \
+    }
+
+// Float division runs eight rows, one validity byte, at a time, as checked
+// kernels do; zero_lanes gives a bit per lane whose divisor is zero
+#define VECTOR_FLOAT_DIVIDE_KERNEL(target, name, vector, lanes, load, store, divide, zero_lanes, scalar) \
+    static target void name(double* out, uint8_t* validity, const double* a, const double* b, size_t n) { \
+        size_t i = 0; \
+        for (; i + 8 <= n; i += 8) { \
+            unsigned zero = 0; \
+            for (size_t j = 0; j < 8; j += (lanes)) { \
+                vector y = load(b + i + j); \
+                zero |= (unsigned)zero_lanes(y) << j; \
+                store(out + i + j, divide(load(a + i + j), y)); \
+            } \
+            validity[i >> 3] &= (uint8_t)~zero; \
+        } \
+        scalar(out + i, validity + (i >> 3), a + i, b + i, n - i); \
+    }
+
+// --- SSE2 ---
+// SSE2 has no 64-bit integer compare or multiply; equality is built from
+// 32-bit compares. Ordered comparisons, shifts and multiplication, whose
+// overflow check needs the high half of the product, stay scalar. Doubles
+// have every operator but the remainder, which is fmod.
+
+#define SSE2_KERNEL(name, op, scalar) \
+    VECTOR_KERNEL(, name, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, op, scalar)
+#define SSE2_UNARY_KERNEL(name, op, scalar) \
+    VECTOR_UNARY_KERNEL(, name, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, op, scalar)
+#define SSE2_CHECKED_KERNEL(name, op, lanes_overflow, second, scalar) \
+    VECTOR_CHECKED_KERNEL(, name, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, op, lanes_overflow, second, scalar)
+
+static inline __m128i sse2_one(void) { return _mm_set1_epi64x(1); }
+
+static inline __m128i sse2_cmpeq64(__m128i x, __m128i y) {
+    __m128i eq32 = _mm_cmpeq_epi32(x, y);
+    return _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static inline __m128i sse2_is_zero(__m128i x) { return sse2_cmpeq64(x, _mm_setzero_si128()); }
+
+// Sign bits of lanes where r = x + y (or x - y) overflowed: the operands
+// agree in sign (differ, for subtraction) and the result does not
+static inline int sse2_sign_bits(__m128i x) { return _mm_movemask_pd(_mm_castsi128_pd(x)); }
+static inline int sse2_add_overflow(__m128i x, __m128i y, __m128i r) {
+    return sse2_sign_bits(_mm_and_si128(_mm_xor_si128(x, r), _mm_xor_si128(y, r)));
+}
+static inline int sse2_subtract_overflow(__m128i x, __m128i y, __m128i r) {
+    return sse2_sign_bits(_mm_and_si128(_mm_xor_si128(x, y), _mm_xor_si128(x, r)));
+}
+static inline int sse2_negate_overflow(__m128i x, __m128i y, __m128i r) { (void)y; return sse2_sign_bits(_mm_and_si128(x, r)); }
+
+static inline __m128i sse2_equal(__m128i x, __m128i y) { return _mm_and_si128(sse2_cmpeq64(x, y), sse2_one()); }
+static inline __m128i sse2_not_equal(__m128i x, __m128i y) { return _mm_andnot_si128(sse2_cmpeq64(x, y), sse2_one()); }
+static inline __m128i sse2_logical_and(__m128i x, __m128i y) {
+    return _mm_andnot_si128(_mm_or_si128(sse2_is_zero(x), sse2_is_zero(y)), sse2_one());
+}
+static inline __m128i sse2_logical_or(__m128i x, __m128i y) {
+    return _mm_andnot_si128(_mm_and_si128(sse2_is_zero(x), sse2_is_zero(y)), sse2_one());
+}
+static inline __m128i sse2_negate(__m128i x, __m128i y) { (void)y; return _mm_sub_epi64(_mm_setzero_si128(), x); }
+static inline __m128i sse2_logical_not(__m128i x) { return _mm_and_si128(sse2_is_zero(x), sse2_one()); }
+static inline __m128i sse2_bitwise_not(__m128i x) { return _mm_xor_si128(x, _mm_set1_epi32(-1)); }
+
+SSE2_CHECKED_KERNEL(sse2_kernel_add, _mm_add_epi64, sse2_add_overflow, b, expresso_kernel_add)
+SSE2_CHECKED_KERNEL(sse2_kernel_subtract, _mm_sub_epi64, sse2_subtract_overflow, b, expresso_kernel_subtract)
+SSE2_CHECKED_KERNEL(sse2_kernel_negate, sse2_negate, sse2_negate_overflow, a, expresso_kernel_negate)
+SSE2_KERNEL(sse2_kernel_equal, sse2_equal, expresso_kernel_equal)
+SSE2_KERNEL(sse2_kernel_not_equal, sse2_not_equal, expresso_kernel_not_equal)
+SSE2_KERNEL(sse2_kernel_bitwise_and, _mm_and_si128, expresso_kernel_bitwise_and)
+SSE2_KERNEL(sse2_kernel_bitwise_xor, _mm_xor_si128, expresso_kernel_bitwise_xor)
+SSE2_KERNEL(sse2_kernel_bitwise_or, _mm_or_si128, expresso_kernel_bitwise_or)
+SSE2_KERNEL(sse2_kernel_logical_and, sse2_logical_and, expresso_kernel_logical_and)
+SSE2_KERNEL(sse2_kernel_logical_or, sse2_logical_or, expresso_kernel_logical_or)
+SSE2_UNARY_KERNEL(sse2_kernel_logical_not, sse2_logical_not, expresso_kernel_logical_not)
+SSE2_UNARY_KERNEL(sse2_kernel_bitwise_not, sse2_bitwise_not, expresso_kernel_bitwise_not)
+
+static inline void sse2_store_mask(long long* out, __m128d mask) {
+    _mm_storeu_si128((__m128i*)out, _mm_and_si128(_mm_castpd_si128(mask), sse2_one()));
+}
+
+#define SSE2_FLOAT_COMPARE_KERNEL(name, op, scalar) \
+    VECTOR_FLOAT_COMPARE_KERNEL(, name, 2, _mm_loadu_pd, sse2_store_mask, op, scalar)
+#define SSE2_FLOAT_KERNEL(name, op, second, scalar) \
+    VECTOR_FLOAT_KERNEL(, name, 2, _mm_loadu_pd, _mm_storeu_pd, op, second, scalar)
+
+// The ordered comparisons are false for NaN, cmpneq true
+static inline __m128d sse2_float_negate(__m128d x, __m128d y) { (void)y; return _mm_xor_pd(x, _mm_set1_pd(-0.0)); }
+static inline int sse2_zero_lanes(__m128d y) { return _mm_movemask_pd(_mm_cmpeq_pd(y, _mm_setzero_pd())); }
+
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_less, _mm_cmplt_pd, expresso_kernel_float_less)
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_greater, _mm_cmpgt_pd, expresso_kernel_float_greater)
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_less_equal, _mm_cmple_pd, expresso_kernel_float_less_equal)
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_greater_equal, _mm_cmpge_pd, expresso_kernel_float_greater_equal)
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_equal, _mm_cmpeq_pd, expresso_kernel_float_equal)
+SSE2_FLOAT_COMPARE_KERNEL(sse2_kernel_float_not_equal, _mm_cmpneq_pd, expresso_kernel_float_not_equal)
+SSE2_FLOAT_KERNEL(sse2_kernel_float_multiply, _mm_mul_pd, b, expresso_kernel_float_multiply)
+SSE2_FLOAT_KERNEL(sse2_kernel_float_add, _mm_add_pd, b, expresso_kernel_float_add)
+SSE2_FLOAT_KERNEL(sse2_kernel_float_subtract, _mm_sub_pd, b, expresso_kernel_float_subtract)
+SSE2_FLOAT_KERNEL(sse2_kernel_float_negate, sse2_float_negate, a, expresso_kernel_float_negate)
+VECTOR_FLOAT_DIVIDE_KERNEL(, sse2_kernel_float_divide, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_div_pd,
+                           sse2_zero_lanes, expresso_kernel_float_divide)
+
+static void sse2_kernel_select(void* out, const long long* condition, const void* if_true, const void* if_false, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i zero = sse2_is_zero(_mm_loadu_si128((const __m128i*)(condition + i)));
+        __m128i t = _mm_loadu_si128((const __m128i*)((const char*)if_true + i * 8));
+        __m128i f = _mm_loadu_si128((const __m128i*)((const char*)if_false + i * 8));
+        _mm_storeu_si128((__m128i*)((char*)out + i * 8), _mm_or_si128(_mm_and_si128(zero, f), _mm_andnot_si128(zero, t)));
+    }
+    expresso_kernel_select((char*)out + i * 8, condition + i, (const char*)if_true + i * 8, (const char*)if_false + i * 8, n - i);
+}
+
+static const ExpressoKernelTable sse2_kernels = {
+    .level = EXPRESSO_SIMD_SSE2,
+    .integer = {
+        [EXPRESSO_OP_LOGICAL_NOT] = sse2_kernel_logical_not,
+        [EXPRESSO_OP_BITWISE_NOT] = sse2_kernel_bitwise_not,
+        [EXPRESSO_OP_SHIFT_LEFT] = expresso_kernel_shift_left,
+        [EXPRESSO_OP_SHIFT_RIGHT] = expresso_kernel_shift_right,
+        [EXPRESSO_OP_LESS] = expresso_kernel_less,
+        [EXPRESSO_OP_GREATER] = expresso_kernel_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = expresso_kernel_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = expresso_kernel_greater_equal,
+        [EXPRESSO_OP_EQUAL] = sse2_kernel_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = sse2_kernel_not_equal,
+        [EXPRESSO_OP_BITWISE_AND] = sse2_kernel_bitwise_and,
+        [EXPRESSO_OP_BITWISE_XOR] = sse2_kernel_bitwise_xor,
+        [EXPRESSO_OP_BITWISE_OR] = sse2_kernel_bitwise_or,
+        [EXPRESSO_OP_LOGICAL_AND] = sse2_kernel_logical_and,
+        [EXPRESSO_OP_LOGICAL_OR] = sse2_kernel_logical_or,
+    },
+    .checked = {
+        [EXPRESSO_OP_NEGATE] = sse2_kernel_negate,
+        [EXPRESSO_OP_MULTIPLY] = expresso_kernel_multiply,
+        [EXPRESSO_OP_DIVIDE] = expresso_kernel_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_modulo,
+        [EXPRESSO_OP_ADD] = sse2_kernel_add,
+        [EXPRESSO_OP_SUBTRACT] = sse2_kernel_subtract,
+    },
+    .float_compare = {
+        [EXPRESSO_OP_LESS] = sse2_kernel_float_less,
+        [EXPRESSO_OP_GREATER] = sse2_kernel_float_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = sse2_kernel_float_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = sse2_kernel_float_greater_equal,
+        [EXPRESSO_OP_EQUAL] = sse2_kernel_float_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = sse2_kernel_float_not_equal,
+    },
+    .float_arithmetic = {
+        [EXPRESSO_OP_NEGATE] = sse2_kernel_float_negate,
+        [EXPRESSO_OP_MULTIPLY] = sse2_kernel_float_multiply,
+        [EXPRESSO_OP_ADD] = sse2_kernel_float_add,
+        [EXPRESSO_OP_SUBTRACT] = sse2_kernel_float_subtract,
+    },
+    .float_checked = {
+        [EXPRESSO_OP_DIVIDE] = sse2_kernel_float_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_float_modulo,
+    },
+    .select = sse2_kernel_select,
+};
+
+// --- AVX2 ---
+// AVX2 adds 64-bit compares and a signed 32x32->64 multiply, used where the
+// operands fit in 32 bits and the product cannot overflow. Integer division
+// and shifts with the spec's semantics stay scalar, as does fmod.
+
+#define AVX2_KERNEL(name, op, scalar) \
+    VECTOR_KERNEL(AVX2_TARGET, name, __m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256, op, scalar)
+#define AVX2_UNARY_KERNEL(name, op, scalar) \
+    VECTOR_UNARY_KERNEL(AVX2_TARGET, name, __m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256, op, scalar)
+#define AVX2_CHECKED_KERNEL(name, op, lanes_overflow, second, scalar) \
+    VECTOR_CHECKED_KERNEL(AVX2_TARGET, name, __m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256, op, lanes_overflow, second, scalar)
+
+static inline AVX2_TARGET __m256i avx2_one(void) { return _mm256_set1_epi64x(1); }
+static inline AVX2_TARGET __m256i avx2_is_zero(__m256i x) { return _mm256_cmpeq_epi64(x, _mm256_setzero_si256()); }
+
+static inline AVX2_TARGET int avx2_sign_bits(__m256i x) { return _mm256_movemask_pd(_mm256_castsi256_pd(x)); }
+static inline AVX2_TARGET int avx2_add_overflow(__m256i x, __m256i y, __m256i r) {
+    return avx2_sign_bits(_mm256_and_si256(_mm256_xor_si256(x, r), _mm256_xor_si256(y, r)));
+}
+static inline AVX2_TARGET int avx2_subtract_overflow(__m256i x, __m256i y, __m256i r) {
+    return avx2_sign_bits(_mm256_and_si256(_mm256_xor_si256(x, y), _mm256_xor_si256(x, r)));
+}
+static inline AVX2_TARGET int avx2_negate_overflow(__m256i x, __m256i y, __m256i r) {
+    (void)y;
+    return avx2_sign_bits(_mm256_and_si256(x, r));
+}
+
+static inline AVX2_TARGET __m256i avx2_add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+static inline AVX2_TARGET __m256i avx2_subtract(__m256i x, __m256i y) { return _mm256_sub_epi64(x, y); }
+static inline AVX2_TARGET __m256i avx2_less(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpgt_epi64(y, x), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_greater(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpgt_epi64(x, y), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_less_equal(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpgt_epi64(x, y), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_greater_equal(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpgt_epi64(y, x), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_equal(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpeq_epi64(x, y), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_not_equal(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpeq_epi64(x, y), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_bitwise_and(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+static inline AVX2_TARGET __m256i avx2_bitwise_xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+static inline AVX2_TARGET __m256i avx2_bitwise_or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+static inline AVX2_TARGET __m256i avx2_logical_and(__m256i x, __m256i y) {
+    return _mm256_andnot_si256(_mm256_or_si256(avx2_is_zero(x), avx2_is_zero(y)), avx2_one());
+}
+static inline AVX2_TARGET __m256i avx2_logical_or(__m256i x, __m256i y) {
+    return _mm256_andnot_si256(_mm256_and_si256(avx2_is_zero(x), avx2_is_zero(y)), avx2_one());
+}
+static inline AVX2_TARGET __m256i avx2_negate(__m256i x, __m256i y) { (void)y; return _mm256_sub_epi64(_mm256_setzero_si256(), x); }
+static inline AVX2_TARGET __m256i avx2_logical_not(__m256i x) { return _mm256_and_si256(avx2_is_zero(x), avx2_one()); }
+static inline AVX2_TARGET __m256i avx2_bitwise_not(__m256i x) { return _mm256_xor_si256(x, _mm256_set1_epi32(-1)); }
+
+AVX2_CHECKED_KERNEL(avx2_kernel_add, avx2_add, avx2_add_overflow, b, expresso_kernel_add)
+AVX2_CHECKED_KERNEL(avx2_kernel_subtract, avx2_subtract, avx2_subtract_overflow, b, expresso_kernel_subtract)
+AVX2_CHECKED_KERNEL(avx2_kernel_negate, avx2_negate, avx2_negate_overflow, a, expresso_kernel_negate)
+AVX2_KERNEL(avx2_kernel_less, avx2_less, expresso_kernel_less)
+AVX2_KERNEL(avx2_kernel_greater, avx2_greater, expresso_kernel_greater)
+AVX2_KERNEL(avx2_kernel_less_equal, avx2_less_equal, expresso_kernel_less_equal)
+AVX2_KERNEL(avx2_kernel_greater_equal, avx2_greater_equal, expresso_kernel_greater_equal)
+AVX2_KERNEL(avx2_kernel_equal, avx2_equal, expresso_kernel_equal)
+AVX2_KERNEL(avx2_kernel_not_equal, avx2_not_equal, expresso_kernel_not_equal)
+AVX2_KERNEL(avx2_kernel_bitwise_and, avx2_bitwise_and, expresso_kernel_bitwise_and)
+AVX2_KERNEL(avx2_kernel_bitwise_xor, avx2_bitwise_xor, expresso_kernel_bitwise_xor)
+AVX2_KERNEL(avx2_kernel_bitwise_or, avx2_bitwise_or, expresso_kernel_bitwise_or)
+AVX2_KERNEL(avx2_kernel_logical_and, avx2_logical_and, expresso_kernel_logical_and)
+AVX2_KERNEL(avx2_kernel_logical_or, avx2_logical_or, expresso_kernel_logical_or)
+AVX2_UNARY_KERNEL(avx2_kernel_logical_not, avx2_logical_not, expresso_kernel_logical_not)
+AVX2_UNARY_KERNEL(avx2_kernel_bitwise_not, avx2_bitwise_not, expresso_kernel_bitwise_not)
+
+// Rows are multiplied eight at a time; a block with an operand outside 32
+// bits is left to the scalar kernel, which checks each product
+static AVX2_TARGET void avx2_kernel_multiply(long long* out, uint8_t* validity, const long long* a, const long long* b, size_t n) {
+    const __m256i bias = _mm256_set1_epi64x(0x80000000LL);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x[2], y[2], high = _mm256_setzero_si256();
+        for (int j = 0; j < 2; j++) {
+            x[j] = _mm256_loadu_si256((const __m256i*)(a + i + 4 * j));
+            y[j] = _mm256_loadu_si256((const __m256i*)(b + i + 4 * j));
+            // A value fits in 32 bits if nothing is left above bit 31 once biased
+            high = _mm256_or_si256(high, _mm256_srli_epi64(_mm256_add_epi64(x[j], bias), 32));
+            high = _mm256_or_si256(high, _mm256_srli_epi64(_mm256_add_epi64(y[j], bias), 32));
+        }
+        if (!_mm256_testz_si256(high, high)) {
+            expresso_kernel_multiply(out + i, validity + (i >> 3), a + i, b + i, 8);
+            continue;
+        }
+        for (int j = 0; j < 2; j++) _mm256_storeu_si256((__m256i*)(out + i + 4 * j), _mm256_mul_epi32(x[j], y[j]));
+    }
+    expresso_kernel_multiply(out + i, validity + (i >> 3), a + i, b + i, n - i);
+}
+
+static inline AVX2_TARGET __m256d avx2_load_pd(const double* p) { return _mm256_loadu_pd(p); }
+static inline AVX2_TARGET void avx2_store_pd(double* p, __m256d x) { _mm256_storeu_pd(p, x); }
+static inline AVX2_TARGET __m256d avx2_cmp_less(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_LT_OQ); }
+static inline AVX2_TARGET __m256d avx2_cmp_greater(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_GT_OQ); }
+static inline AVX2_TARGET __m256d avx2_cmp_less_equal(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_LE_OQ); }
+static inline AVX2_TARGET __m256d avx2_cmp_greater_equal(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_GE_OQ); }
+static inline AVX2_TARGET __m256d avx2_cmp_equal(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_EQ_OQ); }
+static inline AVX2_TARGET __m256d avx2_cmp_not_equal(__m256d x, __m256d y) { return _mm256_cmp_pd(x, y, _CMP_NEQ_UQ); }
+static inline AVX2_TARGET void avx2_store_mask(long long* out, __m256d mask) {
+    _mm256_storeu_si256((__m256i*)out, _mm256_and_si256(_mm256_castpd_si256(mask), avx2_one()));
+}
+static inline AVX2_TARGET __m256d avx2_float_multiply(__m256d x, __m256d y) { return _mm256_mul_pd(x, y); }
+static inline AVX2_TARGET __m256d avx2_float_add(__m256d x, __m256d y) { return _mm256_add_pd(x, y); }
+static inline AVX2_TARGET __m256d avx2_float_subtract(__m256d x, __m256d y) { return _mm256_sub_pd(x, y); }
+static inline AVX2_TARGET __m256d avx2_float_divide(__m256d x, __m256d y) { return _mm256_div_pd(x, y); }
+static inline AVX2_TARGET __m256d avx2_float_negate(__m256d x, __m256d y) {
+    (void)y;
+    return _mm256_xor_pd(x, _mm256_set1_pd(-0.0));
+}
+static inline AVX2_TARGET int avx2_zero_lanes(__m256d y) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(y, _mm256_setzero_pd(), _CMP_EQ_OQ));
+}
+
+#define AVX2_FLOAT_COMPARE_KERNEL(name, op, scalar) \
+    VECTOR_FLOAT_COMPARE_KERNEL(AVX2_TARGET, name, 4, avx2_load_pd, avx2_store_mask, op, scalar)
+#define AVX2_FLOAT_KERNEL(name, op, second, scalar) \
+    VECTOR_FLOAT_KERNEL(AVX2_TARGET, name, 4, avx2_load_pd, avx2_store_pd, op, second, scalar)
+
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_less, avx2_cmp_less, expresso_kernel_float_less)
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_greater, avx2_cmp_greater, expresso_kernel_float_greater)
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_less_equal, avx2_cmp_less_equal, expresso_kernel_float_less_equal)
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_greater_equal, avx2_cmp_greater_equal, expresso_kernel_float_greater_equal)
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_equal, avx2_cmp_equal, expresso_kernel_float_equal)
+AVX2_FLOAT_COMPARE_KERNEL(avx2_kernel_float_not_equal, avx2_cmp_not_equal, expresso_kernel_float_not_equal)
+AVX2_FLOAT_KERNEL(avx2_kernel_float_multiply, avx2_float_multiply, b, expresso_kernel_float_multiply)
+AVX2_FLOAT_KERNEL(avx2_kernel_float_add, avx2_float_add, b, expresso_kernel_float_add)
+AVX2_FLOAT_KERNEL(avx2_kernel_float_subtract, avx2_float_subtract, b, expresso_kernel_float_subtract)
+AVX2_FLOAT_KERNEL(avx2_kernel_float_negate, avx2_float_negate, a, expresso_kernel_float_negate)
+VECTOR_FLOAT_DIVIDE_KERNEL(AVX2_TARGET, avx2_kernel_float_divide, __m256d, 4, avx2_load_pd, avx2_store_pd, avx2_float_divide,
+                           avx2_zero_lanes, expresso_kernel_float_divide)
+
+static AVX2_TARGET void avx2_kernel_select(void* out, const long long* condition, const void* if_true, const void* if_false, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i zero = avx2_is_zero(_mm256_loadu_si256((const __m256i*)(condition + i)));
+        __m256i t = _mm256_loadu_si256((const __m256i*)((const char*)if_true + i * 8));
+        __m256i f = _mm256_loadu_si256((const __m256i*)((const char*)if_false + i * 8));
+        _mm256_storeu_si256((__m256i*)((char*)out + i * 8), _mm256_blendv_epi8(t, f, zero));
+    }
+    expresso_kernel_select((char*)out + i * 8, condition + i, (const char*)if_true + i * 8, (const char*)if_false + i * 8, n - i);
+}
+
+static const ExpressoKernelTable avx2_kernels = {
+    .level = EXPRESSO_SIMD_AVX2,
+    .integer = {
+        [EXPRESSO_OP_LOGICAL_NOT] = avx2_kernel_logical_not,
+        [EXPRESSO_OP_BITWISE_NOT] = avx2_kernel_bitwise_not,
+        [EXPRESSO_OP_SHIFT_LEFT] = expresso_kernel_shift_left,
+        [EXPRESSO_OP_SHIFT_RIGHT] = expresso_kernel_shift_right,
+        [EXPRESSO_OP_LESS] = avx2_kernel_less,
+        [EXPRESSO_OP_GREATER] = avx2_kernel_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = avx2_kernel_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = avx2_kernel_greater_equal,
+        [EXPRESSO_OP_EQUAL] = avx2_kernel_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = avx2_kernel_not_equal,
+        [EXPRESSO_OP_BITWISE_AND] = avx2_kernel_bitwise_and,
+        [EXPRESSO_OP_BITWISE_XOR] = avx2_kernel_bitwise_xor,
+        [EXPRESSO_OP_BITWISE_OR] = avx2_kernel_bitwise_or,
+        [EXPRESSO_OP_LOGICAL_AND] = avx2_kernel_logical_and,
+        [EXPRESSO_OP_LOGICAL_OR] = avx2_kernel_logical_or,
+    },
+    .checked = {
+        [EXPRESSO_OP_NEGATE] = avx2_kernel_negate,
+        [EXPRESSO_OP_MULTIPLY] = avx2_kernel_multiply,
+        [EXPRESSO_OP_DIVIDE] = expresso_kernel_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_modulo,
+        [EXPRESSO_OP_ADD] = avx2_kernel_add,
+        [EXPRESSO_OP_SUBTRACT] = avx2_kernel_subtract,
+    },
+    .float_compare = {
+        [EXPRESSO_OP_LESS] = avx2_kernel_float_less,
+        [EXPRESSO_OP_GREATER] = avx2_kernel_float_greater,
+        [EXPRESSO_OP_LESS_EQUAL] = avx2_kernel_float_less_equal,
+        [EXPRESSO_OP_GREATER_EQUAL] = avx2_kernel_float_greater_equal,
+        [EXPRESSO_OP_EQUAL] = avx2_kernel_float_equal,
+        [EXPRESSO_OP_NOT_EQUAL] = avx2_kernel_float_not_equal,
+    },
+    .float_arithmetic = {
+        [EXPRESSO_OP_NEGATE] = avx2_kernel_float_negate,
+        [EXPRESSO_OP_MULTIPLY] = avx2_kernel_float_multiply,
+        [EXPRESSO_OP_ADD] = avx2_kernel_float_add,
+        [EXPRESSO_OP_SUBTRACT] = avx2_kernel_float_subtract,
+    },
+    .float_checked = {
+        [EXPRESSO_OP_DIVIDE] = avx2_kernel_float_divide,
+        [EXPRESSO_OP_MODULO] = expresso_kernel_float_modulo,
+    },
+    .select = avx2_kernel_select,
+};
+
+const ExpressoKernelTable* expresso_kernels_sse2(void) { return &sse2_kernels; }
+const ExpressoKernelTable* expresso_kernels_avx2(void) { return &avx2_kernels; }
+
+#else
+
+const ExpressoKernelTable* expresso_kernels_sse2(void) { return NULL; }
+const ExpressoKernelTable* expresso_kernels_avx2(void) { return NULL; }
+
+#endif // EXPRESSO_KERNELS_X86
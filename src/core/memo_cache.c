@@ -0,0 +1,295 @@
+/*
+ * Expresso
+ * memo_cache.c
+ *
+ * Bounded cache of the values of constant subexpressions, shared across
+ * evaluations.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "memo_cache.h"
+#include "intern.h" // For interned results
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_ENTRY (-1)
+
+typedef struct {
+    uint64_t hash;
+    unsigned char* key; // Encoded subtree; NULL if the slot is free
+    size_t key_length;
+    Value value;
+    int32_t next;       // Next entry in the same bucket
+    bool referenced;    // Used since the CLOCK hand last passed
+} MemoEntry;
+
+struct ExpressoMemoCache {
+    MemoEntry* entries;
+    size_t capacity;
+    size_t count;
+    size_t hand;        // Next entry the CLOCK hand considers
+    int32_t* buckets;   // First entry of each chain
+    size_t bucket_mask;
+
+    // Encoding of the subtree last looked up or stored
+    unsigned char* key;
+    size_t key_length;
+    size_t key_capacity;
+    ExpressoNodeIndex* pending; // Nodes still to encode
+    size_t pending_capacity;
+
+    ExpressoMemoStats stats;
+};
+
+static void* checked_realloc(void* memory, size_t size) {
+    void* grown = realloc(memory, size);
+    if (!grown) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for memo cache.\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+ExpressoMemoCache* expresso_memo_cache_create(size_t capacity) {
+    if (capacity == 0) capacity = 1;
+    ExpressoMemoCache* cache = (ExpressoMemoCache*)calloc(1, sizeof(ExpressoMemoCache));
+    if (!cache) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for memo cache.\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t buckets = 1;
+    while (buckets < capacity) buckets *= 2;
+    cache->entries = (MemoEntry*)checked_realloc(NULL, capacity * sizeof(MemoEntry));
+    cache->buckets = (int32_t*)checked_realloc(NULL, buckets * sizeof(int32_t));
+    cache->capacity = capacity;
+    cache->bucket_mask = buckets - 1;
+    for (size_t i = 0; i < capacity; i++) cache->entries[i].key = NULL;
+    for (size_t i = 0; i < buckets; i++) cache->buckets[i] = NO_ENTRY;
+    cache->stats.capacity = capacity;
+    return cache;
+}
+
+void expresso_memo_cache_clear(ExpressoMemoCache* cache) {
+    if (!cache) return;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        if (!cache->entries[i].key) continue;
+        free(cache->entries[i].key);
+        value_destroy(cache->entries[i].value);
+        cache->entries[i].key = NULL;
+    }
+    for (size_t i = 0; i <= cache->bucket_mask; i++) cache->buckets[i] = NO_ENTRY;
+    cache->count = 0;
+    cache->hand = 0;
+}
+
+void expresso_memo_cache_destroy(ExpressoMemoCache* cache) {
+    if (!cache) return;
+    expresso_memo_cache_clear(cache);
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache->key);
+    free(cache->pending);
+    free(cache);
+}
+
+// --- Keys ---
+
+static void append_key(ExpressoMemoCache* cache, const void* bytes, size_t length) {
+    if (cache->key_length + length > cache->key_capacity) {
+        size_t capacity = cache->key_capacity ? cache->key_capacity * 2 : 256;
+        while (capacity < cache->key_length + length) capacity *= 2;
+        cache->key = (unsigned char*)checked_realloc(cache->key, capacity);
+        cache->key_capacity = capacity;
+    }
+    memcpy(cache->key + cache->key_length, bytes, length);
+    cache->key_length += length;
+}
+
+// Encode the subtree in prefix order: kind, operator and payload of each
+// node. The kind fixes the number of children, so equal encodings mean
+// equal subtrees. Returns the hash of the encoding.
+static uint64_t encode_subtree(ExpressoMemoCache* cache, const ExpressoAst* ast, ExpressoNodeIndex index) {
+    size_t pending = 0;
+    cache->key_length = 0;
+    if (cache->pending_capacity == 0) {
+        cache->pending_capacity = 64;
+        cache->pending = (ExpressoNodeIndex*)checked_realloc(NULL, cache->pending_capacity * sizeof(ExpressoNodeIndex));
+    }
+    cache->pending[pending++] = index;
+
+    while (pending > 0) {
+        const ExpressoNode* node = &ast->nodes[cache->pending[--pending]];
+        unsigned char header[2] = { node->kind, node->op };
+        append_key(cache, header, sizeof header);
+        switch ((ExpressoNodeKind)node->kind) {
+            case EXPRESSO_NODE_STRING:
+            case EXPRESSO_NODE_BIGINT:
+            case EXPRESSO_NODE_PARAMETER:
+                append_key(cache, &node->data.text.length, sizeof node->data.text.length);
+                append_key(cache, expresso_ast_string(ast, node), node->data.text.length);
+                break;
+            case EXPRESSO_NODE_CHARACTER:
+                append_key(cache, &node->data.char_value, 1);
+                break;
+            case EXPRESSO_NODE_INTEGER:
+            case EXPRESSO_NODE_FLOAT:
+                append_key(cache, &node->data, sizeof node->data.integer_value);
+                break;
+            default:
+                break;
+        }
+        if (pending + 3 > cache->pending_capacity) {
+            cache->pending_capacity *= 2;
+            cache->pending = (ExpressoNodeIndex*)checked_realloc(cache->pending, cache->pending_capacity * sizeof(ExpressoNodeIndex));
+        }
+        for (int i = 2; i >= 0; i--) {
+            if (node->children[i] != EXPRESSO_NODE_NONE) cache->pending[pending++] = node->children[i];
+        }
+    }
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < cache->key_length; i++) {
+        hash = (hash ^ cache->key[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static int32_t find_entry(const ExpressoMemoCache* cache, uint64_t hash) {
+    for (int32_t i = cache->buckets[hash & cache->bucket_mask]; i != NO_ENTRY; i = cache->entries[i].next) {
+        const MemoEntry* entry = &cache->entries[i];
+        if (entry->hash == hash && entry->key_length == cache->key_length &&
+            memcmp(entry->key, cache->key, cache->key_length) == 0) {
+            return i;
+        }
+    }
+    return NO_ENTRY;
+}
+
+// --- Lookup and replacement ---
+
+bool expresso_memo_cache_lookup(ExpressoMemoCache* cache, const ExpressoAst* ast, ExpressoNodeIndex index, Value* result) {
+    if (!cache || !ast || index == EXPRESSO_NODE_NONE) return false;
+    int32_t found = find_entry(cache, encode_subtree(cache, ast, index));
+    if (found == NO_ENTRY) {
+        cache->stats.misses++;
+        return false;
+    }
+    cache->stats.hits++;
+    cache->entries[found].referenced = true;
+    *result = value_copy(cache->entries[found].value);
+    return true;
+}
+
+static void unlink_entry(ExpressoMemoCache* cache, int32_t index) {
+    int32_t* link = &cache->buckets[cache->entries[index].hash & cache->bucket_mask];
+    while (*link != index) link = &cache->entries[*link].next;
+    *link = cache->entries[index].next;
+}
+
+// Pick the slot for a new entry, evicting with the CLOCK policy if full
+static int32_t free_slot(ExpressoMemoCache* cache) {
+    if (cache->count < cache->capacity) {
+        for (;;) {
+            size_t slot = cache->hand;
+            cache->hand = (cache->hand + 1) % cache->capacity;
+            if (!cache->entries[slot].key) return (int32_t)slot;
+        }
+    }
+    for (;;) {
+        MemoEntry* entry = &cache->entries[cache->hand];
+        int32_t slot = (int32_t)cache->hand;
+        cache->hand = (cache->hand + 1) % cache->capacity;
+        if (entry->referenced) {
+            entry->referenced = false;
+            continue;
+        }
+        unlink_entry(cache, slot);
+        free(entry->key);
+        value_destroy(entry->value);
+        entry->key = NULL;
+        cache->count--;
+        cache->stats.evictions++;
+        return slot;
+    }
+}
+
+void expresso_memo_cache_store(ExpressoMemoCache* cache, const ExpressoAst* ast, ExpressoNodeIndex index, Value value) {
+    if (!cache || !ast || index == EXPRESSO_NODE_NONE) return;
+    uint64_t hash = encode_subtree(cache, ast, index);
+    if (find_entry(cache, hash) != NO_ENTRY) return;
+
+    int32_t slot = free_slot(cache);
+    MemoEntry* entry = &cache->entries[slot];
+    entry->key = (unsigned char*)checked_realloc(NULL, cache->key_length ? cache->key_length : 1);
+    memcpy(entry->key, cache->key, cache->key_length);
+    entry->key_length = cache->key_length;
+    entry->hash = hash;
+    // Outlives the evaluation storing it
+    entry->value = expresso_intern_enabled() ? value_intern(value) : value_promote(value);
+    entry->referenced = false;
+    entry->next = cache->buckets[hash & cache->bucket_mask];
+    cache->buckets[hash & cache->bucket_mask] = slot;
+    cache->count++;
+}
+
+void expresso_memo_cache_get_stats(const ExpressoMemoCache* cache, ExpressoMemoStats* stats) {
+    if (!stats) return;
+    if (!cache) {
+        memset(stats, 0, sizeof *stats);
+        return;
+    }
+    *stats = cache->stats;
+    stats->entries = cache->count;
+}
+
+void expresso_memo_find_constants(const ExpressoAst* ast, uint8_t* constant) {
+    // Children precede their parents, so one pass upwards suffices
+    for (size_t i = 0; i < ast->count; i++) {
+        const ExpressoNode* node = &ast->nodes[i];
+        uint8_t is_constant = node->kind != EXPRESSO_NODE_PARAMETER;
+        for (int c = 0; c < 3 && is_constant; c++) {
+            if (node->children[c] != EXPRESSO_NODE_NONE) is_constant = constant[node->children[c]];
+        }
+        constant[i] = is_constant;
+    }
+}
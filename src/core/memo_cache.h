@@ -0,0 +1,102 @@
+/*
+ * Expresso
+ * memo_cache.h
+ *
+ * Bounded cache of the values of constant subexpressions, shared across
+ * evaluations.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_MEMO_CACHE_H
+#define EXPRESSO_MEMO_CACHE_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint8_t
+#include "value.h"
+#include "ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Evaluation has no side effects, so a subtree without parameters has the
+// same value every time it is evaluated. The cache remembers such values,
+// keyed by the structure of the subtree (operators, literals and shape, not
+// node indices), so the same subexpression in later expressions of a
+// session is not computed again. When full, an entry not used since the
+// CLOCK hand last passed it is evicted.
+typedef struct ExpressoMemoCache ExpressoMemoCache;
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    size_t entries;
+    size_t capacity;
+} ExpressoMemoStats;
+
+// Create a cache holding at most capacity values (at least 1)
+ExpressoMemoCache* expresso_memo_cache_create(size_t capacity);
+void expresso_memo_cache_destroy(ExpressoMemoCache* cache);
+
+// Drop every entry; the counters are kept
+void expresso_memo_cache_clear(ExpressoMemoCache* cache);
+
+// Look up the value of the subtree at index. On a hit, *result receives a
+// copy the caller owns.
+bool expresso_memo_cache_lookup(ExpressoMemoCache* cache, const ExpressoAst* ast, ExpressoNodeIndex index, Value* result);
+
+// Remember a copy of value as the value of the subtree at index
+void expresso_memo_cache_store(ExpressoMemoCache* cache, const ExpressoAst* ast, ExpressoNodeIndex index, Value value);
+
+void expresso_memo_cache_get_stats(const ExpressoMemoCache* cache, ExpressoMemoStats* stats);
+
+// Set constant[i] for each node i of ast whose subtree has no parameters;
+// constant must have room for ast->count flags
+void expresso_memo_find_constants(const ExpressoAst* ast, uint8_t* constant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_MEMO_CACHE_H
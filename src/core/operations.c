@@ -49,115 +49,332 @@
  *
  */
 #include "value.h"
+#include "operations.h"
+#include "bigint.h" // For integers beyond 64 bits
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h> // For LLONG_MIN
 #include <math.h> // For isnan, isinf
 
-// --- Value Operations Functions ---
-Value value_by_adding_values(Value leftValue, Value rightValue) {
-    Value v;
+#define INTEGER_BITS ((long long)(sizeof(long long) * 8))
 
-    if (value_is_integer(leftValue) && value_is_integer(rightValue))
-    {
-        v.type = VALUE_TYPE_INTEGER;
-        int l = value_as_integer(leftValue);
-        int r = value_as_integer(rightValue);
-        v.data.integer_value = l + r;
-    }
-    else
-    {
-        v = value_create_error("Type error.");
-    }
-    return v;
+// --- Binary operators ---
+//
+// Each binary operator is a matrix of functions indexed by the types of its
+// operands, so applying one costs a table lookup and one call. Operands are
+// promoted as in C: characters act as integers, and when either operand is
+// a float both are taken as floats. Integer arithmetic is 64-bit; results
+// that do not fit are promoted to big integers, and division by zero is an
+// error rather than a fault. Big integers mix with integers and characters
+// as integers do, but not with the bitwise operators. A string on the left
+// of + concatenates the text of any operand but an error.
+
+typedef Value (*BinaryFunction)(Value leftValue, Value rightValue);
+
+typedef struct {
+    BinaryFunction function;
+    ValueType result; // VALUE_TYPE_ERROR where the operands are rejected
+} BinaryCell;
+
+#define VALUE_TYPE_COUNT (VALUE_TYPE_ERROR + 1)
+
+static inline long long integer_operand(Value value) {
+    return value_get_type(value) == VALUE_TYPE_CHARACTER ? value_get_character(value) : value_get_integer(value);
 }
 
-Value value_by_subtracting_values(Value leftValue, Value rightValue) {
-    Value v;
+static inline double float_operand(Value value) {
+    ValueType type = value_get_type(value);
+    if (type == VALUE_TYPE_FLOAT) return value_get_float(value);
+    if (type == VALUE_TYPE_BIGINT) return expresso_bigint_to_double(value_get_bigint(value));
+    return (double)integer_operand(value);
+}
 
-    if (value_is_integer(leftValue) && value_is_integer(rightValue))
-    {
-        v.type = VALUE_TYPE_INTEGER;
-        int l = value_as_integer(leftValue);
-        int r = value_as_integer(rightValue);
-        v.data.integer_value = l - r;
-    }
-    else
-    {
-        v = value_create_error("Type error.");
-    }
-    return v;
+static Value type_error(Value leftValue, Value rightValue) {
+    (void)leftValue;
+    (void)rightValue;
+    return value_create_error_code(EXPRESSO_ERROR_TYPE);
 }
 
-Value value_by_multiplying_values(Value leftValue, Value rightValue) {
-    Value v;
+// An error operand is the result, the left one when both are errors
+static Value propagate_error(Value leftValue, Value rightValue) {
+    return value_copy(value_is_error(leftValue) ? leftValue : rightValue);
+}
 
-    if (value_is_integer(leftValue) && value_is_integer(rightValue))
-    {
-        v.type = VALUE_TYPE_INTEGER;
-        int l = value_as_integer(leftValue);
-        int r = value_as_integer(rightValue);
-        v.data.integer_value = l * r;
-    }
-    else
-    {
-        v = value_create_error("Type error.");
-    }
-    return v;
+// The overflow and failure paths are kept out of line so the checks cost
+// one predictable branch on the overflow flag
+__attribute__((cold, noinline)) static Value widened(BinaryFunction function, long long l, long long r) {
+    Value left = value_create_integer(l);
+    Value right = value_create_integer(r);
+    Value result = function(left, right);
+    value_destroy(left);
+    value_destroy(right);
+    return result;
 }
 
-Value value_by_dividing_values(Value leftValue, Value rightValue) {
-    Value v;
+__attribute__((cold, noinline)) static Value division_by_zero(void) {
+    return value_create_error_code(EXPRESSO_ERROR_DIVISION_BY_ZERO);
+}
+
+#define UNLIKELY(condition) __builtin_expect(!!(condition), 0)
 
-    if (value_is_integer(leftValue) && value_is_integer(rightValue))
-    {
-        v.type = VALUE_TYPE_INTEGER;
-        int l = value_as_integer(leftValue);
-        int r = value_as_integer(rightValue);
-        v.data.integer_value = l / r;
+static inline Value integer_product(long long l, long long r) {
+    long long v;
+    if (UNLIKELY(__builtin_mul_overflow(l, r, &v))) return widened(expresso_bigint_multiply, l, r);
+    return value_create_integer(v);
+}
+
+static inline Value integer_sum(long long l, long long r) {
+    long long v;
+    if (UNLIKELY(__builtin_add_overflow(l, r, &v))) return widened(expresso_bigint_add, l, r);
+    return value_create_integer(v);
+}
+
+static inline Value integer_difference(long long l, long long r) {
+    long long v;
+    if (UNLIKELY(__builtin_sub_overflow(l, r, &v))) return widened(expresso_bigint_subtract, l, r);
+    return value_create_integer(v);
+}
+
+// LLONG_MIN / -1 does not fit; LLONG_MIN % -1 is 0, but the division
+// instruction traps on both
+static inline Value integer_quotient(long long l, long long r) {
+    if (UNLIKELY(r == 0)) return division_by_zero();
+    if (UNLIKELY(r == -1)) return integer_difference(0, l);
+    return value_create_integer(l / r);
+}
+
+static inline Value integer_remainder(long long l, long long r) {
+    if (UNLIKELY(r == 0)) return division_by_zero();
+    return value_create_integer(r == -1 ? 0 : l % r);
+}
+
+static inline Value float_quotient(double l, double r) {
+    if (UNLIKELY(r == 0)) return division_by_zero();
+    return value_create_float(l / r);
+}
+
+static inline Value float_remainder(double l, double r) {
+    if (UNLIKELY(r == 0)) return division_by_zero();
+    return value_create_float(fmod(l, r));
+}
+
+// X(name, operator, integer result, float result) for operators defined on
+// integers and floats; l and r are the promoted operands. Big integer
+// operands go to the expresso_bigint_ function of the same name.
+#define ARITHMETIC_OPERATORS(X) \
+    X(multiply, MULTIPLY, integer_product(l, r), value_create_float(l * r)) \
+    X(divide, DIVIDE, integer_quotient(l, r), float_quotient(l, r)) \
+    X(modulo, MODULO, integer_remainder(l, r), float_remainder(l, r)) \
+    X(add, ADD, integer_sum(l, r), value_create_float(l + r)) \
+    X(subtract, SUBTRACT, integer_difference(l, r), value_create_float(l - r))
+
+// X(name, operator, comparison) for comparisons of numbers
+#define COMPARISON_OPERATORS(X) \
+    X(less, LESS, <) \
+    X(greater, GREATER, >) \
+    X(less_equal, LESS_EQUAL, <=) \
+    X(greater_equal, GREATER_EQUAL, >=)
+
+// Equality also compares strings by content, and values of unrelated types
+// compare as distinct
+#define EQUALITY_OPERATORS(X) \
+    X(equal, EQUAL, ==) \
+    X(not_equal, NOT_EQUAL, !=)
+
+// X(name, operator, integer expression) for operators on integers only
+#define BITWISE_OPERATORS(X) \
+    X(shift_left, SHIFT_LEFT, shift_integer_left(l, r)) \
+    X(shift_right, SHIFT_RIGHT, shift_integer_right(l, r)) \
+    X(bitwise_and, BITWISE_AND, l & r) \
+    X(bitwise_xor, BITWISE_XOR, l ^ r) \
+    X(bitwise_or, BITWISE_OR, l | r)
+
+#define DEFINE_ARITHMETIC(name, op, integer_result, float_result) \
+    static Value name##_integers(Value leftValue, Value rightValue) { \
+        long long l = integer_operand(leftValue), r = integer_operand(rightValue); \
+        return integer_result; \
+    } \
+    static Value name##_floats(Value leftValue, Value rightValue) { \
+        double l = float_operand(leftValue), r = float_operand(rightValue); \
+        return float_result; \
+    } \
+    static Value name##_bigints(Value leftValue, Value rightValue) { \
+        return expresso_bigint_##name(leftValue, rightValue); \
     }
-    else
-    {
-        v = value_create_error("Type error.");
+
+#define DEFINE_COMPARISON(name, op, comparison) \
+    static Value name##_integers(Value leftValue, Value rightValue) { \
+        return value_create_integer(integer_operand(leftValue) comparison integer_operand(rightValue)); \
+    } \
+    static Value name##_floats(Value leftValue, Value rightValue) { \
+        return value_create_integer(float_operand(leftValue) comparison float_operand(rightValue)); \
+    } \
+    static Value name##_bigints(Value leftValue, Value rightValue) { \
+        return value_create_integer(expresso_bigint_compare(leftValue, rightValue) comparison 0); \
     }
-    return v;
+
+#define DEFINE_BITWISE(name, op, integer_expression) \
+    static Value name##_integers(Value leftValue, Value rightValue) { \
+        long long l = integer_operand(leftValue), r = integer_operand(rightValue); \
+        return value_create_integer(integer_expression); \
+    }
+
+#define DEFINE_EQUALITY(name, op, comparison) \
+    DEFINE_COMPARISON(name, op, comparison) \
+    static Value name##_strings(Value leftValue, Value rightValue) { \
+        return value_create_integer(value_equals(leftValue, rightValue) comparison true); \
+    } \
+    static Value name##_unrelated(Value leftValue, Value rightValue) { \
+        (void)leftValue; \
+        (void)rightValue; \
+        return value_create_integer(0 comparison 1); \
+    }
+
+// String + <any> appends the text of the right operand (see value.h)
+static Value concatenate(Value leftValue, Value rightValue) {
+    return value_concatenate(leftValue, &rightValue, 1);
 }
 
-Value value_by_modulasing_values(Value leftValue, Value rightValue) {
-    Value v;
+ARITHMETIC_OPERATORS(DEFINE_ARITHMETIC)
+COMPARISON_OPERATORS(DEFINE_COMPARISON)
+EQUALITY_OPERATORS(DEFINE_EQUALITY)
+BITWISE_OPERATORS(DEFINE_BITWISE)
+
+#define CELL(function, type) { function, VALUE_TYPE_##type }
+#define REJECTED CELL(type_error, ERROR)
+#define PROPAGATED CELL(propagate_error, ERROR)
+
+// Rows are left operand types, columns right operand types. A big integer
+// pairs with a float or a string as an integer does; bigint is the cell for
+// a big integer with an integer, character or big integer. string_other is
+// the cell for a string with a number or character. An error operand, on
+// either side, is passed through unchanged.
+#define MATRIX(integer, integer_float, integer_string, float_float, float_string, string_string, string_other, \
+               character_character, bigint) { \
+    [VALUE_TYPE_INTEGER] = { \
+        [VALUE_TYPE_INTEGER] = integer, [VALUE_TYPE_FLOAT] = integer_float, [VALUE_TYPE_CHARACTER] = integer, \
+        [VALUE_TYPE_STRING] = integer_string, [VALUE_TYPE_BIGINT] = bigint, [VALUE_TYPE_ERROR] = PROPAGATED }, \
+    [VALUE_TYPE_FLOAT] = { \
+        [VALUE_TYPE_INTEGER] = integer_float, [VALUE_TYPE_FLOAT] = float_float, [VALUE_TYPE_CHARACTER] = integer_float, \
+        [VALUE_TYPE_STRING] = float_string, [VALUE_TYPE_BIGINT] = integer_float, [VALUE_TYPE_ERROR] = PROPAGATED }, \
+    [VALUE_TYPE_CHARACTER] = { \
+        [VALUE_TYPE_INTEGER] = integer, [VALUE_TYPE_FLOAT] = integer_float, [VALUE_TYPE_CHARACTER] = character_character, \
+        [VALUE_TYPE_STRING] = integer_string, [VALUE_TYPE_BIGINT] = bigint, [VALUE_TYPE_ERROR] = PROPAGATED }, \
+    [VALUE_TYPE_STRING] = { \
+        [VALUE_TYPE_INTEGER] = string_other, [VALUE_TYPE_FLOAT] = string_other, [VALUE_TYPE_CHARACTER] = string_other, \
+        [VALUE_TYPE_STRING] = string_string, [VALUE_TYPE_BIGINT] = string_other, [VALUE_TYPE_ERROR] = PROPAGATED }, \
+    [VALUE_TYPE_BIGINT] = { \
+        [VALUE_TYPE_INTEGER] = bigint, [VALUE_TYPE_FLOAT] = integer_float, [VALUE_TYPE_CHARACTER] = bigint, \
+        [VALUE_TYPE_STRING] = integer_string, [VALUE_TYPE_BIGINT] = bigint, [VALUE_TYPE_ERROR] = PROPAGATED }, \
+    [VALUE_TYPE_ERROR] = { \
+        [VALUE_TYPE_INTEGER] = PROPAGATED, [VALUE_TYPE_FLOAT] = PROPAGATED, [VALUE_TYPE_CHARACTER] = PROPAGATED, \
+        [VALUE_TYPE_STRING] = PROPAGATED, [VALUE_TYPE_BIGINT] = PROPAGATED, [VALUE_TYPE_ERROR] = PROPAGATED } }
+
+// The cell of each arithmetic operator for a string left operand
+#define STRING_multiply REJECTED
+#define STRING_divide REJECTED
+#define STRING_modulo REJECTED
+#define STRING_add CELL(concatenate, STRING)
+#define STRING_subtract REJECTED
+
+#define ARITHMETIC_MATRIX(name, op, integer_result, float_result) \
+    [EXPRESSO_OP_##op] = MATRIX(CELL(name##_integers, INTEGER), CELL(name##_floats, FLOAT), REJECTED, \
+                                CELL(name##_floats, FLOAT), REJECTED, STRING_##name, STRING_##name, \
+                                CELL(name##_integers, INTEGER), CELL(name##_bigints, BIGINT)),
+
+#define COMPARISON_MATRIX(name, op, comparison) \
+    [EXPRESSO_OP_##op] = MATRIX(CELL(name##_integers, INTEGER), CELL(name##_floats, INTEGER), REJECTED, \
+                                CELL(name##_floats, INTEGER), REJECTED, REJECTED, REJECTED, \
+                                CELL(name##_integers, INTEGER), CELL(name##_bigints, INTEGER)),
+
+#define EQUALITY_MATRIX(name, op, comparison) \
+    [EXPRESSO_OP_##op] = MATRIX(CELL(name##_integers, INTEGER), CELL(name##_floats, INTEGER), CELL(name##_unrelated, INTEGER), \
+                                CELL(name##_floats, INTEGER), CELL(name##_unrelated, INTEGER), \
+                                CELL(name##_strings, INTEGER), CELL(name##_unrelated, INTEGER), \
+                                CELL(name##_integers, INTEGER), CELL(name##_bigints, INTEGER)),
+
+#define BITWISE_MATRIX(name, op, integer_expression) \
+    [EXPRESSO_OP_##op] = MATRIX(CELL(name##_integers, INTEGER), REJECTED, REJECTED, \
+                                REJECTED, REJECTED, REJECTED, REJECTED, \
+                                CELL(name##_integers, INTEGER), REJECTED),
 
-    if (value_is_integer(leftValue) && value_is_integer(rightValue))
-    {
-        v.type = VALUE_TYPE_INTEGER;
-        int l = value_as_integer(leftValue);
-        int r = value_as_integer(rightValue);
-        v.data.integer_value = l % r;
+static const BinaryCell binary_operators[EXPRESSO_OP_LOGICAL_AND][VALUE_TYPE_COUNT][VALUE_TYPE_COUNT] = {
+    ARITHMETIC_OPERATORS(ARITHMETIC_MATRIX)
+    COMPARISON_OPERATORS(COMPARISON_MATRIX)
+    EQUALITY_OPERATORS(EQUALITY_MATRIX)
+    BITWISE_OPERATORS(BITWISE_MATRIX)
+};
+
+static inline bool is_matrix_operator(ExpressoOperator op) {
+    return op >= EXPRESSO_OP_MULTIPLY && op <= EXPRESSO_OP_BITWISE_OR;
+}
+
+static inline bool is_value_type(ValueType type) {
+    return (unsigned)type < VALUE_TYPE_COUNT;
+}
+
+static inline Value apply_matrix(ExpressoOperator op, Value leftValue, Value rightValue) {
+    return binary_operators[op][value_get_type(leftValue)][value_get_type(rightValue)].function(leftValue, rightValue);
+}
+
+// --- Value Operations Functions ---
+#define DEFINE_ENTRY_POINT(function, op) \
+    Value function(Value leftValue, Value rightValue) { \
+        return apply_matrix(EXPRESSO_OP_##op, leftValue, rightValue); \
     }
-    else
-    {
-        v = value_create_error("Type error.");
+
+DEFINE_ENTRY_POINT(value_by_multiplying_values, MULTIPLY)
+DEFINE_ENTRY_POINT(value_by_dividing_values, DIVIDE)
+DEFINE_ENTRY_POINT(value_by_modulasing_values, MODULO)
+DEFINE_ENTRY_POINT(value_by_adding_values, ADD)
+DEFINE_ENTRY_POINT(value_by_subtracting_values, SUBTRACT)
+DEFINE_ENTRY_POINT(value_by_left_shifting_values, SHIFT_LEFT)
+DEFINE_ENTRY_POINT(value_by_right_shifting_values, SHIFT_RIGHT)
+DEFINE_ENTRY_POINT(value_by_comparing_less_values, LESS)
+DEFINE_ENTRY_POINT(value_by_comparing_greater_values, GREATER)
+DEFINE_ENTRY_POINT(value_by_comparing_less_equal_values, LESS_EQUAL)
+DEFINE_ENTRY_POINT(value_by_comparing_greater_equal_values, GREATER_EQUAL)
+DEFINE_ENTRY_POINT(value_by_comparing_equal_values, EQUAL)
+DEFINE_ENTRY_POINT(value_by_comparing_not_equal_values, NOT_EQUAL)
+DEFINE_ENTRY_POINT(value_by_bitwise_anding_values, BITWISE_AND)
+DEFINE_ENTRY_POINT(value_by_bitwise_xoring_values, BITWISE_XOR)
+DEFINE_ENTRY_POINT(value_by_bitwise_oring_values, BITWISE_OR)
+
+Value value_by_adding_all_values(const Value* values, size_t count) {
+    Value sum = value_copy(values[0]);
+    size_t i = 1;
+    while (i < count && value_get_type(sum) != VALUE_TYPE_STRING) {
+        Value next = value_by_adding_values(sum, values[i++]);
+        value_destroy(sum);
+        sum = next;
     }
-    return v;
+    if (i == count) return sum;
+    Value result = value_concatenate(sum, values + i, count - i);
+    value_destroy(sum);
+    return result;
 }
 
 Value value_by_negating_value(Value value) {
     Value v;
     if (value_is_integer(value)) {
-        v.type = VALUE_TYPE_INTEGER;
-        v.data.integer_value = -value_as_integer(value);
+        v = integer_difference(0, value_as_integer(value));
+    } else if (value_is_bigint(value)) {
+        v = expresso_bigint_negate(value);
+    } else if (value_is_float(value)) {
+        v = value_create_float(-value_get_float(value));
     } else {
-        v = value_create_error("Type error for negation.");
+        v = value_create_error_code(EXPRESSO_ERROR_TYPE_NEGATION);
     }
     return v;
 }
 
 Value value_by_logical_negating_value(Value value) {
     Value v;
-    if (value_is_integer(value)) {
-        v.type = VALUE_TYPE_INTEGER;
-        v.data.integer_value = !value_as_integer(value);
+    if (value_is_condition(value)) {
+        v = value_create_integer(!value_is_true(value));
     } else {
-        v = value_create_error("Type error for logical NOT.");
+        v = value_create_error_code(EXPRESSO_ERROR_TYPE_LOGICAL_NOT);
     }
     return v;
 }
@@ -165,10 +382,87 @@ Value value_by_logical_negating_value(Value value) {
 Value value_by_bitwise_complementing_value(Value value) {
     Value v;
     if (value_is_integer(value)) {
-        v.type = VALUE_TYPE_INTEGER;
-        v.data.integer_value = ~value_as_integer(value);
+        v = value_create_integer(~value_as_integer(value));
     } else {
-        v = value_create_error("Type error for bitwise NOT.");
+        v = value_create_error_code(EXPRESSO_ERROR_TYPE_BITWISE_NOT);
     }
     return v;
 }
+
+// Shifts follow the spec: a negative count shifts the other way, and a count
+// of the full width or more yields 0 (or -1 for a right shift of a negative).
+long long shift_integer_right(long long value, long long count) {
+    if (count < 0) return count == LLONG_MIN ? 0 : shift_integer_left(value, -count);
+    if (count >= INTEGER_BITS) return value < 0 ? -1 : 0;
+    return value >> count;
+}
+
+long long shift_integer_left(long long value, long long count) {
+    if (count < 0) return count == LLONG_MIN ? (value < 0 ? -1 : 0) : shift_integer_right(value, -count);
+    if (count >= INTEGER_BITS) return 0;
+    return (long long)((unsigned long long)value << count);
+}
+
+// && and || short-circuit: the right operand is only checked when the left
+// one does not decide the result, so 0 && "s" is 0 rather than a type error.
+Value value_by_logical_anding_values(Value leftValue, Value rightValue) {
+    if (!value_is_condition(leftValue)) return value_create_error_code(EXPRESSO_ERROR_TYPE_LOGICAL_AND);
+    if (!value_is_true(leftValue)) return value_create_integer(0);
+    if (!value_is_condition(rightValue)) return value_create_error_code(EXPRESSO_ERROR_TYPE_LOGICAL_AND);
+    return value_create_integer(value_is_true(rightValue));
+}
+
+Value value_by_logical_oring_values(Value leftValue, Value rightValue) {
+    if (!value_is_condition(leftValue)) return value_create_error_code(EXPRESSO_ERROR_TYPE_LOGICAL_OR);
+    if (value_is_true(leftValue)) return value_create_integer(1);
+    if (!value_is_condition(rightValue)) return value_create_error_code(EXPRESSO_ERROR_TYPE_LOGICAL_OR);
+    return value_create_integer(value_is_true(rightValue));
+}
+
+Value value_by_applying_unary_operator(ExpressoOperator op, Value value) {
+    switch (op) {
+        case EXPRESSO_OP_PLUS:        return value_copy(value);
+        case EXPRESSO_OP_NEGATE:      return value_by_negating_value(value);
+        case EXPRESSO_OP_LOGICAL_NOT: return value_by_logical_negating_value(value);
+        case EXPRESSO_OP_BITWISE_NOT: return value_by_bitwise_complementing_value(value);
+        default:                      return value_create_error_code(EXPRESSO_ERROR_UNKNOWN_UNARY_OPERATOR);
+    }
+}
+
+Value value_by_applying_binary_operator(ExpressoOperator op, Value leftValue, Value rightValue) {
+    if (is_matrix_operator(op)) {
+        if (!is_value_type(value_get_type(leftValue)) || !is_value_type(value_get_type(rightValue))) return value_create_error_code(EXPRESSO_ERROR_TYPE);
+        return apply_matrix(op, leftValue, rightValue);
+    }
+    switch (op) {
+        case EXPRESSO_OP_LOGICAL_AND:   return value_by_logical_anding_values(leftValue, rightValue);
+        case EXPRESSO_OP_LOGICAL_OR:    return value_by_logical_oring_values(leftValue, rightValue);
+        default:                        return value_create_error_code(EXPRESSO_ERROR_UNKNOWN_OPERATOR);
+    }
+}
+
+static inline bool is_condition_type(ValueType type) {
+    return type == VALUE_TYPE_INTEGER || type == VALUE_TYPE_BIGINT || type == VALUE_TYPE_FLOAT;
+}
+
+ValueType value_result_type(ExpressoOperator op, ValueType leftType, ValueType rightType) {
+    if (leftType == VALUE_TYPE_ERROR) return VALUE_TYPE_ERROR;
+
+    switch (op) {
+        case EXPRESSO_OP_PLUS:
+            return leftType;
+        case EXPRESSO_OP_NEGATE:
+            return leftType == VALUE_TYPE_INTEGER || leftType == VALUE_TYPE_BIGINT || leftType == VALUE_TYPE_FLOAT
+                       ? leftType : VALUE_TYPE_ERROR;
+        case EXPRESSO_OP_LOGICAL_NOT:
+            return is_condition_type(leftType) ? VALUE_TYPE_INTEGER : VALUE_TYPE_ERROR;
+        case EXPRESSO_OP_BITWISE_NOT:
+            return leftType == VALUE_TYPE_INTEGER ? VALUE_TYPE_INTEGER : VALUE_TYPE_ERROR;
+        case EXPRESSO_OP_LOGICAL_AND:
+        case EXPRESSO_OP_LOGICAL_OR:
+            return is_condition_type(leftType) && is_condition_type(rightType) ? VALUE_TYPE_INTEGER : VALUE_TYPE_ERROR;
+        default:
+            if (!is_matrix_operator(op) || !is_value_type(leftType) || !is_value_type(rightType)) return VALUE_TYPE_ERROR;
+            return binary_operators[op][leftType][rightType].result;
+    }
+}
@@ -51,6 +51,7 @@
 #define EXPRESSO_OPERATIONS_H
 
 #include "value.h"
+#include "ast.h" // For ExpressoOperator
 
 // --- Value Operations Functions ---
 #ifdef __cplusplus
@@ -65,6 +66,57 @@ Value value_by_modulasing_values(Value leftValue, Value rightValue);
 Value value_by_negating_value(Value value);
 Value value_by_logical_negating_value(Value value);
 Value value_by_bitwise_complementing_value(Value value);
+Value value_by_left_shifting_values(Value leftValue, Value rightValue);
+Value value_by_right_shifting_values(Value leftValue, Value rightValue);
+Value value_by_comparing_less_values(Value leftValue, Value rightValue);
+Value value_by_comparing_greater_values(Value leftValue, Value rightValue);
+Value value_by_comparing_less_equal_values(Value leftValue, Value rightValue);
+Value value_by_comparing_greater_equal_values(Value leftValue, Value rightValue);
+Value value_by_comparing_equal_values(Value leftValue, Value rightValue);
+Value value_by_comparing_not_equal_values(Value leftValue, Value rightValue);
+Value value_by_bitwise_anding_values(Value leftValue, Value rightValue);
+Value value_by_bitwise_xoring_values(Value leftValue, Value rightValue);
+Value value_by_bitwise_oring_values(Value leftValue, Value rightValue);
+Value value_by_logical_anding_values(Value leftValue, Value rightValue);
+Value value_by_logical_oring_values(Value leftValue, Value rightValue);
+
+// Conditions, and the operands of !, && and ||, are numbers: integers of
+// either width, or floats, which are true when not 0.0 as in C. A big
+// integer is never zero, so it is always true.
+static inline bool value_is_condition(Value value) {
+    ValueType type = value_get_type(value);
+    return type == VALUE_TYPE_INTEGER || type == VALUE_TYPE_BIGINT || type == VALUE_TYPE_FLOAT;
+}
+
+static inline bool value_is_true(Value value) {
+    switch (value_get_type(value)) {
+        case VALUE_TYPE_BIGINT: return true;
+        case VALUE_TYPE_FLOAT:  return value_get_float(value) != 0.0;
+        default:                return value_get_integer(value) != 0;
+    }
+}
+
+// values[0] + values[1] + ... + values[count - 1], added left to right.
+// Once the sum is a string, the rest are concatenated to it at once, in one
+// allocation of the exact size. The values are not destroyed.
+Value value_by_adding_all_values(const Value* values, size_t count);
+
+// Apply a unary or binary operator by its tag; the operands are not
+// destroyed. Unary plus returns a copy of its operand.
+Value value_by_applying_unary_operator(ExpressoOperator op, Value value);
+Value value_by_applying_binary_operator(ExpressoOperator op, Value leftValue, Value rightValue);
+
+// Type of the result of applying op to operands of the given types, or
+// VALUE_TYPE_ERROR if the operation rejects them. rightType is ignored for
+// unary operators. Paths that type-check ahead of evaluation (e.g. batch
+// evaluation) use this so they agree with the functions above. An integer
+// result can still be promoted to a big integer at evaluation, and integer
+// division by zero fails.
+ValueType value_result_type(ExpressoOperator op, ValueType leftType, ValueType rightType);
+
+// Integer shifts as performed by the shift operators, for any count
+long long shift_integer_left(long long value, long long count);
+long long shift_integer_right(long long value, long long count);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,699 @@
+/*
+ * Expresso
+ * optimizer.c
+ *
+ * Implementation of the expression tree optimisation pass.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "optimizer.h"
+#include "operations.h"
+#include "memo_cache.h"
+#include <limits.h> // For CHAR_MIN, CHAR_MAX, LLONG_MIN, LLONG_MAX
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TYPE_UNKNOWN (-1)
+
+// What is known about the value of a node in the optimised tree
+typedef struct {
+    int type;           // ValueType, or TYPE_UNKNOWN
+    bool can_fail;      // May evaluate to an error, or to a big integer
+    long long min, max; // Bounds of an integer value
+} Fact;
+
+static const Fact UNKNOWN_FACT = { TYPE_UNKNOWN, true, LLONG_MIN, LLONG_MAX };
+
+typedef struct {
+    const ExpressoAst* ast;
+    ExpressoAst* out;
+    Fact* facts; // Indexed like out->nodes
+    size_t facts_capacity;
+    const ExpressoParameterType* parameter_types;
+    size_t parameter_type_count;
+    uint8_t* constant; // Indexed like ast->nodes; only set with a memo cache
+    bool in_constant;  // Inside a constant subtree looked up in the cache
+    size_t depth;      // Of the optimize_node() calls in progress
+} Optimizer;
+
+// Rewriting recurses once per level of the tree; subtrees below this depth
+// are copied unoptimised, without recursing, so deep input cannot exhaust
+// the native stack
+#define OPTIMIZER_MAX_DEPTH 4096
+
+static ExpressoMemoCache* memo_cache = NULL;
+
+void expresso_optimizer_set_memo_cache(ExpressoMemoCache* cache) {
+    memo_cache = cache;
+}
+
+// The optimised tree is append-only and every subtree occupies a contiguous
+// run of nodes and strings, so a subtree that gets replaced is discarded by
+// rolling the tree back to where it started
+typedef struct {
+    size_t count;
+    size_t strings_size;
+} Mark;
+
+static Mark mark(const ExpressoAst* out) {
+    return (Mark){ out->count, out->strings_size };
+}
+
+static void rollback(ExpressoAst* out, Mark at) {
+    out->count = at.count;
+    out->strings_size = at.strings_size;
+}
+
+static ExpressoNodeIndex with_fact(Optimizer* o, ExpressoNodeIndex index, Fact fact) {
+    if ((size_t)index >= o->facts_capacity) {
+        size_t capacity = o->facts_capacity ? o->facts_capacity * 2 : 64;
+        while (capacity <= (size_t)index) capacity *= 2;
+        Fact* facts = (Fact*)realloc(o->facts, capacity * sizeof(Fact));
+        if (!facts) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for optimizer facts.\n");
+            exit(EXIT_FAILURE);
+        }
+        o->facts = facts;
+        o->facts_capacity = capacity;
+    }
+    o->facts[index] = fact;
+    return index;
+}
+
+static bool is_constant(const ExpressoNode* node) {
+    return node->kind == EXPRESSO_NODE_INTEGER || node->kind == EXPRESSO_NODE_FLOAT ||
+           node->kind == EXPRESSO_NODE_CHARACTER || node->kind == EXPRESSO_NODE_STRING;
+}
+
+static bool is_integer_constant(const ExpressoAst* out, ExpressoNodeIndex index, long long value) {
+    const ExpressoNode* node = &out->nodes[index];
+    return node->kind == EXPRESSO_NODE_INTEGER && node->data.integer_value == value;
+}
+
+static bool known_integer(Fact fact) {
+    return fact.type == VALUE_TYPE_INTEGER && !fact.can_fail;
+}
+
+// The k of a constant 2^k with k >= 1, or 0
+static int power_of_two_exponent(const ExpressoAst* out, ExpressoNodeIndex index) {
+    const ExpressoNode* node = &out->nodes[index];
+    if (node->kind != EXPRESSO_NODE_INTEGER) return 0;
+    long long value = node->data.integer_value;
+    if (value < 2 || (value & (value - 1)) != 0) return 0;
+    int exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+// Whether x * 2^exponent cannot overflow, so multiplication and a shift agree
+static bool product_fits(Fact x, int exponent) {
+    long long factor = 1LL << exponent, product;
+    return !__builtin_mul_overflow(x.min, factor, &product) && !__builtin_mul_overflow(x.max, factor, &product);
+}
+
+static Value constant_value(const ExpressoAst* out, ExpressoNodeIndex index) {
+    const ExpressoNode* node = &out->nodes[index];
+    switch ((ExpressoNodeKind)node->kind) {
+        case EXPRESSO_NODE_INTEGER:   return value_create_integer(node->data.integer_value);
+        case EXPRESSO_NODE_FLOAT:     return value_create_float(node->data.float_value);
+        case EXPRESSO_NODE_CHARACTER: return value_create_character(node->data.char_value);
+        case EXPRESSO_NODE_STRING:    return value_create_string_from(expresso_ast_string(out, node), node->data.text.length);
+        default:                      return value_create_error_code(EXPRESSO_ERROR_NOT_A_CONSTANT);
+    }
+}
+
+static ExpressoNodeIndex add_integer(Optimizer* o, long long value) {
+    return with_fact(o, expresso_ast_add_integer(o->out, value), (Fact){ VALUE_TYPE_INTEGER, false, value, value });
+}
+
+// A string as long as a rope is left to evaluation, where a chain of
+// concatenations is joined once, rather than copied into the tree at each
+// step of folding it
+static bool has_literal(Value value) {
+    ValueType type = value_get_type(value);
+    if (type == VALUE_TYPE_STRING) return value_string_length(value) < VALUE_ROPE_MIN_LENGTH;
+    return type != VALUE_TYPE_ERROR && type != VALUE_TYPE_BIGINT;
+}
+
+// Replace the subtree started at start with a literal for value. Returns
+// EXPRESSO_NODE_NONE, leaving the tree alone, if value is an error, a big
+// integer or a long string, which have no literal.
+static ExpressoNodeIndex fold(Optimizer* o, Mark start, Value value) {
+    ExpressoNodeIndex index = EXPRESSO_NODE_NONE;
+    Fact fact = { (int)value_get_type(value), false, 0, 0 };
+
+    if (has_literal(value)) rollback(o->out, start);
+    switch (value_get_type(value)) {
+        case VALUE_TYPE_INTEGER:
+            index = add_integer(o, value_get_integer(value));
+            break;
+        case VALUE_TYPE_FLOAT:
+            index = with_fact(o, expresso_ast_add_float(o->out, value_get_float(value)), fact);
+            break;
+        case VALUE_TYPE_CHARACTER:
+            fact.min = fact.max = value_get_character(value);
+            index = with_fact(o, expresso_ast_add_character(o->out, value_get_character(value)), fact);
+            break;
+        case VALUE_TYPE_STRING:
+            if (!has_literal(value)) break;
+            index = with_fact(o, expresso_ast_add_string(o->out, value_c_str(&value), value_string_length(value)), fact);
+            break;
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_ERROR:
+            break;
+    }
+    value_destroy(value);
+    return index;
+}
+
+// --- Static facts about results ---
+
+static Fact integer_range(long long min, long long max) {
+    return (Fact){ VALUE_TYPE_INTEGER, false, min, max };
+}
+
+// A character operand takes part in arithmetic as an integer
+static Fact promoted(Fact fact) {
+    if (fact.type != VALUE_TYPE_CHARACTER) return fact;
+    fact.type = VALUE_TYPE_INTEGER;
+    if (fact.min < CHAR_MIN || fact.min > CHAR_MAX) fact.min = CHAR_MIN;
+    if (fact.max > CHAR_MAX || fact.max < CHAR_MIN) fact.max = CHAR_MAX;
+    return fact;
+}
+
+// Bounds of add, subtract and multiply. A bound that overflows means the
+// operation can, and operations.c then promotes the result to a big integer.
+static Fact narrowed_range(ExpressoOperator op, Fact left, Fact right) {
+    Fact whole = integer_range(LLONG_MIN, LLONG_MAX);
+    whole.can_fail = true;
+    long long min, max;
+    switch (op) {
+        case EXPRESSO_OP_ADD:
+            if (__builtin_add_overflow(left.min, right.min, &min) || __builtin_add_overflow(left.max, right.max, &max)) return whole;
+            break;
+        case EXPRESSO_OP_SUBTRACT:
+            if (__builtin_sub_overflow(left.min, right.max, &min) || __builtin_sub_overflow(left.max, right.min, &max)) return whole;
+            break;
+        default: {
+            long long products[4];
+            if (__builtin_mul_overflow(left.min, right.min, &products[0]) ||
+                __builtin_mul_overflow(left.min, right.max, &products[1]) ||
+                __builtin_mul_overflow(left.max, right.min, &products[2]) ||
+                __builtin_mul_overflow(left.max, right.max, &products[3])) {
+                return whole;
+            }
+            min = max = products[0];
+            for (int i = 1; i < 4; i++) {
+                if (products[i] < min) min = products[i];
+                if (products[i] > max) max = products[i];
+            }
+            break;
+        }
+    }
+    return integer_range(min, max);
+}
+
+static Fact unary_fact(ExpressoOperator op, Fact operand) {
+    if (operand.type == TYPE_UNKNOWN) return UNKNOWN_FACT;
+    if (value_result_type(op, (ValueType)operand.type, VALUE_TYPE_INTEGER) != VALUE_TYPE_INTEGER) return UNKNOWN_FACT;
+
+    Fact fact = integer_range(LLONG_MIN, LLONG_MAX);
+    fact.can_fail = operand.can_fail;
+    switch (op) {
+        case EXPRESSO_OP_NEGATE:
+            if (operand.min > LLONG_MIN) {
+                fact.min = -operand.max;
+                fact.max = -operand.min;
+            } else {
+                fact.can_fail = true; // -LLONG_MIN overflows
+            }
+            break;
+        case EXPRESSO_OP_BITWISE_NOT:
+            fact.min = ~operand.max;
+            fact.max = ~operand.min;
+            break;
+        case EXPRESSO_OP_LOGICAL_NOT:
+            fact.min = 0;
+            fact.max = 1;
+            break;
+        default:
+            break;
+    }
+    return fact;
+}
+
+static Fact binary_fact(ExpressoOperator op, Fact left, Fact right) {
+    if (left.type == TYPE_UNKNOWN || right.type == TYPE_UNKNOWN) return UNKNOWN_FACT;
+    ValueType result = value_result_type(op, (ValueType)left.type, (ValueType)right.type);
+    if (result == VALUE_TYPE_FLOAT) {
+        // Float division fails on a zero divisor, whose range is not tracked
+        bool divides = op == EXPRESSO_OP_DIVIDE || op == EXPRESSO_OP_MODULO;
+        return (Fact){ (int)VALUE_TYPE_FLOAT, divides || left.can_fail || right.can_fail, LLONG_MIN, LLONG_MAX };
+    }
+    if (result != VALUE_TYPE_INTEGER) return UNKNOWN_FACT;
+    left = promoted(left);
+    right = promoted(right);
+
+    Fact fact = integer_range(LLONG_MIN, LLONG_MAX);
+    switch (op) {
+        case EXPRESSO_OP_ADD:
+        case EXPRESSO_OP_SUBTRACT:
+        case EXPRESSO_OP_MULTIPLY:
+            fact = narrowed_range(op, left, right);
+            break;
+        case EXPRESSO_OP_DIVIDE:
+        case EXPRESSO_OP_MODULO: {
+            // Fails if the divisor can be zero, or for LLONG_MIN / -1
+            fact.can_fail = (right.min <= 0 && right.max >= 0) ||
+                            (op == EXPRESSO_OP_DIVIDE && left.min == LLONG_MIN && right.min <= -1 && right.max >= -1);
+            if (left.min >= 0 && right.min > 0) {
+                fact.min = 0;
+                fact.max = op == EXPRESSO_OP_DIVIDE ? left.max : (left.max < right.max - 1 ? left.max : right.max - 1);
+            }
+            break;
+        }
+        case EXPRESSO_OP_BITWISE_AND:
+            if (left.min >= 0 || right.min >= 0) {
+                fact.min = 0;
+                fact.max = left.min < 0 ? right.max : right.min < 0 ? left.max : (left.max < right.max ? left.max : right.max);
+            }
+            break;
+        case EXPRESSO_OP_SHIFT_LEFT:
+        case EXPRESSO_OP_SHIFT_RIGHT:
+        case EXPRESSO_OP_BITWISE_XOR:
+        case EXPRESSO_OP_BITWISE_OR:
+            break;
+        default:
+            // Comparisons and logical operators
+            fact.min = 0;
+            fact.max = 1;
+            break;
+    }
+    fact.can_fail = fact.can_fail || left.can_fail || right.can_fail;
+    return fact;
+}
+
+static Fact conditional_fact(Fact c, Fact t, Fact f) {
+    Fact fact = UNKNOWN_FACT;
+    if (c.type == VALUE_TYPE_INTEGER && t.type != TYPE_UNKNOWN && t.type == f.type) {
+        fact.type = t.type;
+        fact.can_fail = c.can_fail || t.can_fail || f.can_fail;
+        fact.min = t.min < f.min ? t.min : f.min;
+        fact.max = t.max > f.max ? t.max : f.max;
+    }
+    return fact;
+}
+
+// --- Rewriting ---
+
+static ExpressoNodeIndex optimize_node(Optimizer* o, ExpressoNodeIndex index);
+
+static ExpressoNodeIndex optimize_unary(Optimizer* o, ExpressoOperator op, ExpressoNodeIndex child) {
+    Mark start = mark(o->out);
+    ExpressoNodeIndex operand = optimize_node(o, child);
+    Fact fact = o->facts[operand];
+
+    // Unary plus passes any value through untouched
+    if (op == EXPRESSO_OP_PLUS) return operand;
+
+    if (is_constant(&o->out->nodes[operand])) {
+        Value value = constant_value(o->out, operand);
+        ExpressoNodeIndex folded = fold(o, start, value_by_applying_unary_operator(op, value));
+        value_destroy(value);
+        if (folded != EXPRESSO_NODE_NONE) return folded;
+    }
+
+    // --x and ~~x; the inner node is the last one added, so dropping it
+    // leaves x at the end of the tree
+    const ExpressoNode* node = &o->out->nodes[operand];
+    if ((op == EXPRESSO_OP_NEGATE || op == EXPRESSO_OP_BITWISE_NOT) &&
+        node->kind == EXPRESSO_NODE_UNARY && node->op == op && known_integer(fact)) {
+        ExpressoNodeIndex inner = node->children[0];
+        o->out->count = (size_t)operand;
+        return inner;
+    }
+
+    return with_fact(o, expresso_ast_add_unary(o->out, op, operand), unary_fact(op, fact));
+}
+
+// Rebuild the subtree started at start as op(x, constant) with x the
+// optimised child; used when x was not the first operand
+static ExpressoNodeIndex rebuild_with_constant(Optimizer* o, Mark start, ExpressoNodeIndex child,
+                                               ExpressoOperator op, long long constant, Fact fact) {
+    rollback(o->out, start);
+    ExpressoNodeIndex x = optimize_node(o, child);
+    ExpressoNodeIndex right = add_integer(o, constant);
+    return with_fact(o, expresso_ast_add_binary(o->out, op, x, right), fact);
+}
+
+static ExpressoNodeIndex optimize_binary(Optimizer* o, const ExpressoNode* node) {
+    ExpressoOperator op = (ExpressoOperator)node->op;
+    ExpressoNodeIndex left_child = node->children[0];
+    ExpressoNodeIndex right_child = node->children[1];
+
+    Mark start = mark(o->out);
+    ExpressoNodeIndex left = optimize_node(o, left_child);
+    Mark after_left = mark(o->out);
+
+    // 0 && x and 1 || x never evaluate x, so it is dropped even if it would fail
+    const ExpressoNode* left_node = &o->out->nodes[left];
+    bool is_or = op == EXPRESSO_OP_LOGICAL_OR;
+    if ((op == EXPRESSO_OP_LOGICAL_AND || is_or) && left_node->kind == EXPRESSO_NODE_INTEGER &&
+        (left_node->data.integer_value != 0) == is_or) {
+        rollback(o->out, start);
+        return add_integer(o, is_or);
+    }
+
+    ExpressoNodeIndex right = optimize_node(o, right_child);
+    Fact left_fact = o->facts[left];
+    Fact right_fact = o->facts[right];
+    ExpressoAst* out = o->out;
+
+    if (is_constant(&out->nodes[left]) && is_constant(&out->nodes[right])) {
+        Value l = constant_value(out, left);
+        Value r = constant_value(out, right);
+        ExpressoNodeIndex folded = fold(o, start, value_by_applying_binary_operator(op, l, r));
+        value_destroy(l);
+        value_destroy(r);
+        if (folded != EXPRESSO_NODE_NONE) return folded;
+    }
+
+    Fact fact = binary_fact(op, left_fact, right_fact);
+    bool left_integer = known_integer(left_fact);
+    bool right_integer = known_integer(right_fact);
+
+    // Identities: x*1, 1*x, x+0, 0+x, x-0
+    if (left_integer && ((op == EXPRESSO_OP_MULTIPLY && is_integer_constant(out, right, 1)) ||
+                          ((op == EXPRESSO_OP_ADD || op == EXPRESSO_OP_SUBTRACT) && is_integer_constant(out, right, 0)))) {
+        rollback(out, after_left);
+        return left;
+    }
+    if (right_integer && ((op == EXPRESSO_OP_MULTIPLY && is_integer_constant(out, left, 1)) ||
+                           (op == EXPRESSO_OP_ADD && is_integer_constant(out, left, 0)))) {
+        rollback(out, start);
+        return optimize_node(o, right_child);
+    }
+
+    // Strength reduction by powers of two. Multiplication must not overflow;
+    // division and modulo need a non-negative dividend, since they
+    // truncate towards zero where shifts round down.
+    int exponent = power_of_two_exponent(out, right);
+    if (op == EXPRESSO_OP_MULTIPLY && exponent && left_integer && product_fits(left_fact, exponent)) {
+        out->nodes[right].data.integer_value = exponent;
+        return with_fact(o, expresso_ast_add_binary(out, EXPRESSO_OP_SHIFT_LEFT, left, right), fact);
+    }
+    if ((op == EXPRESSO_OP_DIVIDE || op == EXPRESSO_OP_MODULO) && exponent && left_integer && left_fact.min >= 0) {
+        long long divisor = out->nodes[right].data.integer_value;
+        bool divide = op == EXPRESSO_OP_DIVIDE;
+        out->nodes[right].data.integer_value = divide ? exponent : divisor - 1;
+        o->facts[right] = integer_range(out->nodes[right].data.integer_value, out->nodes[right].data.integer_value);
+        return with_fact(o, expresso_ast_add_binary(out, divide ? EXPRESSO_OP_SHIFT_RIGHT : EXPRESSO_OP_BITWISE_AND, left, right), fact);
+    }
+    exponent = power_of_two_exponent(out, left);
+    if (op == EXPRESSO_OP_MULTIPLY && exponent && right_integer && product_fits(right_fact, exponent)) {
+        return rebuild_with_constant(o, start, right_child, EXPRESSO_OP_SHIFT_LEFT, exponent, fact);
+    }
+
+    return with_fact(o, expresso_ast_add_binary(out, op, left, right), fact);
+}
+
+static ExpressoNodeIndex optimize_conditional(Optimizer* o, const ExpressoNode* node) {
+    ExpressoNodeIndex branches[] = { node->children[1], node->children[2] };
+    Mark start = mark(o->out);
+    ExpressoNodeIndex condition = optimize_node(o, node->children[0]);
+
+    // Only the selected branch is ever evaluated, so the other is dropped
+    // even if it would fail
+    const ExpressoNode* condition_node = &o->out->nodes[condition];
+    if (condition_node->kind == EXPRESSO_NODE_INTEGER) {
+        bool selected = condition_node->data.integer_value != 0;
+        rollback(o->out, start);
+        return optimize_node(o, selected ? branches[0] : branches[1]);
+    }
+
+    ExpressoNodeIndex if_true = optimize_node(o, branches[0]);
+    ExpressoNodeIndex if_false = optimize_node(o, branches[1]);
+    Fact fact = conditional_fact(o->facts[condition], o->facts[if_true], o->facts[if_false]);
+    return with_fact(o, expresso_ast_add_conditional(o->out, condition, if_true, if_false), fact);
+}
+
+static Fact parameter_fact(const Optimizer* o, const char* name) {
+    for (size_t i = 0; i < o->parameter_type_count; i++) {
+        if (strcmp(o->parameter_types[i].name, name) == 0) {
+            return (Fact){ (int)o->parameter_types[i].type, o->parameter_types[i].type == VALUE_TYPE_ERROR,
+                           LLONG_MIN, LLONG_MAX };
+        }
+    }
+    return UNKNOWN_FACT;
+}
+
+static ExpressoNodeIndex rewrite_node(Optimizer* o, ExpressoNodeIndex index) {
+    const ExpressoNode node = o->ast->nodes[index];
+    Fact constant = { (int)VALUE_TYPE_INTEGER, false, 0, 0 };
+
+    switch ((ExpressoNodeKind)node.kind) {
+        case EXPRESSO_NODE_INTEGER:
+            return add_integer(o, node.data.integer_value);
+        case EXPRESSO_NODE_FLOAT:
+            constant.type = VALUE_TYPE_FLOAT;
+            return with_fact(o, expresso_ast_add_float(o->out, node.data.float_value), constant);
+        case EXPRESSO_NODE_CHARACTER:
+            constant.type = VALUE_TYPE_CHARACTER;
+            constant.min = constant.max = node.data.char_value;
+            return with_fact(o, expresso_ast_add_character(o->out, node.data.char_value), constant);
+        case EXPRESSO_NODE_STRING:
+            constant.type = VALUE_TYPE_STRING;
+            return with_fact(o, expresso_ast_add_string(o->out, expresso_ast_string(o->ast, &node), node.data.text.length), constant);
+        case EXPRESSO_NODE_BIGINT:
+            // Big integer literals are left to the evaluator rather than folded
+            constant.type = VALUE_TYPE_BIGINT;
+            return with_fact(o, expresso_ast_add_bigint(o->out, expresso_ast_string(o->ast, &node), node.data.text.length), constant);
+        case EXPRESSO_NODE_PARAMETER: {
+            const char* name = expresso_ast_string(o->ast, &node);
+            return with_fact(o, expresso_ast_add_parameter(o->out, name, node.data.text.length), parameter_fact(o, name));
+        }
+        case EXPRESSO_NODE_UNARY:
+            return optimize_unary(o, (ExpressoOperator)node.op, node.children[0]);
+        case EXPRESSO_NODE_BINARY:
+            return optimize_binary(o, &node);
+        case EXPRESSO_NODE_CONDITIONAL:
+            return optimize_conditional(o, &node);
+    }
+    return EXPRESSO_NODE_NONE;
+}
+
+// Copy the subtree at index as it is, with its facts, children first. The
+// work stacks live on the heap, so any depth is copied in constant stack.
+static ExpressoNodeIndex copy_subtree(Optimizer* o, ExpressoNodeIndex index) {
+    size_t work_count = 0, work_capacity = 64, result_count = 0, result_capacity = 64;
+    ExpressoNodeIndex* work = (ExpressoNodeIndex*)malloc(work_capacity * sizeof(ExpressoNodeIndex));
+    ExpressoNodeIndex* results = (ExpressoNodeIndex*)malloc(result_capacity * sizeof(ExpressoNodeIndex));
+    if (!work || !results) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for optimizer work stack.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // A node is pushed as ~index before its children, and popped again as
+    // index once their copies are on the results stack
+    work[work_count++] = ~index;
+    while (work_count > 0) {
+        ExpressoNodeIndex entry = work[--work_count];
+        bool children_done = entry >= 0;
+        ExpressoNodeIndex current = children_done ? entry : ~entry;
+        const ExpressoNode* node = &o->ast->nodes[current];
+        ExpressoNodeIndex copy;
+
+        if (node->kind < EXPRESSO_NODE_UNARY) {
+            copy = rewrite_node(o, current); // Literals and parameters do not recurse
+        } else if (!children_done) {
+            if (work_count + 4 > work_capacity) {
+                work_capacity *= 2;
+                work = (ExpressoNodeIndex*)realloc(work, work_capacity * sizeof(ExpressoNodeIndex));
+                if (!work) {
+                    fprintf(stderr, "Fatal Error: Memory allocation failed for optimizer work stack.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            work[work_count++] = current;
+            for (int i = 2; i >= 0; i--) {
+                if (node->children[i] != EXPRESSO_NODE_NONE) work[work_count++] = ~node->children[i];
+            }
+            continue;
+        } else if (node->kind == EXPRESSO_NODE_UNARY) {
+            ExpressoNodeIndex operand = results[--result_count];
+            copy = with_fact(o, expresso_ast_add_unary(o->out, (ExpressoOperator)node->op, operand),
+                             unary_fact((ExpressoOperator)node->op, o->facts[operand]));
+        } else if (node->kind == EXPRESSO_NODE_BINARY) {
+            result_count -= 2;
+            ExpressoNodeIndex left = results[result_count], right = results[result_count + 1];
+            copy = with_fact(o, expresso_ast_add_binary(o->out, (ExpressoOperator)node->op, left, right),
+                             binary_fact((ExpressoOperator)node->op, o->facts[left], o->facts[right]));
+        } else {
+            result_count -= 3;
+            ExpressoNodeIndex* c = &results[result_count];
+            copy = with_fact(o, expresso_ast_add_conditional(o->out, c[0], c[1], c[2]),
+                             conditional_fact(o->facts[c[0]], o->facts[c[1]], o->facts[c[2]]));
+        }
+
+        if (result_count == result_capacity) {
+            result_capacity *= 2;
+            results = (ExpressoNodeIndex*)realloc(results, result_capacity * sizeof(ExpressoNodeIndex));
+            if (!results) {
+                fprintf(stderr, "Fatal Error: Memory allocation failed for optimizer work stack.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        results[result_count++] = copy;
+    }
+
+    ExpressoNodeIndex root = results[0];
+    free(work);
+    free(results);
+    return root;
+}
+
+// Rewrite the subtree at index, or reuse the folded value of a constant one
+static ExpressoNodeIndex rewrite_or_look_up(Optimizer* o, ExpressoNodeIndex index) {
+    if (!o->constant || o->in_constant || !o->constant[index] || o->ast->nodes[index].kind < EXPRESSO_NODE_UNARY) {
+        return rewrite_node(o, index);
+    }
+
+    // The outermost constant subtree may have been folded before. Errors and
+    // big integers are not folded, so those are left for evaluation as usual.
+    Value cached;
+    if (expresso_memo_cache_lookup(memo_cache, o->ast, index, &cached)) {
+        if (has_literal(cached)) return fold(o, mark(o->out), cached);
+        value_destroy(cached);
+    }
+    o->in_constant = true;
+    ExpressoNodeIndex result = rewrite_node(o, index);
+    o->in_constant = false;
+    if (result != EXPRESSO_NODE_NONE && is_constant(&o->out->nodes[result])) {
+        Value value = constant_value(o->out, result);
+        expresso_memo_cache_store(memo_cache, o->ast, index, value);
+        value_destroy(value);
+    }
+    return result;
+}
+
+static ExpressoNodeIndex optimize_node(Optimizer* o, ExpressoNodeIndex index) {
+    if (o->depth >= OPTIMIZER_MAX_DEPTH) return copy_subtree(o, index);
+    o->depth++;
+    ExpressoNodeIndex result = rewrite_or_look_up(o, index);
+    o->depth--;
+    return result;
+}
+
+void expresso_optimize(const ExpressoAst* ast, ExpressoAst* optimized,
+                       const ExpressoParameterType* parameter_types, size_t parameter_type_count) {
+    if (!optimized) return;
+    expresso_ast_reset(optimized);
+    // Rolling back discarded subtrees needs a plain append-only tree; a
+    // shared input is expanded and can be re-shared afterwards
+    expresso_ast_set_sharing(optimized, false);
+    if (!ast || ast->root == EXPRESSO_NODE_NONE) return;
+
+    Optimizer o = { ast, optimized, NULL, 0, parameter_types, parameter_types ? parameter_type_count : 0, NULL, false, 0 };
+    if (memo_cache) {
+        o.constant = (uint8_t*)malloc(ast->count);
+        if (!o.constant) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for optimizer facts.\n");
+            exit(EXIT_FAILURE);
+        }
+        expresso_memo_find_constants(ast, o.constant);
+    }
+    optimized->root = optimize_node(&o, ast->root);
+    free(o.facts);
+    free(o.constant);
+}
+
+// --- Debug output ---
+
+static void dump_node(FILE* out, const ExpressoAst* ast, ExpressoNodeIndex index) {
+    const ExpressoNode* node = &ast->nodes[index];
+
+    switch ((ExpressoNodeKind)node->kind) {
+        case EXPRESSO_NODE_INTEGER:   fprintf(out, "%lld", node->data.integer_value); break;
+        case EXPRESSO_NODE_FLOAT:     fprintf(out, "%.17g", node->data.float_value); break;
+        case EXPRESSO_NODE_CHARACTER: fprintf(out, "'%c'", node->data.char_value); break;
+        case EXPRESSO_NODE_STRING:    fprintf(out, "\"%s\"", expresso_ast_string(ast, node)); break;
+        case EXPRESSO_NODE_BIGINT:    fprintf(out, "%s", expresso_ast_string(ast, node)); break;
+        case EXPRESSO_NODE_PARAMETER: fprintf(out, "$%s", expresso_ast_string(ast, node)); break;
+        case EXPRESSO_NODE_UNARY:
+        case EXPRESSO_NODE_BINARY:
+            fprintf(out, "(%s", expresso_operator_symbol((ExpressoOperator)node->op));
+            for (int i = 0; i < 2 && node->children[i] != EXPRESSO_NODE_NONE; i++) {
+                fputc(' ', out);
+                dump_node(out, ast, node->children[i]);
+            }
+            fputc(')', out);
+            break;
+        case EXPRESSO_NODE_CONDITIONAL:
+            fputs("(?", out);
+            for (int i = 0; i < 3; i++) {
+                fputc(' ', out);
+                dump_node(out, ast, node->children[i]);
+            }
+            fputc(')', out);
+            break;
+    }
+}
+
+void expresso_ast_dump(FILE* out, const ExpressoAst* ast) {
+    if (!ast || ast->root == EXPRESSO_NODE_NONE) {
+        fputs("(empty)\n", out);
+        return;
+    }
+    dump_node(out, ast, ast->root);
+    fputc('\n', out);
+}
+
+void expresso_optimizer_dump(FILE* out, const ExpressoAst* before, const ExpressoAst* after) {
+    fputs("before: ", out);
+    expresso_ast_dump(out, before);
+    fputs("after:  ", out);
+    expresso_ast_dump(out, after);
+}
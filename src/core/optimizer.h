@@ -0,0 +1,99 @@
+/*
+ * Expresso
+ * optimizer.h
+ *
+ * Optimisation pass over native expression trees: constant folding,
+ * algebraic simplification and pruning of constant conditionals.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_OPTIMIZER_H
+#define EXPRESSO_OPTIMIZER_H
+
+#include <stddef.h> // For size_t
+#include <stdio.h>  // For FILE
+#include "value.h"
+#include "ast.h"
+#include "memo_cache.h"
+
+// The type a parameter is known to have (name without the '$')
+typedef struct {
+    const char* name;
+    ValueType type;
+} ExpressoParameterType;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rewrite ast into optimized, a different tree, which is reset first:
+//  - subtrees without parameters are folded to literals, except where
+//    evaluating them fails (the failure is left for evaluation to report)
+//  - ?: with a constant condition is replaced by the branch it selects
+//  - unary plus is dropped, and x*1, x+0, x-0, --x and ~~x become x
+//  - x*2^k, x/2^k and x%2^k become x<<k, x>>k and x&(2^k-1)
+// The last two only apply where x is known to be an integer that cannot
+// fail and, where a multiplication could overflow or a negative dividend
+// would round differently, known to be in range; parameters are only known through
+// parameter_types (which may be NULL). The optimised tree evaluates to the
+// same value as ast for any bindings of the declared types. Subtrees nested
+// more than 4096 levels deep are copied as they are. optimized is built
+// without sharing; pass it to expresso_ast_share to re-share it.
+void expresso_optimize(const ExpressoAst* ast, ExpressoAst* optimized,
+                       const ExpressoParameterType* parameter_types, size_t parameter_type_count);
+
+// Look up the folded values of constant subtrees in cache, and remember new
+// ones, so that a subexpression repeated across expressions is folded once;
+// NULL (the default) folds everything afresh
+void expresso_optimizer_set_memo_cache(ExpressoMemoCache* cache);
+
+// Print a tree as an S-expression, e.g. (+ $a (* 2 3)), and a newline
+void expresso_ast_dump(FILE* out, const ExpressoAst* ast);
+
+// Print the trees before and after optimisation, one per line
+void expresso_optimizer_dump(FILE* out, const ExpressoAst* before, const ExpressoAst* after);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_OPTIMIZER_H
@@ -0,0 +1,254 @@
+/*
+ * Expresso
+ * parse_cache.c
+ *
+ * Least-recently-used cache of compiled expressions, keyed by their
+ * whitespace-normalised text.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "parse_cache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ParseCacheEntry {
+    char* key;
+    size_t key_length;
+    uint64_t hash;
+    ExpressoAst* ast;
+    size_t bytes;
+    struct ParseCacheEntry* chain; // Next entry in the same bucket
+    struct ParseCacheEntry* newer; // Towards the most recently used
+    struct ParseCacheEntry* older; // Towards the least recently used
+} ParseCacheEntry;
+
+struct ParseCache {
+    ParseCacheEntry** buckets;
+    size_t bucket_mask;
+    ParseCacheEntry* newest;
+    ParseCacheEntry* oldest;
+    ParseCacheStats stats;
+};
+
+ParseCache* parse_cache_create(size_t max_entries, size_t max_bytes) {
+    if (max_entries == 0 || max_bytes == 0) {
+        fprintf(stderr, "Error: Parse cache capacity cannot be 0.\n");
+        return NULL;
+    }
+
+    ParseCache* cache = (ParseCache*)calloc(1, sizeof(ParseCache));
+    size_t buckets = 16;
+    while (buckets < max_entries && buckets < ((size_t)1 << 20)) buckets *= 2;
+    ParseCacheEntry** table = cache ? (ParseCacheEntry**)calloc(buckets, sizeof(ParseCacheEntry*)) : NULL;
+    if (!table) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for parse cache.\n");
+        exit(EXIT_FAILURE);
+    }
+    cache->buckets = table;
+    cache->bucket_mask = buckets - 1;
+    cache->stats.max_entries = max_entries;
+    cache->stats.max_bytes = max_bytes;
+    return cache;
+}
+
+void parse_cache_destroy(ParseCache* cache) {
+    if (!cache) return;
+    ParseCacheEntry* entry = cache->newest;
+    while (entry) {
+        ParseCacheEntry* older = entry->older;
+        expresso_ast_destroy(entry->ast);
+        free(entry->key);
+        free(entry);
+        entry = older;
+    }
+    free(cache->buckets);
+    free(cache);
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Characters that can continue a number, a parameter or a two-character
+// operator; whitespace between two of the same kind separates tokens
+static int joining_class(char c) {
+    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        c == '_' || c == '$' || c == '.') {
+        return 1;
+    }
+    if (c == '&' || c == '=' || c == '!' || c == '<' || c == '>') return 2;
+    return 0;
+}
+
+size_t parse_cache_normalize(const char* text, char* key) {
+    size_t length = 0;
+    const char* p = text;
+    while (is_space(*p)) p++;
+
+    while (*p) {
+        if (is_space(*p)) {
+            while (is_space(*p)) p++;
+            if (*p && length > 0 && joining_class(key[length - 1]) != 0 &&
+                joining_class(key[length - 1]) == joining_class(*p)) {
+                key[length++] = ' ';
+            }
+            continue;
+        }
+        if (*p == '"' || *p == '\'') {
+            // Literals are copied as they are, escapes included
+            char quote = *p;
+            key[length++] = *p++;
+            while (*p && *p != quote) {
+                if (*p == '\\' && p[1]) key[length++] = *p++;
+                key[length++] = *p++;
+            }
+            if (*p) key[length++] = *p++;
+            continue;
+        }
+        key[length++] = *p++;
+    }
+    key[length] = '\0';
+    return length;
+}
+
+static uint64_t hash_key(const char* key, size_t length) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)key[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static ParseCacheEntry** find_link(ParseCache* cache, const char* key, size_t key_length, uint64_t hash) {
+    ParseCacheEntry** link = &cache->buckets[hash & cache->bucket_mask];
+    while (*link && ((*link)->hash != hash || (*link)->key_length != key_length ||
+                     memcmp((*link)->key, key, key_length) != 0)) {
+        link = &(*link)->chain;
+    }
+    return link;
+}
+
+static void unlink_recency(ParseCache* cache, ParseCacheEntry* entry) {
+    if (entry->newer) entry->newer->older = entry->older;
+    else cache->newest = entry->older;
+    if (entry->older) entry->older->newer = entry->newer;
+    else cache->oldest = entry->newer;
+}
+
+static void link_newest(ParseCache* cache, ParseCacheEntry* entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest) cache->newest->newer = entry;
+    else cache->oldest = entry;
+    cache->newest = entry;
+}
+
+const ExpressoAst* parse_cache_lookup(ParseCache* cache, const char* key, size_t key_length) {
+    if (!cache || !key) return NULL;
+    ParseCacheEntry* entry = *find_link(cache, key, key_length, hash_key(key, key_length));
+    if (!entry) {
+        cache->stats.misses++;
+        return NULL;
+    }
+    cache->stats.hits++;
+    if (entry != cache->newest) {
+        unlink_recency(cache, entry);
+        link_newest(cache, entry);
+    }
+    return entry->ast;
+}
+
+static void evict_oldest(ParseCache* cache) {
+    ParseCacheEntry* entry = cache->oldest;
+    ParseCacheEntry** link = find_link(cache, entry->key, entry->key_length, entry->hash);
+    *link = entry->chain;
+    unlink_recency(cache, entry);
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->bytes;
+    cache->stats.evictions++;
+    expresso_ast_destroy(entry->ast);
+    free(entry->key);
+    free(entry);
+}
+
+bool parse_cache_insert(ParseCache* cache, const char* key, size_t key_length, ExpressoAst* ast) {
+    if (!cache || !key || !ast) return false;
+    size_t bytes = sizeof(ParseCacheEntry) + key_length + 1 + sizeof(ExpressoAst) +
+                   ast->count * sizeof(ExpressoNode) + ast->strings_size;
+    uint64_t hash = hash_key(key, key_length);
+    if (bytes > cache->stats.max_bytes || *find_link(cache, key, key_length, hash)) return false;
+
+    while (cache->stats.entries >= cache->stats.max_entries || cache->stats.bytes + bytes > cache->stats.max_bytes) {
+        evict_oldest(cache);
+    }
+
+    ParseCacheEntry* entry = (ParseCacheEntry*)malloc(sizeof(ParseCacheEntry));
+    char* copy = (char*)malloc(key_length + 1);
+    if (!entry || !copy) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for parse cache entry.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, key, key_length);
+    copy[key_length] = '\0';
+    entry->key = copy;
+    entry->key_length = key_length;
+    entry->hash = hash;
+    entry->ast = ast;
+    entry->bytes = bytes;
+    entry->chain = cache->buckets[hash & cache->bucket_mask];
+    cache->buckets[hash & cache->bucket_mask] = entry;
+    link_newest(cache, entry);
+    cache->stats.entries++;
+    cache->stats.bytes += bytes;
+    return true;
+}
+
+void parse_cache_get_stats(const ParseCache* cache, ParseCacheStats* stats) {
+    if (!stats) return;
+    if (!cache) {
+        memset(stats, 0, sizeof *stats);
+        return;
+    }
+    *stats = cache->stats;
+}
@@ -0,0 +1,93 @@
+/*
+ * Expresso
+ * parse_cache.h
+ *
+ * Least-recently-used cache of compiled expressions, keyed by their
+ * whitespace-normalised text.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_PARSE_CACHE_H
+#define EXPRESSO_PARSE_CACHE_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h> // For size_t
+#include "ast.h"
+
+#define PARSE_CACHE_DEFAULT_ENTRIES 256
+#define PARSE_CACHE_DEFAULT_BYTES (1024 * 1024)
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    size_t entries;
+    size_t bytes;
+    size_t max_entries;
+    size_t max_bytes;
+} ParseCacheStats;
+
+typedef struct ParseCache ParseCache;
+
+// Create a cache bounded both in entries and in bytes (keys, nodes and
+// strings); the least recently used entries go first
+ParseCache* parse_cache_create(size_t max_entries, size_t max_bytes);
+void parse_cache_destroy(ParseCache* cache);
+
+// Write the cache key of an expression to key, which needs room for
+// strlen(text) + 1 characters, and return its length. Whitespace is dropped
+// except inside literals and where removing it would join two tokens, so
+// texts with the same key have the same tokens.
+size_t parse_cache_normalize(const char* text, char* key);
+
+// Find the tree compiled from a text with this key; NULL on a miss. The
+// tree stays owned by the cache and valid until the next insertion.
+const ExpressoAst* parse_cache_lookup(ParseCache* cache, const char* key, size_t key_length);
+
+// Add a tree under key, evicting older entries to make room. On success the
+// cache owns ast; an entry too large for the cache on its own is refused,
+// and ast stays with the caller.
+bool parse_cache_insert(ParseCache* cache, const char* key, size_t key_length, ExpressoAst* ast);
+
+void parse_cache_get_stats(const ParseCache* cache, ParseCacheStats* stats);
+
+#endif // EXPRESSO_PARSE_CACHE_H
@@ -47,6 +47,10 @@
  *
  */
 #include "value.h"
+#include "arena.h" // For the evaluation arena
+#include "bigint.h" // For big integer values
+#include "format.h" // For number output
+#include "intern.h" // For interned strings
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,9 +61,244 @@ static const char * value_type_names[] = {
 	"Float",
 	"Character",
 	"String",
+	"Big Integer",
 	"Error"
 };
 
+// Not thread-safe, like the reference counts themselves
+static ValueAllocationStats allocation_stats;
+
+// The reference count of text and boxes in the evaluation arena, which
+// copies share and which are never freed one by one
+#define ARENA_REFERENCES SIZE_MAX
+
+// Memory for a string or box: from the arena during an evaluation, unless
+// it must outlive it, otherwise from the heap
+static void* allocate(size_t size, bool on_heap, size_t* references) {
+    if (!on_heap && expresso_arena_active()) {
+        *references = ARENA_REFERENCES;
+        return expresso_arena_allocate(size);
+    }
+    void* memory = malloc(size);
+    if (!memory) {
+        // Handle allocation failure - this is a critical error
+        fprintf(stderr, "Fatal Error: Memory allocation failed for value.\n");
+        exit(EXIT_FAILURE);
+    }
+    *references = 1;
+    allocation_stats.allocations++;
+    allocation_stats.bytes += size;
+    return memory;
+}
+
+// A string of length bytes for the caller to fill in
+static ExpressoString* new_string(size_t length, bool on_heap) {
+    size_t references;
+    ExpressoString* string = (ExpressoString*)allocate(sizeof(ExpressoString) + length + 1, on_heap, &references);
+    string->references = references;
+    string->length = length;
+    string->rope = NULL;
+    string->text[length] = '\0';
+    return string;
+}
+
+static ExpressoString* create_string(const char* text, size_t length, bool on_heap) {
+    ExpressoString* string = new_string(length, on_heap);
+    memcpy(string->text, text, length);
+    return string;
+}
+
+// The pieces of a concatenation, which follow its ExpressoString in the same
+// allocation. Once the text has been joined the pieces are released.
+struct ExpressoRope {
+    Value left, right;      // Strings
+    ExpressoString* joined; // NULL until the text is first read
+};
+
+// Whether copies of a string must count their references; those in the
+// arena or the intern pool live on regardless
+static inline bool counted(const ExpressoString* string) {
+    return string->references < EXPRESSO_INTERNED_REFERENCES;
+}
+
+static inline ExpressoString* shared_text(Value val);
+static const char* string_text(ExpressoString* string);
+
+static inline bool unjoined_rope(const ExpressoString* string) {
+    return string && string->rope && !string->rope->joined;
+}
+
+// Walks of a rope keep pieces to come back to on a stack, which starts on
+// the C stack and moves to the heap as it grows, so ropes of any depth and
+// shape are walked without recursing
+#define ROPE_INLINE_PENDING 16
+
+static void* grow_pending(void* items, const void* inline_items, size_t count, size_t* capacity, size_t size) {
+    *capacity *= 2;
+    void* grown = malloc(*capacity * size);
+    if (!grown) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for rope traversal.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(grown, items, count * size);
+    if (items != inline_items) free(items);
+    return grown;
+}
+
+// A rope releases its pieces too. The walk goes on down one piece and
+// releases the other at once, unless both are ropes.
+static void release_string(ExpressoString* string) {
+    ExpressoString* inline_pending[ROPE_INLINE_PENDING];
+    ExpressoString** pending = inline_pending;
+    size_t count = 0, capacity = ROPE_INLINE_PENDING;
+
+    for (;;) {
+        while (string && counted(string) && --string->references == 0) {
+            ExpressoRope* rope = string->rope;
+            ExpressoString* next = NULL;
+            if (rope && rope->joined) {
+                next = rope->joined;
+            } else if (rope) {
+                ExpressoString* left = shared_text(rope->left);
+                ExpressoString* right = shared_text(rope->right);
+                next = unjoined_rope(right) ? right : left;
+                ExpressoString* other = next == right ? left : right;
+                if (!unjoined_rope(other)) {
+                    release_string(other); // Not a rope, so this goes no deeper
+                } else {
+                    if (count == capacity) {
+                        pending = (ExpressoString**)grow_pending(pending, inline_pending, count, &capacity, sizeof(*pending));
+                    }
+                    pending[count++] = other;
+                }
+            }
+            allocation_stats.releases++;
+            free(string);
+            string = next;
+        }
+        if (count == 0) break;
+        string = pending[--count];
+    }
+    if (pending != inline_pending) free(pending);
+}
+
+#ifdef EXPRESSO_NAN_BOXING
+
+#define CANONICAL_NAN 0x7FF8000000000000ULL
+
+static inline Value tagged(unsigned tag, uint64_t payload) {
+    Value v;
+    v.bits = (uint64_t)tag << VALUE_TAG_SHIFT | (payload & VALUE_PAYLOAD_MASK);
+    return v;
+}
+
+// --- Value Creation Functions ---
+static Value create_integer(long long val, bool on_heap) {
+    uint64_t bits = (uint64_t)val;
+    if ((long long)(int64_t)(bits << 16) >> 16 == val) return tagged(VALUE_TAG_INTEGER, bits);
+
+    size_t references;
+    ExpressoBoxedInteger* box = (ExpressoBoxedInteger*)allocate(sizeof(ExpressoBoxedInteger), on_heap, &references);
+    box->references = references;
+    box->value = val;
+    return tagged(VALUE_TAG_BOXED_INTEGER, (uintptr_t)box);
+}
+
+Value value_create_integer(long long val) {
+    return create_integer(val, false);
+}
+
+Value value_create_float(double val) {
+    Value v;
+    if (val != val) {
+        v.bits = CANONICAL_NAN; // No NaN may look like a tag
+    } else {
+        memcpy(&v.bits, &val, sizeof val);
+    }
+    return v;
+}
+
+Value value_create_character(char val) {
+    return tagged(VALUE_TAG_CHARACTER, (unsigned char)val);
+}
+
+// Store text inline when it fits, otherwise in a new shared buffer
+static Value create_text(ValueType type, const char* text, size_t length, bool on_heap) {
+    if (type == VALUE_TYPE_STRING && length <= VALUE_INLINE_CAPACITY) {
+        Value v = tagged(VALUE_TAG_INLINE_STRING, (uint64_t)length << 40);
+        memcpy((char*)&v.bits + VALUE_INLINE_OFFSET, text, length); // The NUL is already there
+        return v;
+    }
+    unsigned tag = type == VALUE_TYPE_STRING ? VALUE_TAG_STRING : VALUE_TAG_ERROR;
+    return tagged(tag, (uintptr_t)create_string(text, length, on_heap));
+}
+
+static Value shared_string(ExpressoString* string) {
+    return tagged(VALUE_TAG_STRING, (uintptr_t)string);
+}
+
+Value value_create_bigint(ExpressoBigint* value) {
+    return tagged(VALUE_TAG_BIGINT, (uintptr_t)value);
+}
+
+Value value_create_error_at(ExpressoErrorCode code, size_t start, size_t length) {
+    uint64_t span = 0;
+    if (start <= 0xFFFFFF && length < 0x7FFF) span = (uint64_t)(length + 1) << 32 | (uint64_t)start << 8;
+    return tagged(VALUE_TAG_ERROR, VALUE_ERROR_CATALOGUED | span | (uint64_t)code);
+}
+
+ExpressoErrorCode value_error_code(Value val) {
+    if (value_tag(val) != VALUE_TAG_ERROR) return EXPRESSO_ERROR_NONE;
+    return val.bits & VALUE_ERROR_CATALOGUED ? (ExpressoErrorCode)(val.bits & 0xFF) : EXPRESSO_ERROR_CUSTOM;
+}
+
+bool value_error_span(Value val, size_t* start, size_t* length) {
+    if (value_tag(val) != VALUE_TAG_ERROR || !(val.bits & VALUE_ERROR_CATALOGUED)) return false;
+    size_t stored = (size_t)(val.bits >> 32 & 0x7FFF);
+    if (stored == 0) return false;
+    *start = (size_t)(val.bits >> 8 & 0xFFFFFF);
+    *length = stored - 1;
+    return true;
+}
+
+// The shared buffer of a long string or run-time error message, otherwise NULL
+static inline ExpressoString* shared_text(Value val) {
+    unsigned tag = value_tag(val);
+    if (tag == VALUE_TAG_ERROR && val.bits & VALUE_ERROR_CATALOGUED) return NULL;
+    return tag == VALUE_TAG_STRING || tag == VALUE_TAG_ERROR ? (ExpressoString*)value_pointer(val) : NULL;
+}
+
+static inline const char* text_of(const Value* val) {
+    if (value_tag(*val) == VALUE_TAG_INLINE_STRING) return (const char*)&val->bits + VALUE_INLINE_OFFSET;
+    return string_text(shared_text(*val));
+}
+
+static inline size_t text_length(Value val) {
+    if (value_tag(val) == VALUE_TAG_INLINE_STRING) return (size_t)(val.bits >> 40 & 0xFF);
+    return shared_text(val)->length;
+}
+
+// --- Value Destruction Function ---
+void value_destroy(Value val) {
+    switch (value_tag(val)) {
+        case VALUE_TAG_STRING: release_string((ExpressoString*)value_pointer(val)); break;
+        case VALUE_TAG_ERROR:
+            if (!(val.bits & VALUE_ERROR_CATALOGUED)) release_string((ExpressoString*)value_pointer(val));
+            break;
+        case VALUE_TAG_BIGINT: expresso_bigint_free(value_get_bigint(val)); break;
+        case VALUE_TAG_BOXED_INTEGER: {
+            ExpressoBoxedInteger* box = (ExpressoBoxedInteger*)value_pointer(val);
+            if (box->references != ARENA_REFERENCES && --box->references == 0) {
+                allocation_stats.releases++;
+                free(box);
+            }
+            break;
+        }
+    }
+}
+
+#else
+
 // --- Value Creation Functions ---
 Value value_create_integer(long long val) {
     Value v;
@@ -82,142 +321,496 @@ Value value_create_character(char val) {
     return v;
 }
 
-Value value_create_string(const char* val) {
+// Store text inline when it fits, otherwise in a new shared buffer. The
+// message of an error is always shared.
+static Value create_text(ValueType type, const char* text, size_t length, bool on_heap) {
     Value v;
-    v.type = VALUE_TYPE_STRING;
-    if (val) {
-        v.data.string_value = strdup(val); // Allocate and copy string
-        if (!v.data.string_value) {
-            // Handle allocation failure - this is a critical error
-            fprintf(stderr, "Fatal Error: Memory allocation failed for string value.\n");
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        v.data.string_value = NULL;
+    v.type = type;
+    if (type == VALUE_TYPE_ERROR) {
+        v.length = 0;
+        v.data.error.message = create_string(text, length, on_heap);
+        v.data.error.start = 0;
+        v.data.error.length = 0;
+        v.data.error.code = EXPRESSO_ERROR_CUSTOM;
+        return v;
+    }
+    v.length = (unsigned int)length;
+    if (length <= VALUE_INLINE_CAPACITY) {
+        memcpy(v.data.inline_string, text, length);
+        v.data.inline_string[length] = '\0';
+        return v;
     }
+    v.data.string_value = create_string(text, length, on_heap);
     return v;
 }
 
-Value value_create_error(const char* message) {
+static Value shared_string(ExpressoString* string) {
+    Value v;
+    v.type = VALUE_TYPE_STRING;
+    v.length = (unsigned int)string->length;
+    v.data.string_value = string;
+    return v;
+}
+
+Value value_create_bigint(ExpressoBigint* value) {
+    Value v;
+    v.type = VALUE_TYPE_BIGINT;
+    v.data.bigint_value = value;
+    return v;
+}
+
+Value value_create_error_at(ExpressoErrorCode code, size_t start, size_t length) {
     Value v;
     v.type = VALUE_TYPE_ERROR;
-    if (message) {
-        v.data.string_value = strdup(message);
-        if (!v.data.string_value) {
-            fprintf(stderr, "Fatal Error: Memory allocation failed for error message.\n");
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        v.data.string_value = strdup("Unknown Error");
+    v.length = 0;
+    v.data.error.message = NULL;
+    v.data.error.start = 0;
+    v.data.error.length = 0;
+    v.data.error.code = (uint16_t)code;
+    if (start <= UINT32_MAX && length < UINT16_MAX) {
+        v.data.error.start = (uint32_t)start;
+        v.data.error.length = (uint16_t)(length + 1);
     }
     return v;
 }
 
+ExpressoErrorCode value_error_code(Value val) {
+    return val.type == VALUE_TYPE_ERROR ? (ExpressoErrorCode)val.data.error.code : EXPRESSO_ERROR_NONE;
+}
+
+bool value_error_span(Value val, size_t* start, size_t* length) {
+    if (val.type != VALUE_TYPE_ERROR || val.data.error.length == 0) return false;
+    *start = val.data.error.start;
+    *length = val.data.error.length - 1u;
+    return true;
+}
+
+// The shared buffer of a long string or run-time error message, otherwise NULL
+static inline ExpressoString* shared_text(Value val) {
+    if (val.type == VALUE_TYPE_ERROR) return val.data.error.message;
+    return val.type == VALUE_TYPE_STRING && val.length > VALUE_INLINE_CAPACITY ? val.data.string_value : NULL;
+}
+
+static inline const char* text_of(const Value* val) {
+    return val->length > VALUE_INLINE_CAPACITY ? string_text(val->data.string_value) : val->data.inline_string;
+}
+
+static inline size_t text_length(Value val) {
+    return val.length;
+}
+
 // --- Value Destruction Function ---
 void value_destroy(Value val) {
-    if (val.type == VALUE_TYPE_STRING || val.type == VALUE_TYPE_ERROR) {
-        free(val.data.string_value);
+    ExpressoString* string = shared_text(val);
+    if (string) {
+        release_string(string);
+    } else if (val.type == VALUE_TYPE_BIGINT) {
+        expresso_bigint_free(val.data.bigint_value);
+    }
+}
+
+#endif // EXPRESSO_NAN_BOXING
+
+// --- Concatenation ---
+
+// A piece of a rope to write later, and where its text ends
+typedef struct {
+    const Value* piece;
+    char* end;
+} PendingPiece;
+
+// Write the text of a string value to the bytes just before end, copying
+// the pieces of a rope without joining it. Pieces that are not ropes are
+// written at once; when both pieces of a rope are ropes, the left one waits
+// on a stack while the walk goes on down the right.
+static void copy_text(const Value* val, char* end) {
+    PendingPiece inline_pending[ROPE_INLINE_PENDING];
+    PendingPiece* pending = inline_pending;
+    size_t count = 0, capacity = ROPE_INLINE_PENDING;
+
+    for (;;) {
+        ExpressoString* string = shared_text(*val);
+        if (unjoined_rope(string)) {
+            ExpressoRope* rope = string->rope;
+            char* middle = end - text_length(rope->right);
+            if (!unjoined_rope(shared_text(rope->right))) {
+                memcpy(middle, text_of(&rope->right), text_length(rope->right));
+                val = &rope->left;
+                end = middle;
+                continue;
+            }
+            if (!unjoined_rope(shared_text(rope->left))) {
+                size_t length = text_length(rope->left);
+                memcpy(middle - length, text_of(&rope->left), length);
+            } else {
+                if (count == capacity) {
+                    pending = (PendingPiece*)grow_pending(pending, inline_pending, count, &capacity, sizeof(*pending));
+                }
+                pending[count].piece = &rope->left;
+                pending[count++].end = middle;
+            }
+            val = &rope->right;
+            continue;
+        }
+        size_t length = text_length(*val);
+        memcpy(end - length, text_of(val), length);
+        if (count == 0) break;
+        count--;
+        val = pending[count].piece;
+        end = pending[count].end;
+    }
+    if (pending != inline_pending) free(pending);
+}
+
+// A flat copy of the text of a string value, which may be a rope
+static ExpressoString* flat_string(const Value* val, bool on_heap) {
+    size_t length = text_length(*val);
+    ExpressoString* string = new_string(length, on_heap);
+    copy_text(val, string->text + length);
+    return string;
+}
+
+// The text of a shared string. A rope is joined the first time, into memory
+// that lasts as long as the rope does.
+static const char* string_text(ExpressoString* string) {
+    ExpressoRope* rope = string->rope;
+    if (!rope) return string->text;
+    if (!rope->joined) {
+        Value whole = shared_string(string);
+        rope->joined = flat_string(&whole, string->references != ARENA_REFERENCES);
+        value_destroy(rope->left);
+        value_destroy(rope->right);
+    }
+    return rope->joined->text;
+}
+
+// A copy of a string a rope can hold. Ropes made during an evaluation are
+// dropped with the arena, never released, so counted text is copied there.
+static Value rope_piece(Value piece) {
+    ExpressoString* string = shared_text(piece);
+    if (string && counted(string) && expresso_arena_active()) return shared_string(flat_string(&piece, false));
+    return value_copy(piece);
+}
+
+static Value create_rope(Value left, Value right, size_t length) {
+    size_t references;
+    ExpressoString* string = (ExpressoString*)allocate(sizeof(ExpressoString) + sizeof(ExpressoRope), false, &references);
+    ExpressoRope* rope = (ExpressoRope*)(string + 1);
+    string->references = references;
+    string->length = length;
+    string->rope = rope;
+    rope->left = rope_piece(left);
+    rope->right = rope_piece(right);
+    rope->joined = NULL;
+    return shared_string(string);
+}
+
+// The text a value other than a string adds to a concatenation: formatted
+// into buffer, or for a big integer into *digits, which the caller frees
+static bool term_text(Value val, char* buffer, char** digits, const char** text, size_t* length) {
+    *digits = NULL;
+    *text = buffer;
+    switch (value_get_type(val)) {
+        case VALUE_TYPE_INTEGER: *length = expresso_format_integer(value_get_integer(val), buffer); return true;
+        case VALUE_TYPE_FLOAT: *length = expresso_format_double(value_get_float(val), buffer); return true;
+        case VALUE_TYPE_CHARACTER:
+            buffer[0] = value_get_character(val);
+            *length = 1;
+            return true;
+        case VALUE_TYPE_BIGINT:
+            *digits = expresso_bigint_to_string(value_get_bigint(val));
+            *text = *digits;
+            *length = strlen(*digits);
+            return true;
+        case VALUE_TYPE_STRING:
+        case VALUE_TYPE_ERROR:
+            break;
+    }
+    return false;
+}
+
+Value value_concatenate(Value string, const Value* values, size_t count) {
+    char buffer[EXPRESSO_FORMAT_BUFFER_SIZE];
+    char* digits;
+    const char* text;
+    size_t piece;
+
+    // Measure first, so the result is allocated once at its exact size
+    if (value_is_error(string)) return value_copy(string);
+    if (value_get_type(string) != VALUE_TYPE_STRING) return value_create_error_code(EXPRESSO_ERROR_TYPE);
+    size_t length = text_length(string);
+    for (size_t i = 0; i < count; i++) {
+        if (value_get_type(values[i]) == VALUE_TYPE_STRING) {
+            length += text_length(values[i]);
+            continue;
+        }
+        if (value_is_error(values[i])) return value_copy(values[i]);
+        term_text(values[i], buffer, &digits, &text, &piece);
+        free(digits);
+        length += piece;
+    }
+
+    if (count == 1 && length >= VALUE_ROPE_MIN_LENGTH) {
+        if (value_get_type(values[0]) == VALUE_TYPE_STRING) return create_rope(string, values[0], length);
+        term_text(values[0], buffer, &digits, &text, &piece);
+        Value right = create_text(VALUE_TYPE_STRING, text, piece, false);
+        free(digits);
+        Value rope = create_rope(string, right, length);
+        value_destroy(right);
+        return rope;
+    }
+
+    char inline_text[VALUE_INLINE_CAPACITY + 1];
+    ExpressoString* joined = length > VALUE_INLINE_CAPACITY ? new_string(length, false) : NULL;
+    char* end = (joined ? joined->text : inline_text) + text_length(string);
+    copy_text(&string, end);
+    for (size_t i = 0; i < count; i++) {
+        if (value_get_type(values[i]) == VALUE_TYPE_STRING) {
+            end += text_length(values[i]);
+            copy_text(&values[i], end);
+            continue;
+        }
+        term_text(values[i], buffer, &digits, &text, &piece);
+        memcpy(end, text, piece);
+        end += piece;
+        free(digits);
     }
+    return joined ? shared_string(joined) : create_text(VALUE_TYPE_STRING, inline_text, length, false);
+}
+
+Value value_create_string(const char* val) {
+    // A NULL string is empty
+    return val ? create_text(VALUE_TYPE_STRING, val, strlen(val), false) : create_text(VALUE_TYPE_STRING, "", 0, false);
+}
+
+Value value_create_string_from(const char* text, size_t length) {
+    return create_text(VALUE_TYPE_STRING, text, length, false);
+}
+
+Value value_create_interned_string(const char* text, size_t length) {
+    if (length <= VALUE_INLINE_CAPACITY) return create_text(VALUE_TYPE_STRING, text, length, false);
+    return shared_string(expresso_intern(text, length));
+}
+
+Value value_create_error_code(ExpressoErrorCode code) {
+    return value_create_error_at(code, SIZE_MAX, 0); // Too far in to store, so no span
+}
+
+Value value_create_error(const char* message) {
+    if (!message) return value_create_error_code(EXPRESSO_ERROR_UNKNOWN);
+    return create_text(VALUE_TYPE_ERROR, message, strlen(message), false);
+}
+
+// The message of an error: from the catalogue, or made at run time
+static inline const char* error_text(Value val) {
+    ExpressoString* message = shared_text(val);
+    return message ? message->text : expresso_error_message(value_error_code(val));
 }
 
 // --- Value Type Check Functions ---
-bool value_is_integer(Value val) { return val.type == VALUE_TYPE_INTEGER; }
-bool value_is_float(Value val) { return val.type == VALUE_TYPE_FLOAT; }
-bool value_is_character(Value val) { return val.type == VALUE_TYPE_CHARACTER; }
-bool value_is_string(Value val) { return val.type == VALUE_TYPE_STRING; }
-bool value_is_error(Value val) { return val.type == VALUE_TYPE_ERROR; }
+bool value_is_integer(Value val) { return value_get_type(val) == VALUE_TYPE_INTEGER; }
+bool value_is_float(Value val) { return value_get_type(val) == VALUE_TYPE_FLOAT; }
+bool value_is_character(Value val) { return value_get_type(val) == VALUE_TYPE_CHARACTER; }
+bool value_is_string(Value val) { return value_get_type(val) == VALUE_TYPE_STRING; }
+bool value_is_bigint(Value val) { return value_get_type(val) == VALUE_TYPE_BIGINT; }
+bool value_is_error(Value val) { return value_get_type(val) == VALUE_TYPE_ERROR; }
 
 // --- Value Access Functions (with type checking) ---
 // In a real system, these would have robust error handling or assertions
 // For now, we assume correct type checking before calling these.
 long long value_as_integer(Value val) {
-    if (val.type == VALUE_TYPE_INTEGER) return val.data.integer_value;
-    if (val.type == VALUE_TYPE_FLOAT) return (long long)val.data.float_value; // Implicit conversion
-    if (val.type == VALUE_TYPE_CHARACTER) return (long long)val.data.char_value;
+    ValueType type = value_get_type(val);
+    if (type == VALUE_TYPE_INTEGER) return value_get_integer(val);
+    if (type == VALUE_TYPE_FLOAT) return (long long)value_get_float(val); // Implicit conversion
+    if (type == VALUE_TYPE_CHARACTER) return (long long)value_get_character(val);
     // Error handling for incorrect type access would go here
     fprintf(stderr, "Error: Attempted to access non-integer value as integer.\n");
     exit(EXIT_FAILURE);
 }
 
 double value_as_float(Value val) {
-    if (val.type == VALUE_TYPE_FLOAT) return val.data.float_value;
-    if (val.type == VALUE_TYPE_INTEGER) return (double)val.data.integer_value;
-    if (val.type == VALUE_TYPE_CHARACTER) return (double)val.data.char_value;
+    ValueType type = value_get_type(val);
+    if (type == VALUE_TYPE_FLOAT) return value_get_float(val);
+    if (type == VALUE_TYPE_INTEGER) return (double)value_get_integer(val);
+    if (type == VALUE_TYPE_CHARACTER) return (double)value_get_character(val);
+    if (type == VALUE_TYPE_BIGINT) return expresso_bigint_to_double(value_get_bigint(val));
     fprintf(stderr, "Error: Attempted to access non-float value as float.\n");
     exit(EXIT_FAILURE);
 }
 
 char value_as_character(Value val) {
-    if (val.type == VALUE_TYPE_CHARACTER) return val.data.char_value;
-    if (val.type == VALUE_TYPE_INTEGER) return (char)val.data.integer_value; // Potential data loss
+    ValueType type = value_get_type(val);
+    if (type == VALUE_TYPE_CHARACTER) return value_get_character(val);
+    if (type == VALUE_TYPE_INTEGER) return (char)value_get_integer(val); // Potential data loss
     fprintf(stderr, "Error: Attempted to access non-character value as character.\n");
     exit(EXIT_FAILURE);
 }
 
-const char* value_as_string(Value val) {
-    if (val.type == VALUE_TYPE_STRING || val.type == VALUE_TYPE_ERROR) return val.data.string_value;
+const char* value_as_string(const Value* val) {
+    if (value_get_type(*val) == VALUE_TYPE_STRING) return text_of(val);
+    if (value_get_type(*val) == VALUE_TYPE_ERROR) return error_text(*val);
     fprintf(stderr, "Error: Attempted to access non-string value as string.\n");
     exit(EXIT_FAILURE);
 }
 
-const char* value_as_error_message(Value val) {
-    if (val.type == VALUE_TYPE_ERROR) return val.data.string_value;
+const char* value_as_error_message(const Value* val) {
+    if (value_get_type(*val) == VALUE_TYPE_ERROR) return error_text(*val);
     fprintf(stderr, "Error: Attempted to access non-error value as error message.\n");
     exit(EXIT_FAILURE);
 }
 
+size_t value_string_length(Value val) {
+    if (value_get_type(val) == VALUE_TYPE_STRING) return text_length(val);
+    if (value_get_type(val) == VALUE_TYPE_ERROR) return strlen(error_text(val));
+    fprintf(stderr, "Error: Attempted to access non-string value as string.\n");
+    exit(EXIT_FAILURE);
+}
+
 // --- Value Utility Functions ---
 Value value_copy(Value val) {
-    if (val.type == VALUE_TYPE_STRING || val.type == VALUE_TYPE_ERROR) {
-        return value_create_string(val.data.string_value);
+    ExpressoString* string = shared_text(val);
+    if (string) {
+        // Strings are immutable, so copies share the text
+        if (counted(string)) string->references++;
+        return val;
     }
+    if (value_get_type(val) == VALUE_TYPE_BIGINT && !value_get_bigint(val)->in_arena) {
+        return value_create_bigint(expresso_bigint_copy(value_get_bigint(val)));
+    }
+#ifdef EXPRESSO_NAN_BOXING
+    if (value_tag(val) == VALUE_TAG_BOXED_INTEGER) {
+        ExpressoBoxedInteger* box = (ExpressoBoxedInteger*)value_pointer(val);
+        if (box->references != ARENA_REFERENCES) box->references++;
+        return val;
+    }
+#endif
     return val; // For other types, a shallow copy is fine (they are immutable primitives)
 }
 
+Value value_intern(Value val) {
+    ExpressoString* string = shared_text(val);
+    if (value_get_type(val) != VALUE_TYPE_STRING || !string) return value_promote(val);
+    if (string->references != EXPRESSO_INTERNED_REFERENCES) string = expresso_intern(string_text(string), string->length);
+    return shared_string(string);
+}
+
+bool value_in_arena(Value val) {
+    ExpressoString* string = shared_text(val);
+    if (string) return string->references == ARENA_REFERENCES;
+    if (value_get_type(val) == VALUE_TYPE_BIGINT) return value_get_bigint(val)->in_arena;
+#ifdef EXPRESSO_NAN_BOXING
+    if (value_tag(val) == VALUE_TAG_BOXED_INTEGER) {
+        return ((ExpressoBoxedInteger*)value_pointer(val))->references == ARENA_REFERENCES;
+    }
+#endif
+    return false;
+}
+
+Value value_promote(Value val) {
+    if (!value_in_arena(val)) return value_copy(val);
+    ValueType type = value_get_type(val);
+    if (type == VALUE_TYPE_BIGINT) return value_create_bigint(expresso_bigint_copy(value_get_bigint(val)));
+#ifdef EXPRESSO_NAN_BOXING
+    if (type == VALUE_TYPE_INTEGER) return create_integer(value_get_integer(val), true);
+#endif
+    ExpressoString* string = shared_text(val);
+    if (type == VALUE_TYPE_ERROR) return create_text(type, string->text, string->length, true);
+    // A rope is joined straight onto the heap
+    if (string && string->rope) return shared_string(flat_string(&val, true));
+    return create_text(type, text_of(&val), text_length(val), true);
+}
+
 bool value_equals(Value v1, Value v2) {
-    if (v1.type != v2.type) {
+    ValueType type = value_get_type(v1);
+    if (type != value_get_type(v2)) {
         // Implement type coercion for comparison if needed, e.g., 5 == 5.0
         // For now, strict type equality
         return false;
     }
 
-    switch (v1.type) {
-        case VALUE_TYPE_INTEGER: return v1.data.integer_value == v2.data.integer_value;
+    switch (type) {
+        case VALUE_TYPE_INTEGER: return value_get_integer(v1) == value_get_integer(v2);
         case VALUE_TYPE_FLOAT:
             // Handle NaN comparison: NaN != NaN
-            if (isnan(v1.data.float_value) || isnan(v2.data.float_value)) return false;
-            return v1.data.float_value == v2.data.float_value;
-        case VALUE_TYPE_CHARACTER: return v1.data.char_value == v2.data.char_value;
-        case VALUE_TYPE_STRING: return strcmp(v1.data.string_value, v2.data.string_value) == 0;
-        case VALUE_TYPE_ERROR: return strcmp(v1.data.string_value, v2.data.string_value) == 0;
+            if (isnan(value_get_float(v1)) || isnan(value_get_float(v2))) return false;
+            return value_get_float(v1) == value_get_float(v2);
+        case VALUE_TYPE_CHARACTER: return value_get_character(v1) == value_get_character(v2);
+        case VALUE_TYPE_STRING: {
+            // Shared text is equal to itself, and distinct interned texts differ
+            const ExpressoString* s1 = shared_text(v1);
+            const ExpressoString* s2 = shared_text(v2);
+            if (s1 && s1 == s2) return true;
+            if (s1 && s2 && s1->references == EXPRESSO_INTERNED_REFERENCES &&
+                s2->references == EXPRESSO_INTERNED_REFERENCES) {
+                return false;
+            }
+            size_t length = text_length(v1);
+            return length == text_length(v2) && memcmp(text_of(&v1), text_of(&v2), length) == 0;
+        }
+        case VALUE_TYPE_ERROR: // Wherever they were reported
+            if (value_error_code(v1) != value_error_code(v2)) return false;
+            return value_error_code(v1) != EXPRESSO_ERROR_CUSTOM || strcmp(error_text(v1), error_text(v2)) == 0;
+        case VALUE_TYPE_BIGINT: return expresso_bigint_compare(v1, v2) == 0;
     }
     return false; // Should not reach here
 }
 
 void value_print(Value val) {
-    switch (val.type) {
-        case VALUE_TYPE_INTEGER: printf("%lld", val.data.integer_value); break;
-        case VALUE_TYPE_FLOAT: printf("%f", val.data.float_value); break;
-        case VALUE_TYPE_CHARACTER: printf("'%c'", val.data.char_value); break;
-        case VALUE_TYPE_STRING: printf("\"%s\"", val.data.string_value); break;
-        case VALUE_TYPE_ERROR: fprintf(stderr, "Error: %s", val.data.string_value); break;
+    char number[EXPRESSO_FORMAT_BUFFER_SIZE];
+    switch (value_get_type(val)) {
+        case VALUE_TYPE_INTEGER:
+            expresso_format_integer(value_get_integer(val), number);
+            fputs(number, stdout);
+            break;
+        case VALUE_TYPE_FLOAT:
+            expresso_format_double(value_get_float(val), number);
+            fputs(number, stdout);
+            break;
+        case VALUE_TYPE_CHARACTER: printf("'%c'", value_get_character(val)); break;
+        case VALUE_TYPE_STRING:
+            putchar('"');
+            fwrite(text_of(&val), 1, text_length(val), stdout);
+            putchar('"');
+            break;
+        case VALUE_TYPE_BIGINT: {
+            char* digits = expresso_bigint_to_string(value_get_bigint(val));
+            printf("%s", digits);
+            free(digits);
+            break;
+        }
+        case VALUE_TYPE_ERROR: {
+            ExpressoErrorCode code = value_error_code(val);
+            size_t start, length;
+            fprintf(stderr, "Error: %s", expresso_error_category_name(expresso_error_category(code)));
+            if (value_error_span(val, &start, &length)) fprintf(stderr, " at offset %zu", start);
+            fprintf(stderr, ": %s", error_text(val));
+            break;
+        }
     }
 }
 
 // Added for error-reporting purposes
 Value value_type_as_string(Value val) {
-    switch (val.type) {
+    ValueType type = value_get_type(val);
+    switch (type) {
         case VALUE_TYPE_INTEGER:
         case VALUE_TYPE_FLOAT:
         case VALUE_TYPE_CHARACTER:
         case VALUE_TYPE_STRING:
-        case VALUE_TYPE_ERROR:	return value_create_string(value_type_names[val.type]);
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_ERROR:	return value_create_string(value_type_names[type]);
     }
-    return value_create_error("Unknown value type.");
+    return value_create_error_code(EXPRESSO_ERROR_UNKNOWN_VALUE_TYPE);
 }
 
-const char* value_c_str(Value val) {
-    if (val.type == VALUE_TYPE_STRING || val.type == VALUE_TYPE_ERROR) return val.data.string_value;
-    fprintf(stderr, "Error: Attempted to access non-string value as string.\n");
-    exit(EXIT_FAILURE);
+const char* value_c_str(const Value* val) {
+    return value_as_string(val);
+}
+
+void value_allocation_stats(ValueAllocationStats* stats) {
+    *stats = allocation_stats;
+}
+
+void value_reset_allocation_stats(void) {
+    memset(&allocation_stats, 0, sizeof(allocation_stats));
 }
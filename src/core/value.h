@@ -51,6 +51,9 @@
 
 #include <stdbool.h> // For bool
 #include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint64_t
+#include <string.h>  // For memcpy
+#include "errors.h"  // For ExpressoErrorCode
 
 // Define the possible types a Value can hold
 typedef enum {
@@ -58,20 +61,160 @@ typedef enum {
     VALUE_TYPE_FLOAT,
     VALUE_TYPE_CHARACTER,
     VALUE_TYPE_STRING,
+    VALUE_TYPE_BIGINT, // Integer beyond 64 bits (see bigint.h)
     VALUE_TYPE_ERROR // Special type for error propagation
 } ValueType;
 
+typedef struct ExpressoBigint ExpressoBigint;
+typedef struct ExpressoRope ExpressoRope;
+
+// Immutable, reference-counted text of a long string or error message. Text
+// in the evaluation arena or the intern pool is shared without counting.
+typedef struct {
+    size_t references;
+    size_t length; // Bytes, excluding the NUL
+    ExpressoRope* rope; // For a concatenation, its pieces; text is then unused
+    char text[]; // NUL-terminated
+} ExpressoString;
+
+// A concatenation at least this long is a rope of its two operands, whose
+// text is joined the first time it is read, so chains of concatenations
+// copy each piece once rather than once per step
+#define VALUE_ROPE_MIN_LENGTH 256
+
+#ifdef EXPRESSO_NAN_BOXING
+
+// A value in one 64-bit word (the EXPRESSO_NAN_BOXING build option). A
+// double is stored as itself, with every NaN made the one positive quiet NaN.
+// Everything else is a negative quiet NaN: a tag in the top 16 bits and a
+// 48-bit payload. Pointers must fit in 48 bits, as user-space pointers do on
+// x86-64 and AArch64.
+typedef struct {
+    uint64_t bits;
+} Value;
+
+#define VALUE_TAG_SHIFT 48
+#define VALUE_PAYLOAD_MASK 0x0000FFFFFFFFFFFFULL
+#define VALUE_TAG_INTEGER 0xFFF9u        // 48-bit two's complement integer
+#define VALUE_TAG_CHARACTER 0xFFFAu
+#define VALUE_TAG_INLINE_STRING 0xFFFBu  // Text in the payload; see below
+#define VALUE_TAG_BOXED_INTEGER 0xFFFCu  // ExpressoBoxedInteger*
+#define VALUE_TAG_STRING 0xFFFDu         // ExpressoString*
+#define VALUE_TAG_ERROR 0xFFFEu          // ExpressoString*, or a catalogued error; see below
+#define VALUE_TAG_BIGINT 0xFFFFu         // ExpressoBigint*, heap or evaluation arena
+
+// Tags from VALUE_TAG_BOXED_INTEGER up point to memory the value owns
+#define VALUE_FIRST_OWNING_TAG VALUE_TAG_BOXED_INTEGER
+
+// A short string's bytes and NUL sit in the payload at this byte offset of
+// the word, and its length in payload bits 40-47
+#define VALUE_INLINE_CAPACITY 4
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define VALUE_INLINE_OFFSET 3
+#else
+#define VALUE_INLINE_OFFSET 0
+#endif
+
+// A catalogued error has payload bit 47 set, which no user-space pointer
+// has, its ExpressoErrorCode in bits 0-7, the start of its span in bits 8-31
+// and the span's length plus one (zero for none) in bits 32-46
+#define VALUE_ERROR_CATALOGUED (1ULL << 47)
+
+// Integers beyond 48 bits, shared by copies
+typedef struct {
+    size_t references;
+    long long value;
+} ExpressoBoxedInteger;
+
+static inline unsigned value_tag(Value val) {
+    return (unsigned)(val.bits >> VALUE_TAG_SHIFT);
+}
+
+static inline void* value_pointer(Value val) {
+    return (void*)(uintptr_t)(val.bits & VALUE_PAYLOAD_MASK);
+}
+
+// Unchecked access, for code that has already looked at the type
+static inline ValueType value_get_type(Value val) {
+    static const ValueType types[] = {
+        VALUE_TYPE_FLOAT,   VALUE_TYPE_INTEGER, VALUE_TYPE_CHARACTER, VALUE_TYPE_STRING,
+        VALUE_TYPE_INTEGER, VALUE_TYPE_STRING,  VALUE_TYPE_ERROR,     VALUE_TYPE_BIGINT
+    };
+    unsigned tag = value_tag(val);
+    return tag < VALUE_TAG_INTEGER ? VALUE_TYPE_FLOAT : types[tag - 0xFFF8u];
+}
+
+static inline long long value_get_integer(Value val) {
+    if (value_tag(val) == VALUE_TAG_INTEGER) return (long long)(int64_t)(val.bits << 16) >> 16;
+    return ((const ExpressoBoxedInteger*)value_pointer(val))->value;
+}
+
+static inline double value_get_float(Value val) {
+    double d;
+    memcpy(&d, &val.bits, sizeof d);
+    return d;
+}
+
+static inline char value_get_character(Value val) {
+    return (char)(val.bits & 0xFF);
+}
+
+static inline ExpressoBigint* value_get_bigint(Value val) {
+    return (ExpressoBigint*)value_pointer(val);
+}
+
+// Whether value_copy and value_destroy have any work to do
+static inline bool value_owns_memory(Value val) {
+    return value_tag(val) >= VALUE_FIRST_OWNING_TAG;
+}
+
+#else
+
+// Strings up to this many bytes are stored in the Value
+#define VALUE_INLINE_CAPACITY 15
+
 // Define the Value union/struct
 typedef struct {
     ValueType type;
+    unsigned int length; // Bytes of a string, excluding the NUL
     union {
         long long integer_value; // Using long long for machine-dependent int
         double float_value;
         char char_value;
-        char* string_value; // Dynamically allocated string
+        char inline_string[VALUE_INLINE_CAPACITY + 1]; // length <= VALUE_INLINE_CAPACITY
+        ExpressoString* string_value; // length > VALUE_INLINE_CAPACITY; shared by copies
+        ExpressoBigint* bigint_value; // Heap or evaluation arena
+        struct {
+            ExpressoString* message; // Only for EXPRESSO_ERROR_CUSTOM; shared by copies
+            uint32_t start;          // Of the span in the source
+            uint16_t length;         // Of the span plus one; zero for none
+            uint16_t code;           // ExpressoErrorCode
+        } error;
     } data;
 } Value;
 
+// Unchecked access, for code that has already looked at the type
+static inline ValueType value_get_type(Value val) { return val.type; }
+static inline long long value_get_integer(Value val) { return val.data.integer_value; }
+static inline double value_get_float(Value val) { return val.data.float_value; }
+static inline char value_get_character(Value val) { return val.data.char_value; }
+static inline ExpressoBigint* value_get_bigint(Value val) { return val.data.bigint_value; }
+
+// Whether value_copy and value_destroy have any work to do
+static inline bool value_owns_memory(Value val) {
+    return val.type == VALUE_TYPE_STRING || val.type == VALUE_TYPE_BIGINT || val.type == VALUE_TYPE_ERROR;
+}
+
+#endif // EXPRESSO_NAN_BOXING
+
+// Counts of buffer allocations for strings (and, NaN-boxed, large integers),
+// for measuring workloads
+typedef struct {
+    unsigned long long allocations;
+    unsigned long long releases;
+    unsigned long long bytes;
+} ValueAllocationStats;
+
 // --- Value Creation Functions ---
 #ifdef __cplusplus
 extern "C" {
@@ -81,7 +224,23 @@ Value value_create_integer(long long val);
 Value value_create_float(double val);
 Value value_create_character(char val);
 Value value_create_string(const char* val);
-Value value_create_error(const char* message); // For error propagation
+Value value_create_string_from(const char* text, size_t length); // text need not be NUL-terminated
+// The same string with long text shared from the intern pool (see intern.h)
+Value value_create_interned_string(const char* text, size_t length);
+// Errors are propagated as values. A catalogued error (see errors.h) is
+// made without allocating; its message is looked up when it is printed.
+Value value_create_error_code(ExpressoErrorCode code);
+// A catalogued error located by length bytes of the source from start. A
+// span too far into the source or too long to be stored is dropped.
+Value value_create_error_at(ExpressoErrorCode code, size_t start, size_t length);
+Value value_create_error(const char* message); // An EXPRESSO_ERROR_CUSTOM error with a copy of message
+Value value_create_bigint(ExpressoBigint* value); // Takes ownership
+// A string followed by the text of each of count values: a string's own, a
+// number as it prints, a character itself. With one value, a result long
+// enough is a rope; otherwise the text is joined in one allocation of the
+// exact size. A copy of the first error among string and the values, else a
+// type error if string is not a string.
+Value value_concatenate(Value string, const Value* values, size_t count);
 
 // --- Value Destruction Function ---
 void value_destroy(Value val);
@@ -91,21 +250,37 @@ bool value_is_integer(Value val);
 bool value_is_float(Value val);
 bool value_is_character(Value val);
 bool value_is_string(Value val);
+bool value_is_bigint(Value val);
 bool value_is_error(Value val);
 
 // --- Value Access Functions (with type checking) ---
 long long value_as_integer(Value val);
 double value_as_float(Value val);
 char value_as_character(Value val);
-const char* value_as_string(Value val); // Returns const char* for immutability
-const char* value_as_error_message(Value val);
+// Text of a string or error value. Short strings live inside the Value, so
+// the text is valid only as long as *val is.
+const char* value_as_string(const Value* val); // Returns const char* for immutability
+const char* value_as_error_message(const Value* val);
+ExpressoErrorCode value_error_code(Value val);
+// Whether an error has a source span, and if so where it is
+bool value_error_span(Value val, size_t* start, size_t* length);
+size_t value_string_length(Value val); // Cached; strings may contain NULs
 
 // --- Value Utility Functions ---
-Value value_copy(Value val); // Creates a deep copy for strings
+// Shares the text of long strings; O(1). A copy of a value made during an
+// evaluation lasts only as long as that evaluation (see arena.h).
+Value value_copy(Value val);
+Value value_promote(Value val); // A copy that outlives any evaluation, moved out of the arena
+Value value_intern(Value val); // Like value_promote, but long strings go to the intern pool
+bool value_in_arena(Value val);
 bool value_equals(Value v1, Value v2);
 void value_print(Value val); // For debugging/output
 Value value_type_as_string(Value val); // For error-reporting/debugging
-const char* value_c_str(Value val); // Returns const char* for immutability
+const char* value_c_str(const Value* val); // Returns const char* for immutability
+
+// Buffers allocated and released since the last reset
+void value_allocation_stats(ValueAllocationStats* stats);
+void value_reset_allocation_stats(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,229 @@
+/*
+ * Expresso
+ * vm.c
+ *
+ * Stack-based virtual machine that runs compiled expression bytecode.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "vm.h"
+#include "operations.h"
+#include "arena.h" // For the evaluation arena
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint32_t read_operand(const uint8_t* code) {
+    uint32_t operand;
+    memcpy(&operand, code, sizeof operand);
+    return operand;
+}
+
+// Scalars are copied and dropped in place without a call
+static inline Value vm_copy(Value value) {
+    return value_owns_memory(value) ? value_copy(value) : value;
+}
+
+static inline void vm_release(Value value) {
+    if (value_owns_memory(value)) value_destroy(value);
+}
+
+// Replace the top two values with op(left, right), releasing the operands
+#define BINARY_CASE(opcode, function) \
+    case opcode: { \
+        Value right = *--sp; \
+        Value left = sp[-1]; \
+        sp[-1] = function(left, right); \
+        vm_release(left); \
+        vm_release(right); \
+        pc++; \
+        break; \
+    }
+
+// Replace the top value with op(operand), releasing the operand
+#define UNARY_CASE(opcode, function) \
+    case opcode: { \
+        Value operand = sp[-1]; \
+        sp[-1] = function(operand); \
+        vm_release(operand); \
+        pc++; \
+        break; \
+    }
+
+// The right operand of && and || decides the result once it is reached
+static inline Value logical_and_right(Value value) {
+    return value_by_logical_anding_values(value_create_integer(1), value);
+}
+
+static inline Value logical_or_right(Value value) {
+    return value_by_logical_oring_values(value_create_integer(0), value);
+}
+
+static Value execute(const ExpressoProgram* program, const Value* bindings, Value* stack);
+
+Value expresso_vm_run(const ExpressoProgram* program, const Value* bindings) {
+    if (!program || program->max_stack <= EXPRESSO_VM_INLINE_STACK) {
+        Value stack[EXPRESSO_VM_INLINE_STACK];
+        return expresso_vm_execute(program, bindings, stack);
+    }
+
+    ExpressoArenaMark arena = expresso_arena_enter();
+    Value* stack = (Value*)expresso_arena_allocate(program->max_stack * sizeof(Value));
+    return expresso_arena_leave(arena, expresso_vm_execute(program, bindings, stack));
+}
+
+static Value execute(const ExpressoProgram* program, const Value* bindings, Value* stack) {
+    if (!program || program->code_size == 0) {
+        return value_create_error_code(EXPRESSO_ERROR_EMPTY_PROGRAM);
+    }
+    if (program->parameter_count > 0 && !bindings) {
+        return value_create_error_code(EXPRESSO_ERROR_MISSING_BINDINGS);
+    }
+
+    const uint8_t* code = program->code;
+    const uint8_t* pc = code;
+    Value* sp = stack;
+
+    for (;;) {
+        switch ((ExpressoOpcode)*pc) {
+            case EXPRESSO_OPCODE_CONSTANT:
+                *sp++ = vm_copy(program->constants[read_operand(pc + 1)]);
+                pc += 1 + sizeof(uint32_t);
+                break;
+
+            case EXPRESSO_OPCODE_PARAMETER:
+                *sp++ = vm_copy(bindings[read_operand(pc + 1)]);
+                pc += 1 + sizeof(uint32_t);
+                break;
+
+            UNARY_CASE(EXPRESSO_OPCODE_NEGATE, value_by_negating_value)
+            UNARY_CASE(EXPRESSO_OPCODE_LOGICAL_NOT, value_by_logical_negating_value)
+            UNARY_CASE(EXPRESSO_OPCODE_BITWISE_NOT, value_by_bitwise_complementing_value)
+
+            BINARY_CASE(EXPRESSO_OPCODE_MULTIPLY, value_by_multiplying_values)
+            BINARY_CASE(EXPRESSO_OPCODE_DIVIDE, value_by_dividing_values)
+            BINARY_CASE(EXPRESSO_OPCODE_MODULO, value_by_modulasing_values)
+            BINARY_CASE(EXPRESSO_OPCODE_ADD, value_by_adding_values)
+            BINARY_CASE(EXPRESSO_OPCODE_SUBTRACT, value_by_subtracting_values)
+            BINARY_CASE(EXPRESSO_OPCODE_SHIFT_LEFT, value_by_left_shifting_values)
+            BINARY_CASE(EXPRESSO_OPCODE_SHIFT_RIGHT, value_by_right_shifting_values)
+            BINARY_CASE(EXPRESSO_OPCODE_LESS, value_by_comparing_less_values)
+            BINARY_CASE(EXPRESSO_OPCODE_GREATER, value_by_comparing_greater_values)
+            BINARY_CASE(EXPRESSO_OPCODE_LESS_EQUAL, value_by_comparing_less_equal_values)
+            BINARY_CASE(EXPRESSO_OPCODE_GREATER_EQUAL, value_by_comparing_greater_equal_values)
+            BINARY_CASE(EXPRESSO_OPCODE_EQUAL, value_by_comparing_equal_values)
+            BINARY_CASE(EXPRESSO_OPCODE_NOT_EQUAL, value_by_comparing_not_equal_values)
+            BINARY_CASE(EXPRESSO_OPCODE_BITWISE_AND, value_by_bitwise_anding_values)
+            BINARY_CASE(EXPRESSO_OPCODE_BITWISE_XOR, value_by_bitwise_xoring_values)
+            BINARY_CASE(EXPRESSO_OPCODE_BITWISE_OR, value_by_bitwise_oring_values)
+            UNARY_CASE(EXPRESSO_OPCODE_LOGICAL_AND, logical_and_right)
+            UNARY_CASE(EXPRESSO_OPCODE_LOGICAL_OR, logical_or_right)
+
+            case EXPRESSO_OPCODE_ADD_CHAIN: {
+                uint32_t count = read_operand(pc + 1);
+                sp -= count;
+                Value sum = value_by_adding_all_values(sp, count);
+                for (uint32_t i = 0; i < count; i++) vm_release(sp[i]);
+                *sp++ = sum;
+                pc += 1 + sizeof(uint32_t);
+                break;
+            }
+
+            case EXPRESSO_OPCODE_AND_THEN:
+            case EXPRESSO_OPCODE_OR_ELSE: {
+                // Leave the result and skip the right operand if the left decides it
+                bool is_and = *pc == EXPRESSO_OPCODE_AND_THEN;
+                Value left = sp[-1];
+                if (!value_is_condition(left)) {
+                    vm_release(left);
+                    sp[-1] = value_create_error_code(is_and ? EXPRESSO_ERROR_TYPE_LOGICAL_AND : EXPRESSO_ERROR_TYPE_LOGICAL_OR);
+                    pc = code + read_operand(pc + 1);
+                } else if (value_is_true(left) != is_and) {
+                    vm_release(left);
+                    sp[-1] = value_create_integer(!is_and);
+                    pc = code + read_operand(pc + 1);
+                } else {
+                    vm_release(left);
+                    sp--;
+                    pc += 1 + sizeof(uint32_t);
+                }
+                break;
+            }
+
+            case EXPRESSO_OPCODE_BRANCH: {
+                Value condition = *--sp;
+                if (!value_is_condition(condition)) {
+                    vm_release(condition);
+                    *sp++ = value_create_error_code(EXPRESSO_ERROR_TYPE_CONDITIONAL);
+                    pc = code + read_operand(pc + 1 + sizeof(uint32_t));
+                    break;
+                }
+                bool taken = value_is_true(condition);
+                vm_release(condition);
+                if (taken) {
+                    pc += 1 + 2 * sizeof(uint32_t);
+                } else {
+                    pc = code + read_operand(pc + 1);
+                }
+                break;
+            }
+
+            case EXPRESSO_OPCODE_JUMP:
+                pc = code + read_operand(pc + 1);
+                break;
+
+            case EXPRESSO_OPCODE_RETURN:
+                return *--sp;
+
+            default:
+                // Unreachable for programs built by expresso_program_compile()
+                while (sp > stack) vm_release(*--sp);
+                return value_create_error_code(EXPRESSO_ERROR_INVALID_BYTECODE);
+        }
+    }
+}
+
+Value expresso_vm_execute(const ExpressoProgram* program, const Value* bindings, Value* stack) {
+    // Strings, errors and big integers made on the way are dropped with the arena
+    ExpressoArenaMark arena = expresso_arena_enter();
+    return expresso_arena_leave(arena, execute(program, bindings, stack));
+}
@@ -103,6 +103,7 @@ unaryExpression
 
 primaryExpression
     : literal
+    | Parameter
     | '(' expression ')'
     ;
 
@@ -116,7 +117,8 @@ literal
 // Lexers (C-style)
 IntegerLiteral: [0-9]+ | '0x'[0-9a-fA-F]+;
 FloatingLiteral: [0-9]* '.' [0-9]+;
-CharacterLiteral: '\'' (~['\\] | '\\.')* '\'';
+CharacterLiteral: '\'' (~['\\] | '\\' .)* '\'';
 StringLiteral: '"' (~["\\] | '\\'.)* '"';
+Parameter: '$' [a-zA-Z_] [a-zA-Z_0-9]*;
 
 WS: [ \t\n\r]+ -> skip; // Custom: Error on assignment ops if needed, but grammar excludes =
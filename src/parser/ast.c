@@ -0,0 +1,499 @@
+/*
+ * Expresso
+ * ast.c
+ *
+ * Construction of the native expression tree. Nodes live in one contiguous,
+ * geometrically grown array and string payloads in a single pool, so building
+ * a tree costs amortised O(1) allocations and destroying it costs two frees.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "ast.h"
+#include "literal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AST_INITIAL_NODES 32
+#define AST_INITIAL_STRINGS 64
+
+ExpressoAst* expresso_ast_create(void) {
+    ExpressoAst* ast = (ExpressoAst*)calloc(1, sizeof(ExpressoAst));
+    if (!ast) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree.\n");
+        exit(EXIT_FAILURE);
+    }
+    ast->root = EXPRESSO_NODE_NONE;
+    return ast;
+}
+
+void expresso_ast_destroy(ExpressoAst* ast) {
+    if (!ast) return;
+    free(ast->nodes);
+    free(ast->strings);
+    free(ast->share_slots);
+    free(ast->uses);
+    free(ast);
+}
+
+void expresso_ast_reset(ExpressoAst* ast) {
+    if (!ast) return;
+    ast->count = 0;
+    ast->strings_size = 0;
+    ast->root = EXPRESSO_NODE_NONE;
+    if (ast->share_slots) {
+        memset(ast->share_slots, 0xFF, ast->share_capacity * sizeof(ExpressoNodeIndex));
+    }
+    ast->added = 0;
+    ast->shared = 0;
+}
+
+// --- Hash-consing ---
+
+#define AST_INITIAL_SHARE_SLOTS 64
+
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 0x100000001B3ULL;
+}
+
+static bool has_text(const ExpressoNode* node) {
+    return node->kind == EXPRESSO_NODE_STRING || node->kind == EXPRESSO_NODE_BIGINT || node->kind == EXPRESSO_NODE_PARAMETER;
+}
+
+// Children are already shared, so nodes are compared one level deep. Text
+// payloads are compared by content since each node has its own copy.
+static uint64_t node_hash(const ExpressoAst* ast, const ExpressoNode* node) {
+    uint64_t hash = hash_mix(hash_mix(0xCBF29CE484222325ULL, node->kind), node->op);
+    if (has_text(node)) {
+        const char* text = ast->strings + node->data.text.offset;
+        for (uint32_t i = 0; i < node->data.text.length; i++) hash = hash_mix(hash, (unsigned char)text[i]);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &node->data, sizeof bits);
+        hash = hash_mix(hash, bits);
+    }
+    for (int i = 0; i < 3; i++) hash = hash_mix(hash, (uint32_t)node->children[i]);
+    return hash ^ (hash >> 29);
+}
+
+static bool nodes_match(const ExpressoAst* ast, const ExpressoNode* x, const ExpressoNode* y) {
+    if (x->kind != y->kind || x->op != y->op) return false;
+    for (int i = 0; i < 3; i++) {
+        if (x->children[i] != y->children[i]) return false;
+    }
+    if (has_text(x)) {
+        return x->data.text.length == y->data.text.length &&
+               memcmp(ast->strings + x->data.text.offset, ast->strings + y->data.text.offset, x->data.text.length) == 0;
+    }
+    // Unused payload bytes are zeroed by ast_append
+    return memcmp(&x->data, &y->data, sizeof x->data) == 0;
+}
+
+// Find the slot holding a node identical to node, or the empty slot for it
+static size_t share_slot(const ExpressoAst* ast, const ExpressoNode* node) {
+    size_t mask = ast->share_capacity - 1;
+    size_t slot = (size_t)node_hash(ast, node) & mask;
+    while (ast->share_slots[slot] != EXPRESSO_NODE_NONE &&
+           !nodes_match(ast, &ast->nodes[ast->share_slots[slot]], node)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Record a node as stored: index it by structure and count it as a parent
+// of its children
+static void share_insert(ExpressoAst* ast, ExpressoNodeIndex index) {
+    // Keep the table at most half full; nodes 0..index-1 are already in it
+    if ((size_t)index + 1 > ast->share_capacity / 2) {
+        size_t capacity = ast->share_capacity ? ast->share_capacity * 2 : AST_INITIAL_SHARE_SLOTS;
+        ExpressoNodeIndex* slots = (ExpressoNodeIndex*)malloc(capacity * sizeof(ExpressoNodeIndex));
+        if (!slots) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree sharing.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(slots, 0xFF, capacity * sizeof(ExpressoNodeIndex));
+        free(ast->share_slots);
+        ast->share_slots = slots;
+        ast->share_capacity = capacity;
+        for (ExpressoNodeIndex i = 0; i < index; i++) {
+            ast->share_slots[share_slot(ast, &ast->nodes[i])] = i;
+        }
+    }
+    if ((size_t)index >= ast->uses_capacity) {
+        size_t capacity = ast->uses_capacity ? ast->uses_capacity * 2 : AST_INITIAL_NODES;
+        while (capacity <= (size_t)index) capacity *= 2;
+        uint32_t* uses = (uint32_t*)realloc(ast->uses, capacity * sizeof(uint32_t));
+        if (!uses) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree sharing.\n");
+            exit(EXIT_FAILURE);
+        }
+        ast->uses = uses;
+        ast->uses_capacity = capacity;
+    }
+
+    const ExpressoNode* node = &ast->nodes[index];
+    ast->share_slots[share_slot(ast, node)] = index;
+    ast->uses[index] = 0;
+    for (int i = 0; i < 3; i++) {
+        if (node->children[i] != EXPRESSO_NODE_NONE && ++ast->uses[node->children[i]] == 2) ast->shared++;
+    }
+}
+
+// Called once the node just appended is complete. With sharing on, an
+// identical stored node replaces it and its text is dropped from the pool.
+static ExpressoNodeIndex ast_finish(ExpressoAst* ast, size_t strings_size) {
+    ExpressoNodeIndex index = (ExpressoNodeIndex)(ast->count - 1);
+    if (!ast->sharing) return index;
+
+    ast->added++;
+    if (ast->share_capacity > 0) {
+        ExpressoNodeIndex existing = ast->share_slots[share_slot(ast, &ast->nodes[index])];
+        if (existing != EXPRESSO_NODE_NONE) {
+            ast->count--;
+            ast->strings_size = strings_size;
+            return existing;
+        }
+    }
+    share_insert(ast, index);
+    return index;
+}
+
+void expresso_ast_set_sharing(ExpressoAst* ast, bool enabled) {
+    if (!ast || ast->sharing == enabled) return;
+    ast->sharing = enabled;
+    if (!enabled) return;
+
+    // Nodes added before sharing was turned on are stored as they are
+    ast->added = ast->count;
+    ast->shared = 0;
+    if (ast->share_slots) {
+        memset(ast->share_slots, 0xFF, ast->share_capacity * sizeof(ExpressoNodeIndex));
+    }
+    for (size_t i = 0; i < ast->count; i++) {
+        share_insert(ast, (ExpressoNodeIndex)i);
+    }
+}
+
+void expresso_ast_sharing_stats(const ExpressoAst* ast, ExpressoSharingStats* stats) {
+    if (!stats) return;
+    bool used = ast && (ast->sharing || ast->added > 0);
+    stats->nodes_added = used ? ast->added : 0;
+    stats->nodes_stored = used ? ast->count : 0;
+    stats->shared_nodes = used ? ast->shared : 0;
+}
+
+static ExpressoNode* ast_append(ExpressoAst* ast, ExpressoNodeKind kind, ExpressoOperator op) {
+    if (ast->count == ast->capacity) {
+        size_t capacity = ast->capacity ? ast->capacity * 2 : AST_INITIAL_NODES;
+        ExpressoNode* nodes = (ExpressoNode*)realloc(ast->nodes, capacity * sizeof(ExpressoNode));
+        if (!nodes) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree nodes.\n");
+            exit(EXIT_FAILURE);
+        }
+        ast->nodes = nodes;
+        ast->capacity = capacity;
+    }
+
+    ExpressoNode* node = &ast->nodes[ast->count++];
+    node->kind = (uint8_t)kind;
+    node->op = (uint8_t)op;
+    node->children[0] = EXPRESSO_NODE_NONE;
+    node->children[1] = EXPRESSO_NODE_NONE;
+    node->children[2] = EXPRESSO_NODE_NONE;
+    node->data.integer_value = 0;
+    return node;
+}
+
+ExpressoNodeIndex expresso_ast_add_integer(ExpressoAst* ast, long long value) {
+    ast_append(ast, EXPRESSO_NODE_INTEGER, EXPRESSO_OP_NONE)->data.integer_value = value;
+    return ast_finish(ast, ast->strings_size);
+}
+
+ExpressoNodeIndex expresso_ast_add_float(ExpressoAst* ast, double value) {
+    ast_append(ast, EXPRESSO_NODE_FLOAT, EXPRESSO_OP_NONE)->data.float_value = value;
+    return ast_finish(ast, ast->strings_size);
+}
+
+ExpressoNodeIndex expresso_ast_add_character(ExpressoAst* ast, char value) {
+    ast_append(ast, EXPRESSO_NODE_CHARACTER, EXPRESSO_OP_NONE)->data.char_value = value;
+    return ast_finish(ast, ast->strings_size);
+}
+
+static ExpressoNodeIndex ast_add_text(ExpressoAst* ast, ExpressoNodeKind kind, const char* text, size_t length) {
+    size_t strings_size = ast->strings_size;
+    size_t needed = ast->strings_size + length + 1;
+    if (needed > ast->strings_capacity) {
+        size_t capacity = ast->strings_capacity ? ast->strings_capacity : AST_INITIAL_STRINGS;
+        while (capacity < needed) capacity *= 2;
+        char* strings = (char*)realloc(ast->strings, capacity);
+        if (!strings) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree strings.\n");
+            exit(EXIT_FAILURE);
+        }
+        ast->strings = strings;
+        ast->strings_capacity = capacity;
+    }
+
+    ExpressoNode* node = ast_append(ast, kind, EXPRESSO_OP_NONE);
+    node->data.text.offset = (uint32_t)ast->strings_size;
+    node->data.text.length = (uint32_t)length;
+    if (length > 0) {
+        memcpy(ast->strings + ast->strings_size, text, length);
+    }
+    ast->strings[ast->strings_size + length] = '\0';
+    ast->strings_size = needed;
+    return ast_finish(ast, strings_size);
+}
+
+ExpressoNodeIndex expresso_ast_add_string(ExpressoAst* ast, const char* text, size_t length) {
+    return ast_add_text(ast, EXPRESSO_NODE_STRING, text, length);
+}
+
+ExpressoNodeIndex expresso_ast_add_bigint(ExpressoAst* ast, const char* spelling, size_t length) {
+    return ast_add_text(ast, EXPRESSO_NODE_BIGINT, spelling, length);
+}
+
+ExpressoNodeIndex expresso_ast_add_parameter(ExpressoAst* ast, const char* name, size_t length) {
+    return ast_add_text(ast, EXPRESSO_NODE_PARAMETER, name, length);
+}
+
+ExpressoNodeIndex expresso_ast_add_unary(ExpressoAst* ast, ExpressoOperator op, ExpressoNodeIndex operand) {
+    ast_append(ast, EXPRESSO_NODE_UNARY, op)->children[0] = operand;
+    return ast_finish(ast, ast->strings_size);
+}
+
+ExpressoNodeIndex expresso_ast_add_binary(ExpressoAst* ast, ExpressoOperator op, ExpressoNodeIndex left, ExpressoNodeIndex right) {
+    ExpressoNode* node = ast_append(ast, EXPRESSO_NODE_BINARY, op);
+    node->children[0] = left;
+    node->children[1] = right;
+    return ast_finish(ast, ast->strings_size);
+}
+
+ExpressoNodeIndex expresso_ast_add_conditional(ExpressoAst* ast, ExpressoNodeIndex condition, ExpressoNodeIndex if_true, ExpressoNodeIndex if_false) {
+    ExpressoNode* node = ast_append(ast, EXPRESSO_NODE_CONDITIONAL, EXPRESSO_OP_NONE);
+    node->children[0] = condition;
+    node->children[1] = if_true;
+    node->children[2] = if_false;
+    return ast_finish(ast, ast->strings_size);
+}
+
+// Quoted literals without escapes are stored straight from the input; the
+// rest are decoded into a bounded buffer first
+#define LITERAL_BUFFER_SIZE 128
+
+static ExpressoNodeIndex ast_add_quoted(ExpressoAst* ast, ExpressoNodeKind kind, const char* text, size_t length) {
+    const char* body = text + 1;
+    size_t body_length = length >= 2 ? length - 2 : 0;
+    char buffer[LITERAL_BUFFER_SIZE];
+    char* decoded = NULL;
+
+    if (memchr(body, '\\', body_length)) {
+        decoded = body_length <= sizeof(buffer) ? buffer : (char*)malloc(body_length);
+        if (!decoded) {
+            fprintf(stderr, "Fatal Error: Memory allocation failed for literal.\n");
+            exit(EXIT_FAILURE);
+        }
+        body_length = expresso_literal_unescape(body, body_length, decoded);
+        body = decoded;
+    }
+
+    // A character literal holds exactly one character once decoded
+    ExpressoNodeIndex index = EXPRESSO_NODE_NONE;
+    if (kind == EXPRESSO_NODE_STRING) {
+        index = expresso_ast_add_string(ast, body, body_length);
+    } else if (body_length == 1) {
+        index = expresso_ast_add_character(ast, body[0]);
+    }
+
+    if (decoded && decoded != buffer) free(decoded);
+    return index;
+}
+
+ExpressoNodeIndex expresso_ast_add_literal(ExpressoAst* ast, ExpressoNodeKind kind, const char* text, size_t length) {
+    switch (kind) {
+        case EXPRESSO_NODE_INTEGER: {
+            long long value;
+            if (expresso_literal_integer(text, length, &value)) return expresso_ast_add_integer(ast, value);
+            if (!expresso_literal_is_integer(text, length)) return EXPRESSO_NODE_NONE;
+            return expresso_ast_add_bigint(ast, text, length);
+        }
+        case EXPRESSO_NODE_FLOAT: {
+            double value;
+            if (!expresso_literal_float(text, length, &value)) return EXPRESSO_NODE_NONE;
+            return expresso_ast_add_float(ast, value);
+        }
+        case EXPRESSO_NODE_CHARACTER:
+        case EXPRESSO_NODE_STRING:
+            return ast_add_quoted(ast, kind, text, length);
+        default:
+            return EXPRESSO_NODE_NONE;
+    }
+}
+
+void expresso_ast_share(const ExpressoAst* ast, ExpressoAst* shared) {
+    if (!ast || !shared) return;
+    expresso_ast_reset(shared);
+    expresso_ast_set_sharing(shared, true);
+    if (ast->root == EXPRESSO_NODE_NONE) return;
+
+    // Children come before their parents, so one pass down from the root
+    // marks what is reachable and one pass up rebuilds it
+    ExpressoNodeIndex* map = (ExpressoNodeIndex*)malloc((size_t)(ast->root + 1) * sizeof(ExpressoNodeIndex));
+    if (!map) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for expression tree sharing.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (ExpressoNodeIndex i = 0; i < ast->root; i++) map[i] = EXPRESSO_NODE_NONE;
+    map[ast->root] = 0;
+    for (ExpressoNodeIndex i = ast->root; i >= 0; i--) {
+        if (map[i] == EXPRESSO_NODE_NONE) continue;
+        for (int c = 0; c < 3; c++) {
+            if (ast->nodes[i].children[c] != EXPRESSO_NODE_NONE) map[ast->nodes[i].children[c]] = 0;
+        }
+    }
+
+    for (ExpressoNodeIndex i = 0; i <= ast->root; i++) {
+        if (map[i] == EXPRESSO_NODE_NONE) continue;
+        const ExpressoNode* node = &ast->nodes[i];
+        switch ((ExpressoNodeKind)node->kind) {
+            case EXPRESSO_NODE_INTEGER:
+                map[i] = expresso_ast_add_integer(shared, node->data.integer_value);
+                break;
+            case EXPRESSO_NODE_FLOAT:
+                map[i] = expresso_ast_add_float(shared, node->data.float_value);
+                break;
+            case EXPRESSO_NODE_CHARACTER:
+                map[i] = expresso_ast_add_character(shared, node->data.char_value);
+                break;
+            case EXPRESSO_NODE_STRING:
+                map[i] = expresso_ast_add_string(shared, expresso_ast_string(ast, node), node->data.text.length);
+                break;
+            case EXPRESSO_NODE_BIGINT:
+                map[i] = expresso_ast_add_bigint(shared, expresso_ast_string(ast, node), node->data.text.length);
+                break;
+            case EXPRESSO_NODE_PARAMETER:
+                map[i] = expresso_ast_add_parameter(shared, expresso_ast_string(ast, node), node->data.text.length);
+                break;
+            case EXPRESSO_NODE_UNARY:
+                map[i] = expresso_ast_add_unary(shared, (ExpressoOperator)node->op, map[node->children[0]]);
+                break;
+            case EXPRESSO_NODE_BINARY:
+                map[i] = expresso_ast_add_binary(shared, (ExpressoOperator)node->op,
+                                                 map[node->children[0]], map[node->children[1]]);
+                break;
+            case EXPRESSO_NODE_CONDITIONAL:
+                map[i] = expresso_ast_add_conditional(shared, map[node->children[0]],
+                                                      map[node->children[1]], map[node->children[2]]);
+                break;
+        }
+    }
+    shared->root = map[ast->root];
+    free(map);
+}
+
+bool expresso_ast_equal(const ExpressoAst* a, ExpressoNodeIndex a_index, const ExpressoAst* b, ExpressoNodeIndex b_index) {
+    if (a_index == EXPRESSO_NODE_NONE || b_index == EXPRESSO_NODE_NONE) {
+        return a_index == b_index;
+    }
+    // Shared subtrees are equal to themselves
+    if (a == b && a_index == b_index) return true;
+
+    const ExpressoNode* x = &a->nodes[a_index];
+    const ExpressoNode* y = &b->nodes[b_index];
+    if (x->kind != y->kind || x->op != y->op) return false;
+
+    switch ((ExpressoNodeKind)x->kind) {
+        case EXPRESSO_NODE_INTEGER:
+            return x->data.integer_value == y->data.integer_value;
+        case EXPRESSO_NODE_FLOAT:
+            return memcmp(&x->data.float_value, &y->data.float_value, sizeof(double)) == 0;
+        case EXPRESSO_NODE_CHARACTER:
+            return x->data.char_value == y->data.char_value;
+        case EXPRESSO_NODE_STRING:
+        case EXPRESSO_NODE_BIGINT:
+        case EXPRESSO_NODE_PARAMETER:
+            return x->data.text.length == y->data.text.length &&
+                   memcmp(expresso_ast_string(a, x), expresso_ast_string(b, y), x->data.text.length) == 0;
+        case EXPRESSO_NODE_UNARY:
+        case EXPRESSO_NODE_BINARY:
+        case EXPRESSO_NODE_CONDITIONAL:
+            for (int i = 0; i < 3; i++) {
+                if (!expresso_ast_equal(a, x->children[i], b, y->children[i])) return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+const char* expresso_ast_string(const ExpressoAst* ast, const ExpressoNode* node) {
+    if (!ast || !node || !has_text(node)) return NULL;
+    return ast->strings + node->data.text.offset;
+}
+
+const char* expresso_operator_symbol(ExpressoOperator op) {
+    switch (op) {
+        case EXPRESSO_OP_PLUS:          return "+";
+        case EXPRESSO_OP_NEGATE:        return "-";
+        case EXPRESSO_OP_LOGICAL_NOT:   return "!";
+        case EXPRESSO_OP_BITWISE_NOT:   return "~";
+        case EXPRESSO_OP_MULTIPLY:      return "*";
+        case EXPRESSO_OP_DIVIDE:        return "/";
+        case EXPRESSO_OP_MODULO:        return "%";
+        case EXPRESSO_OP_ADD:           return "+";
+        case EXPRESSO_OP_SUBTRACT:      return "-";
+        case EXPRESSO_OP_SHIFT_LEFT:    return "<<";
+        case EXPRESSO_OP_SHIFT_RIGHT:   return ">>";
+        case EXPRESSO_OP_LESS:          return "<";
+        case EXPRESSO_OP_GREATER:       return ">";
+        case EXPRESSO_OP_LESS_EQUAL:    return "<=";
+        case EXPRESSO_OP_GREATER_EQUAL: return ">=";
+        case EXPRESSO_OP_EQUAL:         return "==";
+        case EXPRESSO_OP_NOT_EQUAL:     return "!=";
+        case EXPRESSO_OP_BITWISE_AND:   return "&";
+        case EXPRESSO_OP_BITWISE_XOR:   return "^";
+        case EXPRESSO_OP_BITWISE_OR:    return "|";
+        case EXPRESSO_OP_LOGICAL_AND:   return "&&";
+        case EXPRESSO_OP_LOGICAL_OR:    return "||";
+        case EXPRESSO_OP_NONE:          break;
+    }
+    return "?";
+}
@@ -0,0 +1,216 @@
+/*
+ * Expresso
+ * ast.h
+ *
+ * Header file for the native expression tree. The ANTLR parse tree is lowered
+ * once into this compact form: a contiguous array of nodes addressed by index,
+ * each carrying an operator tag or a decoded literal payload. The tree owns all
+ * of its storage, so releasing it is a constant number of frees regardless of
+ * the size of the expression.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_AST_H
+#define EXPRESSO_AST_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h> // For size_t
+#include <stdint.h> // For fixed-width node fields
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index of a node within an ExpressoAst
+typedef int32_t ExpressoNodeIndex;
+
+#define EXPRESSO_NODE_NONE ((ExpressoNodeIndex)-1)
+
+// The kinds of node in a native expression tree
+typedef enum {
+    EXPRESSO_NODE_INTEGER,
+    EXPRESSO_NODE_FLOAT,
+    EXPRESSO_NODE_CHARACTER,
+    EXPRESSO_NODE_STRING,
+    EXPRESSO_NODE_BIGINT,      // An integer literal too large for a long long; data.text holds its spelling
+    EXPRESSO_NODE_PARAMETER,   // A named input, e.g. $price; data.text holds the name
+    EXPRESSO_NODE_UNARY,       // children[0] is the operand
+    EXPRESSO_NODE_BINARY,      // children[0] and children[1] are the operands
+    EXPRESSO_NODE_CONDITIONAL  // children[0] ? children[1] : children[2]
+} ExpressoNodeKind;
+
+// Operator tags for unary and binary nodes
+typedef enum {
+    EXPRESSO_OP_NONE,
+
+    // Unary operators
+    EXPRESSO_OP_PLUS,
+    EXPRESSO_OP_NEGATE,
+    EXPRESSO_OP_LOGICAL_NOT,
+    EXPRESSO_OP_BITWISE_NOT,
+
+    // Binary operators
+    EXPRESSO_OP_MULTIPLY,
+    EXPRESSO_OP_DIVIDE,
+    EXPRESSO_OP_MODULO,
+    EXPRESSO_OP_ADD,
+    EXPRESSO_OP_SUBTRACT,
+    EXPRESSO_OP_SHIFT_LEFT,
+    EXPRESSO_OP_SHIFT_RIGHT,
+    EXPRESSO_OP_LESS,
+    EXPRESSO_OP_GREATER,
+    EXPRESSO_OP_LESS_EQUAL,
+    EXPRESSO_OP_GREATER_EQUAL,
+    EXPRESSO_OP_EQUAL,
+    EXPRESSO_OP_NOT_EQUAL,
+    EXPRESSO_OP_BITWISE_AND,
+    EXPRESSO_OP_BITWISE_XOR,
+    EXPRESSO_OP_BITWISE_OR,
+    EXPRESSO_OP_LOGICAL_AND,
+    EXPRESSO_OP_LOGICAL_OR
+} ExpressoOperator;
+
+// A single node. Children are indices into the same tree, never pointers.
+typedef struct {
+    uint8_t kind;    // ExpressoNodeKind
+    uint8_t op;      // ExpressoOperator for unary and binary nodes
+    ExpressoNodeIndex children[3];
+    union {
+        long long integer_value;
+        double float_value;
+        char char_value;
+        struct {
+            uint32_t offset; // Into the tree's string pool
+            uint32_t length; // Excluding the terminating NUL
+        } text;
+    } data;
+} ExpressoNode;
+
+// A whole expression. Nodes are appended bottom-up, so every child index is
+// lower than its parent's; the root is recorded separately. A tree built with
+// sharing on is a DAG: structurally identical subtrees are stored once.
+typedef struct {
+    ExpressoNode* nodes;
+    size_t count;
+    size_t capacity;
+    char* strings; // Pool of NUL-terminated string payloads and parameter names
+    size_t strings_size;
+    size_t strings_capacity;
+    ExpressoNodeIndex root;
+
+    // Hash-consing state, used only while sharing is on
+    bool sharing;
+    ExpressoNodeIndex* share_slots; // Open-addressed index of the nodes by structure
+    size_t share_capacity;          // Power of two
+    uint32_t* uses;                 // Number of parents of each node
+    size_t uses_capacity;
+    size_t added;                   // Nodes requested, including those shared
+    size_t shared;                  // Nodes with more than one parent
+} ExpressoAst;
+
+// How much a tree built with sharing on saved
+typedef struct {
+    size_t nodes_added;  // Nodes requested from the builder
+    size_t nodes_stored; // Distinct nodes kept; the difference was shared
+    size_t shared_nodes; // Stored nodes used by more than one parent
+} ExpressoSharingStats;
+
+// Create an empty tree
+ExpressoAst* expresso_ast_create(void);
+
+// Free a tree and everything it owns
+void expresso_ast_destroy(ExpressoAst* ast);
+
+// Forget all nodes but keep the storage for reuse
+void expresso_ast_reset(ExpressoAst* ast);
+
+// Hash-cons the nodes added from now on: adding a node identical in kind,
+// operator, payload and children to one already stored returns the stored
+// node instead. Trees built this way must only grow, apart from a reset.
+void expresso_ast_set_sharing(ExpressoAst* ast, bool enabled);
+
+// Report the savings from sharing; all zero if sharing was never on
+void expresso_ast_sharing_stats(const ExpressoAst* ast, ExpressoSharingStats* stats);
+
+// Rebuild the part of ast reachable from its root into shared, which is
+// reset and has sharing turned on
+void expresso_ast_share(const ExpressoAst* ast, ExpressoAst* shared);
+
+// Does more than one parent use the node? Always false without sharing.
+static inline bool expresso_ast_is_shared(const ExpressoAst* ast, ExpressoNodeIndex index) {
+    return ast->shared > 0 && ast->uses[index] > 1;
+}
+
+// Append nodes; each returns the index of the new node, or of the identical
+// node already stored if sharing is on
+ExpressoNodeIndex expresso_ast_add_integer(ExpressoAst* ast, long long value);
+ExpressoNodeIndex expresso_ast_add_float(ExpressoAst* ast, double value);
+ExpressoNodeIndex expresso_ast_add_character(ExpressoAst* ast, char value);
+ExpressoNodeIndex expresso_ast_add_string(ExpressoAst* ast, const char* text, size_t length);
+ExpressoNodeIndex expresso_ast_add_bigint(ExpressoAst* ast, const char* spelling, size_t length); // Decimal or "0x" hex digits
+ExpressoNodeIndex expresso_ast_add_parameter(ExpressoAst* ast, const char* name, size_t length); // name excludes the '$'
+ExpressoNodeIndex expresso_ast_add_unary(ExpressoAst* ast, ExpressoOperator op, ExpressoNodeIndex operand);
+ExpressoNodeIndex expresso_ast_add_binary(ExpressoAst* ast, ExpressoOperator op, ExpressoNodeIndex left, ExpressoNodeIndex right);
+ExpressoNodeIndex expresso_ast_add_conditional(ExpressoAst* ast, ExpressoNodeIndex condition, ExpressoNodeIndex if_true, ExpressoNodeIndex if_false);
+
+// Append a literal node decoded from its source spelling, e.g. "0x1F", "'a'"
+// or "\"text\"" with the quotes. kind must be one of the literal node kinds.
+// Both parser backends decode through this so their trees agree. An integer
+// literal too large for a long long becomes an EXPRESSO_NODE_BIGINT. Returns
+// EXPRESSO_NODE_NONE if a character literal does not hold one character.
+ExpressoNodeIndex expresso_ast_add_literal(ExpressoAst* ast, ExpressoNodeKind kind, const char* text, size_t length);
+
+// Compare two subtrees, possibly of different trees, for structural equality
+bool expresso_ast_equal(const ExpressoAst* a, ExpressoNodeIndex a_index, const ExpressoAst* b, ExpressoNodeIndex b_index);
+
+// Get the NUL-terminated payload of a string node, spelling of a big integer
+// node or name of a parameter node
+const char* expresso_ast_string(const ExpressoAst* ast, const ExpressoNode* node);
+
+// Get the source spelling of an operator (e.g. "<<"), or "?" if unknown
+const char* expresso_operator_symbol(ExpressoOperator op);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_AST_H
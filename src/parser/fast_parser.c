@@ -0,0 +1,431 @@
+/*
+ * Expresso
+ * fast_parser.c
+ *
+ * The hand-written parser backend. A small lexer mirrors the token rules of
+ * Expresso.g4 (longest match, whitespace skipped) and a precedence-climbing
+ * parser consumes one token of lookahead, descending once per operand rather
+ * than once per grammar rule, so a literal costs one call instead of fifteen.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "fast_parser.h"
+#include <string.h>
+
+typedef enum {
+    TOKEN_END,
+    TOKEN_INTEGER,
+    TOKEN_FLOAT,
+    TOKEN_CHARACTER,
+    TOKEN_STRING,
+    TOKEN_PARAMETER,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+    TOKEN_QUESTION,
+    TOKEN_COLON,
+    TOKEN_PIPE,
+    TOKEN_AND_AND,
+    TOKEN_AMPERSAND,
+    TOKEN_CARET,
+    TOKEN_EQUAL_EQUAL,
+    TOKEN_NOT_EQUAL,
+    TOKEN_LESS,
+    TOKEN_GREATER,
+    TOKEN_LESS_EQUAL,
+    TOKEN_GREATER_EQUAL,
+    TOKEN_SHIFT_LEFT,
+    TOKEN_SHIFT_RIGHT,
+    TOKEN_PLUS,
+    TOKEN_MINUS,
+    TOKEN_STAR,
+    TOKEN_SLASH,
+    TOKEN_PERCENT,
+    TOKEN_BANG,
+    TOKEN_TILDE,
+    TOKEN_INVALID
+} TokenType;
+
+typedef struct {
+    TokenType type;
+    size_t start;
+    size_t length;
+} Token;
+
+typedef struct {
+    const char* input;
+    size_t position;    // Lexer position, just past the current token
+    Token current;
+    Token next;         // One extra token, needed to recognise '|' '|'
+    int depth;
+    ExpressoAst* ast;
+    ExpressoSyntaxError error;
+} Parser;
+
+// Binding power of binary operators, lowest first, as in Expresso.g4
+enum {
+    PRECEDENCE_NONE,
+    PRECEDENCE_LOGICAL_OR,
+    PRECEDENCE_LOGICAL_AND,
+    PRECEDENCE_BITWISE_OR,
+    PRECEDENCE_BITWISE_XOR,
+    PRECEDENCE_BITWISE_AND,
+    PRECEDENCE_EQUALITY,
+    PRECEDENCE_RELATIONAL,
+    PRECEDENCE_SHIFT,
+    PRECEDENCE_ADDITIVE,
+    PRECEDENCE_MULTIPLICATIVE
+};
+
+// --- Lexer ---
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+static bool is_identifier_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_hex_digit(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// IntegerLiteral: [0-9]+ | '0x'[0-9a-fA-F]+
+// FloatingLiteral: [0-9]* '.' [0-9]+
+// The longest of the alternatives wins, as in the ANTLR lexer.
+static TokenType scan_number(const char* s, size_t* length) {
+    size_t decimal = 0;
+    while (is_digit(s[decimal])) decimal++;
+
+    size_t hex = 0;
+    if (s[0] == '0' && s[1] == 'x' && is_hex_digit(s[2])) {
+        hex = 3;
+        while (is_hex_digit(s[hex])) hex++;
+    }
+
+    size_t fraction = 0;
+    if (s[decimal] == '.' && is_digit(s[decimal + 1])) {
+        fraction = decimal + 2;
+        while (is_digit(s[fraction])) fraction++;
+    }
+
+    if (fraction > hex && fraction > decimal) {
+        *length = fraction;
+        return TOKEN_FLOAT;
+    }
+    if (hex > decimal) {
+        *length = hex;
+        return TOKEN_INTEGER;
+    }
+    *length = decimal;
+    return decimal > 0 ? TOKEN_INTEGER : TOKEN_INVALID;
+}
+
+// CharacterLiteral: '\'' (~['\\] | '\\' .)* '\''
+// StringLiteral:    '"' (~["\\] | '\\' .)* '"'
+static TokenType scan_quoted(const char* s, size_t* length) {
+    char quote = s[0];
+    size_t i = 1;
+
+    while (s[i] != '\0' && s[i] != quote) {
+        if (s[i] == '\\') {
+            if (s[i + 1] == '\0') return TOKEN_INVALID;
+            i++;
+        }
+        i++;
+    }
+    if (s[i] != quote) return TOKEN_INVALID;
+
+    *length = i + 1;
+    return quote == '"' ? TOKEN_STRING : TOKEN_CHARACTER;
+}
+
+static Token scan_token(Parser* parser) {
+    const char* input = parser->input;
+    size_t p = parser->position;
+
+    // WS: [ \t\n\r]+ -> skip
+    while (input[p] == ' ' || input[p] == '\t' || input[p] == '\n' || input[p] == '\r') p++;
+
+    Token token = { TOKEN_INVALID, p, 1 };
+    const char* s = input + p;
+    char c = s[0];
+
+    switch (c) {
+        case '\0': token.type = TOKEN_END; token.length = 0; break;
+        case '(': token.type = TOKEN_LPAREN; break;
+        case ')': token.type = TOKEN_RPAREN; break;
+        case '?': token.type = TOKEN_QUESTION; break;
+        case ':': token.type = TOKEN_COLON; break;
+        case '|': token.type = TOKEN_PIPE; break;
+        case '^': token.type = TOKEN_CARET; break;
+        case '+': token.type = TOKEN_PLUS; break;
+        case '-': token.type = TOKEN_MINUS; break;
+        case '*': token.type = TOKEN_STAR; break;
+        case '/': token.type = TOKEN_SLASH; break;
+        case '%': token.type = TOKEN_PERCENT; break;
+        case '~': token.type = TOKEN_TILDE; break;
+        case '&':
+            if (s[1] == '&') { token.type = TOKEN_AND_AND; token.length = 2; }
+            else token.type = TOKEN_AMPERSAND;
+            break;
+        case '=':
+            if (s[1] == '=') { token.type = TOKEN_EQUAL_EQUAL; token.length = 2; }
+            break;
+        case '!':
+            if (s[1] == '=') { token.type = TOKEN_NOT_EQUAL; token.length = 2; }
+            else token.type = TOKEN_BANG;
+            break;
+        case '<':
+            if (s[1] == '<') { token.type = TOKEN_SHIFT_LEFT; token.length = 2; }
+            else if (s[1] == '=') { token.type = TOKEN_LESS_EQUAL; token.length = 2; }
+            else token.type = TOKEN_LESS;
+            break;
+        case '>':
+            if (s[1] == '>') { token.type = TOKEN_SHIFT_RIGHT; token.length = 2; }
+            else if (s[1] == '=') { token.type = TOKEN_GREATER_EQUAL; token.length = 2; }
+            else token.type = TOKEN_GREATER;
+            break;
+        case '\'':
+        case '"':
+            token.type = scan_quoted(s, &token.length);
+            break;
+        case '$':
+            // Parameter: '$' [a-zA-Z_] [a-zA-Z_0-9]*
+            if (is_identifier_start(s[1])) {
+                size_t i = 2;
+                while (is_identifier_start(s[i]) || is_digit(s[i])) i++;
+                token.type = TOKEN_PARAMETER;
+                token.length = i;
+            }
+            break;
+        default:
+            if (is_digit(c) || c == '.') {
+                token.type = scan_number(s, &token.length);
+            }
+            break;
+    }
+
+    parser->position = p + token.length;
+    return token;
+}
+
+static void advance(Parser* parser) {
+    parser->current = parser->next;
+    parser->next = scan_token(parser);
+}
+
+// --- Parser ---
+
+static ExpressoNodeIndex fail(Parser* parser, ExpressoErrorCode code) {
+    if (parser->error.code == EXPRESSO_ERROR_NONE) {
+        parser->error.code = parser->current.type == TOKEN_INVALID ? EXPRESSO_ERROR_UNRECOGNISED_TOKEN : code;
+        parser->error.message = expresso_error_message(parser->error.code);
+        parser->error.position = parser->current.start;
+        parser->error.length = parser->current.length;
+    }
+    return EXPRESSO_NODE_NONE;
+}
+
+static ExpressoNodeIndex parse_conditional(Parser* parser);
+
+// Binary operator and binding power of the current token. '|' '|' is the
+// logical-or operator and is reported with a width of two tokens.
+static int binary_operator(const Parser* parser, ExpressoOperator* op, int* tokens) {
+    *tokens = 1;
+    switch (parser->current.type) {
+        case TOKEN_PIPE:
+            if (parser->next.type == TOKEN_PIPE) {
+                *op = EXPRESSO_OP_LOGICAL_OR;
+                *tokens = 2;
+                return PRECEDENCE_LOGICAL_OR;
+            }
+            *op = EXPRESSO_OP_BITWISE_OR;
+            return PRECEDENCE_BITWISE_OR;
+        case TOKEN_AND_AND:       *op = EXPRESSO_OP_LOGICAL_AND;   return PRECEDENCE_LOGICAL_AND;
+        case TOKEN_CARET:         *op = EXPRESSO_OP_BITWISE_XOR;   return PRECEDENCE_BITWISE_XOR;
+        case TOKEN_AMPERSAND:     *op = EXPRESSO_OP_BITWISE_AND;   return PRECEDENCE_BITWISE_AND;
+        case TOKEN_EQUAL_EQUAL:   *op = EXPRESSO_OP_EQUAL;         return PRECEDENCE_EQUALITY;
+        case TOKEN_NOT_EQUAL:     *op = EXPRESSO_OP_NOT_EQUAL;     return PRECEDENCE_EQUALITY;
+        case TOKEN_LESS:          *op = EXPRESSO_OP_LESS;          return PRECEDENCE_RELATIONAL;
+        case TOKEN_GREATER:       *op = EXPRESSO_OP_GREATER;       return PRECEDENCE_RELATIONAL;
+        case TOKEN_LESS_EQUAL:    *op = EXPRESSO_OP_LESS_EQUAL;    return PRECEDENCE_RELATIONAL;
+        case TOKEN_GREATER_EQUAL: *op = EXPRESSO_OP_GREATER_EQUAL; return PRECEDENCE_RELATIONAL;
+        case TOKEN_SHIFT_LEFT:    *op = EXPRESSO_OP_SHIFT_LEFT;    return PRECEDENCE_SHIFT;
+        case TOKEN_SHIFT_RIGHT:   *op = EXPRESSO_OP_SHIFT_RIGHT;   return PRECEDENCE_SHIFT;
+        case TOKEN_PLUS:          *op = EXPRESSO_OP_ADD;           return PRECEDENCE_ADDITIVE;
+        case TOKEN_MINUS:         *op = EXPRESSO_OP_SUBTRACT;      return PRECEDENCE_ADDITIVE;
+        case TOKEN_STAR:          *op = EXPRESSO_OP_MULTIPLY;      return PRECEDENCE_MULTIPLICATIVE;
+        case TOKEN_SLASH:         *op = EXPRESSO_OP_DIVIDE;        return PRECEDENCE_MULTIPLICATIVE;
+        case TOKEN_PERCENT:       *op = EXPRESSO_OP_MODULO;        return PRECEDENCE_MULTIPLICATIVE;
+        default:
+            *op = EXPRESSO_OP_NONE;
+            return PRECEDENCE_NONE;
+    }
+}
+
+static ExpressoNodeIndex parse_primary(Parser* parser) {
+    Token token = parser->current;
+    ExpressoNodeKind kind;
+
+    switch (token.type) {
+        case TOKEN_INTEGER:   kind = EXPRESSO_NODE_INTEGER; break;
+        case TOKEN_FLOAT:     kind = EXPRESSO_NODE_FLOAT; break;
+        case TOKEN_CHARACTER: kind = EXPRESSO_NODE_CHARACTER; break;
+        case TOKEN_STRING:    kind = EXPRESSO_NODE_STRING; break;
+        case TOKEN_LPAREN: {
+            advance(parser);
+            ExpressoNodeIndex inner = parse_conditional(parser);
+            if (inner == EXPRESSO_NODE_NONE) return inner;
+            if (parser->current.type != TOKEN_RPAREN) return fail(parser, EXPRESSO_ERROR_EXPECTED_RPAREN);
+            advance(parser);
+            return inner;
+        }
+        case TOKEN_PARAMETER:
+            advance(parser);
+            return expresso_ast_add_parameter(parser->ast, parser->input + token.start + 1, token.length - 1);
+        default:
+            return fail(parser, EXPRESSO_ERROR_EXPECTED_EXPRESSION);
+    }
+
+    ExpressoNodeIndex literal = expresso_ast_add_literal(parser->ast, kind, parser->input + token.start, token.length);
+    // Lexed numbers always decode; only a character literal can be rejected
+    if (literal == EXPRESSO_NODE_NONE) return fail(parser, EXPRESSO_ERROR_CHARACTER_LITERAL);
+    advance(parser);
+    return literal;
+}
+
+static ExpressoNodeIndex parse_unary(Parser* parser) {
+    ExpressoOperator op;
+    switch (parser->current.type) {
+        case TOKEN_BANG:  op = EXPRESSO_OP_LOGICAL_NOT; break;
+        case TOKEN_TILDE: op = EXPRESSO_OP_BITWISE_NOT; break;
+        case TOKEN_PLUS:  op = EXPRESSO_OP_PLUS; break;
+        case TOKEN_MINUS: op = EXPRESSO_OP_NEGATE; break;
+        default:
+            return parse_primary(parser);
+    }
+
+    if (++parser->depth > EXPRESSO_FAST_PARSER_MAX_DEPTH) return fail(parser, EXPRESSO_ERROR_PARSE_TOO_DEEP);
+    advance(parser);
+    ExpressoNodeIndex operand = parse_unary(parser);
+    parser->depth--;
+    if (operand == EXPRESSO_NODE_NONE) return operand;
+    return expresso_ast_add_unary(parser->ast, op, operand);
+}
+
+// Parse operands joined by operators binding at least as tightly as
+// min_precedence. Every level is left-associative except bitwise or, which
+// Expresso.g4 writes right-recursively; like nesting, each '|' in a chain
+// counts against the maximum depth.
+static ExpressoNodeIndex parse_binary(Parser* parser, int min_precedence) {
+    ExpressoNodeIndex left = parse_unary(parser);
+
+    while (left != EXPRESSO_NODE_NONE) {
+        ExpressoOperator op;
+        int tokens;
+        int precedence = binary_operator(parser, &op, &tokens);
+        if (precedence == PRECEDENCE_NONE || precedence < min_precedence) break;
+
+        while (tokens-- > 0) advance(parser);
+        ExpressoNodeIndex right;
+        if (precedence == PRECEDENCE_BITWISE_OR) {
+            if (++parser->depth > EXPRESSO_FAST_PARSER_MAX_DEPTH) return fail(parser, EXPRESSO_ERROR_PARSE_TOO_DEEP);
+            right = parse_binary(parser, precedence);
+            parser->depth--;
+        } else {
+            right = parse_binary(parser, precedence + 1);
+        }
+        if (right == EXPRESSO_NODE_NONE) return right;
+        left = expresso_ast_add_binary(parser->ast, op, left, right);
+    }
+    return left;
+}
+
+// conditionalExpression: logicalOrExpression ('?' expression ':' conditionalExpression)?
+static ExpressoNodeIndex parse_conditional(Parser* parser) {
+    if (++parser->depth > EXPRESSO_FAST_PARSER_MAX_DEPTH) return fail(parser, EXPRESSO_ERROR_PARSE_TOO_DEEP);
+
+    ExpressoNodeIndex result = parse_binary(parser, PRECEDENCE_LOGICAL_OR);
+    if (result != EXPRESSO_NODE_NONE && parser->current.type == TOKEN_QUESTION) {
+        advance(parser);
+        ExpressoNodeIndex if_true = parse_conditional(parser);
+        if (if_true == EXPRESSO_NODE_NONE) return if_true;
+        if (parser->current.type != TOKEN_COLON) return fail(parser, EXPRESSO_ERROR_EXPECTED_COLON);
+        advance(parser);
+        ExpressoNodeIndex if_false = parse_conditional(parser);
+        if (if_false == EXPRESSO_NODE_NONE) return if_false;
+        result = expresso_ast_add_conditional(parser->ast, result, if_true, if_false);
+    }
+
+    parser->depth--;
+    return result;
+}
+
+bool expresso_fast_parse(const char* expression_str, ExpressoAst* ast, ExpressoSyntaxError* error) {
+    Parser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.input = expression_str ? expression_str : "";
+    parser.ast = ast;
+
+    expresso_ast_reset(ast);
+    parser.current = scan_token(&parser);
+    parser.next = scan_token(&parser);
+
+    ExpressoNodeIndex root = parse_conditional(&parser);
+    if (root != EXPRESSO_NODE_NONE && parser.current.type != TOKEN_END) {
+        root = fail(&parser, EXPRESSO_ERROR_UNEXPECTED_INPUT);
+    }
+
+    if (root == EXPRESSO_NODE_NONE) {
+        expresso_ast_reset(ast);
+        if (error) *error = parser.error;
+        return false;
+    }
+
+    ast->root = root;
+    if (error) {
+        error->code = EXPRESSO_ERROR_NONE;
+        error->message = NULL;
+        error->position = 0;
+        error->length = 0;
+    }
+    return true;
+}
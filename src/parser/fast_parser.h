@@ -0,0 +1,85 @@
+/*
+ * Expresso
+ * fast_parser.h
+ *
+ * Header file for the hand-written parser backend. It recognises the grammar
+ * in Expresso.g4 with a single-pass precedence-climbing (Pratt) parser and
+ * builds the native expression tree directly, without the ANTLR runtime.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef EXPRESSO_FAST_PARSER_H
+#define EXPRESSO_FAST_PARSER_H
+
+#include <stdbool.h> // For bool
+#include <stddef.h>  // For size_t
+#include "ast.h"
+#include "errors.h" // For ExpressoErrorCode
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum nesting of unary operators, parentheses, conditionals and '|'
+// chains before the parser gives up rather than exhausting the native stack
+#define EXPRESSO_FAST_PARSER_MAX_DEPTH 4096
+
+// Description of a syntax error
+typedef struct {
+    ExpressoErrorCode code;
+    const char* message; // Static string from the catalogue, never freed
+    size_t position;     // Byte offset into the input
+    size_t length;       // Bytes of the offending token
+} ExpressoSyntaxError;
+
+// Parse expression_str into ast, replacing its previous contents. Trees are
+// identical to those lowered from the ANTLR parse. Unlike the ANTLR start
+// rule, which stops at the end of the first complete expression, any input
+// left after the expression is a syntax error.
+// Returns true on success; on failure fills error (if not NULL).
+bool expresso_fast_parse(const char* expression_str, ExpressoAst* ast, ExpressoSyntaxError* error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_FAST_PARSER_H
@@ -0,0 +1,549 @@
+/*
+ * Expresso
+ * literal.c
+ *
+ * Implementation of the literal decoder. Floats take the first of three paths
+ * that applies: an exact computation in double arithmetic when the digits and
+ * the power of ten are both exactly representable (Clinger's fast path), the
+ * Eisel-Lemire algorithm with a 128-bit power-of-five table, and a decimal
+ * shift conversion for the rare inputs with more than 19 significant digits
+ * whose rounding the 19-digit prefix cannot decide.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "literal.h"
+#include "literal_powers.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BIAS 1023
+#define DOUBLE_INFINITE_POWER 0x7FF
+#define DOUBLE_INFINITY_BITS ((uint64_t)DOUBLE_INFINITE_POWER << DOUBLE_MANTISSA_BITS)
+
+// Digits a uint64_t always holds without overflow
+#define MAX_EXACT_DIGITS 19
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Hex digit values plus one, so that zero marks a non-digit
+static const uint8_t hex_values[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
+static inline int hex_digit(char c) {
+    return hex_values[(unsigned char)c] - 1;
+}
+
+// --- Digit runs ---
+
+// Eight ASCII digits are checked and converted with a few multiplies on a
+// little-endian word; other targets take the digits one at a time.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LITERAL_SWAR 1
+
+static inline uint64_t load_eight(const char* s) {
+    uint64_t word;
+    memcpy(&word, s, sizeof(word));
+    return word;
+}
+
+static inline bool eight_digits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static inline uint64_t eight_digits_value(uint64_t word) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    word -= 0x3030303030303030ULL;
+    word = word * 10 + (word >> 8);
+    return (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+}
+#else
+#define LITERAL_SWAR 0
+#endif
+
+// Accumulate the digits at s into *value until a non-digit, the end, or
+// room for `limit` digits runs out. Returns the number of digits taken.
+static size_t take_digits(const char* s, size_t length, size_t limit, uint64_t* value) {
+    size_t i = 0;
+    if (limit > length) limit = length;
+#if LITERAL_SWAR
+    while (limit - i >= 8 && eight_digits(load_eight(s + i))) {
+        *value = *value * 100000000 + eight_digits_value(load_eight(s + i));
+        i += 8;
+    }
+#endif
+    while (i < limit && is_digit(s[i])) {
+        *value = *value * 10 + (uint64_t)(s[i] - '0');
+        i++;
+    }
+    return i;
+}
+
+// --- Integers ---
+
+static bool decode_hex(const char* text, size_t length, long long* value) {
+    size_t i = 0;
+    while (i < length && text[i] == '0') i++;
+    if (length - i > 16) return false;
+
+    uint64_t bits = 0;
+    for (; i < length; i++) {
+        int digit = hex_digit(text[i]);
+        if (digit < 0) return false;
+        bits = bits << 4 | (uint64_t)digit;
+    }
+    if (bits > (uint64_t)LLONG_MAX) return false;
+    *value = (long long)bits;
+    return true;
+}
+
+bool expresso_literal_is_integer(const char* text, size_t length) {
+    bool hex = length > 2 && text[0] == '0' && text[1] == 'x';
+    size_t i = hex ? 2 : 0;
+    if (i == length) return false;
+    for (; i < length; i++) {
+        if (hex ? hex_digit(text[i]) < 0 : !is_digit(text[i])) return false;
+    }
+    return true;
+}
+
+bool expresso_literal_integer(const char* text, size_t length, long long* value) {
+    if (length > 2 && text[0] == '0' && text[1] == 'x') {
+        return decode_hex(text + 2, length - 2, value);
+    }
+    if (length == 0) return false;
+
+    size_t i = 0;
+    while (i < length && text[i] == '0') i++;
+    if (length - i > MAX_EXACT_DIGITS) return false;
+
+    uint64_t magnitude = 0;
+    if (i + take_digits(text + i, length - i, MAX_EXACT_DIGITS, &magnitude) != length) return false;
+    if (magnitude > (uint64_t)LLONG_MAX) return false;
+    *value = (long long)magnitude;
+    return true;
+}
+
+// --- Floats: Clinger's fast path ---
+
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// w and 10^|q| are both exact doubles, so one correctly rounded IEEE
+// operation gives the correctly rounded result
+static bool clinger(uint64_t w, int64_t q, double* value) {
+    if (w > (1ULL << 53) || q < -22 || q > 22) return false;
+    double d = (double)w;
+    *value = q < 0 ? d / exact_powers_of_ten[-q] : d * exact_powers_of_ten[q];
+    return true;
+}
+
+// --- Floats: Eisel-Lemire ---
+
+// The bits of the double nearest w * 10^q, for w != 0 with at most 19
+// digits. The 128-bit product of w and the truncated power of five is
+// always close enough to decide the rounding (Mushtak and Lemire, "Fast
+// Number Parsing Without Fallback").
+static uint64_t eisel_lemire(uint64_t w, int64_t q) {
+    if (q < LITERAL_SMALLEST_POWER_OF_FIVE) return 0;
+    if (q > LITERAL_LARGEST_POWER_OF_FIVE) return DOUBLE_INFINITY_BITS;
+
+    int leading_zeros = __builtin_clzll(w);
+    w <<= leading_zeros;
+
+    // The top 55 bits of the product decide the result. Only when all the
+    // bits below them are ones can the lower half of the power carry in.
+    const uint64_t* power = literal_powers_of_five[q - LITERAL_SMALLEST_POWER_OF_FIVE];
+    unsigned __int128 product = (unsigned __int128)w * power[0];
+    uint64_t high = (uint64_t)(product >> 64);
+    uint64_t low = (uint64_t)product;
+    const uint64_t precision_mask = UINT64_MAX >> (DOUBLE_MANTISSA_BITS + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64_t carry = (uint64_t)(((unsigned __int128)w * power[1]) >> 64);
+        low += carry;
+        if (carry > low) high++;
+    }
+
+    int upper_bit = (int)(high >> 63);
+    int shift = upper_bit + 64 - DOUBLE_MANTISSA_BITS - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(q * log2(10)) + 63, exact over the table's range
+    int32_t power2 = (int32_t)(((((152170 + 65536) * q) >> 16) + 63) + upper_bit - leading_zeros + DOUBLE_EXPONENT_BIAS);
+
+    if (power2 <= 0) {
+        // Subnormal: shift into place and round. Decimal inputs this small
+        // are never exactly halfway between two doubles.
+        if (-power2 + 1 >= 64) return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (1ULL << DOUBLE_MANTISSA_BITS) ? 0 : 1;
+        return mantissa | (uint64_t)power2 << DOUBLE_MANTISSA_BITS;
+    }
+
+    // Round half up, except that an exact tie rounds to even. Ties are
+    // only possible for the small powers where the product is exact.
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high) {
+        mantissa &= ~1ULL;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << DOUBLE_MANTISSA_BITS)) {
+        mantissa = 1ULL << DOUBLE_MANTISSA_BITS;
+        power2++;
+    }
+    mantissa &= ~(1ULL << DOUBLE_MANTISSA_BITS);
+    if (power2 >= DOUBLE_INFINITE_POWER) return DOUBLE_INFINITY_BITS;
+    return mantissa | (uint64_t)power2 << DOUBLE_MANTISSA_BITS;
+}
+
+// --- Floats: decimal shift conversion ---
+
+// Enough digits to decide the rounding of any double: halfway points
+// between subnormals have 767 significant digits
+#define DECIMAL_DIGITS 800
+#define DECIMAL_MAX_SHIFT 60
+
+// The value 0.d1d2d3... * 10^point, digits stored as 0-9. truncated records
+// nonzero digits dropped beyond the capacity.
+typedef struct {
+    int count;
+    int point;
+    bool truncated;
+    uint8_t digits[DECIMAL_DIGITS];
+} Decimal;
+
+static void decimal_trim(Decimal* d) {
+    while (d->count > 0 && d->digits[d->count - 1] == 0) d->count--;
+    if (d->count == 0) d->point = 0;
+}
+
+static void decimal_parse(Decimal* d, const char* text, size_t length) {
+    d->count = 0;
+    d->point = 0;
+    d->truncated = false;
+
+    size_t i = 0;
+    while (i < length && text[i] == '0') i++;
+    for (; i < length && text[i] != '.'; i++) {
+        if (d->count < DECIMAL_DIGITS) d->digits[d->count++] = (uint8_t)(text[i] - '0');
+        else if (text[i] != '0') d->truncated = true;
+        d->point++;
+    }
+    for (i++; i < length; i++) {
+        if (d->count == 0 && text[i] == '0') {
+            d->point--;
+            continue;
+        }
+        if (d->count < DECIMAL_DIGITS) d->digits[d->count++] = (uint8_t)(text[i] - '0');
+        else if (text[i] != '0') d->truncated = true;
+    }
+    decimal_trim(d);
+}
+
+// Divide by 2^k, k <= DECIMAL_MAX_SHIFT
+static void decimal_shift_right(Decimal* d, unsigned k) {
+    int read = 0;
+    int write = 0;
+    uint64_t n = 0;
+
+    // Skip the leading digits that leave a zero quotient
+    for (; (n >> k) == 0; read++) {
+        if (read >= d->count) {
+            if (n == 0) {
+                d->count = 0;
+                d->point = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                read++;
+            }
+            break;
+        }
+        n = n * 10 + d->digits[read];
+    }
+    d->point -= read - 1;
+
+    uint64_t mask = (1ULL << k) - 1;
+    for (; read < d->count; read++) {
+        d->digits[write++] = (uint8_t)(n >> k);
+        n = (n & mask) * 10 + d->digits[read];
+    }
+    while (n > 0) {
+        uint8_t digit = (uint8_t)(n >> k);
+        n = (n & mask) * 10;
+        if (write < DECIMAL_DIGITS) d->digits[write++] = digit;
+        else if (digit > 0) d->truncated = true;
+    }
+    d->count = write;
+    decimal_trim(d);
+}
+
+// Multiply by 2^k, k <= DECIMAL_MAX_SHIFT. The product is formed from the
+// least significant digit up, so it is built reversed and copied back.
+static void decimal_shift_left(Decimal* d, unsigned k) {
+    uint8_t reversed[DECIMAL_DIGITS + 20];
+    int produced = 0;
+    uint64_t n = 0;
+
+    for (int read = d->count - 1; read >= 0; read--) {
+        n += (uint64_t)d->digits[read] << k;
+        reversed[produced++] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+    while (n > 0) {
+        reversed[produced++] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+
+    d->point += produced - d->count;
+    int write = 0;
+    for (int read = produced - 1; read >= 0; read--) {
+        if (write < DECIMAL_DIGITS) d->digits[write++] = reversed[read];
+        else if (reversed[read] != 0) d->truncated = true;
+    }
+    d->count = write;
+    decimal_trim(d);
+}
+
+// Multiply by 2^k, or divide for negative k
+static void decimal_shift(Decimal* d, int k) {
+    for (; k > DECIMAL_MAX_SHIFT; k -= DECIMAL_MAX_SHIFT) decimal_shift_left(d, DECIMAL_MAX_SHIFT);
+    for (; k < -DECIMAL_MAX_SHIFT; k += DECIMAL_MAX_SHIFT) decimal_shift_right(d, DECIMAL_MAX_SHIFT);
+    if (k > 0) decimal_shift_left(d, (unsigned)k);
+    if (k < 0) decimal_shift_right(d, (unsigned)-k);
+}
+
+// The integer part, rounded half to even on the digits after the point
+static uint64_t decimal_rounded_integer(const Decimal* d) {
+    if (d->point > 20) return UINT64_MAX;
+    uint64_t n = 0;
+    int i = 0;
+    for (; i < d->point && i < d->count; i++) n = n * 10 + d->digits[i];
+    for (; i < d->point; i++) n *= 10;
+
+    int next = d->point;
+    if (next >= 0 && next < d->count) {
+        bool round_up;
+        if (d->digits[next] == 5 && next + 1 == d->count) {
+            round_up = d->truncated || (next > 0 && d->digits[next - 1] % 2 == 1);
+        } else {
+            round_up = d->digits[next] >= 5;
+        }
+        if (round_up) n++;
+    }
+    return n;
+}
+
+// Scale by powers of two into [1/2, 1), then shift the 53 mantissa bits in
+// front of the point and round
+static uint64_t decimal_to_bits(Decimal* d) {
+    // Shifts that move the point at least one place per step
+    static const int point_shifts[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    const int step_count = (int)(sizeof(point_shifts) / sizeof(point_shifts[0]));
+
+    if (d->count == 0) return 0;
+    if (d->point > 310) return DOUBLE_INFINITY_BITS;
+    if (d->point < -330) return 0;
+
+    int exponent = 0;
+    while (d->point > 0) {
+        int n = d->point >= step_count ? 27 : point_shifts[d->point];
+        decimal_shift(d, -n);
+        exponent += n;
+    }
+    while (d->point < 0 || (d->point == 0 && d->digits[0] < 5)) {
+        int n = -d->point >= step_count ? 27 : point_shifts[-d->point];
+        decimal_shift(d, n);
+        exponent -= n;
+    }
+
+    // [1/2, 1) to the [1, 2) of a normal mantissa
+    exponent--;
+    if (exponent < 1 - DOUBLE_EXPONENT_BIAS) {
+        int n = 1 - DOUBLE_EXPONENT_BIAS - exponent;
+        decimal_shift(d, -n);
+        exponent += n;
+    }
+    if (exponent + DOUBLE_EXPONENT_BIAS >= DOUBLE_INFINITE_POWER) return DOUBLE_INFINITY_BITS;
+
+    decimal_shift(d, DOUBLE_MANTISSA_BITS + 1);
+    uint64_t mantissa = decimal_rounded_integer(d);
+    if (mantissa == (2ULL << DOUBLE_MANTISSA_BITS)) {
+        mantissa >>= 1;
+        exponent++;
+        if (exponent + DOUBLE_EXPONENT_BIAS >= DOUBLE_INFINITE_POWER) return DOUBLE_INFINITY_BITS;
+    }
+    if ((mantissa & (1ULL << DOUBLE_MANTISSA_BITS)) == 0) exponent = -DOUBLE_EXPONENT_BIAS;
+
+    return (mantissa & ((1ULL << DOUBLE_MANTISSA_BITS) - 1)) |
+           (uint64_t)(exponent + DOUBLE_EXPONENT_BIAS) << DOUBLE_MANTISSA_BITS;
+}
+
+// --- Floats ---
+
+static double from_bits(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool expresso_literal_float(const char* text, size_t length, double* value) {
+    // Up to 19 significant digits go into w, the rest only into the exponent
+    // q and the truncated flag, so the literal is w * 10^q or a little more
+    uint64_t w = 0;
+    int64_t q = 0;
+    size_t digits = 0;
+    bool truncated = false;
+
+    size_t i = 0;
+    while (i < length && text[i] == '0') i++;
+    digits = take_digits(text + i, length - i, MAX_EXACT_DIGITS, &w);
+    i += digits;
+    for (; i < length && is_digit(text[i]); i++) {
+        truncated |= text[i] != '0';
+        q++;
+    }
+    bool whole = i > 0;
+
+    if (i < length && text[i] == '.') {
+        size_t start = ++i;
+        if (digits == 0) {
+            while (i < length && text[i] == '0') i++;
+        }
+        size_t taken = take_digits(text + i, length - i, MAX_EXACT_DIGITS - digits, &w);
+        i += taken;
+        digits += taken;
+        q -= (int64_t)(i - start);
+        for (; i < length && is_digit(text[i]); i++) {
+            truncated |= text[i] != '0';
+        }
+        if (i == start) return false;
+    } else if (!whole) {
+        return false;
+    }
+    if (i != length) return false;
+
+    if (w == 0) {
+        *value = 0.0;
+        return true;
+    }
+    if (!truncated) {
+        if (!clinger(w, q, value)) *value = from_bits(eisel_lemire(w, q));
+        return true;
+    }
+
+    // The literal lies strictly between w * 10^q and (w + 1) * 10^q; when
+    // both round the same way so does the literal
+    uint64_t bits = eisel_lemire(w, q);
+    if (bits == eisel_lemire(w + 1, q)) {
+        *value = from_bits(bits);
+        return true;
+    }
+
+    Decimal decimal;
+    decimal_parse(&decimal, text, length);
+    *value = from_bits(decimal_to_bits(&decimal));
+    return true;
+}
+
+// --- Escapes ---
+
+size_t expresso_literal_unescape(const char* text, size_t length, char* out) {
+    size_t written = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '\\' || i + 1 == length) {
+            out[written++] = text[i];
+            continue;
+        }
+
+        char c = text[++i];
+        switch (c) {
+            case 'a': out[written++] = '\a'; break;
+            case 'b': out[written++] = '\b'; break;
+            case 'f': out[written++] = '\f'; break;
+            case 'n': out[written++] = '\n'; break;
+            case 'r': out[written++] = '\r'; break;
+            case 't': out[written++] = '\t'; break;
+            case 'v': out[written++] = '\v'; break;
+            case 'x': {
+                // As in C, every following hex digit belongs to the escape
+                unsigned code = 0;
+                size_t start = i;
+                while (i + 1 < length && hex_digit(text[i + 1]) >= 0) {
+                    code = code << 4 | (unsigned)hex_digit(text[++i]);
+                }
+                out[written++] = i == start ? 'x' : (char)code;
+                break;
+            }
+            case '0': case '1': case '2': case '3':
+            case '4': case '5': case '6': case '7': {
+                unsigned code = (unsigned)(c - '0');
+                for (int n = 1; n < 3 && i + 1 < length && text[i + 1] >= '0' && text[i + 1] <= '7'; n++) {
+                    code = code << 3 | (unsigned)(text[++i] - '0');
+                }
+                out[written++] = (char)code;
+                break;
+            }
+            default:
+                // \\ \' \" \? and anything else stand for the character itself
+                out[written++] = c;
+                break;
+        }
+    }
+    return written;
+}
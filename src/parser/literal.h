@@ -0,0 +1,88 @@
+/*
+ * Expresso
+ * literal.h
+ *
+ * Header file for the literal decoder. Literals are decoded straight from
+ * their token span in the input, without a terminated copy: integers and
+ * hex integers with overflow checks, floats correctly rounded to the nearest
+ * double, and the escape sequences of character and string literals.
+ *
+ * Expresso is an interactive command-line tool for evaluating expressions.
+ * Expresso supports basic data types (integers, characters, strings),
+ * literals, operators (arithmetic, logical, comparison, bitwise, string
+ * manipulation), and nested expressions using C syntax (e.g., precedence,
+ * parentheses). Key constraint: No mutable state—every input is a pure
+ * expression that evaluates to an immutable value.
+ *
+ * ========================================================================
+ *
+ * © Copyright 2025 Alfonso Guerra
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of the copyright holder nor the names of
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EXPRESSO_LITERAL_H
+#define EXPRESSO_LITERAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decode an IntegerLiteral spelling: decimal digits or "0x" and hex digits.
+// Either must fit in a long long; hex digits are a magnitude, not a two's
+// complement bit pattern. Returns false if the literal is out of range or
+// not an integer spelling.
+bool expresso_literal_integer(const char* text, size_t length, long long* value);
+
+// Is text an IntegerLiteral spelling, whatever its value? Those that do not
+// fit in a long long are big integers.
+bool expresso_literal_is_integer(const char* text, size_t length);
+
+// Decode a FloatingLiteral spelling, [0-9]* '.' [0-9]+ (plain digits are
+// accepted too), rounded to the nearest double with ties to even. Values
+// beyond the double range become infinity or zero like strtod.
+// Returns false if text is not a float spelling.
+bool expresso_literal_float(const char* text, size_t length, double* value);
+
+// Decode the escape sequences in the body of a quoted literal (without the
+// quotes) into out, which must have room for length bytes. Recognises the C
+// escapes \a \b \f \n \r \t \v \\ \' \" \? with octal \ooo and hex \xhh;
+// any other escaped character stands for itself. Returns the decoded length.
+size_t expresso_literal_unescape(const char* text, size_t length, char* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSO_LITERAL_H
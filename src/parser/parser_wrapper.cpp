@@ -54,61 +54,481 @@
  *
  */
 #include "parser_wrapper.h"
+#include "fast_parser.h"
 #include "ExpressoLexer.h"
 #include "ExpressoParser.h"
 #include "ExpressoBaseVisitor.h"
 #include "antlr4-runtime.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
-// Define the opaque context structure
-struct ExpressoParserContext {
+// Records where the first syntax error of a parse is, as a code point
+// index into the input; the errors are still printed by ANTLR's console
+// listener
+struct FirstErrorListener : antlr4::BaseErrorListener {
+    bool seen = false;
+    bool lexical = false; // Reported by the lexer, which then drops the character
+    size_t index = 0;
+    size_t length = 0;
+
+    void reset() {
+        seen = lexical = false;
+        index = length = 0;
+    }
+
+    // ANTLR's line and column would lose the line on multi-line input, so
+    // the position is taken from the offending token or, for the lexer, the
+    // start of the text it could not match
+    void syntaxError(antlr4::Recognizer* recognizer, antlr4::Token* offending, size_t, size_t,
+                     const std::string&, std::exception_ptr cause) override {
+        if (seen) return;
+        seen = true;
+        lexical = !offending;
+        // The lexer has no token to offer, only its one bad character; the
+        // end of the input is a token whose stop is before its start
+        if (!offending) {
+            index = recognizer->getInputStream()->index();
+            try {
+                if (cause) std::rethrow_exception(cause);
+            } catch (const antlr4::LexerNoViableAltException& e) {
+                index = e.getStartIndex();
+            } catch (...) {
+            }
+            length = 1;
+        } else {
+            index = offending->getStartIndex();
+            if (offending->getStopIndex() + 1 > offending->getStartIndex()) {
+                length = offending->getStopIndex() + 1 - offending->getStartIndex();
+            }
+        }
+    }
+};
+
+// The ANTLR pipeline. It is created on first use, so contexts that only use
+// the fast backend never pay for initialising the ANTLR runtime.
+struct AntlrPipeline {
     antlr4::ANTLRInputStream input;
     ExpressoLexer lexer;
     antlr4::CommonTokenStream tokens;
     ExpressoParser parser;
+    // First stage: SLL prediction that gives up at the first error
+    std::shared_ptr<antlr4::BailErrorStrategy> bail;
+    // Second stage: full LL prediction with the usual reporting and recovery
+    std::shared_ptr<antlr4::DefaultErrorStrategy> recover;
+    FirstErrorListener first_error;
+
+    AntlrPipeline() :
+        input(""), lexer(&input), tokens(&lexer), parser(&tokens),
+        bail(std::make_shared<antlr4::BailErrorStrategy>()),
+        recover(std::make_shared<antlr4::DefaultErrorStrategy>()) {
+        lexer.addErrorListener(&first_error);
+        parser.addErrorListener(&first_error);
+    }
+
+    void set_stage(const std::shared_ptr<antlr4::ANTLRErrorStrategy>& strategy,
+                   antlr4::atn::PredictionMode mode) {
+        parser.setErrorHandler(strategy);
+        parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(mode);
+    }
+};
+
+// Define the opaque context structure
+struct ExpressoParserContext {
+    ExpressoParserBackend backend;
+    bool sharing; // Hash-cons the native trees of later parses
+    std::unique_ptr<AntlrPipeline> antlr;
+    ExpressoParserStats stats;
+    ExpressoSyntaxError last_error; // Of the last parse; code EXPRESSO_ERROR_NONE if it succeeded
+
+    // The text of the last parse. Node text is handed out as spans into it.
+    std::string source;
+    // Byte offset of each code point in source, or empty when source is
+    // ASCII and token indices are already byte offsets.
+    std::vector<size_t> code_point_offsets;
+
+    ExpressoParserContext() : backend(EXPRESSO_PARSER_BACKEND_ANTLR), sharing(true), stats(), last_error() {}
+
+    void set_source(const char* expression_str) {
+        source.assign(expression_str);
+        code_point_offsets.clear();
+
+        bool ascii = true;
+        for (unsigned char c : source) {
+            if (c >= 0x80) {
+                ascii = false;
+                break;
+            }
+        }
+        if (ascii) return;
+
+        for (size_t i = 0; i < source.size(); ++i) {
+            if ((static_cast<unsigned char>(source[i]) & 0xC0) != 0x80) {
+                code_point_offsets.push_back(i);
+            }
+        }
+        code_point_offsets.push_back(source.size());
+    }
+
+    void set_syntax_error(ExpressoErrorCode code, size_t position, size_t length) {
+        last_error.code = code;
+        last_error.message = expresso_error_message(code);
+        last_error.position = position;
+        last_error.length = length;
+    }
+
+    size_t byte_offset(size_t code_point) const {
+        if (code_point_offsets.empty()) {
+            return code_point < source.size() ? code_point : source.size();
+        }
+        return code_point < code_point_offsets.size() ? code_point_offsets[code_point] : source.size();
+    }
 
-    ExpressoParserContext() :
-        input(""), lexer(&input), tokens(&lexer), parser(&tokens) {}
+    // Text between two inclusive code point indices, as reported by tokens
+    std::string_view span(size_t start, size_t stop) const {
+        if (stop < start || stop == std::numeric_limits<size_t>::max()) return std::string_view();
+        size_t begin = byte_offset(start);
+        size_t end = byte_offset(stop + 1);
+        return std::string_view(source).substr(begin, end - begin);
+    }
+
+    std::string_view token_text(const antlr4::Token* token) const {
+        if (!token || token->getType() == antlr4::Token::EOF) return std::string_view();
+        return span(token->getStartIndex(), token->getStopIndex());
+    }
+
+    std::string_view node_text(antlr4::tree::ParseTree* node) const {
+        if (auto* terminal = dynamic_cast<antlr4::tree::TerminalNode*>(node)) {
+            return token_text(terminal->getSymbol());
+        }
+        if (auto* rule_node = dynamic_cast<antlr4::ParserRuleContext*>(node)) {
+            antlr4::Token* start = rule_node->getStart();
+            antlr4::Token* stop = rule_node->getStop();
+            if (!start || !stop || stop->getType() == antlr4::Token::EOF) return std::string_view();
+            return span(start->getStartIndex(), stop->getStopIndex());
+        }
+        return std::string_view();
+    }
 };
 
-// Define the parse tree wrapper structure
+// Define the parse tree wrapper structure. Wrappers are cheap to create: the
+// node's text stays a span into the parser's source until a caller asks for
+// a NUL-terminated copy.
 struct ExpressoParseTree {
     antlr4::tree::ParseTree* node;
-    std::string text;
+    const ExpressoParserContext* ctx; // Owner of the source text
+    std::string text;                 // Materialised by expresso_tree_get_text
+    bool has_text;
+    ExpressoAst* ast;                 // Lowered native tree, owned by this wrapper
 
-    explicit ExpressoParseTree(antlr4::tree::ParseTree* n) : node(n) {
-        if (node) {
-            text = node->getText();
-        }
+    ExpressoParseTree(antlr4::tree::ParseTree* n, const ExpressoParserContext* c) :
+        node(n), ctx(c), has_text(false), ast(nullptr) {}
+
+    ~ExpressoParseTree() {
+        expresso_ast_destroy(ast);
     }
+
+    ExpressoParseTree(const ExpressoParseTree&) = delete;
+    ExpressoParseTree& operator=(const ExpressoParseTree&) = delete;
 };
 
+// --- Lowering of the ANTLR parse tree into the native expression tree ---
+
+static ExpressoNodeIndex lower_tree(ExpressoAst* ast, const ExpressoParserContext* ctx, antlr4::tree::ParseTree* node);
+
+static ExpressoOperator unary_operator_for(std::string_view symbol) {
+    if (symbol == "+") return EXPRESSO_OP_PLUS;
+    if (symbol == "-") return EXPRESSO_OP_NEGATE;
+    if (symbol == "!") return EXPRESSO_OP_LOGICAL_NOT;
+    if (symbol == "~") return EXPRESSO_OP_BITWISE_NOT;
+    return EXPRESSO_OP_NONE;
+}
+
+static ExpressoOperator binary_operator_for(std::string_view symbol) {
+    static const struct {
+        std::string_view symbol;
+        ExpressoOperator op;
+    } operators[] = {
+        { "*", EXPRESSO_OP_MULTIPLY },      { "/", EXPRESSO_OP_DIVIDE },
+        { "%", EXPRESSO_OP_MODULO },        { "+", EXPRESSO_OP_ADD },
+        { "-", EXPRESSO_OP_SUBTRACT },      { "<<", EXPRESSO_OP_SHIFT_LEFT },
+        { ">>", EXPRESSO_OP_SHIFT_RIGHT },  { "<", EXPRESSO_OP_LESS },
+        { ">", EXPRESSO_OP_GREATER },       { "<=", EXPRESSO_OP_LESS_EQUAL },
+        { ">=", EXPRESSO_OP_GREATER_EQUAL },{ "==", EXPRESSO_OP_EQUAL },
+        { "!=", EXPRESSO_OP_NOT_EQUAL },    { "&", EXPRESSO_OP_BITWISE_AND },
+        { "^", EXPRESSO_OP_BITWISE_XOR },   { "|", EXPRESSO_OP_BITWISE_OR },
+        { "&&", EXPRESSO_OP_LOGICAL_AND },  { "||", EXPRESSO_OP_LOGICAL_OR },
+    };
+    for (const auto& entry : operators) {
+        if (symbol == entry.symbol) return entry.op;
+    }
+    return EXPRESSO_OP_NONE;
+}
+
+static ExpressoNodeIndex lower_literal(ExpressoAst* ast, const ExpressoParserContext* ctx, antlr4::tree::TerminalNode* terminal) {
+    antlr4::Token* token = terminal->getSymbol();
+    std::string_view text = ctx->token_text(token);
+
+    switch (token->getType()) {
+        case ExpressoLexer::IntegerLiteral:
+            return expresso_ast_add_literal(ast, EXPRESSO_NODE_INTEGER, text.data(), text.size());
+        case ExpressoLexer::FloatingLiteral:
+            return expresso_ast_add_literal(ast, EXPRESSO_NODE_FLOAT, text.data(), text.size());
+        case ExpressoLexer::CharacterLiteral:
+            return expresso_ast_add_literal(ast, EXPRESSO_NODE_CHARACTER, text.data(), text.size());
+        case ExpressoLexer::StringLiteral:
+            return expresso_ast_add_literal(ast, EXPRESSO_NODE_STRING, text.data(), text.size());
+        case ExpressoLexer::Parameter:
+            return expresso_ast_add_parameter(ast, text.data() + 1, text.size() - 1);
+        default:
+            return EXPRESSO_NODE_NONE;
+    }
+}
+
+// Fold "operand (operator operand)*" left to right into binary nodes. The
+// operator of logicalOrExpression is the token pair '|' '|'.
+static ExpressoNodeIndex lower_operator_chain(ExpressoAst* ast, const ExpressoParserContext* ctx, antlr4::tree::ParseTree* node) {
+    const auto& children = node->children;
+    ExpressoNodeIndex result = lower_tree(ast, ctx, children[0]);
+    size_t i = 1;
+
+    while (result != EXPRESSO_NODE_NONE && i < children.size()) {
+        std::string_view symbol = ctx->node_text(children[i]);
+        size_t operator_tokens = 0;
+        while (i < children.size() && dynamic_cast<antlr4::tree::TerminalNode*>(children[i])) {
+            ++operator_tokens;
+            ++i;
+        }
+        if (i == children.size()) return EXPRESSO_NODE_NONE;
+
+        ExpressoOperator op = binary_operator_for(symbol);
+        if (operator_tokens == 2 && op == EXPRESSO_OP_BITWISE_OR) {
+            op = EXPRESSO_OP_LOGICAL_OR;
+        } else if (operator_tokens != 1) {
+            op = EXPRESSO_OP_NONE;
+        }
+
+        ExpressoNodeIndex right = lower_tree(ast, ctx, children[i++]);
+        if (op == EXPRESSO_OP_NONE || right == EXPRESSO_NODE_NONE) return EXPRESSO_NODE_NONE;
+        result = expresso_ast_add_binary(ast, op, result, right);
+    }
+    return result;
+}
+
+static ExpressoNodeIndex lower_tree(ExpressoAst* ast, const ExpressoParserContext* ctx, antlr4::tree::ParseTree* node) {
+    if (auto* terminal = dynamic_cast<antlr4::tree::TerminalNode*>(node)) {
+        return lower_literal(ast, ctx, terminal);
+    }
+
+    auto* rule_node = dynamic_cast<antlr4::RuleContext*>(node);
+    if (!rule_node || node->children.empty()) return EXPRESSO_NODE_NONE;
+    const auto& children = node->children;
+
+    switch (rule_node->getRuleIndex()) {
+        case RuleExpression:
+        case RuleLiteral:
+            return lower_tree(ast, ctx, children[0]);
+
+        case RuleConditionalExpression:
+            if (children.size() == 5) {
+                ExpressoNodeIndex condition = lower_tree(ast, ctx, children[0]);
+                ExpressoNodeIndex if_true = lower_tree(ast, ctx, children[2]);
+                ExpressoNodeIndex if_false = lower_tree(ast, ctx, children[4]);
+                if (condition == EXPRESSO_NODE_NONE || if_true == EXPRESSO_NODE_NONE || if_false == EXPRESSO_NODE_NONE) {
+                    return EXPRESSO_NODE_NONE;
+                }
+                return expresso_ast_add_conditional(ast, condition, if_true, if_false);
+            }
+            return lower_tree(ast, ctx, children[0]);
+
+        case RuleUnaryExpression:
+            if (children.size() == 2) {
+                ExpressoOperator op = unary_operator_for(ctx->node_text(children[0]));
+                ExpressoNodeIndex operand = lower_tree(ast, ctx, children[1]);
+                if (op == EXPRESSO_OP_NONE || operand == EXPRESSO_NODE_NONE) return EXPRESSO_NODE_NONE;
+                return expresso_ast_add_unary(ast, op, operand);
+            }
+            return lower_tree(ast, ctx, children[0]);
+
+        case RulePrimaryExpression:
+            // Parentheses only group; they leave no node behind
+            return lower_tree(ast, ctx, children.size() == 3 ? children[1] : children[0]);
+
+        default:
+            // Every remaining rule is one binary precedence level
+            return lower_operator_chain(ast, ctx, node);
+    }
+}
+
+static ExpressoAst* lower_to_ast(const ExpressoParserContext* ctx, antlr4::tree::ParseTree* node) {
+    ExpressoAst* ast = expresso_ast_create();
+    expresso_ast_set_sharing(ast, ctx->sharing);
+    ast->root = lower_tree(ast, ctx, node);
+    if (ast->root == EXPRESSO_NODE_NONE) {
+        expresso_ast_destroy(ast);
+        return nullptr;
+    }
+    return ast;
+}
+
 ExpressoParserContext* expresso_parser_create(void) {
     return new ExpressoParserContext();
 }
 
-ExpressoParseTree* expresso_parser_parse(ExpressoParserContext* ctx, const char* expression_str) {
-    if (!ctx || !expression_str) return nullptr;
+void expresso_parser_set_backend(ExpressoParserContext* ctx, ExpressoParserBackend backend) {
+    if (ctx) ctx->backend = backend;
+}
+
+ExpressoParserBackend expresso_parser_get_backend(const ExpressoParserContext* ctx) {
+    return ctx ? ctx->backend : EXPRESSO_PARSER_BACKEND_ANTLR;
+}
 
-    ctx->input.load(expression_str);
-    ctx->lexer.setInputStream(&ctx->input);
-    ctx->tokens.setTokenSource(&ctx->lexer);
-    ctx->parser.setTokenStream(&ctx->tokens);
-    ctx->parser.reset();
+void expresso_parser_set_sharing(ExpressoParserContext* ctx, bool enabled) {
+    if (ctx) ctx->sharing = enabled;
+}
 
-    ExpressoParser::ExpressionContext* tree = ctx->parser.expression();
+bool expresso_parser_backend_from_name(const char* name, ExpressoParserBackend* backend) {
+    if (!name || !backend) return false;
+    if (strcmp(name, "antlr") == 0) {
+        *backend = EXPRESSO_PARSER_BACKEND_ANTLR;
+        return true;
+    }
+    if (strcmp(name, "fast") == 0) {
+        *backend = EXPRESSO_PARSER_BACKEND_FAST;
+        return true;
+    }
+    return false;
+}
 
-    if (ctx->parser.getNumberOfSyntaxErrors() > 0) {
+static ExpressoParseTree* parse_with_antlr(ExpressoParserContext* ctx) {
+    if (!ctx->antlr) {
+        ctx->antlr = std::make_unique<AntlrPipeline>();
+    }
+    AntlrPipeline& antlr = *ctx->antlr;
+
+    antlr.input.load(ctx->source);
+    antlr.lexer.setInputStream(&antlr.input);
+    antlr.tokens.setTokenSource(&antlr.lexer);
+    antlr.parser.setTokenStream(&antlr.tokens);
+    antlr.parser.reset();
+    antlr.first_error.reset();
+
+    // SLL prediction is cheaper and decides every valid input in this
+    // grammar the same way LL does. The bail strategy throws at the first
+    // error rather than reporting it, so only inputs that SLL cannot accept
+    // pay for a second, full LL parse that reports errors as before.
+    //
+    // The start rule does not end at EOF, so input left over after the
+    // expression is checked for here, as the fast parser rejects it. So are
+    // lexer errors: the lexer skips the character, and the parser may accept
+    // what remains.
+    ExpressoParser::ExpressionContext* tree = nullptr;
+    antlr.set_stage(antlr.bail, antlr4::atn::PredictionMode::SLL);
+    try {
+        tree = antlr.parser.expression();
+        if (antlr.first_error.seen || antlr.tokens.LA(1) != antlr4::Token::EOF) {
+            throw antlr4::ParseCancellationException();
+        }
+        ctx->stats.sll_parses++;
+    } catch (antlr4::ParseCancellationException&) {
+        ctx->stats.ll_fallbacks++;
+        antlr.parser.reset(); // Rewinds the token stream
+        antlr.set_stage(antlr.recover, antlr4::atn::PredictionMode::LL);
+        tree = antlr.parser.expression();
+        antlr4::Token* rest = antlr.tokens.LT(1);
+        if (antlr.parser.getNumberOfSyntaxErrors() == 0 && rest->getType() != antlr4::Token::EOF) {
+            antlr.parser.notifyErrorListeners(rest, "extraneous input '" + rest->getText() + "' expecting <EOF>", nullptr);
+        }
+    }
+
+    if (antlr.parser.getNumberOfSyntaxErrors() > 0 || antlr.first_error.seen) {
+        ctx->stats.ll_failures++;
         std::cerr << "Syntax Error(s) detected." << std::endl;
+        size_t start = ctx->byte_offset(antlr.first_error.index);
+        ctx->set_syntax_error(antlr.first_error.lexical ? EXPRESSO_ERROR_UNRECOGNISED_TOKEN : EXPRESSO_ERROR_SYNTAX, start,
+                              ctx->byte_offset(antlr.first_error.index + antlr.first_error.length) - start);
         return nullptr;
     }
 
-    return new ExpressoParseTree(tree);
+    ExpressoParseTree* result = new ExpressoParseTree(tree, ctx);
+    result->ast = lower_to_ast(ctx, tree);
+    if (!result->ast) {
+        std::cerr << "Syntax Error(s) detected." << std::endl;
+        ctx->set_syntax_error(EXPRESSO_ERROR_SYNTAX, 0, ctx->source.size());
+        delete result;
+        return nullptr;
+    }
+    return result;
+}
+
+static ExpressoParseTree* parse_with_fast_parser(ExpressoParserContext* ctx) {
+    ExpressoAst* ast = expresso_ast_create();
+    expresso_ast_set_sharing(ast, ctx->sharing);
+    ExpressoSyntaxError error;
+
+    if (!expresso_fast_parse(ctx->source.c_str(), ast, &error)) {
+        std::cerr << "line 1:" << error.position << " " << error.message << std::endl;
+        std::cerr << "Syntax Error(s) detected." << std::endl;
+        ctx->last_error = error;
+        expresso_ast_destroy(ast);
+        return nullptr;
+    }
+
+    // Fast trees have no parse tree node; only the native tree and the text
+    // of the whole input are available through the wrapper.
+    ExpressoParseTree* result = new ExpressoParseTree(nullptr, ctx);
+    result->ast = ast;
+    return result;
+}
+
+bool expresso_parser_get_syntax_error(const ExpressoParserContext* ctx, ExpressoSyntaxError* error) {
+    if (!ctx || ctx->last_error.code == EXPRESSO_ERROR_NONE) return false;
+    if (error) *error = ctx->last_error;
+    return true;
+}
+
+void expresso_parser_get_stats(const ExpressoParserContext* ctx, ExpressoParserStats* stats) {
+    if (!ctx || !stats) return;
+    *stats = ctx->stats;
+}
+
+void expresso_parser_reset_stats(ExpressoParserContext* ctx) {
+    if (ctx) ctx->stats = ExpressoParserStats();
+}
+
+ExpressoParseTree* expresso_parser_parse(ExpressoParserContext* ctx, const char* expression_str) {
+    if (!ctx || !expression_str) return nullptr;
+
+    ctx->set_source(expression_str);
+    ctx->last_error = ExpressoSyntaxError();
+    if (ctx->backend == EXPRESSO_PARSER_BACKEND_FAST) {
+        return parse_with_fast_parser(ctx);
+    }
+    return parse_with_antlr(ctx);
+}
+
+const char* expresso_tree_get_text_span(ExpressoParseTree* tree, size_t* length) {
+    std::string_view text;
+    if (tree && tree->ctx) {
+        text = tree->node ? tree->ctx->node_text(tree->node) : std::string_view(tree->ctx->source);
+    }
+    if (length) *length = text.size();
+    return text.data();
 }
 
 const char* expresso_tree_get_text(ExpressoParseTree* tree) {
     if (!tree) return nullptr;
+    if (!tree->has_text) {
+        size_t length = 0;
+        const char* text = expresso_tree_get_text_span(tree, &length);
+        tree->text.assign(text ? text : "", length);
+        tree->has_text = true;
+    }
     return tree->text.c_str();
 }
 
@@ -130,7 +550,7 @@ ExpressoParseTree* expresso_tree_get_child(ExpressoParseTree* tree, int index) {
     if (index < 0 || (size_t)index >= tree->node->children.size()) {
         return nullptr;
     }
-    return new ExpressoParseTree(tree->node->children[index]);
+    return new ExpressoParseTree(tree->node->children[index], tree->ctx);
 }
 
 int expresso_tree_get_terminal_type(ExpressoParseTree* tree) {
@@ -145,14 +565,23 @@ void expresso_tree_destroy(ExpressoParseTree* tree) {
     delete tree;
 }
 
-// Visitor implementation
+const ExpressoAst* expresso_tree_get_ast(ExpressoParseTree* tree) {
+    if (!tree) return nullptr;
+    if (!tree->ast && tree->node) {
+        tree->ast = lower_to_ast(tree->ctx, tree->node);
+    }
+    return tree->ast;
+}
+
+// Visitor implementation. The wrappers handed to the C callbacks live on the
+// stack and carry only a node pointer until text is requested.
 class CxxVisitor : public ExpressoBaseVisitor {
 public:
-    CxxVisitor(CExpressoVisitor* visitor) : visitor_(visitor) {}
+    CxxVisitor(CExpressoVisitor* visitor, const ExpressoParserContext* ctx) : visitor_(visitor), ctx_(ctx) {}
 
     std::any visitExpression(ExpressoParser::ExpressionContext *ctx) override {
         if (visitor_->visit_expression) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_expression(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -160,7 +589,7 @@ public:
 
     std::any visitAdditiveExpression(ExpressoParser::AdditiveExpressionContext *ctx) override {
         if (visitor_->visit_additive_expression) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_additive_expression(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -168,7 +597,7 @@ public:
 
     std::any visitMultiplicativeExpression(ExpressoParser::MultiplicativeExpressionContext *ctx) override {
         if (visitor_->visit_multiplicative_expression) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_multiplicative_expression(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -176,7 +605,7 @@ public:
 
     std::any visitUnaryExpression(ExpressoParser::UnaryExpressionContext *ctx) override {
         if (visitor_->visit_unary_expression) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_unary_expression(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -184,7 +613,7 @@ public:
 
     std::any visitPrimaryExpression(ExpressoParser::PrimaryExpressionContext *ctx) override {
         if (visitor_->visit_primary_expression) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_primary_expression(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -192,7 +621,7 @@ public:
 
     std::any visitLiteral(ExpressoParser::LiteralContext *ctx) override {
         if (visitor_->visit_literal) {
-            ExpressoParseTree tree(ctx);
+            ExpressoParseTree tree(ctx, ctx_);
             return visitor_->visit_literal(visitor_, &tree);
         }
         return visitChildren(ctx);
@@ -200,18 +629,19 @@ public:
 
 private:
     CExpressoVisitor* visitor_;
+    const ExpressoParserContext* ctx_;
 };
 
 Value expresso_tree_accept(ExpressoParseTree* tree, CExpressoVisitor* visitor) {
     if (!tree || !tree->node || !visitor) {
-        return value_create_error("Invalid arguments to accept");
+        return value_create_error_code(EXPRESSO_ERROR_INVALID_ACCEPT_ARGUMENTS);
     }
-    CxxVisitor c_visitor(visitor);
+    CxxVisitor c_visitor(visitor, tree->ctx);
     std::any result = c_visitor.visit(tree->node);
     if (result.has_value() && result.type() == typeid(Value)) {
         return std::any_cast<Value>(result);
     }
-    return value_create_error("Visitor did not return a Value");
+    return value_create_error_code(EXPRESSO_ERROR_VISITOR_RESULT);
 }
 
 void expresso_parser_destroy(ExpressoParserContext* ctx) {
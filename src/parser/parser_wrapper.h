@@ -50,6 +50,8 @@
 #define EXPRESSO_PARSER_WRAPPER_H
 
 #include "value.h"
+#include "ast.h"
+#include "fast_parser.h" // For ExpressoSyntaxError
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,14 +70,61 @@ extern "C" {
 typedef struct ExpressoParserContext ExpressoParserContext;
 typedef struct ExpressoParseTree ExpressoParseTree;
 
+// The parser implementations that can produce a native expression tree
+typedef enum {
+    EXPRESSO_PARSER_BACKEND_ANTLR, // Generated from Expresso.g4 by ANTLR4 (default)
+    EXPRESSO_PARSER_BACKEND_FAST   // Hand-written, see fast_parser.h
+} ExpressoParserBackend;
+
+// Counters for the two-stage ANTLR parse. Each parse first runs SLL
+// prediction and gives up at the first error. Only then is the input
+// parsed again with full LL prediction and error reporting.
+typedef struct {
+    unsigned long long sll_parses;   // Inputs accepted by the SLL stage
+    unsigned long long ll_fallbacks; // Inputs retried with full LL
+    unsigned long long ll_failures;  // Retries that ended in a syntax error
+} ExpressoParserStats;
+
 // Function to create a new parser instance
 ExpressoParserContext* expresso_parser_create(void);
 
+// Select the backend used by subsequent parses. Trees from the fast backend
+// have no ANTLR nodes: expresso_tree_get_ast and the text functions work on
+// them, but they report no type or children.
+void expresso_parser_set_backend(ExpressoParserContext* ctx, ExpressoParserBackend backend);
+ExpressoParserBackend expresso_parser_get_backend(const ExpressoParserContext* ctx);
+
+// Build the native trees of subsequent parses with identical subtrees stored
+// once (see expresso_ast_set_sharing). On by default.
+void expresso_parser_set_sharing(ExpressoParserContext* ctx, bool enabled);
+
+// Read or clear the counters of the ANTLR backend
+void expresso_parser_get_stats(const ExpressoParserContext* ctx, ExpressoParserStats* stats);
+void expresso_parser_reset_stats(ExpressoParserContext* ctx);
+
+// Look up a backend by its command-line name ("antlr" or "fast")
+// Returns false if the name is unknown
+bool expresso_parser_backend_from_name(const char* name, ExpressoParserBackend* backend);
+
 // Function to parse an expression string
 // Returns the parse tree on success, NULL on syntax error
 ExpressoParseTree* expresso_parser_parse(ExpressoParserContext* ctx, const char* expression_str);
 
-// Get the raw text of a parse tree node
+// Describe the syntax error that made the last parse return NULL. The ANTLR
+// backend reports every error as EXPRESSO_ERROR_SYNTAX, or
+// EXPRESSO_ERROR_UNRECOGNISED_TOKEN for a character the lexer cannot match,
+// at the byte offset of its first offending token. Returns false if the last
+// parse succeeded.
+bool expresso_parser_get_syntax_error(const ExpressoParserContext* ctx, ExpressoSyntaxError* error);
+
+// Get the source text of a parse tree node as a span into the parser's copy
+// of the input. The span is not NUL-terminated and stays valid until the next
+// parse with the same context. Returns NULL (and a length of 0) if the node
+// covers no text.
+const char* expresso_tree_get_text_span(ExpressoParseTree* tree, size_t* length);
+
+// Get the source text of a parse tree node as a NUL-terminated string. The
+// copy is made on first request and owned by the node.
 const char* expresso_tree_get_text(ExpressoParseTree* tree);
 
 // Get the type of a parse tree node (returns rule index or -1 for terminal)
@@ -87,9 +136,15 @@ int expresso_tree_get_child_count(ExpressoParseTree* tree);
 // Get a child of a parse tree node by index
 ExpressoParseTree* expresso_tree_get_child(ExpressoParseTree* tree, int index);
 
-// Free a parse tree
+// Free a parse tree, including its native expression tree
 void expresso_tree_destroy(ExpressoParseTree* tree);
 
+// Get the native expression tree lowered from a parse tree node. The tree
+// returned by expresso_parser_parse is lowered during parsing; other nodes
+// are lowered on first use. The result is owned by the parse tree node.
+// Returns NULL if the node does not denote an expression.
+const ExpressoAst* expresso_tree_get_ast(ExpressoParseTree* tree);
+
 int expresso_tree_get_terminal_type(ExpressoParseTree* tree);
 
 typedef struct CExpressoVisitor CExpressoVisitor;
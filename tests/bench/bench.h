@@ -0,0 +1,28 @@
+#ifndef EXPRESSO_BENCH_H
+#define EXPRESSO_BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+// Monotonic time in nanoseconds
+static inline double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Keep the compiler from discarding a computed result
+static volatile long long bench_sink;
+
+// Time `iterations` runs of body and print the mean cost of one run
+#define BENCH_RUN(label, iterations, body) \
+    do { \
+        double bench_start_ = bench_now_ns(); \
+        for (long bench_i_ = 0; bench_i_ < (iterations); bench_i_++) { \
+            body; \
+        } \
+        double bench_ns_ = (bench_now_ns() - bench_start_) / (double)(iterations); \
+        printf("  %-28s %12.1f ns/op\n", label, bench_ns_); \
+    } while (0)
+
+#endif // EXPRESSO_BENCH_H
@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "batch.h"
+#include "expresso.h"
+#include <stdlib.h>
+
+// Compares evaluating a compiled expression once per row against
+// evaluating it over whole columns at each available SIMD level.
+static const char* expressions[] = {
+    "$a + $b * 3",
+    "($a & 255) ^ ($b | 7) == 0 || $a < $b",
+    "$a > $b ? $a - $b : $b - $a",
+    "$a / ($b | 1)",
+    "$a / ($b & 1)", // Dirty data: half the rows divide by zero
+};
+
+static const char* level_names[] = { "batch (scalar)", "batch (sse2)", "batch (avx2)" };
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    long long* a = malloc(rows * sizeof(long long));
+    long long* b = malloc(rows * sizeof(long long));
+    long long* out = malloc(rows * sizeof(long long));
+    uint8_t* validity = malloc((rows + 7) / 8);
+    if (!a || !b || !out || !validity) {
+        fprintf(stderr, "Fatal Error: Memory allocation failed for benchmark columns\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < rows; i++) {
+        a[i] = rand() % 100000 - 50000;
+        b[i] = rand() % 100000 - 50000;
+    }
+
+    ExpressoColumnType types[] = { EXPRESSO_COLUMN_INTEGER, EXPRESSO_COLUMN_INTEGER };
+    ExpressoColumn columns[] = { { EXPRESSO_COLUMN_INTEGER, a, NULL }, { EXPRESSO_COLUMN_INTEGER, b, NULL } };
+    ExpressoColumn result = { EXPRESSO_COLUMN_INTEGER, out, validity };
+    printf("%zu rows, per-row cost\n", rows);
+
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        const char* expr = expressions[i];
+        printf("%s\n", expr);
+
+        ExpressoCompiled* compiled = expresso_compile(expr, NULL);
+        double start = bench_now_ns();
+        for (size_t row = 0; row < rows; row++) {
+            Value bindings[] = { value_create_integer(a[row]), value_create_integer(b[row]) };
+            Value v = expresso_eval(compiled, bindings);
+            bench_sink = value_is_error(v) ? -1 : value_get_integer(v);
+            value_destroy(v);
+        }
+        printf("  %-28s %12.2f ns/row\n", "expresso_eval per row", (bench_now_ns() - start) / (double)rows);
+
+        ExpressoBatch* batch = expresso_batch_prepare(compiled, types);
+        for (int level = EXPRESSO_SIMD_SCALAR; batch && level <= EXPRESSO_SIMD_AVX2; level++) {
+            if (!expresso_batch_set_simd_level(batch, (ExpressoSimdLevel)level)) continue;
+            start = bench_now_ns();
+            expresso_batch_eval(batch, columns, rows, &result);
+            bench_sink = out[rows / 2];
+            printf("  %-28s %12.2f ns/row\n", level_names[level], (bench_now_ns() - start) / (double)rows);
+        }
+
+        expresso_batch_destroy(batch);
+        expresso_compiled_destroy(compiled);
+    }
+
+    free(a);
+    free(b);
+    free(out);
+    free(validity);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "kernels.h"
+#include "operations.h"
+#include "value.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Compares checked 64-bit arithmetic, which detects overflow, against
+// arithmetic without checks. Per value, an operator function is timed
+// against ^, which has no check but the same dispatch; per column, each
+// SIMD level's kernel is timed against a wrapping loop. Operands never
+// overflow, so the checked paths only pay for their checks.
+#define COLUMN 4096
+
+static long long a[COLUMN], b[COLUMN], out[COLUMN];
+static uint8_t validity[COLUMN / 8];
+
+typedef unsigned long long ull;
+
+static void unchecked_add(long long* o, const long long* x, const long long* y, size_t n) {
+    for (size_t i = 0; i < n; i++) o[i] = (long long)((ull)x[i] + (ull)y[i]);
+}
+
+static void unchecked_multiply(long long* o, const long long* x, const long long* y, size_t n) {
+    for (size_t i = 0; i < n; i++) o[i] = (long long)((ull)x[i] * (ull)y[i]);
+}
+
+static const char* level_names[] = { "checked (scalar)", "checked (sse2)", "checked (avx2)" };
+
+static void bench_operator(const char* name, ExpressoOperator op, Value (*checked)(Value, Value),
+                           void (*unchecked)(long long*, const long long*, const long long*, size_t), long iterations) {
+    printf("%s, per value\n", name);
+
+    BENCH_RUN("a ^ b (no check)", iterations, {
+        long long sum = 0;
+        for (size_t i = 0; i < COLUMN; i++) {
+            Value v = value_by_bitwise_xoring_values(value_create_integer(a[i]), value_create_integer(b[i]));
+            sum += value_get_integer(v);
+        }
+        bench_sink = sum;
+    });
+    BENCH_RUN("checked", iterations, {
+        long long sum = 0;
+        for (size_t i = 0; i < COLUMN; i++) {
+            Value v = checked(value_create_integer(a[i]), value_create_integer(b[i]));
+            sum += value_get_integer(v);
+        }
+        bench_sink = sum;
+    });
+
+    printf("%s, per column of %d\n", name, COLUMN);
+    BENCH_RUN("unchecked", iterations, {
+        unchecked(out, a, b, COLUMN);
+        bench_sink = out[COLUMN / 2];
+    });
+    for (int level = EXPRESSO_SIMD_SCALAR; level <= EXPRESSO_SIMD_AVX2; level++) {
+        const ExpressoKernelTable* kernels = expresso_kernels((ExpressoSimdLevel)level);
+        if (!kernels) continue;
+        BENCH_RUN(level_names[level], iterations, {
+            kernels->checked[op](out, validity, a, b, COLUMN);
+            bench_sink = out[COLUMN / 2] + validity[0];
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 10000;
+    for (size_t i = 0; i < COLUMN; i++) {
+        a[i] = rand() % 2000001 - 1000000;
+        b[i] = rand() % 2000001 - 1000000;
+    }
+    for (size_t i = 0; i < COLUMN / 8; i++) validity[i] = 0xFF;
+
+    bench_operator("a + b", EXPRESSO_OP_ADD, value_by_adding_values, unchecked_add, iterations);
+    bench_operator("a * b", EXPRESSO_OP_MULTIPLY, value_by_multiplying_values, unchecked_multiply, iterations);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "bench.h"
+#include "ast.h"
+#include "bytecode.h"
+#include "evaluator.h"
+#include "fast_parser.h"
+#include "vm.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Concatenations of 1000 terms, "row" + "<text>" + 12345 + "<text>" ...:
+// copying the text so far at every +, as adding term by term would, against
+// the tree walker, whose long results are ropes joined once, and the VM,
+// which adds the whole chain in one instruction. The cost of copying at
+// every step grows with the square of the length, so it is measured for
+// short and long terms.
+#define TERMS 1000
+
+static const char* texts[] = {
+    "field, ",
+    "a field long enough that copying the text so far at each step shows, ",
+};
+
+static const char* term(const char* text, int i) {
+    return i % 2 ? text : "12345";
+}
+
+// Each step allocates the result at its exact size and copies both sides
+static size_t copy_every_step(const char* text) {
+    char* sum = strdup("row");
+    size_t length = 3;
+    for (int i = 1; i < TERMS; i++) {
+        size_t piece = strlen(term(text, i));
+        char* next = (char*)malloc(length + piece + 1);
+        memcpy(next, sum, length);
+        memcpy(next + length, term(text, i), piece + 1);
+        free(sum);
+        sum = next;
+        length += piece;
+    }
+    free(sum);
+    return length;
+}
+
+static void run(const char* text, long iterations) {
+    char* expr = (char*)malloc(TERMS * (strlen(text) + 8));
+    strcpy(expr, "\"row\"");
+    for (int i = 1; i < TERMS; i++) {
+        strcat(expr, i % 2 ? " + \"" : " + ");
+        strcat(expr, term(text, i));
+        if (i % 2) strcat(expr, "\"");
+    }
+
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoSyntaxError error;
+    if (!expresso_fast_parse(expr, ast, &error)) {
+        fprintf(stderr, "Failed to parse the concatenation\n");
+        exit(EXIT_FAILURE);
+    }
+    ExpressoProgram* program = expresso_program_compile(ast, NULL);
+
+    printf("Concatenation of %d terms of up to %zu bytes\n", TERMS, strlen(text));
+    BENCH_RUN("copy at every step", iterations, bench_sink += (long long)copy_every_step(text));
+    BENCH_RUN("tree walker (ropes)", iterations, {
+        Value v = evaluate_ast(ast);
+        bench_sink += (long long)value_string_length(v);
+        value_destroy(v);
+    });
+    BENCH_RUN("bytecode VM (fused)", iterations, {
+        Value v = expresso_vm_run(program, NULL);
+        bench_sink += (long long)value_string_length(v);
+        value_destroy(v);
+    });
+
+    expresso_program_destroy(program);
+    expresso_ast_destroy(ast);
+    free(expr);
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000;
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) run(texts[i], iterations);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "evaluator.h"
+#include "ast.h"
+#include <stdlib.h>
+
+// Times the tree walker on trees nested DEPTH levels deep. The trees are
+// built directly, since the parsers limit how deeply parentheses nest.
+#define DEPTH 10000
+
+typedef enum { LEFT_ADDITIONS, RIGHT_ADDITIONS, NEGATIONS, CONDITIONALS, SHAPE_COUNT } Shape;
+
+static const char* shape_names[] = {
+    "((1 + 1) + 1) + ...",
+    "1 + (1 + (1 + ...))",
+    "-(-(-(...)))",
+    "1 ? (1 ? ... : 0) : 0",
+};
+
+static ExpressoAst* build(Shape shape) {
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoNodeIndex node = expresso_ast_add_integer(ast, 1);
+    for (int level = 1; level < DEPTH; level++) {
+        switch (shape) {
+            case LEFT_ADDITIONS:
+                node = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, node, expresso_ast_add_integer(ast, 1));
+                break;
+            case RIGHT_ADDITIONS:
+                node = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, expresso_ast_add_integer(ast, 1), node);
+                break;
+            case NEGATIONS:
+                node = expresso_ast_add_unary(ast, EXPRESSO_OP_NEGATE, node);
+                break;
+            default: {
+                ExpressoNodeIndex condition = expresso_ast_add_integer(ast, 1);
+                node = expresso_ast_add_conditional(ast, condition, node, expresso_ast_add_integer(ast, 0));
+                break;
+            }
+        }
+    }
+    ast->root = node;
+    return ast;
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000;
+
+    for (int shape = 0; shape < SHAPE_COUNT; shape++) {
+        ExpressoAst* ast = build((Shape)shape);
+        printf("%s, %d levels\n", shape_names[shape], DEPTH);
+        BENCH_RUN("tree walker", iterations, {
+            Value v = evaluate_ast(ast);
+            bench_sink = value_get_integer(v);
+            value_destroy(v);
+        });
+        expresso_ast_destroy(ast);
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "format.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Compares result formatting against snprintf. Integers are drawn from
+// every magnitude; doubles are a mix of short decimals, as results of
+// literal arithmetic usually are, and arbitrary bit patterns.
+#define COUNT 4096
+
+static long long integers[COUNT];
+static double doubles[COUNT];
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000;
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        integers[i] = (long long)(state >> (state % 64));
+        if (i % 2) {
+            doubles[i] = (double)(state % 100000) / 100.0;
+        } else {
+            uint64_t bits = state & 0x7FEFFFFFFFFFFFFFULL;
+            memcpy(&doubles[i], &bits, sizeof(bits));
+        }
+    }
+
+    char buffer[512];
+    printf("integers, per %d\n", COUNT);
+    BENCH_RUN("snprintf %lld", iterations, {
+        size_t total = 0;
+        for (int i = 0; i < COUNT; i++) total += (size_t)snprintf(buffer, sizeof(buffer), "%lld", integers[i]);
+        bench_sink = (long long)total;
+    });
+    BENCH_RUN("expresso_format_integer", iterations, {
+        size_t total = 0;
+        for (int i = 0; i < COUNT; i++) total += expresso_format_integer(integers[i], buffer);
+        bench_sink = (long long)total;
+    });
+
+    printf("doubles, per %d\n", COUNT);
+    BENCH_RUN("snprintf %f (inexact)", iterations, {
+        size_t total = 0;
+        for (int i = 0; i < COUNT; i++) total += (size_t)snprintf(buffer, sizeof(buffer), "%f", doubles[i]);
+        bench_sink = (long long)total;
+    });
+    BENCH_RUN("snprintf %.17g", iterations, {
+        size_t total = 0;
+        for (int i = 0; i < COUNT; i++) total += (size_t)snprintf(buffer, sizeof(buffer), "%.17g", doubles[i]);
+        bench_sink = (long long)total;
+    });
+    BENCH_RUN("expresso_format_double", iterations, {
+        size_t total = 0;
+        for (int i = 0; i < COUNT; i++) total += expresso_format_double(doubles[i], buffer);
+        bench_sink = (long long)total;
+    });
+    return 0;
+}
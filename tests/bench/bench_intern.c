@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "expresso.h"
+#include "intern.h"
+#include "value.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A batch file whose lines repeat the same long string literals: compiles
+// every line and keeps the programs, as a batch run does, then compares the
+// memory their string constants hold with and without interning. Then
+// compares equality of separately made equal strings with interned ones.
+#define LINES 10000
+
+static const char* templates[] = {
+    "$x > %d ? \"status: shipped to the customer\" : \"status: awaiting payment\"",
+    "$x == %d ? \"priority: handle before end of day\" : \"priority: normal handling\"",
+};
+
+static void compile_lines(bool intern) {
+    static ExpressoCompiled* programs[LINES];
+    char line[128];
+
+    expresso_intern_set_enabled(intern);
+    value_reset_allocation_stats();
+    for (int i = 0; i < LINES; i++) {
+        snprintf(line, sizeof(line), templates[i % 2], i);
+        programs[i] = expresso_compile(line, NULL);
+    }
+
+    ValueAllocationStats values;
+    ExpressoInternStats pool;
+    value_allocation_stats(&values);
+    expresso_intern_stats(&pool);
+    printf("  %-28s %12llu bytes in %llu buffers\n", intern ? "interned" : "copied",
+           values.bytes + (unsigned long long)pool.bytes, values.allocations + (unsigned long long)pool.strings);
+
+    for (int i = 0; i < LINES; i++) expresso_compiled_destroy(programs[i]);
+    expresso_intern_set_enabled(false);
+}
+
+int main(void) {
+    printf("String constants of %d compiled lines\n", LINES);
+    compile_lines(false);
+    compile_lines(true);
+
+    const char* text = "a string long enough to be kept out of line";
+    Value a = value_create_string(text);
+    Value b = value_create_string(text);
+    Value c = value_create_interned_string(text, strlen(text));
+    Value d = value_create_interned_string(text, strlen(text));
+    printf("Equality of equal long strings\n");
+    BENCH_RUN("separate copies", 10000000, bench_sink += value_equals(a, b));
+    BENCH_RUN("interned", 10000000, bench_sink += value_equals(c, d));
+    value_destroy(a);
+    value_destroy(b);
+    expresso_intern_reset();
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "bench.h"
+#include "expresso.h"
+#include "jit.h"
+#include <stdlib.h>
+
+// Compares expresso_eval() running compiled expressions on the bytecode VM
+// and as native code.
+static const char* expressions[] = {
+    "$a + $b * 3",
+    "($a & 255) ^ ($b | 7) == 0 || $a < $b",
+    "$a > $b ? $a - $b : $b - $a",
+    "((($a + 1) * ($b + 2)) - (($a + 3) * ($b - 4))) / 3 == 14 || $a && $b",
+    "$x == $y ? $x : $y",
+};
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 10000000;
+    Value bindings[] = { value_create_integer(12345), value_create_integer(-678) };
+    Value float_bindings[] = { value_create_float(1.5), value_create_float(2.5) };
+
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        const char* expr = expressions[i];
+        const Value* values = expr[1] == 'x' ? float_bindings : bindings;
+        printf("%s\n", expr);
+
+        ExpressoCompiled* compiled = expresso_compile(expr, NULL);
+        expresso_jit_set_enabled(false);
+        BENCH_RUN("bytecode VM", iterations, {
+            Value v = expresso_eval(compiled, values);
+            bench_sink = value_get_integer(v);
+        });
+
+        expresso_jit_set_enabled(true);
+        BENCH_RUN(expresso_jit_enabled() ? "native code" : "native code (unavailable)", iterations, {
+            Value v = expresso_eval(compiled, values);
+            bench_sink = value_get_integer(v);
+        });
+        expresso_compiled_destroy(compiled);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "bench.h"
+#include "ast.h"
+#include "fast_parser.h"
+#include "literal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Compares the literal decoder against strtoll/strtod on a literal-heavy
+// corpus. The decoder reads each literal from its span of the corpus text;
+// strtoll/strtod are timed both on the bounded copy the tree builder used
+// to make and, as a lower bound, on spellings already terminated in place.
+#define CORPUS 4096
+
+typedef struct {
+    char text[CORPUS * 32];
+    size_t start[CORPUS];
+    size_t length[CORPUS];
+} Corpus;
+
+static Corpus corpus;
+
+// Spellings separated by NULs, so the same text serves both kinds of caller
+static void build(int kind) {
+    size_t used = 0;
+    for (int i = 0; i < CORPUS; i++) {
+        char* out = corpus.text + used;
+        int n;
+        switch (kind) {
+            case 0: n = sprintf(out, "%d", rand() % (i % 4 == 0 ? 1000000000 : 1000)); break;
+            case 1: n = sprintf(out, "0x%X", (unsigned)rand()); break;
+            case 2: n = sprintf(out, "%d.%02d", rand() % 1000, rand() % 100); break;
+            default: n = sprintf(out, "%d.%d%d", rand() % 100000, rand(), rand()); break;
+        }
+        corpus.start[i] = used;
+        corpus.length[i] = (size_t)n;
+        used += (size_t)n + 1;
+    }
+}
+
+static long long strtoll_copied(const char* text, size_t length) {
+    char buffer[128];
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    return length > 2 && buffer[1] == 'x' ? strtoll(buffer + 2, NULL, 16) : strtoll(buffer, NULL, 10);
+}
+
+static double strtod_copied(const char* text, size_t length) {
+    char buffer[128];
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    return strtod(buffer, NULL);
+}
+
+static void bench_integers(const char* name, long iterations) {
+    printf("%s, per corpus of %d\n", name, CORPUS);
+    BENCH_RUN("strtoll (copied)", iterations, {
+        long long sum = 0;
+        for (int i = 0; i < CORPUS; i++) sum += strtoll_copied(corpus.text + corpus.start[i], corpus.length[i]);
+        bench_sink = sum;
+    });
+    BENCH_RUN("strtoll (in place)", iterations, {
+        long long sum = 0;
+        for (int i = 0; i < CORPUS; i++) {
+            const char* text = corpus.text + corpus.start[i];
+            sum += text[1] == 'x' ? strtoll(text + 2, NULL, 16) : strtoll(text, NULL, 10);
+        }
+        bench_sink = sum;
+    });
+    BENCH_RUN("decoder", iterations, {
+        long long sum = 0;
+        for (int i = 0; i < CORPUS; i++) {
+            long long value;
+            expresso_literal_integer(corpus.text + corpus.start[i], corpus.length[i], &value);
+            sum += value;
+        }
+        bench_sink = sum;
+    });
+}
+
+static void bench_floats(const char* name, long iterations) {
+    printf("%s, per corpus of %d\n", name, CORPUS);
+    BENCH_RUN("strtod (copied)", iterations, {
+        double sum = 0;
+        for (int i = 0; i < CORPUS; i++) sum += strtod_copied(corpus.text + corpus.start[i], corpus.length[i]);
+        bench_sink = (long long)sum;
+    });
+    BENCH_RUN("strtod (in place)", iterations, {
+        double sum = 0;
+        for (int i = 0; i < CORPUS; i++) sum += strtod(corpus.text + corpus.start[i], NULL);
+        bench_sink = (long long)sum;
+    });
+    BENCH_RUN("decoder", iterations, {
+        double sum = 0;
+        for (int i = 0; i < CORPUS; i++) {
+            double value;
+            expresso_literal_float(corpus.text + corpus.start[i], corpus.length[i], &value);
+            sum += value;
+        }
+        bench_sink = (long long)sum;
+    });
+}
+
+// End to end: parsing a sum of literals, most of the work is decoding
+static void bench_parse(long iterations) {
+    char expression[CORPUS * 2];
+    size_t used = 0;
+    for (int i = 0; i < 256; i++) {
+        used += (size_t)sprintf(expression + used, "%s%d.%d + %d", i ? " + " : "", rand() % 1000, rand(), rand());
+    }
+
+    printf("parse 512 literals\n");
+    ExpressoAst* ast = expresso_ast_create();
+    BENCH_RUN("fast parser", iterations, {
+        expresso_ast_reset(ast);
+        bench_sink = expresso_fast_parse(expression, ast, NULL);
+    });
+    expresso_ast_destroy(ast);
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000;
+    srand(1);
+
+    build(0);
+    bench_integers("decimal integers", iterations);
+    build(1);
+    bench_integers("hex integers", iterations);
+    build(2);
+    bench_floats("short floats (d.dd)", iterations);
+    build(3);
+    bench_floats("long floats (15-25 digits)", iterations);
+    bench_parse(iterations * 10);
+    return 0;
+}
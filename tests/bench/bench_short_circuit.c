@@ -0,0 +1,43 @@
+#include "bench.h"
+#include "expresso.h"
+#include "jit.h"
+#include <stdlib.h>
+
+// Compares && and || against the same tests combined eagerly with & and |.
+// The left test decides the result for nine values of $a in ten, so the lazy
+// forms skip the costly right operand most of the time.
+#define COSTLY "((($a * 3 + 1) * ($a - 7) / 5 + ($a << 2) % 9) * (($a ^ 99) + 3) - $a / 3 > 100)"
+
+static const char* expressions[] = {
+    "$a % 10 == 0 && " COSTLY,
+    "($a % 10 == 0) & " COSTLY,
+    "$a % 10 != 0 || " COSTLY,
+    "($a % 10 != 0) | " COSTLY,
+};
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 10000000;
+
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        const char* expr = expressions[i];
+        printf("%s\n", expr);
+
+        ExpressoCompiled* compiled = expresso_compile(expr, NULL);
+        long a = 0;
+        expresso_jit_set_enabled(false);
+        BENCH_RUN("bytecode VM", iterations, {
+            Value bindings[] = { value_create_integer(a++ % 1000) };
+            Value v = expresso_eval(compiled, bindings);
+            bench_sink = value_get_integer(v);
+        });
+
+        expresso_jit_set_enabled(true);
+        BENCH_RUN(expresso_jit_enabled() ? "native code" : "native code (unavailable)", iterations, {
+            Value bindings[] = { value_create_integer(a++ % 1000) };
+            Value v = expresso_eval(compiled, bindings);
+            bench_sink = value_get_integer(v);
+        });
+        expresso_compiled_destroy(compiled);
+    }
+    return 0;
+}
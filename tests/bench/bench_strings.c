@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "expresso.h"
+#include "value.h"
+#include <stdlib.h>
+
+// String-heavy evaluation: comparisons and ?: selection over short and long
+// strings, and the copies a caller makes of results. Alongside the time,
+// reports how many string buffers each run allocated and released; short
+// strings should allocate none, and copying a long one should be free.
+#define COPIES 64
+
+// Print the buffer allocations and releases per run since the last reset
+static void report_allocations(long iterations) {
+    ValueAllocationStats stats;
+    value_allocation_stats(&stats);
+    printf("  %-28s %12.2f allocs/op %8.2f releases/op\n", "", (double)stats.allocations / (double)iterations,
+           (double)stats.releases / (double)iterations);
+    value_reset_allocation_stats();
+}
+
+static ExpressoCompiled* compile(const char* expression) {
+    ExpressoCompiled* compiled = expresso_compile(expression, NULL);
+    if (!compiled) {
+        fprintf(stderr, "Failed to compile: %s\n", expression);
+        exit(EXIT_FAILURE);
+    }
+    return compiled;
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000000;
+
+    ExpressoCompiled* select = compile("$name == \"expresso\" ? \"matched\" : \"a result that does not fit inline\"");
+    ExpressoCompiled* compare = compile("$left != $right");
+    ExpressoCompiled* literal = compile("\"a literal long enough to need a buffer\"");
+
+    Value names[2] = {value_create_string("expresso"), value_create_string("espresso")};
+    Value pairs[2] = {value_create_string("a description of the first item"),
+                      value_create_string("a description of the second item")};
+
+    value_reset_allocation_stats();
+    printf("evaluation\n");
+    BENCH_RUN("== to short result", iterations, {
+        Value result = expresso_eval(select, &names[0]);
+        bench_sink = (long long)value_string_length(result);
+        value_destroy(result);
+    });
+    report_allocations(iterations);
+    BENCH_RUN("== to long result", iterations, {
+        Value result = expresso_eval(select, &names[1]);
+        bench_sink = (long long)value_string_length(result);
+        value_destroy(result);
+    });
+    report_allocations(iterations);
+    BENCH_RUN("long != long", iterations, {
+        Value result = expresso_eval(compare, pairs);
+        bench_sink = value_get_integer(result);
+        value_destroy(result);
+    });
+    report_allocations(iterations);
+    BENCH_RUN("long literal", iterations, {
+        Value result = expresso_eval(literal, NULL);
+        bench_sink = (long long)value_string_length(result);
+        value_destroy(result);
+    });
+    report_allocations(iterations);
+
+    Value copies[COPIES];
+    printf("copies, per %d\n", COPIES);
+    BENCH_RUN("copy short", iterations / COPIES, {
+        for (int i = 0; i < COPIES; i++) copies[i] = value_copy(names[0]);
+        for (int i = 0; i < COPIES; i++) value_destroy(copies[i]);
+    });
+    report_allocations(iterations / COPIES);
+    BENCH_RUN("copy long", iterations / COPIES, {
+        for (int i = 0; i < COPIES; i++) copies[i] = value_copy(pairs[0]);
+        for (int i = 0; i < COPIES; i++) value_destroy(copies[i]);
+    });
+    report_allocations(iterations / COPIES);
+
+    for (int i = 0; i < 2; i++) {
+        value_destroy(names[i]);
+        value_destroy(pairs[i]);
+    }
+    expresso_compiled_destroy(select);
+    expresso_compiled_destroy(compare);
+    expresso_compiled_destroy(literal);
+    return 0;
+}
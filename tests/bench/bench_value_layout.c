@@ -0,0 +1,78 @@
+#include "bench.h"
+#include "expresso.h"
+#include "jit.h"
+#include "operations.h"
+#include "value.h"
+#include <stdlib.h>
+
+// Measures the Value representation: scanning columns of values, applying
+// operators to them, and running them through the bytecode VM. Build once
+// as configured by default and once with -DEXPRESSO_NAN_BOXING=ON, and
+// compare the two runs.
+#define COUNT 65536
+
+static Value integers[COUNT];
+static Value floats[COUNT];
+static Value results[COUNT];
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200;
+#ifdef EXPRESSO_NAN_BOXING
+    printf("NaN-boxed values, %zu bytes each\n", sizeof(Value));
+#else
+    printf("Tagged struct values, %zu bytes each\n", sizeof(Value));
+#endif
+
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        integers[i] = value_create_integer((long long)(state % 2000001) - 1000000);
+        floats[i] = value_create_float((double)(state % 100000) / 100.0);
+    }
+
+    printf("columns, per %d values\n", COUNT);
+    BENCH_RUN("sum integers", iterations, {
+        long long sum = 0;
+        for (int i = 0; i < COUNT; i++) {
+            if (value_get_type(integers[i]) == VALUE_TYPE_INTEGER) sum += value_get_integer(integers[i]);
+        }
+        bench_sink = sum;
+    });
+    BENCH_RUN("sum floats", iterations, {
+        double sum = 0;
+        for (int i = 0; i < COUNT; i++) {
+            if (value_get_type(floats[i]) == VALUE_TYPE_FLOAT) sum += value_get_float(floats[i]);
+        }
+        bench_sink = (long long)sum;
+    });
+    BENCH_RUN("integer * float", iterations, {
+        for (int i = 0; i < COUNT; i++) {
+            results[i] = value_by_applying_binary_operator(EXPRESSO_OP_MULTIPLY, integers[i], floats[i]);
+        }
+        bench_sink = (long long)value_get_float(results[COUNT - 1]);
+    });
+    BENCH_RUN("integer < integer", iterations, {
+        for (int i = 0; i < COUNT; i++) {
+            results[i] = value_by_applying_binary_operator(EXPRESSO_OP_LESS, integers[i], integers[COUNT - 1 - i]);
+        }
+        bench_sink = value_get_integer(results[COUNT - 1]);
+    });
+
+    // Without the JIT, so every instruction moves Values through the VM stack
+    expresso_jit_set_enabled(false);
+    ExpressoCompiled* compiled = expresso_compile("($a * 3 + $b - 7) % 1000 < 500 ? $a : $b", NULL);
+    printf("VM, per %d evaluations\n", COUNT);
+    BENCH_RUN("($a * 3 + $b - 7) % 1000 ...", iterations / 10, {
+        long long sum = 0;
+        for (int i = 0; i < COUNT - 1; i++) {
+            Value v = expresso_eval(compiled, &integers[i]);
+            sum += value_get_integer(v);
+            value_destroy(v);
+        }
+        bench_sink = sum;
+    });
+    expresso_compiled_destroy(compiled);
+    return 0;
+}
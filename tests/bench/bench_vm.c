@@ -0,0 +1,55 @@
+#include "bench.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "evaluator.h"
+#include "parser_wrapper.h"
+#include <stdlib.h>
+
+// Compares three ways of evaluating the same expression repeatedly:
+// parsing and evaluating every time, walking a tree parsed once, and
+// running bytecode compiled once.
+static const char* expressions[] = {
+    "1 + 2 * 3",
+    "(17 * 3 + 4) % 7 << 2",
+    "1 < 2 ? (3 & 6) ^ 5 : ~0",
+    "((((1 + 2) * (3 + 4)) - ((5 + 6) * (7 - 8))) / 3) == 14 || 0 && 1",
+};
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000000;
+    ExpressoParserContext* ctx = expresso_parser_create();
+
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        const char* expr = expressions[i];
+        printf("%s\n", expr);
+
+        BENCH_RUN("parse + evaluate (antlr)", iterations / 100, {
+            ExpressoParseTree* tree = expresso_parser_parse(ctx, expr);
+            Value v = evaluate_expression(tree);
+            bench_sink = value_get_integer(v);
+            value_destroy(v);
+            expresso_tree_destroy(tree);
+        });
+
+        ExpressoParseTree* tree = expresso_parser_parse(ctx, expr);
+        const ExpressoAst* ast = expresso_tree_get_ast(tree);
+        BENCH_RUN("tree walker", iterations, {
+            Value v = evaluate_ast(ast);
+            bench_sink = value_get_integer(v);
+            value_destroy(v);
+        });
+
+        ExpressoProgram* program = expresso_program_compile(ast, NULL);
+        BENCH_RUN("bytecode VM", iterations, {
+            Value v = expresso_vm_run(program, NULL);
+            bench_sink = value_get_integer(v);
+            value_destroy(v);
+        });
+
+        expresso_program_destroy(program);
+        expresso_tree_destroy(tree);
+    }
+
+    expresso_parser_destroy(ctx);
+    return 0;
+}
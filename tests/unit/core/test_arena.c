@@ -0,0 +1,152 @@
+#include "assert.h"
+#include "arena.h"
+#include "evaluator.h"
+#include "expresso.h"
+#include "fast_parser.h"
+#include "value.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPEATS 100
+
+static ExpressoAst* parse(const char* expr) {
+    ExpressoAst* ast = expresso_ast_create();
+    expresso_ast_set_sharing(ast, true);
+    ASSERT_TRUE(expresso_fast_parse(expr, ast, NULL), expr);
+    return ast;
+}
+
+// Nested n deep, so the evaluator outgrows its inline work stack
+static char* nested_sum(int n) {
+    char* text = (char*)malloc((size_t)n * 4 + 2);
+    size_t length = 0;
+    for (int i = 0; i < n; i++) length += (size_t)sprintf(text + length, "1+(");
+    text[length++] = '1';
+    memset(text + length, ')', (size_t)n);
+    text[length + (size_t)n] = '\0';
+    return text;
+}
+
+void test_result_leaves_the_arena() {
+    ExpressoAst* ast = parse("1 ? \"a result much too long to be stored inline\" : \"\"");
+    Value result = evaluate_ast(ast);
+    ASSERT_FALSE(value_in_arena(result), "The result should be moved to the heap");
+    expresso_ast_destroy(ast);
+
+    // Reuses the arena the first result came from
+    ast = parse("!\"a string\"");
+    Value error = evaluate_ast(ast);
+    ASSERT_FALSE(value_in_arena(error), "An error result should be moved to the heap");
+    ASSERT_TRUE(strcmp("Type error for logical NOT.", value_as_error_message(&error)) == 0, "Error message mismatch");
+    ASSERT_TRUE(strcmp("a result much too long to be stored inline", value_c_str(&result)) == 0,
+                "The result should outlive the arena");
+    value_destroy(result);
+    value_destroy(error);
+    expresso_ast_destroy(ast);
+
+    // Values made outside an evaluation are on the heap
+    Value string = value_create_string("a string made outside any evaluation");
+    ASSERT_FALSE(value_in_arena(string), "Values outside an evaluation should be on the heap");
+    value_destroy(string);
+}
+
+void test_evaluation_allocates_nothing() {
+    // Long strings, big integers, a deep work stack and shared
+    // subtrees on the way; only the results are kept
+    char* deep = nested_sum(200);
+    const char* expressions[] = {
+        "\"a string literal too long to be inline\" == \"another string literal, also long\"",
+        "9223372036854775807 * 9223372036854775807 / 9223372036854775807 == 9223372036854775807",
+        "(\"shared subtree text, stored once\" == \"x\") + (\"shared subtree text, stored once\" == \"x\")",
+        deep,
+    };
+    size_t count = sizeof(expressions) / sizeof(expressions[0]);
+    ExpressoAst* asts[sizeof(expressions) / sizeof(expressions[0])];
+    for (size_t i = 0; i < count; i++) asts[i] = parse(expressions[i]);
+
+    // The first round sizes the arena
+    for (size_t i = 0; i < count; i++) value_destroy(evaluate_ast(asts[i]));
+
+    value_reset_allocation_stats();
+    expresso_arena_reset_stats();
+    for (int r = 0; r < REPEATS; r++) {
+        for (size_t i = 0; i < count; i++) {
+            Value result = evaluate_ast(asts[i]);
+            ASSERT_TRUE(value_is_integer(result), expressions[i]);
+            value_destroy(result);
+        }
+    }
+    ValueAllocationStats values;
+    ExpressoArenaStats arena;
+    value_allocation_stats(&values);
+    expresso_arena_stats(&arena);
+    ASSERT_EQ(0, values.allocations, "Steady-state evaluation should allocate no values");
+    ASSERT_EQ(0, arena.chunk_allocations, "Steady-state evaluation should not grow the arena");
+
+    for (size_t i = 0; i < count; i++) expresso_ast_destroy(asts[i]);
+    free(deep);
+}
+
+void test_compiled_evaluation_allocates_nothing() {
+    ExpressoCompiled* compiled = expresso_compile("$s == \"a string literal too long to be inline\" || "
+                                                  "$a * $a / $a == $a || !$s", NULL);
+    ASSERT_TRUE(compiled != NULL, "Failed to compile");
+    size_t s = 0, a = 0;
+    ASSERT_TRUE(expresso_parameter_index(compiled, "s", &s) && expresso_parameter_index(compiled, "a", &a),
+                "Parameters not found");
+    Value bindings[2];
+    bindings[s] = value_create_string("a binding too long to be stored inline");
+    bindings[a] = value_create_integer(LLONG_MAX);
+
+    value_destroy(expresso_eval(compiled, bindings));
+    value_reset_allocation_stats();
+    expresso_arena_reset_stats();
+    for (int r = 0; r < REPEATS; r++) {
+        Value result = expresso_eval(compiled, bindings);
+        ASSERT_TRUE(value_is_integer(result) && value_as_integer(result) == 1, "Compiled result is incorrect");
+        value_destroy(result);
+    }
+    ValueAllocationStats values;
+    ExpressoArenaStats arena;
+    value_allocation_stats(&values);
+    expresso_arena_stats(&arena);
+    ASSERT_EQ(0, values.allocations, "Steady-state evaluation should allocate no values");
+    ASSERT_EQ(0, arena.chunk_allocations, "Steady-state evaluation should not grow the arena");
+
+    value_destroy(bindings[0]);
+    value_destroy(bindings[1]);
+    expresso_compiled_destroy(compiled);
+}
+
+void test_arena_grows_to_fit() {
+    // An evaluation that overflows the first chunk makes it larger, once
+    char* deep = nested_sum(2000);
+    ExpressoAst* ast = parse(deep);
+    evaluator_set_max_depth(4000);
+    value_destroy(evaluate_ast(ast));
+
+    expresso_arena_reset_stats();
+    for (int r = 0; r < 10; r++) {
+        Value result = evaluate_ast(ast);
+        ASSERT_EQ(2001, value_as_integer(result), "Deep sum is incorrect");
+    }
+    ExpressoArenaStats arena;
+    expresso_arena_stats(&arena);
+    ASSERT_EQ(0, arena.chunk_allocations, "A grown arena should fit the evaluation");
+
+    evaluator_set_max_depth(0);
+    expresso_ast_destroy(ast);
+    free(deep);
+}
+
+int main() {
+    printf("Running evaluation arena unit tests...\n");
+    test_result_leaves_the_arena();
+    test_evaluation_allocates_nothing();
+    test_compiled_evaluation_allocates_nothing();
+    test_arena_grows_to_fit();
+    printf("All evaluation arena unit tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "assert.h"
+#include "batch.h"
+#include "expresso.h"
+#include "value.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// More than two chunks, ending part way through one
+#define ROWS (2 * EXPRESSO_BATCH_CHUNK + 37)
+
+static long long a_values[ROWS], b_values[ROWS];
+static double x_values[ROWS], y_values[ROWS];
+static uint8_t a_validity[(ROWS + 7) / 8], b_validity[(ROWS + 7) / 8];
+
+static bool is_valid(const uint8_t* validity, size_t row) {
+    return !validity || ((validity[row / 8] >> (row % 8)) & 1);
+}
+
+static void fill_columns() {
+    srand(12345);
+    memset(a_validity, 0, sizeof(a_validity));
+    memset(b_validity, 0, sizeof(b_validity));
+    for (size_t i = 0; i < ROWS; i++) {
+        a_values[i] = rand() % 2001 - 1000;
+        b_values[i] = rand() % 1000 + 1; // Non-zero, so scalar division is defined
+        if (rand() % 2) b_values[i] = -b_values[i];
+        x_values[i] = (double)(rand() % 8) / 4;
+        y_values[i] = (double)(rand() % 8) / 4;
+        if (rand() % 10) a_validity[i / 8] |= (uint8_t)(1u << (i % 8));
+        if (rand() % 10) b_validity[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+}
+
+static ExpressoColumn column_named(const char* name) {
+    ExpressoColumn column = { EXPRESSO_COLUMN_INTEGER, NULL, NULL };
+    switch (name[0]) {
+        case 'a': column.values = a_values; column.validity = a_validity; break;
+        case 'b': column.values = b_values; column.validity = b_validity; break;
+        case 'x': column.type = EXPRESSO_COLUMN_FLOAT; column.values = x_values; break;
+        case 'y': column.type = EXPRESSO_COLUMN_FLOAT; column.values = y_values; break;
+    }
+    return column;
+}
+
+// Check every SIMD level against expresso_eval() row by row. Rows with an
+// invalid input must be invalid unless the expression selects around it.
+static void check_batch_matches_scalar(const char* expr, bool selects) {
+    char assert_msg[160];
+    ExpressoCompiled* compiled = expresso_compile(expr, NULL);
+    snprintf(assert_msg, sizeof(assert_msg), "Failed to compile '%s'", expr);
+    ASSERT_TRUE(compiled != NULL, assert_msg);
+
+    size_t count = expresso_parameter_count(compiled);
+    ExpressoColumn columns[4];
+    ExpressoColumnType types[4];
+    for (size_t p = 0; p < count; p++) {
+        columns[p] = column_named(expresso_parameter_name(compiled, p));
+        types[p] = columns[p].type;
+    }
+
+    ExpressoBatch* batch = expresso_batch_prepare(compiled, types);
+    snprintf(assert_msg, sizeof(assert_msg), "Failed to prepare '%s'", expr);
+    ASSERT_TRUE(batch != NULL, assert_msg);
+
+    static long long result_values[ROWS];
+    static uint8_t result_validity[(ROWS + 7) / 8];
+    for (int level = EXPRESSO_SIMD_SCALAR; level <= EXPRESSO_SIMD_AVX2; level++) {
+        if (!expresso_batch_set_simd_level(batch, (ExpressoSimdLevel)level)) continue;
+
+        ExpressoColumn result = { EXPRESSO_COLUMN_INTEGER, result_values, result_validity };
+        expresso_batch_eval(batch, columns, ROWS, &result);
+        ASSERT_EQ(expresso_batch_result_type(batch), result.type, "Result column type is incorrect");
+
+        for (size_t row = 0; row < ROWS; row++) {
+            bool inputs_valid = true;
+            Value bindings[4];
+            for (size_t p = 0; p < count; p++) {
+                inputs_valid = inputs_valid && is_valid(columns[p].validity, row);
+                bindings[p] = columns[p].type == EXPRESSO_COLUMN_FLOAT
+                    ? value_create_float(((double*)columns[p].values)[row])
+                    : value_create_integer(((long long*)columns[p].values)[row]);
+            }
+            snprintf(assert_msg, sizeof(assert_msg), "'%s' differs at row %zu, SIMD level %d", expr, row, level);
+
+            if (!inputs_valid) {
+                if (!selects) ASSERT_FALSE(is_valid(result_validity, row), assert_msg);
+                continue;
+            }
+            Value expected = expresso_eval(compiled, bindings);
+            if (value_is_error(expected)) {
+                ASSERT_FALSE(is_valid(result_validity, row), assert_msg);
+                value_destroy(expected);
+                continue;
+            }
+            ASSERT_TRUE(is_valid(result_validity, row), assert_msg);
+            if (result.type == EXPRESSO_COLUMN_FLOAT) {
+                ASSERT_TRUE(value_is_float(expected) && value_as_float(expected) == ((double*)result_values)[row], assert_msg);
+            } else {
+                ASSERT_TRUE(value_is_integer(expected) && value_as_integer(expected) == result_values[row], assert_msg);
+            }
+            value_destroy(expected);
+        }
+    }
+
+    expresso_batch_destroy(batch);
+    expresso_compiled_destroy(compiled);
+}
+
+void test_batch_matches_scalar() {
+    check_batch_matches_scalar("$a + $b * 3 - $a", false);
+    check_batch_matches_scalar("($a << 2) >> 1 ^ $b", false);
+    check_batch_matches_scalar("$a < $b && $b >= 0 || !$a", true);
+    check_batch_matches_scalar("$a != 3 && 12 / ($a - 3) < 0", true);
+    check_batch_matches_scalar("$a > 0 || $b > 0", true);
+    check_batch_matches_scalar("~$a & $b | -$b", false);
+    check_batch_matches_scalar("$a / $b + $a % $b", false);
+    check_batch_matches_scalar("$a <= $b == ($a > $b) != 1", false);
+    check_batch_matches_scalar("$x == $y", false);
+    check_batch_matches_scalar("$x != $y", false);
+    check_batch_matches_scalar("$x + $y * 2.5 - -$x", false);
+    check_batch_matches_scalar("$x / $y + $x % $y", false); // Rows where $y is 0.0 fail
+    check_batch_matches_scalar("$x < $y || $x >= $y * 2.0 == ($x <= $y) != ($x > $y)", true);
+    check_batch_matches_scalar("$a > 0 ? $x : $y", true);
+    check_batch_matches_scalar("$a ? $a * 2 : $b", true);
+    check_batch_matches_scalar("6 * 7", false);
+}
+
+void test_batch_division_by_zero_is_invalid() {
+    ExpressoCompiled* compiled = expresso_compile("$a / ($a - 3) + 1", NULL);
+    ExpressoColumnType types[] = { EXPRESSO_COLUMN_INTEGER };
+    ExpressoBatch* batch = expresso_batch_prepare(compiled, types);
+    ASSERT_TRUE(batch != NULL, "Failed to prepare division");
+
+    long long values[] = { 6, 3, 4 };
+    long long out[3];
+    uint8_t validity = 0;
+    ExpressoColumn column = { EXPRESSO_COLUMN_INTEGER, values, NULL };
+    ExpressoColumn result = { EXPRESSO_COLUMN_INTEGER, out, &validity };
+    expresso_batch_eval(batch, &column, 3, &result);
+    ASSERT_EQ(0x5, validity, "Only the row dividing by zero should be invalid");
+    ASSERT_EQ(3, out[0], "6 / 3 + 1 is incorrect");
+    ASSERT_EQ(5, out[2], "4 / 1 + 1 is incorrect");
+
+    expresso_batch_destroy(batch);
+    expresso_compiled_destroy(compiled);
+}
+
+// Rows that overflow are invalid at every SIMD level, wherever they fall
+// in a vector or the scalar tail. Where only a value on the way overflows,
+// the scalar result can still be an integer.
+void test_batch_overflow_is_invalid() {
+    const char* exprs[] = { "$a + $a", "$a - 1 - $a", "-$a", "$a * 3" };
+    long long values[21];
+    for (size_t i = 0; i < 21; i++) values[i] = (long long)i - 10;
+    values[3] = LLONG_MAX;
+    values[9] = LLONG_MIN;
+    values[17] = LLONG_MAX / 2 + 1;
+    values[20] = LLONG_MIN;
+
+    for (size_t e = 0; e < sizeof(exprs) / sizeof(exprs[0]); e++) {
+        ExpressoCompiled* compiled = expresso_compile(exprs[e], NULL);
+        ExpressoColumnType types[] = { EXPRESSO_COLUMN_INTEGER };
+        ExpressoBatch* batch = expresso_batch_prepare(compiled, types);
+        ASSERT_TRUE(batch != NULL, exprs[e]);
+
+        for (int level = EXPRESSO_SIMD_SCALAR; level <= EXPRESSO_SIMD_AVX2; level++) {
+            if (!expresso_batch_set_simd_level(batch, (ExpressoSimdLevel)level)) continue;
+            long long out[21];
+            uint8_t validity[3];
+            ExpressoColumn column = { EXPRESSO_COLUMN_INTEGER, values, NULL };
+            ExpressoColumn result = { EXPRESSO_COLUMN_INTEGER, out, validity };
+            expresso_batch_eval(batch, &column, 21, &result);
+
+            for (size_t row = 0; row < 21; row++) {
+                char assert_msg[160];
+                Value binding = value_create_integer(values[row]);
+                Value expected = expresso_eval(compiled, &binding);
+                snprintf(assert_msg, sizeof(assert_msg), "'%s' differs at row %zu, SIMD level %d", exprs[e], row, level);
+                if (!value_is_integer(expected)) ASSERT_FALSE(is_valid(validity, row), assert_msg);
+                if (values[row] >= -10 && values[row] <= 10) ASSERT_TRUE(is_valid(validity, row), assert_msg);
+                if (is_valid(validity, row)) ASSERT_EQ(value_as_integer(expected), out[row], assert_msg);
+                value_destroy(expected);
+                value_destroy(binding);
+            }
+        }
+
+        expresso_batch_destroy(batch);
+        expresso_compiled_destroy(compiled);
+    }
+}
+
+void test_batch_rejects_unsupported_expressions() {
+    const char* exprs[] = { "$x + 1", "'a' == $a", "$a ? $a : $x", "$a == $x", "$x ? 1 : 2", "$x && $y" };
+    ExpressoColumnType types[] = { EXPRESSO_COLUMN_FLOAT, EXPRESSO_COLUMN_FLOAT };
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        ExpressoCompiled* compiled = expresso_compile(exprs[i], NULL);
+        types[0] = exprs[i][1] == 'x' ? EXPRESSO_COLUMN_FLOAT : EXPRESSO_COLUMN_INTEGER;
+        ASSERT_TRUE(expresso_batch_prepare(compiled, types) == NULL, exprs[i]);
+        expresso_compiled_destroy(compiled);
+    }
+}
+
+int main() {
+    printf("Running batch evaluation unit tests...\n");
+    fill_columns();
+    test_batch_matches_scalar();
+    test_batch_division_by_zero_is_invalid();
+    test_batch_overflow_is_invalid();
+    test_batch_rejects_unsupported_expressions();
+    printf("All batch evaluation unit tests passed!\n");
+    return 0;
+}
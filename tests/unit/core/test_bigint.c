@@ -0,0 +1,187 @@
+#include "assert.h"
+#include "arena.h"
+#include "bigint.h"
+#include "operations.h"
+#include "value.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void assert_digits(const char* expected, Value value, const char* message) {
+    char* digits;
+    if (value_is_bigint(value)) {
+        digits = expresso_bigint_to_string(value_get_bigint(value));
+    } else {
+        ASSERT_TRUE(value_is_integer(value), message);
+        digits = (char*)malloc(32);
+        snprintf(digits, 32, "%lld", value_as_integer(value));
+    }
+    if (strcmp(expected, digits) != 0) fprintf(stderr, "Expected %s, got %s\n", expected, digits);
+    ASSERT_TRUE(strcmp(expected, digits) == 0, message);
+    free(digits);
+}
+
+static char* repeated_digits(size_t n, char digit) {
+    char* text = (char*)malloc(n + 1);
+    memset(text, digit, n);
+    text[n] = '\0';
+    return text;
+}
+
+void test_parse_and_print() {
+    const char* numbers[] = {
+        "0", "-1", "9223372036854775807", "-9223372036854775808",
+        "9223372036854775808", "-9223372036854775809", "18446744073709551616",
+        "340282366920938463463374607431768211455", "-10000000000000000000000000000000000000000",
+    };
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        Value value = expresso_bigint_parse(numbers[i]);
+        assert_digits(numbers[i], value, numbers[i]);
+        value_destroy(value);
+    }
+
+    // Values that fit in 64 bits stay integers
+    Value value = expresso_bigint_parse("-9223372036854775808");
+    ASSERT_TRUE(value_is_integer(value), "LLONG_MIN should be an integer");
+    value_destroy(value);
+    value = expresso_bigint_parse("9223372036854775808");
+    ASSERT_TRUE(value_is_bigint(value), "LLONG_MAX + 1 should be a big integer");
+    ASSERT_FALSE(value_get_bigint(value)->in_arena, "Outside an evaluation, big integers are on the heap");
+    value_destroy(value);
+
+    value = expresso_bigint_parse("12a");
+    ASSERT_TRUE(value_is_error(value), "Non-digits should be rejected");
+    value_destroy(value);
+
+    // Hex digits are a magnitude, sixteen to a limb
+    const char* hex[][2] = {
+        { "0x7FFFFFFFFFFFFFFF", "9223372036854775807" },
+        { "0xFFFFFFFFFFFFFFFF", "18446744073709551615" },
+        { "-0x8000000000000000", "-9223372036854775808" },
+        { "0x10000000000000000", "18446744073709551616" },
+        { "0x0000000000000000000000000ff", "255" },
+    };
+    for (size_t i = 0; i < sizeof(hex) / sizeof(hex[0]); i++) {
+        value = expresso_bigint_parse(hex[i][0]);
+        assert_digits(hex[i][1], value, hex[i][0]);
+        value_destroy(value);
+    }
+    value = expresso_bigint_parse("0x");
+    ASSERT_TRUE(value_is_error(value), "Hex needs at least one digit");
+    value_destroy(value);
+    value = expresso_bigint_parse("0xfg");
+    ASSERT_TRUE(value_is_error(value), "Non-hex digits should be rejected");
+    value_destroy(value);
+}
+
+void test_karatsuba_product() {
+    // 2000 digits is over 100 limbs, well past the Karatsuba threshold
+    // (10^n - 1)^2 is n - 1 nines, an 8, n - 1 zeros and a 1
+    const size_t n = 2000;
+    char* nines = repeated_digits(n, '9');
+    Value x = expresso_bigint_parse(nines);
+    Value square = value_by_multiplying_values(x, x);
+
+    char* expected = (char*)malloc(2 * n + 1);
+    memset(expected, '9', n - 1);
+    expected[n - 1] = '8';
+    memset(expected + n, '0', n - 1);
+    expected[2 * n - 1] = '1';
+    expected[2 * n] = '\0';
+    assert_digits(expected, square, "(10^n - 1)^2 is incorrect");
+
+    // Unbalanced operands, and division undoing the product
+    Value small = expresso_bigint_parse("123456789012345678901234567890123456789");
+    Value product = value_by_multiplying_values(square, small);
+    Value quotient = value_by_dividing_values(product, square);
+    Value remainder = value_by_modulasing_values(product, small);
+    assert_digits("123456789012345678901234567890123456789", quotient, "Quotient of the product is incorrect");
+    assert_digits("0", remainder, "Remainder of the product is incorrect");
+
+    Value offset = value_by_adding_values(product, value_create_integer(12345));
+    Value rest = value_by_modulasing_values(offset, square);
+    assert_digits("12345", rest, "Remainder after an offset is incorrect");
+
+    Value values[] = { x, square, small, product, quotient, remainder, offset, rest };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) value_destroy(values[i]);
+    free(expected);
+    free(nines);
+}
+
+void test_signs_and_comparison() {
+    Value big = expresso_bigint_parse("-55340232221128654849"); // -(3 * 2^64 + 1)
+    Value two64 = expresso_bigint_parse("18446744073709551616");
+
+    // Division truncates toward zero, and the remainder takes the dividend's sign
+    Value quotient = value_by_dividing_values(big, two64);
+    Value remainder = value_by_modulasing_values(big, two64);
+    assert_digits("-3", quotient, "Quotient should truncate toward zero");
+    assert_digits("-1", remainder, "Remainder should take the dividend's sign");
+
+    Value sum = value_by_adding_values(big, two64);
+    assert_digits("-36893488147419103233", sum, "Sum of mixed signs is incorrect");
+    Value negated = value_by_negating_value(big);
+    assert_digits("55340232221128654849", negated, "Negation is incorrect");
+
+    Value minimum = value_create_integer(LLONG_MIN);
+    ASSERT_TRUE(expresso_bigint_compare(big, minimum) < 0, "Ordering across types is incorrect");
+    value_destroy(minimum);
+    ASSERT_TRUE(expresso_bigint_compare(two64, negated) < 0, "Ordering of magnitudes is incorrect");
+    Value again = value_by_negating_value(negated);
+    ASSERT_TRUE(value_equals(big, again), "Negating twice should give the original");
+    value_destroy(again);
+    Value failed = value_by_dividing_values(two64, value_create_integer(0));
+    ASSERT_TRUE(value_is_error(failed), "Division by zero should fail");
+    value_destroy(failed);
+
+    Value values[] = { big, two64, quotient, remainder, sum, negated };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) value_destroy(values[i]);
+}
+
+void test_arena() {
+    ExpressoArenaMark mark = expresso_arena_enter();
+    Value maximum = value_create_integer(LLONG_MAX);
+    Value a = value_by_adding_values(maximum, maximum);
+    value_destroy(maximum);
+    ASSERT_TRUE(value_is_bigint(a) && value_get_bigint(a)->in_arena, "Results should be in the arena");
+    Value b = value_by_multiplying_values(a, a);
+    value_destroy(a);
+
+    // The result moves to the heap as the evaluation leaves
+    b = expresso_arena_leave(mark, b);
+    ASSERT_TRUE(value_is_bigint(b) && !value_get_bigint(b)->in_arena, "The result should be on the heap");
+    assert_digits("340282366920938463389587631136930004996", b, "Result after leaving is incorrect");
+
+    Value copy = value_copy(b);
+    ASSERT_TRUE(value_equals(b, copy), "A copy should equal the original");
+    value_destroy(copy);
+    value_destroy(b);
+}
+
+void test_size_limit() {
+    // Squaring doubles the limbs until the result would be too large
+    Value value = expresso_bigint_parse("18446744073709551617");
+    size_t squarings = 0;
+    while (value_is_bigint(value)) {
+        Value square = value_by_multiplying_values(value, value);
+        value_destroy(value);
+        value = square;
+        squarings++;
+    }
+    ASSERT_TRUE(value_is_error(value) && strcmp(value_as_error_message(&value), "Numeric overflow.") == 0,
+                "An oversized result should be reported as overflow");
+    ASSERT_EQ(16, (int)squarings, "Results up to the limit should be computed");
+    value_destroy(value);
+}
+
+int main() {
+    printf("Running Big Integer unit tests...\n");
+    test_parse_and_print();
+    test_karatsuba_product();
+    test_signs_and_comparison();
+    test_arena();
+    test_size_limit();
+    printf("All Big Integer unit tests passed!\n");
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include "assert.h"
 #include "evaluator.h"
 #include "value.h"
+#include "bigint.h"
 #include "parser_wrapper.h" // Include parser_wrapper.h
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -89,7 +91,7 @@ void test_evaluate_hello_string() {
 
     Value result = evaluate_expression(tree);
     ASSERT_TRUE(value_is_string(result), "Result of '\"hello\"' should be string");
-    ASSERT_TRUE(strcmp("hello", value_c_str(result)) == 0, "Result of '\"hello\"' should be \"hello\"");
+    ASSERT_TRUE(strcmp("hello", value_c_str(&result)) == 0, "Result of '\"hello\"' should be \"hello\"");
     value_destroy(result);
     expresso_tree_destroy(tree);
     expresso_parser_destroy(parser_ctx);
@@ -104,7 +106,7 @@ void test_evaluate_unknown_expression() {
 
     Value result = evaluate_expression(tree);
     ASSERT_TRUE(value_is_error(result), "Result of unknown expression should be error");
-    ASSERT_TRUE(strstr(value_as_error_message(result), "Cannot evaluate") != NULL, "Error message should contain 'Cannot evaluate'");
+    ASSERT_TRUE(strstr(value_as_error_message(&result), "Cannot evaluate") != NULL, "Error message should contain 'Cannot evaluate'");
     value_destroy(result);
     expresso_tree_destroy(tree);
     expresso_parser_destroy(parser_ctx);
@@ -148,15 +150,325 @@ void test_evaluate_parenthesized_expression() {
 
     Value result = evaluate_expression(tree);
     Value type = value_type_as_string(result);
-    snprintf(assert_msg, sizeof(assert_msg), "Parenthesized expression result is %s, but should be integer", value_c_str(type));
+    snprintf(assert_msg, sizeof(assert_msg), "Parenthesized expression result is %s, but should be integer", value_c_str(&type));
     ASSERT_TRUE(value_is_integer(result), assert_msg);
     ASSERT_EQ(16, value_as_integer(result), "Parenthesized expression result is incorrect");
+    value_destroy(type);
 
     value_destroy(result);
     expresso_tree_destroy(tree);
     expresso_parser_destroy(parser_ctx);
 }
 
+void test_evaluate_comparison_bitwise_and_conditional() {
+    char assert_msg[128];
+    ExpressoParserContext* parser_ctx = expresso_parser_create();
+    ASSERT_TRUE(parser_ctx != NULL, "Failed to create parser context");
+
+    struct {
+        const char* expr;
+        long long expected;
+    } cases[] = {
+        { "1 << 2 ? 4 : 0", 4 },
+        { "0 ? 1 : 2", 2 },
+        { "3 < 5", 1 },
+        { "3 >= 5", 0 },
+        { "2 + 2 == 4", 1 },
+        { "6 & 3 | 8 ^ 1", 11 },
+        { "-16 >> 2", -4 },
+        { "1 << -1", 0 },
+        { "1 && 0 || 1", 1 },
+        { "!(1 && 0) ? 1 : 0", 1 },
+        // The right operand is only evaluated if the left does not decide
+        { "0 && 1 / 0", 0 },
+        { "1 || 1 / 0", 1 },
+        { "0 && \"s\"", 0 },
+        { "1 || -\"s\"", 1 },
+        { "2 && 3", 1 },
+        { "0 || -5", 1 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, cases[i].expr);
+        snprintf(assert_msg, sizeof(assert_msg), "Failed to parse '%s'", cases[i].expr);
+        ASSERT_TRUE(tree != NULL, assert_msg);
+
+        Value result = evaluate_expression(tree);
+        snprintf(assert_msg, sizeof(assert_msg), "'%s' should be %lld", cases[i].expr, cases[i].expected);
+        ASSERT_TRUE(value_is_integer(result), assert_msg);
+        ASSERT_EQ(cases[i].expected, value_as_integer(result), assert_msg);
+        value_destroy(result);
+        expresso_tree_destroy(tree);
+    }
+
+    expresso_parser_destroy(parser_ctx);
+}
+
+// Characters act as integers, a float operand makes both floats, and
+// integer arithmetic is 64-bit
+void test_evaluate_numeric_promotion() {
+    char assert_msg[128];
+    ExpressoParserContext* parser_ctx = expresso_parser_create();
+    ASSERT_TRUE(parser_ctx != NULL, "Failed to create parser context");
+
+    struct {
+        const char* expr;
+        ValueType type;
+        long long integer;
+        double real;
+    } cases[] = {
+        { "'a' + 1", VALUE_TYPE_INTEGER, 98, 0 },
+        { "'b' - 'a'", VALUE_TYPE_INTEGER, 1, 0 },
+        { "'a' == 97", VALUE_TYPE_INTEGER, 1, 0 },
+        { "1 == 1.0", VALUE_TYPE_INTEGER, 1, 0 },
+        { "2.5 < 3", VALUE_TYPE_INTEGER, 1, 0 },
+        { "\"a\" == 1", VALUE_TYPE_INTEGER, 0, 0 },
+        { "\"a\" != 'a'", VALUE_TYPE_INTEGER, 1, 0 },
+        { "7 / 2.0", VALUE_TYPE_FLOAT, 0, 3.5 },
+        { "'b' * 1.5", VALUE_TYPE_FLOAT, 0, 147.0 },
+        { "7.5 % 2", VALUE_TYPE_FLOAT, 0, 1.5 },
+        { "3000000000 * 3", VALUE_TYPE_INTEGER, 9000000000LL, 0 },
+        { "4611686018427387904 + 4611686018427387903", VALUE_TYPE_INTEGER, LLONG_MAX, 0 },
+        { "-1.5", VALUE_TYPE_FLOAT, 0, -1.5 },
+        { "-(2.5 * 2)", VALUE_TYPE_FLOAT, 0, -5.0 },
+        { "!1.5", VALUE_TYPE_INTEGER, 0, 0 },
+        { "!0.0", VALUE_TYPE_INTEGER, 1, 0 },
+        { "1.5 && 1", VALUE_TYPE_INTEGER, 1, 0 },
+        { "0.0 || 1", VALUE_TYPE_INTEGER, 1, 0 },
+        { "0.0 && 1 / 0", VALUE_TYPE_INTEGER, 0, 0 },
+        { "1 && 0.5", VALUE_TYPE_INTEGER, 1, 0 },
+        { "1.5 ? 2 : 3", VALUE_TYPE_INTEGER, 2, 0 },
+        { "0.0 ? 2 : 3", VALUE_TYPE_INTEGER, 3, 0 },
+        { "1.5 & 1", VALUE_TYPE_ERROR, 0, 0 },
+        { "-'a'", VALUE_TYPE_ERROR, 0, 0 },
+        { "\"s\" * 2", VALUE_TYPE_ERROR, 0, 0 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, cases[i].expr);
+        snprintf(assert_msg, sizeof(assert_msg), "Failed to parse '%s'", cases[i].expr);
+        ASSERT_TRUE(tree != NULL, assert_msg);
+
+        Value result = evaluate_expression(tree);
+        snprintf(assert_msg, sizeof(assert_msg), "'%s' has the wrong type or value", cases[i].expr);
+        ASSERT_EQ(cases[i].type, value_get_type(result), assert_msg);
+        if (cases[i].type == VALUE_TYPE_INTEGER) ASSERT_EQ(cases[i].integer, value_as_integer(result), assert_msg);
+        if (cases[i].type == VALUE_TYPE_FLOAT) ASSERT_TRUE(value_as_float(result) == cases[i].real, assert_msg);
+        value_destroy(result);
+        expresso_tree_destroy(tree);
+    }
+
+    expresso_parser_destroy(parser_ctx);
+}
+
+// Division by zero is reported as an error, not trapped
+void test_evaluate_arithmetic_failures() {
+    char assert_msg[128];
+    ExpressoParserContext* parser_ctx = expresso_parser_create();
+    ASSERT_TRUE(parser_ctx != NULL, "Failed to create parser context");
+
+    struct {
+        const char* expr;
+        const char* message;
+    } cases[] = {
+        { "1 / 0", "Division by zero." },
+        { "7 % (2 - 2)", "Division by zero." },
+        { "1.5 / 0", "Division by zero." },
+        { "2.5 % 0.0", "Division by zero." },
+        { "(9223372036854775807 + 1) / 0", "Division by zero." },
+        { "(9223372036854775807 + 1) & 1", "Type error." },
+        { "~(9223372036854775807 + 1)", "Type error for bitwise NOT." },
+        { "1 / 0 + 1", "Division by zero." },
+        { "2 * (1 % 0)", "Division by zero." },
+        { "1.5 < 1 / 0", "Division by zero." },
+        { "(1 / 0) == (2 % 0)", "Division by zero." },
+        { "\"a\" + 1 / 0", "Division by zero." },
+        { "1 / 0 + \"a\"", "Division by zero." },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, cases[i].expr);
+        snprintf(assert_msg, sizeof(assert_msg), "Failed to parse '%s'", cases[i].expr);
+        ASSERT_TRUE(tree != NULL, assert_msg);
+
+        Value result = evaluate_expression(tree);
+        snprintf(assert_msg, sizeof(assert_msg), "'%s' should fail with '%s'", cases[i].expr, cases[i].message);
+        ASSERT_TRUE(value_is_error(result), assert_msg);
+        ASSERT_TRUE(strcmp(cases[i].message, value_as_error_message(&result)) == 0, assert_msg);
+        value_destroy(result);
+        expresso_tree_destroy(tree);
+    }
+
+    // LLONG_MIN % -1 has a result, although the division instruction traps on it
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, "(-9223372036854775807 - 1) % -1");
+    Value result = evaluate_expression(tree);
+    ASSERT_TRUE(value_is_integer(result) && value_as_integer(result) == 0, "LLONG_MIN % -1 should be 0");
+    value_destroy(result);
+    expresso_tree_destroy(tree);
+
+    expresso_parser_destroy(parser_ctx);
+}
+
+// Results beyond 64 bits become big integers, and return to integers once
+// they fit again
+void test_evaluate_big_integers() {
+    char assert_msg[160];
+    ExpressoParserContext* parser_ctx = expresso_parser_create();
+    ASSERT_TRUE(parser_ctx != NULL, "Failed to create parser context");
+
+    struct {
+        const char* expr;
+        ValueType type;
+        const char* digits;
+    } cases[] = {
+        { "4611686018427387904 * 2", VALUE_TYPE_BIGINT, "9223372036854775808" },
+        { "9223372036854775807 + 1", VALUE_TYPE_BIGINT, "9223372036854775808" },
+        { "-9223372036854775807 - 2", VALUE_TYPE_BIGINT, "-9223372036854775809" },
+        { "(-9223372036854775807 - 1) / -1", VALUE_TYPE_BIGINT, "9223372036854775808" },
+        { "-(-9223372036854775807 - 1)", VALUE_TYPE_BIGINT, "9223372036854775808" },
+        { "9223372036854775807 * 9223372036854775807", VALUE_TYPE_BIGINT, "85070591730234615847396907784232501249" },
+        { "(9223372036854775807 * 9223372036854775807) % 1000000007 * -1", VALUE_TYPE_INTEGER, "-737564071" },
+        { "(9223372036854775807 + 1) - 1", VALUE_TYPE_INTEGER, "9223372036854775807" },
+        { "9223372036854775807 * 9223372036854775807 / 9223372036854775807", VALUE_TYPE_INTEGER, "9223372036854775807" },
+        { "(9223372036854775807 + 2) > 9223372036854775807 + 1", VALUE_TYPE_INTEGER, "1" },
+        { "(9223372036854775807 + 1) == 'a' + 9223372036854775807 - 96", VALUE_TYPE_INTEGER, "1" },
+        { "(9223372036854775807 + 1) == \"a\"", VALUE_TYPE_INTEGER, "0" },
+        { "9223372036854775807 + 1 ? 2 : 3", VALUE_TYPE_INTEGER, "2" },
+        { "!(9223372036854775807 + 1) || 0", VALUE_TYPE_INTEGER, "0" },
+        // A big integer is a true condition on the left of && and ||
+        { "(9223372036854775807 + 1) && 1", VALUE_TYPE_INTEGER, "1" },
+        { "(9223372036854775807 + 1) && 0", VALUE_TYPE_INTEGER, "0" },
+        { "(9223372036854775807 + 1) || 1 / 0", VALUE_TYPE_INTEGER, "1" },
+        { "(-9223372036854775807 - 2) || 0", VALUE_TYPE_INTEGER, "1" },
+        // Literals too large for a long long are big integers
+        { "9223372036854775808", VALUE_TYPE_BIGINT, "9223372036854775808" },
+        { "-9223372036854775808", VALUE_TYPE_INTEGER, "-9223372036854775808" },
+        { "0xFFFFFFFFFFFFFFFF", VALUE_TYPE_BIGINT, "18446744073709551615" },
+        { "0x8000000000000000 - 1", VALUE_TYPE_INTEGER, "9223372036854775807" },
+        { "100000000000000000000 / 10", VALUE_TYPE_BIGINT, "10000000000000000000" },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, cases[i].expr);
+        snprintf(assert_msg, sizeof(assert_msg), "Failed to parse '%s'", cases[i].expr);
+        ASSERT_TRUE(tree != NULL, assert_msg);
+
+        Value result = evaluate_expression(tree);
+        snprintf(assert_msg, sizeof(assert_msg), "'%s' should be %s", cases[i].expr, cases[i].digits);
+        ASSERT_EQ(cases[i].type, value_get_type(result), assert_msg);
+        char digits[64];
+        if (value_is_bigint(result)) {
+            char* text = expresso_bigint_to_string(value_get_bigint(result));
+            snprintf(digits, sizeof(digits), "%s", text);
+            free(text);
+        } else {
+            snprintf(digits, sizeof(digits), "%lld", value_as_integer(result));
+        }
+        ASSERT_TRUE(strcmp(cases[i].digits, digits) == 0, assert_msg);
+        value_destroy(result);
+        expresso_tree_destroy(tree);
+    }
+
+    // Mixed with a float, a big integer is converted like an integer
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, "(9223372036854775807 + 1) * 0.5");
+    Value result = evaluate_expression(tree);
+    ASSERT_TRUE(value_is_float(result) && value_as_float(result) == 4611686018427387904.0,
+                "A big integer times 0.5 should be a float");
+    value_destroy(result);
+    expresso_tree_destroy(tree);
+
+    expresso_parser_destroy(parser_ctx);
+}
+
+void test_evaluate_deep_nesting() {
+    // Far deeper than a recursive walk could go on the native stack
+    const int depth = 300000;
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoNodeIndex node = expresso_ast_add_integer(ast, 0);
+    long long expected = 0;
+    for (int level = 0; level < depth; level++) {
+        if (level % 2) {
+            node = expresso_ast_add_unary(ast, EXPRESSO_OP_NEGATE, node);
+            expected = -expected;
+        } else {
+            node = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, expresso_ast_add_integer(ast, 1), node);
+            expected = 1 + expected;
+        }
+    }
+    ast->root = node;
+
+    evaluator_set_max_depth(depth + 1);
+    Value result = evaluate_ast(ast);
+    ASSERT_TRUE(value_is_integer(result), "Deeply nested expression should evaluate");
+    ASSERT_EQ(expected, value_as_integer(result), "Deeply nested expression result is incorrect");
+
+    evaluator_set_max_depth(1000);
+    result = evaluate_ast(ast);
+    ASSERT_TRUE(value_is_error(result), "Nesting beyond the maximum depth should be an error");
+    ASSERT_TRUE(strcmp(value_as_error_message(&result), "Expression nested too deeply.") == 0, "Depth error message is incorrect");
+    value_destroy(result);
+
+    evaluator_set_max_depth(0);
+    ASSERT_EQ(EXPRESSO_EVAL_DEFAULT_MAX_DEPTH, evaluator_max_depth(), "0 should restore the default depth");
+    expresso_ast_destroy(ast);
+}
+
+void test_evaluate_shared_subtrees() {
+    // The parser stores (2 * 3 - 1) once; it has two parents
+    ExpressoParserContext* parser_ctx = expresso_parser_create();
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, "(2 * 3 - 1) * (2 * 3 - 1)");
+    ASSERT_TRUE(tree != NULL, "Failed to parse shared expression");
+    ExpressoSharingStats stats;
+    expresso_ast_sharing_stats(expresso_tree_get_ast(tree), &stats);
+    ASSERT_EQ(11, (long long)stats.nodes_added, "Every node should be requested");
+    ASSERT_EQ(6, (long long)stats.nodes_stored, "Repeated subtree should be stored once");
+    ASSERT_EQ(1, (long long)stats.shared_nodes, "Repeated subtree should have two parents");
+    Value result = evaluate_expression(tree);
+    ASSERT_EQ(25, value_as_integer(result), "Shared expression result is incorrect");
+    expresso_tree_destroy(tree);
+    expresso_parser_destroy(parser_ctx);
+
+    // x + x doubled 30 times is 2^30 tree nodes but only 31 stored ones;
+    // evaluating each shared node once keeps this instant
+    ExpressoAst* ast = expresso_ast_create();
+    expresso_ast_set_sharing(ast, true);
+    ExpressoNodeIndex node = expresso_ast_add_integer(ast, 1);
+    for (int level = 0; level < 30; level++) {
+        node = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, node, node);
+    }
+    // A shared conditional, whose branch replaces the frame when unshared
+    ExpressoNodeIndex choice = expresso_ast_add_conditional(ast, expresso_ast_add_integer(ast, 1), node,
+                                                           expresso_ast_add_integer(ast, 0));
+    ast->root = expresso_ast_add_binary(ast, EXPRESSO_OP_SUBTRACT, choice, expresso_ast_add_conditional(ast, expresso_ast_add_integer(ast, 1), node, expresso_ast_add_integer(ast, 0)));
+    ASSERT_TRUE(expresso_ast_is_shared(ast, choice), "Repeated conditional should be shared");
+    result = evaluate_ast(ast);
+    ASSERT_TRUE(value_is_integer(result), "Shared tree should evaluate");
+    ASSERT_EQ(0, value_as_integer(result), "Shared conditional result is incorrect");
+
+    ast->root = node;
+    result = evaluate_ast(ast);
+    ASSERT_EQ(1LL << 30, value_as_integer(result), "Doubling chain result is incorrect");
+
+    // Re-sharing an unshared tree finds the same structure
+    ExpressoAst* plain = expresso_ast_create();
+    ExpressoNodeIndex text = expresso_ast_add_string(plain, "ab", 2);
+    ExpressoNodeIndex again = expresso_ast_add_string(plain, "ab", 2);
+    plain->root = expresso_ast_add_binary(plain, EXPRESSO_OP_ADD,
+                                          expresso_ast_add_binary(plain, EXPRESSO_OP_ADD, text, expresso_ast_add_integer(plain, 7)),
+                                          expresso_ast_add_binary(plain, EXPRESSO_OP_ADD, again, expresso_ast_add_integer(plain, 7)));
+    expresso_ast_share(plain, ast);
+    ASSERT_EQ(4, (long long)ast->count, "Re-shared tree should store each subtree once");
+    ASSERT_TRUE(expresso_ast_equal(plain, plain->root, ast, ast->root), "Re-shared tree should be equal to the original");
+    Value plain_result = evaluate_ast(plain);
+    result = evaluate_ast(ast);
+    ASSERT_TRUE(strcmp(value_c_str(&plain_result), value_c_str(&result)) == 0, "Re-shared tree should evaluate the same");
+    value_destroy(plain_result);
+    value_destroy(result);
+
+    expresso_ast_destroy(plain);
+    expresso_ast_destroy(ast);
+}
+
 int main() {
     printf("Running Evaluator unit tests...\n");
     test_evaluate_arithmetic_operations();
@@ -164,6 +476,12 @@ int main() {
     test_evaluate_unknown_expression();
     test_evaluate_sequence_of_expressions();
     test_evaluate_parenthesized_expression();
+    test_evaluate_comparison_bitwise_and_conditional();
+    test_evaluate_numeric_promotion();
+    test_evaluate_arithmetic_failures();
+    test_evaluate_big_integers();
+    test_evaluate_deep_nesting();
+    test_evaluate_shared_subtrees();
     printf("All Evaluator unit tests passed!\n");
     return 0;
 }
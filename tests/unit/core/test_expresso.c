@@ -0,0 +1,144 @@
+#include "assert.h"
+#include "expresso.h"
+#include "evaluator.h"
+#include "jit.h"
+#include "value.h"
+#include <stdio.h>
+#include <string.h>
+
+void test_compile_and_eval_with_bindings() {
+    ExpressoCompiled* compiled = expresso_compile("$price * $qty + $price", NULL);
+    ASSERT_TRUE(compiled != NULL, "Failed to compile parameterised expression");
+    ASSERT_EQ(2, expresso_parameter_count(compiled), "Parameter count is incorrect");
+    ASSERT_TRUE(strcmp(expresso_parameter_name(compiled, 0), "price") == 0, "First parameter should be price");
+    ASSERT_TRUE(strcmp(expresso_parameter_name(compiled, 1), "qty") == 0, "Second parameter should be qty");
+
+    size_t qty;
+    ASSERT_TRUE(expresso_parameter_index(compiled, "qty", &qty), "qty should be found");
+    ASSERT_EQ(1, qty, "qty index is incorrect");
+    ASSERT_FALSE(expresso_parameter_index(compiled, "tax", NULL), "tax should not be found");
+
+    for (int row = 0; row < 100; row++) {
+        Value bindings[2];
+        bindings[0] = value_create_integer(row);
+        bindings[1] = value_create_integer(3);
+        Value result = expresso_eval(compiled, bindings);
+        ASSERT_TRUE(value_is_integer(result), "Result should be integer");
+        ASSERT_EQ(row * 4, value_as_integer(result), "Result is incorrect");
+        value_destroy(result);
+    }
+
+    expresso_compiled_destroy(compiled);
+}
+
+void test_eval_borrows_string_bindings() {
+    ExpressoCompiled* compiled = expresso_compile("$greeting == \"hello\"", NULL);
+    ASSERT_TRUE(compiled != NULL, "Failed to compile string expression");
+
+    Value greeting = value_create_string("hello");
+    for (int i = 0; i < 2; i++) {
+        Value result = expresso_eval(compiled, &greeting);
+        ASSERT_TRUE(value_is_integer(result), "Result should be integer");
+        ASSERT_EQ(1, value_as_integer(result), "String comparison is incorrect");
+        value_destroy(result);
+    }
+    ASSERT_TRUE(strcmp(value_as_string(&greeting), "hello") == 0, "Binding should be left intact");
+    value_destroy(greeting);
+
+    expresso_compiled_destroy(compiled);
+}
+
+void test_eval_concatenates_string_bindings() {
+    // Long enough together to be a rope of the bindings while evaluating
+    ExpressoCompiled* compiled = expresso_compile("$s + $s", NULL);
+    char text[VALUE_ROPE_MIN_LENGTH + 1];
+    memset(text, 'x', VALUE_ROPE_MIN_LENGTH);
+    text[VALUE_ROPE_MIN_LENGTH] = '\0';
+    Value s = value_create_string(text);
+
+    for (int i = 0; i < 2; i++) {
+        Value result = expresso_eval(compiled, &s);
+        ASSERT_TRUE(value_is_string(result), "Result should be string");
+        ASSERT_EQ(2 * VALUE_ROPE_MIN_LENGTH, value_string_length(result), "Concatenation length is incorrect");
+        ASSERT_FALSE(value_in_arena(result), "Result should outlive the evaluation");
+        ASSERT_TRUE(strncmp(value_as_string(&result) + VALUE_ROPE_MIN_LENGTH, text, VALUE_ROPE_MIN_LENGTH) == 0,
+                    "Concatenation text is incorrect");
+        value_destroy(result);
+    }
+    value_destroy(s);
+    expresso_compiled_destroy(compiled);
+
+    compiled = expresso_compile("\"total: \" + $n + \" for \" + $s", NULL);
+    Value bindings[] = { value_create_integer(12), value_create_string("two") };
+    Value result = expresso_eval(compiled, bindings);
+    ASSERT_TRUE(strcmp(value_as_string(&result), "total: 12 for two") == 0, "Concatenation chain is incorrect");
+    value_destroy(result);
+    value_destroy(bindings[1]);
+    expresso_compiled_destroy(compiled);
+}
+
+void test_compile_errors() {
+    ExpressoSyntaxError error;
+    ASSERT_TRUE(expresso_compile("$price *", &error) == NULL, "Incomplete expression should not compile");
+    ASSERT_EQ(8, error.position, "Error position is incorrect");
+    ASSERT_EQ(EXPRESSO_ERROR_EXPECTED_EXPRESSION, error.code, "Error code is incorrect");
+    ASSERT_TRUE(strcmp("Expected an expression.", error.message) == 0, "Error message should come from the catalogue");
+    ASSERT_TRUE(expresso_compile("$1", &error) == NULL, "Parameter names cannot start with a digit");
+
+    // Parsing succeeds but compiling fails: the error is still filled in
+    evaluator_set_max_depth(3);
+    ASSERT_TRUE(expresso_compile("$a - 1 - 2 - 3 - 4", &error) == NULL, "Expressions beyond the depth limit should not compile");
+    ASSERT_EQ(EXPRESSO_ERROR_TOO_DEEP, error.code, "Too deep error code is incorrect");
+    ASSERT_TRUE(strcmp("Expression nested too deeply.", error.message) == 0, "Too deep message should come from the catalogue");
+    ASSERT_EQ(0, error.position, "Too deep error position is incorrect");
+    ASSERT_EQ(18, error.length, "Too deep error should span the expression");
+    evaluator_set_max_depth(0);
+
+    ExpressoCompiled* compiled = expresso_compile("$a + 1", NULL);
+    Value result = expresso_eval(compiled, NULL);
+    ASSERT_TRUE(value_is_error(result), "Evaluating without bindings should be an error");
+    value_destroy(result);
+    expresso_compiled_destroy(compiled);
+}
+
+void test_eval_short_circuits() {
+    ExpressoCompiled* compiled = expresso_compile("$b != 0 && $a / $b > 3", NULL);
+    ASSERT_TRUE(compiled != NULL, "Failed to compile guarded division");
+    // Slots follow first use: $b, then $a
+    struct { long long b, a, expected; } cases[] = { { 0, 7, 0 }, { 2, 7, 0 }, { 2, 8, 1 }, { 0, 0, 0 } };
+
+    // The division must be skipped whether the expression runs natively or not
+    for (int jit = 0; jit < 2; jit++) {
+        expresso_jit_set_enabled(jit);
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            Value bindings[] = { value_create_integer(cases[i].b), value_create_integer(cases[i].a) };
+            Value result = expresso_eval(compiled, bindings);
+            ASSERT_TRUE(value_is_integer(result), "Guarded division should not fail");
+            ASSERT_EQ(cases[i].expected, value_as_integer(result), "Guarded division is incorrect");
+        }
+    }
+    expresso_jit_set_enabled(true);
+    expresso_compiled_destroy(compiled);
+
+    // A string right operand is never looked at once the left decides
+    compiled = expresso_compile("$a || -\"s\"", NULL);
+    Value bindings[] = { value_create_integer(5) };
+    Value result = expresso_eval(compiled, bindings);
+    ASSERT_EQ(1, value_as_integer(result), "5 || -\"s\" should be 1");
+    bindings[0] = value_create_integer(0);
+    result = expresso_eval(compiled, bindings);
+    ASSERT_TRUE(value_is_error(result), "0 || -\"s\" should be a type error");
+    value_destroy(result);
+    expresso_compiled_destroy(compiled);
+}
+
+int main() {
+    printf("Running compile/eval API unit tests...\n");
+    test_compile_and_eval_with_bindings();
+    test_eval_borrows_string_bindings();
+    test_eval_concatenates_string_bindings();
+    test_compile_errors();
+    test_eval_short_circuits();
+    printf("All compile/eval API unit tests passed!\n");
+    return 0;
+}
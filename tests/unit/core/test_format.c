@@ -0,0 +1,102 @@
+#include "assert.h"
+#include "format.h"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void assert_formats_double(const char* expected, double value) {
+    char buffer[EXPRESSO_FORMAT_BUFFER_SIZE];
+    size_t length = expresso_format_double(value, buffer);
+    if (strcmp(expected, buffer) != 0) fprintf(stderr, "Expected %s, got %s\n", expected, buffer);
+    ASSERT_TRUE(strcmp(expected, buffer) == 0, "Double formatted differently");
+    ASSERT_EQ(strlen(expected), length, "Double length mismatch");
+}
+
+void test_integers() {
+    const long long values[] = {
+        0, 1, -1, 9, 10, 99, 100, 12345, -98765, 1000000000, 999999999999LL,
+        10000000000000000LL, LLONG_MAX, LLONG_MIN, LLONG_MIN + 1,
+    };
+    char buffer[EXPRESSO_FORMAT_BUFFER_SIZE];
+    char expected[EXPRESSO_FORMAT_BUFFER_SIZE];
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        size_t length = expresso_format_integer(values[i], buffer);
+        snprintf(expected, sizeof(expected), "%lld", values[i]);
+        ASSERT_TRUE(strcmp(expected, buffer) == 0, "Integer formatted differently from printf");
+        ASSERT_EQ(strlen(expected), length, "Integer length mismatch");
+    }
+
+    // Every digit count, either side of each power of ten
+    long long power = 1;
+    for (int digits = 1; digits <= 18; digits++) {
+        power *= 10;
+        for (long long value = power - 2; value <= power + 1; value++) {
+            expresso_format_integer(value, buffer);
+            snprintf(expected, sizeof(expected), "%lld", value);
+            ASSERT_TRUE(strcmp(expected, buffer) == 0, "Integer near a power of ten formatted differently");
+        }
+    }
+}
+
+void test_shortest_doubles() {
+    assert_formats_double("0.1", 0.1);
+    assert_formats_double("0.30000000000000004", 0.1 + 0.2);
+    assert_formats_double("3.0", 3.0);
+    assert_formats_double("-2.5", -2.5);
+    assert_formats_double("0.0", 0.0);
+    assert_formats_double("-0.0", -0.0);
+    assert_formats_double("123456.789", 123456.789);
+    assert_formats_double("1000000000000000.0", 1e15);
+    assert_formats_double("1e+16", 1e16);
+    assert_formats_double("0.0001", 0.0001);
+    assert_formats_double("1e-05", 0.00001);
+    assert_formats_double("1.5e-07", 1.5e-7);
+    assert_formats_double("9007199254740994.0", 9007199254740994.0);
+    assert_formats_double("1234567890123456.8", 1234567890123456.789);
+    assert_formats_double("1.7976931348623157e+308", 1.7976931348623157e308);
+    assert_formats_double("2.2250738585072014e-308", 2.2250738585072014e-308);
+    assert_formats_double("5e-324", 4.9406564584124654e-324);
+    assert_formats_double("inf", INFINITY);
+    assert_formats_double("-inf", -INFINITY);
+    assert_formats_double("nan", NAN);
+}
+
+void test_round_trip() {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    char buffer[EXPRESSO_FORMAT_BUFFER_SIZE];
+    for (int i = 0; i < 100000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t bits = i % 2 ? state : state & 0x800FFFFFFFFFFFFFULL; // Half subnormal
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value)) continue;
+
+        size_t length = expresso_format_double(value, buffer);
+        ASSERT_TRUE(length < EXPRESSO_FORMAT_BUFFER_SIZE, "Double overran the buffer size");
+        double parsed = strtod(buffer, NULL);
+        ASSERT_TRUE(memcmp(&parsed, &value, sizeof(value)) == 0, "Double did not read back unchanged");
+
+        // Shortest: no representation with one digit fewer reads back
+        char shorter[EXPRESSO_FORMAT_BUFFER_SIZE + 8];
+        int digits = 0;
+        for (const char* c = buffer; *c && *c != 'e'; c++) digits += *c >= '1' && *c <= '9' ? 1 : 0;
+        if (digits > 1 && value != 0.0) {
+            snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, value);
+            ASSERT_TRUE(strtod(shorter, NULL) != value, "A shorter representation reads back");
+        }
+    }
+}
+
+int main() {
+    printf("Running Format unit tests...\n");
+    test_integers();
+    test_shortest_doubles();
+    test_round_trip();
+    printf("All Format unit tests passed!\n");
+    return 0;
+}
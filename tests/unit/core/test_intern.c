@@ -0,0 +1,123 @@
+#include "assert.h"
+#include "intern.h"
+#include "evaluator.h"
+#include "expresso.h"
+#include "fast_parser.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LONG_TEXT "a literal far too long to be stored inline"
+
+static ExpressoAst* parse(const char* expr) {
+    ExpressoAst* ast = expresso_ast_create();
+    ASSERT_TRUE(expresso_fast_parse(expr, ast, NULL), expr);
+    return ast;
+}
+
+void test_pool_deduplicates() {
+    expresso_intern_reset();
+    char copy[] = LONG_TEXT;
+    ExpressoString* first = expresso_intern(LONG_TEXT, strlen(LONG_TEXT));
+    ExpressoString* second = expresso_intern(copy, strlen(copy));
+    ExpressoString* other = expresso_intern(LONG_TEXT, 10);
+    ASSERT_TRUE(first == second, "Equal texts should be interned once");
+    ASSERT_TRUE(first != other, "Different texts should be interned apart");
+    ASSERT_TRUE(strcmp(LONG_TEXT, first->text) == 0, "Interned text mismatch");
+    ASSERT_EQ(10, other->length, "Interned length mismatch");
+
+    ExpressoInternStats stats;
+    expresso_intern_stats(&stats);
+    ASSERT_EQ(3, stats.lookups, "Lookups should be counted");
+    ASSERT_EQ(1, stats.hits, "Hits should be counted");
+    ASSERT_EQ(2, stats.strings, "Pooled strings should be counted");
+    expresso_intern_reset();
+}
+
+void test_pool_grows() {
+    char text[32];
+    ExpressoString* strings[5000];
+    for (int i = 0; i < 5000; i++) {
+        int length = snprintf(text, sizeof(text), "string number %d", i);
+        strings[i] = expresso_intern(text, (size_t)length);
+    }
+    for (int i = 0; i < 5000; i++) {
+        int length = snprintf(text, sizeof(text), "string number %d", i);
+        ASSERT_TRUE(expresso_intern(text, (size_t)length) == strings[i], "Interned string moved as the pool grew");
+    }
+    ExpressoInternStats stats;
+    expresso_intern_stats(&stats);
+    ASSERT_EQ(5000, stats.strings, "Every distinct text should be pooled once");
+    expresso_intern_reset();
+}
+
+void test_interned_values() {
+    Value a = value_create_interned_string(LONG_TEXT, strlen(LONG_TEXT));
+    Value b = value_create_interned_string(LONG_TEXT, strlen(LONG_TEXT));
+    ASSERT_TRUE(value_c_str(&a) == value_c_str(&b), "Interned values should share their text");
+    ASSERT_TRUE(value_equals(a, b), "Interned values should be equal");
+
+    Value copy = value_copy(a);
+    value_destroy(a);
+    value_destroy(a); // Copies are not counted, so nothing is freed
+    ASSERT_TRUE(strcmp(LONG_TEXT, value_c_str(&copy)) == 0, "Interned text should outlive its values");
+    value_destroy(copy);
+
+    Value other = value_create_interned_string(LONG_TEXT, strlen(LONG_TEXT) - 1);
+    ASSERT_FALSE(value_equals(b, other), "Different interned values should not be equal");
+
+    // Short strings stay inline
+    Value short_string = value_create_interned_string("hi", 2);
+    ExpressoInternStats stats;
+    expresso_intern_stats(&stats);
+    ASSERT_EQ(2, stats.strings, "Short strings should not be pooled");
+
+    // A heap string interned equals the one interned from its text
+    Value heap = value_create_string(LONG_TEXT);
+    Value interned = value_intern(heap);
+    ASSERT_TRUE(value_c_str(&interned) == value_c_str(&b), "value_intern should return the pooled text");
+    ASSERT_TRUE(value_equals(heap, interned), "Heap and interned strings should be equal");
+    value_destroy(heap);
+
+    value_destroy(b);
+    value_destroy(other);
+    value_destroy(short_string);
+    value_destroy(interned);
+    expresso_intern_reset();
+}
+
+void test_literals_interned() {
+    expresso_intern_set_enabled(true);
+    ExpressoAst* ast = parse("\"" LONG_TEXT "\"");
+    Value first = evaluate_ast(ast);
+    Value second = evaluate_ast(ast);
+    ASSERT_TRUE(value_c_str(&first) == value_c_str(&second), "Evaluated literals should share their text");
+
+    ExpressoCompiled* compiled = expresso_compile("$x ? \"" LONG_TEXT "\" : \"\"", NULL);
+    Value bindings[] = { value_create_integer(1) };
+    Value third = expresso_eval(compiled, bindings);
+    ASSERT_TRUE(value_c_str(&first) == value_c_str(&third), "Compiled literals should share their text");
+
+    ExpressoInternStats stats;
+    expresso_intern_stats(&stats);
+    ASSERT_EQ(1, stats.strings, "One literal should be pooled once");
+
+    value_destroy(first);
+    value_destroy(second);
+    value_destroy(third);
+    expresso_compiled_destroy(compiled);
+    expresso_ast_destroy(ast);
+    expresso_intern_set_enabled(false);
+    expresso_intern_reset();
+}
+
+int main() {
+    printf("Running intern pool unit tests...\n");
+    test_pool_deduplicates();
+    test_pool_grows();
+    test_interned_values();
+    test_literals_interned();
+    printf("All intern pool tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "assert.h"
+#include "jit.h"
+#include "vm.h"
+#include "expresso.h"
+#include "value.h"
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char* expressions[] = {
+    "$a + $b * 3 - 7",
+    "$a * $b",          // Wraps around in 64-bit arithmetic
+    "$a / $b + $a % $b",
+    "-$a ^ ~$b | $a & 255",
+    "$a << ($b & 7) >> 2",
+    "$a << $b",
+    "$a << 3 >> 1 ^ $b >> 63",  // Constant counts are shifted inline
+    "$a << 64 | $b >> -2",
+    "$a < $b && $b >= 0 || !$a",
+    "$b != 0 && $a / $b > 3",   // The division is skipped when $b is 0
+    "$a > 0 || $b && $a == $b",
+    "$a <= $b == ($a > $b) != 1",
+    "$a ? $b ? 1 : 2 : (3 ? 4 : 5)",
+    "$x == $y",
+    "$x != $y",
+    "$a > 0 ? $x : $y",
+    "$x + $y * 1.5 - $x / $y",  // Divisions by 0.0, -0.0 and NaN bail out
+    "-$x < $y == ($x >= -$y)",
+    "$x <= $y != ($x > $y)",
+    "$a > 0 && $x || !$y",
+    "1.5 == 1.5",
+    "42",
+};
+
+// Extreme values exercise overflow, and LLONG_MIN / -1 the division the
+// hardware cannot do
+static const long long integers[] = { 0, 1, -1, 7, -13, 1000, 46340, 64, LLONG_MAX, LLONG_MIN, 0x100000005LL };
+static const double floats[] = { 0.0, -0.0, 1.5, -2.25, NAN, INFINITY };
+
+static void check_same_result(const char* expr, const ExpressoProgram* program, const ExpressoJitCode* code,
+                              const Value* bindings) {
+    char assert_msg[160];
+    Value expected = expresso_vm_run(program, bindings);
+    Value actual;
+    // The JIT bails out where the VM reports a failure or a big integer, and
+    // may where one only arose on the way
+    bool ran = expresso_jit_run(code, bindings, &actual);
+    snprintf(assert_msg, sizeof(assert_msg), "JIT ran '%s' past a failure", expr);
+    ASSERT_TRUE(!ran || !(value_is_error(expected) || value_is_bigint(expected)), assert_msg);
+    if (!ran) {
+        value_destroy(expected);
+        return;
+    }
+
+    snprintf(assert_msg, sizeof(assert_msg), "JIT result of '%s' differs from the VM", expr);
+    ASSERT_EQ(value_get_type(expected), value_get_type(actual), assert_msg);
+    if (value_get_type(expected) == VALUE_TYPE_FLOAT) {
+        double e = value_get_float(expected), a = value_get_float(actual);
+        ASSERT_TRUE(memcmp(&e, &a, sizeof(double)) == 0, assert_msg);
+    } else {
+        ASSERT_EQ(value_get_integer(expected), value_get_integer(actual), assert_msg);
+    }
+    value_destroy(expected);
+    value_destroy(actual);
+}
+
+void test_jit_matches_vm() {
+    size_t integer_count = sizeof(integers) / sizeof(integers[0]);
+    size_t float_count = sizeof(floats) / sizeof(floats[0]);
+
+    for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+        const char* expr = expressions[e];
+        ExpressoCompiled* compiled = expresso_compile(expr, NULL);
+        const ExpressoProgram* program = expresso_compiled_program(compiled);
+        ExpressoJitCode* code = NULL;
+
+        for (size_t i = 0; i < integer_count * integer_count; i++) {
+            Value bindings[4];
+            for (size_t p = 0; p < program->parameter_count; p++) {
+                const char* name = program->parameters[p];
+                size_t pick = p == 0 ? i / integer_count : i % integer_count;
+                bindings[p] = name[0] == 'a' || name[0] == 'b'
+                    ? value_create_integer(integers[pick])
+                    : value_create_float(floats[pick % float_count]);
+            }
+            if (!code) {
+                code = expresso_jit_compile(program, bindings, expr);
+                ASSERT_TRUE(code != NULL, expr);
+            }
+            check_same_result(expr, program, code, bindings);
+            for (size_t p = 0; p < program->parameter_count; p++) value_destroy(bindings[p]);
+        }
+
+        expresso_jit_destroy(code);
+        expresso_compiled_destroy(compiled);
+    }
+}
+
+void test_jit_leaves_unsupported_programs_to_vm() {
+    const char* exprs[] = { "$a == \"s\"", "$a != 'a'", "$x + 1", "$a ? 1 : 1.5", "$x ? 1 : 2", "$x && 1", "$a + \"s\"",
+                            "$x == $a", "$x % 1.5" };
+    Value bindings[] = { value_create_float(1.0), value_create_integer(1) };
+
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        ExpressoCompiled* compiled = expresso_compile(exprs[i], NULL);
+        bindings[0] = strstr(exprs[i], "$x") ? value_create_float(1.0) : value_create_integer(1);
+        ASSERT_TRUE(expresso_jit_compile(expresso_compiled_program(compiled), bindings, exprs[i]) == NULL, exprs[i]);
+        expresso_compiled_destroy(compiled);
+    }
+}
+
+void test_jit_bails_out() {
+    ExpressoCompiled* compiled = expresso_compile("$a / $b", NULL);
+    const ExpressoProgram* program = expresso_compiled_program(compiled);
+    Value bindings[] = { value_create_integer(7), value_create_integer(2) };
+    ExpressoJitCode* code = expresso_jit_compile(program, bindings, "$a / $b");
+    Value result;
+
+    ASSERT_TRUE(expresso_jit_run(code, bindings, &result), "7 / 2 should run natively");
+    ASSERT_EQ(3, value_as_integer(result), "7 / 2 is incorrect");
+
+    bindings[1] = value_create_integer(0);
+    ASSERT_FALSE(expresso_jit_run(code, bindings, &result), "Division by zero should bail out");
+
+    bindings[1] = value_create_float(2.0);
+    ASSERT_FALSE(expresso_jit_run(code, bindings, &result), "A binding of another type should bail out");
+
+    // expresso_eval falls back to the VM, which promotes the dividend
+    result = expresso_eval(compiled, bindings);
+    ASSERT_TRUE(value_is_float(result) && value_as_float(result) == 3.5, "7 / 2.0 should be 3.5");
+    value_destroy(result);
+
+    // Other divisions by -1 run natively; LLONG_MIN / -1 does not fit
+    bindings[1] = value_create_integer(-1);
+    ASSERT_TRUE(expresso_jit_run(code, bindings, &result), "7 / -1 should run natively");
+    ASSERT_EQ(-7, value_as_integer(result), "7 / -1 is incorrect");
+    bindings[0] = value_create_integer(LLONG_MIN);
+    ASSERT_FALSE(expresso_jit_run(code, bindings, &result), "LLONG_MIN / -1 should bail out");
+
+    result = expresso_eval(compiled, bindings);
+    ASSERT_TRUE(value_is_bigint(result) && value_as_float(result) == 9223372036854775808.0,
+                "LLONG_MIN / -1 should be a big integer");
+    value_destroy(result);
+    value_destroy(bindings[0]);
+
+    expresso_jit_destroy(code);
+    expresso_compiled_destroy(compiled);
+}
+
+void test_jit_can_be_switched_off() {
+    ExpressoCompiled* compiled = expresso_compile("$a * 2 + 1", NULL);
+    Value bindings[] = { value_create_integer(20) };
+
+    expresso_jit_set_enabled(false);
+    ASSERT_FALSE(expresso_jit_enabled(), "JIT should be off");
+    Value result = expresso_eval(compiled, bindings);
+    ASSERT_EQ(41, value_as_integer(result), "Interpreted result is incorrect");
+
+    expresso_jit_set_enabled(true);
+    ASSERT_TRUE(expresso_jit_enabled(), "JIT should be back on");
+    result = expresso_eval(compiled, bindings);
+    ASSERT_EQ(41, value_as_integer(result), "Native result is incorrect");
+
+    expresso_compiled_destroy(compiled);
+}
+
+void test_jit_writes_perf_map() {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%ld.map", (long)getpid());
+    remove(path);
+
+    expresso_jit_set_perf_map(true);
+    ExpressoCompiled* compiled = expresso_compile("$a + 1", NULL);
+    Value bindings[] = { value_create_integer(1) };
+    ExpressoJitCode* code = expresso_jit_compile(expresso_compiled_program(compiled), bindings, "$a + 1");
+    expresso_jit_set_perf_map(false);
+
+    FILE* map = fopen(path, "r");
+    ASSERT_TRUE(map != NULL, "Perf map should be written");
+    char line[256] = "";
+    unsigned long start = 0;
+    size_t size = 0;
+    ASSERT_TRUE(fgets(line, sizeof(line), map) != NULL, "Perf map should have an entry");
+    ASSERT_EQ(2, sscanf(line, "%lx %zx", &start, &size), "Perf map entry should start with address and size");
+    ASSERT_TRUE(size > 0 && strstr(line, " expresso:$a + 1\n") != NULL, "Perf map entry should name the expression");
+    fclose(map);
+    remove(path);
+
+    expresso_jit_destroy(code);
+    expresso_compiled_destroy(compiled);
+}
+
+int main() {
+    printf("Running JIT unit tests...\n");
+    if (!expresso_jit_available()) {
+        printf("JIT not available on this platform; skipping.\n");
+        return 0;
+    }
+    test_jit_matches_vm();
+    test_jit_leaves_unsupported_programs_to_vm();
+    test_jit_bails_out();
+    test_jit_can_be_switched_off();
+    test_jit_writes_perf_map();
+    printf("All JIT unit tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "assert.h"
+#include "memo_cache.h"
+#include "evaluator.h"
+#include "optimizer.h"
+#include "fast_parser.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ExpressoAst* parse(const char* expr) {
+    ExpressoAst* ast = expresso_ast_create();
+    ASSERT_TRUE(expresso_fast_parse(expr, ast, NULL), expr);
+    return ast;
+}
+
+void test_lookup_is_structural() {
+    ExpressoMemoCache* cache = expresso_memo_cache_create(8);
+    ExpressoAst* first = parse("(\"ab\" + \"cd\") * 3");
+    ExpressoAst* second = parse("1 + (\"ab\" + \"cd\") * 3");
+    ExpressoAst* different = parse("(\"ab\" + \"cd\") * 4");
+    Value value;
+
+    ASSERT_FALSE(expresso_memo_cache_lookup(cache, first, first->root, &value), "Empty cache should miss");
+    Value stored = value_create_string("abcdabcdabcd");
+    expresso_memo_cache_store(cache, first, first->root, stored);
+    value_destroy(stored);
+
+    // The same subtree at other node indices
+    ExpressoNodeIndex product = second->nodes[second->root].children[1];
+    ASSERT_TRUE(expresso_memo_cache_lookup(cache, second, product, &value), "Identical subtree should hit");
+    ASSERT_TRUE(value_is_string(value) && strcmp(value_c_str(&value), "abcdabcdabcd") == 0, "Cached value is incorrect");
+    value_destroy(value);
+    ASSERT_FALSE(expresso_memo_cache_lookup(cache, different, different->root, &value), "Different literal should miss");
+
+    ExpressoMemoStats stats;
+    expresso_memo_cache_get_stats(cache, &stats);
+    ASSERT_EQ(1, (int)stats.hits, "Hit count is incorrect");
+    ASSERT_EQ(2, (int)stats.misses, "Miss count is incorrect");
+    ASSERT_EQ(1, (int)stats.entries, "Entry count is incorrect");
+
+    expresso_memo_cache_clear(cache);
+    ASSERT_FALSE(expresso_memo_cache_lookup(cache, first, first->root, &value), "Cleared cache should miss");
+
+    expresso_ast_destroy(different);
+    expresso_ast_destroy(second);
+    expresso_ast_destroy(first);
+    expresso_memo_cache_destroy(cache);
+}
+
+void test_clock_eviction() {
+    ExpressoMemoCache* cache = expresso_memo_cache_create(2);
+    ExpressoAst* trees[3] = { parse("1 + 1"), parse("2 + 2"), parse("3 + 3") };
+    Value value;
+
+    for (int i = 0; i < 2; i++) {
+        expresso_memo_cache_store(cache, trees[i], trees[i]->root, value_create_integer(2 * (i + 1)));
+    }
+    // Using 1 + 1 gives it a second chance, so 2 + 2 is evicted instead
+    ASSERT_TRUE(expresso_memo_cache_lookup(cache, trees[0], trees[0]->root, &value), "Stored entry should hit");
+    expresso_memo_cache_store(cache, trees[2], trees[2]->root, value_create_integer(6));
+
+    ASSERT_TRUE(expresso_memo_cache_lookup(cache, trees[0], trees[0]->root, &value), "Referenced entry should survive");
+    ASSERT_EQ(2, value_as_integer(value), "Surviving value is incorrect");
+    ASSERT_FALSE(expresso_memo_cache_lookup(cache, trees[1], trees[1]->root, &value), "Unreferenced entry should be evicted");
+    ASSERT_TRUE(expresso_memo_cache_lookup(cache, trees[2], trees[2]->root, &value), "New entry should hit");
+
+    ExpressoMemoStats stats;
+    expresso_memo_cache_get_stats(cache, &stats);
+    ASSERT_EQ(1, (int)stats.evictions, "Eviction count is incorrect");
+    ASSERT_EQ(2, (int)stats.entries, "Cache should stay within its capacity");
+
+    for (int i = 0; i < 3; i++) expresso_ast_destroy(trees[i]);
+    expresso_memo_cache_destroy(cache);
+}
+
+void test_evaluations_share_constant_subtrees() {
+    ExpressoMemoCache* cache = expresso_memo_cache_create(16);
+    evaluator_set_memo_cache(cache);
+
+    // Only the outermost constant subtree is looked up; 2 * 3 is not
+    ExpressoAst* ast = parse("(2 * 3 + 4) * 10 == 100 ? \"yes\" : \"no\"");
+    Value result = evaluate_ast(ast);
+    ASSERT_TRUE(strcmp(value_c_str(&result), "yes") == 0, "First evaluation is incorrect");
+    value_destroy(result);
+    ExpressoMemoStats stats;
+    expresso_memo_cache_get_stats(cache, &stats);
+    ASSERT_EQ(0, (int)stats.hits, "First evaluation should not hit");
+    ASSERT_EQ(1, (int)stats.misses, "Only the whole constant tree should be looked up");
+
+    result = evaluate_ast(ast);
+    ASSERT_TRUE(strcmp(value_c_str(&result), "yes") == 0, "Cached evaluation is incorrect");
+    value_destroy(result);
+    expresso_memo_cache_get_stats(cache, &stats);
+    ASSERT_EQ(1, (int)stats.hits, "Second evaluation should hit");
+    expresso_ast_destroy(ast);
+
+    // Errors are remembered too
+    ast = parse("-\"s\" + 1");
+    Value first = evaluate_ast(ast);
+    Value second = evaluate_ast(ast);
+    ASSERT_TRUE(value_is_error(first) && value_is_error(second), "Cached error should stay an error");
+    ASSERT_TRUE(strcmp(value_as_error_message(&first), value_as_error_message(&second)) == 0, "Cached error message is incorrect");
+    value_destroy(first);
+    value_destroy(second);
+    expresso_ast_destroy(ast);
+
+    evaluator_set_memo_cache(NULL);
+    expresso_memo_cache_destroy(cache);
+}
+
+void test_optimizer_reuses_folded_values() {
+    ExpressoMemoCache* cache = expresso_memo_cache_create(16);
+    expresso_optimizer_set_memo_cache(cache);
+    ExpressoAst* optimized = expresso_ast_create();
+    ExpressoAst* want = parse("$x + 60");
+
+    const char* lines[] = { "$x + (2 + 3) * 12", "$x + (2 + 3) * 12", "$x + 60" };
+    for (int i = 0; i < 3; i++) {
+        ExpressoAst* ast = parse(lines[i]);
+        expresso_optimize(ast, optimized, NULL, 0);
+        ASSERT_TRUE(expresso_ast_equal(optimized, optimized->root, want, want->root), lines[i]);
+        expresso_ast_destroy(ast);
+    }
+    ExpressoMemoStats stats;
+    expresso_memo_cache_get_stats(cache, &stats);
+    ASSERT_EQ(1, (int)stats.hits, "Repeated subexpression should be folded from the cache");
+    ASSERT_EQ(1, (int)stats.misses, "Literals should not be looked up");
+
+    expresso_optimizer_set_memo_cache(NULL);
+    expresso_ast_destroy(want);
+    expresso_ast_destroy(optimized);
+    expresso_memo_cache_destroy(cache);
+}
+
+int main() {
+    printf("Running memo cache unit tests...\n");
+    test_lookup_is_structural();
+    test_clock_eviction();
+    test_evaluations_share_constant_subtrees();
+    test_optimizer_reuses_folded_values();
+    printf("All memo cache unit tests passed!\n");
+    return 0;
+}
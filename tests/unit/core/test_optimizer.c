@@ -0,0 +1,251 @@
+#include "assert.h"
+#include "optimizer.h"
+#include "evaluator.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "fast_parser.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ExpressoAst* parse(const char* expr) {
+    ExpressoAst* ast = expresso_ast_create();
+    ASSERT_TRUE(expresso_fast_parse(expr, ast, NULL), expr);
+    return ast;
+}
+
+// Optimise expr and check the result has the same tree as expected
+static void check_optimizes_to(const char* expr, const char* expected,
+                               const ExpressoParameterType* types, size_t type_count) {
+    char assert_msg[256];
+    ExpressoAst* ast = parse(expr);
+    ExpressoAst* optimized = expresso_ast_create();
+    ExpressoAst* want = parse(expected);
+
+    expresso_optimize(ast, optimized, types, type_count);
+    snprintf(assert_msg, sizeof(assert_msg), "'%s' should optimise to '%s'", expr, expected);
+    ASSERT_TRUE(expresso_ast_equal(optimized, optimized->root, want, want->root), assert_msg);
+
+    expresso_ast_destroy(want);
+    expresso_ast_destroy(optimized);
+    expresso_ast_destroy(ast);
+}
+
+static bool values_same(Value a, Value b) {
+    if (value_get_type(a) != value_get_type(b)) return false;
+    if (value_get_type(a) == VALUE_TYPE_ERROR) return true; // Messages are checked separately
+    return value_equals(a, b);
+}
+
+// Constant expressions in the style of test_evaluator fold to one literal
+// with the value the evaluator gives the original tree
+void test_constant_folding_matches_evaluator() {
+    const char* exprs[] = {
+        "1 + 2 * 3", "(17 * 3 + 4) % 7 << 2", "100 / 7 - -3", "~5 ^ 12 | 3 & 6",
+        "1 < 2 && 3 >= 3 || !0", "5 == 5 != (2 > 7)", "-(-(-4))", "+8", "'a' == 'a'",
+        "\"abc\" == \"abc\"", "1 ? \"yes\" : \"no\"", "0 ? 'x' : 'y'", "2.5 == 2.5", "1 << 70",
+        "(1 < 2) ? (3 ? 4 : 5) : 6", "'a' + 1", "2.5 * 2 - 1", "7 % 2.5", "1 == 1.0", "3000000000 * 3",
+        "\"n=\" + 1 + 'c' + 2.5",
+    };
+
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        ExpressoAst* ast = parse(exprs[i]);
+        ExpressoAst* optimized = expresso_ast_create();
+        expresso_optimize(ast, optimized, NULL, 0);
+
+        ASSERT_EQ(1, optimized->count, exprs[i]);
+        Value expected = evaluate_ast(ast);
+        Value actual = evaluate_ast(optimized);
+        ASSERT_TRUE(values_same(expected, actual), exprs[i]);
+        value_destroy(expected);
+        value_destroy(actual);
+
+        expresso_ast_destroy(optimized);
+        expresso_ast_destroy(ast);
+    }
+}
+
+// Failures are left for evaluation, which reports them as before
+void test_failures_are_not_folded() {
+    check_optimizes_to("1 / 0", "1 / 0", NULL, 0);
+    check_optimizes_to("7 % (2 - 2) + 1", "7 % 0 + 1", NULL, 0);
+    check_optimizes_to("-\"s\" + (1 + 1)", "-\"s\" + 2", NULL, 0);
+    check_optimizes_to("2.5 << 1", "2.5 << 1", NULL, 0);
+
+    ExpressoAst* ast = parse("-'c'");
+    ExpressoAst* optimized = expresso_ast_create();
+    expresso_optimize(ast, optimized, NULL, 0);
+    Value expected = evaluate_ast(ast);
+    Value actual = evaluate_ast(optimized);
+    ASSERT_TRUE(value_is_error(actual), "Negating a character should still fail");
+    ASSERT_TRUE(strcmp(value_as_error_message(&expected), value_as_error_message(&actual)) == 0, "Error message should be unchanged");
+    value_destroy(expected);
+    value_destroy(actual);
+    expresso_ast_destroy(optimized);
+    expresso_ast_destroy(ast);
+}
+
+// Strings as long as a rope stay concatenations, evaluated in one step
+void test_long_strings_are_not_folded() {
+    char expr[1024] = "\"", expected[1024];
+    memset(expr + 1, 'x', VALUE_ROPE_MIN_LENGTH - 2);
+    strcpy(expr + VALUE_ROPE_MIN_LENGTH - 1, "\" + 1 + 2 + \"y\"");
+    strcpy(expected, expr);
+    strcpy(expected + VALUE_ROPE_MIN_LENGTH - 1, "1\" + 2 + \"y\"");
+    check_optimizes_to(expr, expected, NULL, 0);
+}
+
+void test_constant_conditions_are_pruned() {
+    check_optimizes_to("1 ? $a : $b", "$a", NULL, 0);
+    check_optimizes_to("(2 > 3) ? $a : $b + 1", "$b + 1", NULL, 0);
+    check_optimizes_to("0 ? 1 / 0 : $a", "$a", NULL, 0);
+    check_optimizes_to("$c ? 2 * 3 : 1 ? $a : $b", "$c ? 6 : $a", NULL, 0);
+    check_optimizes_to("1.5 ? $a : $b", "1.5 ? $a : $b", NULL, 0); // Type error at evaluation
+
+    // && and || drop a right operand that is never evaluated
+    check_optimizes_to("0 && 1 / 0", "0", NULL, 0);
+    check_optimizes_to("(2 > 1) || -\"s\"", "1", NULL, 0);
+    check_optimizes_to("1 && $a", "1 && $a", NULL, 0); // Still normalised to 0 or 1
+}
+
+void test_identities() {
+    ExpressoParameterType integers[] = { { "a", VALUE_TYPE_INTEGER }, { "b", VALUE_TYPE_INTEGER } };
+
+    check_optimizes_to("+$a", "$a", NULL, 0);
+    check_optimizes_to("--($a & 255)", "$a & 255", integers, 2);
+    check_optimizes_to("~~$a", "$a", integers, 2);
+    check_optimizes_to("-(-(-($a & 255)))", "-($a & 255)", integers, 2);
+    check_optimizes_to("($a < $b) * 1", "$a < $b", integers, 2);
+    check_optimizes_to("1 * ($a == $b)", "$a == $b", integers, 2);
+    check_optimizes_to("0 + ($a & 255) - 0", "$a & 255", integers, 2);
+    check_optimizes_to("$a + 0", "$a", integers, 2);
+
+    // Without known types the operand might be a string or an error
+    check_optimizes_to("--$a", "--$a", NULL, 0);
+    // -$a overflows for LLONG_MIN, where $a itself does not fail
+    check_optimizes_to("--$a", "--$a", integers, 2);
+    check_optimizes_to("($a < $b) * 1", "($a < $b) * 1", NULL, 0);
+    // A character plus 0 is an integer
+    check_optimizes_to("$c + 0", "$c + 0", (ExpressoParameterType[]){ { "c", VALUE_TYPE_CHARACTER } }, 1);
+}
+
+void test_strength_reduction() {
+    ExpressoParameterType integers[] = { { "a", VALUE_TYPE_INTEGER }, { "b", VALUE_TYPE_INTEGER } };
+
+    check_optimizes_to("($a < $b) * 8", "($a < $b) << 3", integers, 2);
+    check_optimizes_to("16 * ($a & 7)", "($a & 7) << 4", integers, 2);
+    check_optimizes_to("($a & 255) / 4", "($a & 255) >> 2", integers, 2);
+    check_optimizes_to("($a & 255) % 8", "($a & 255) & 7", integers, 2);
+
+    // Negative dividends truncate towards zero where shifts round down
+    check_optimizes_to("(($a & 255) - 10) / 4", "(($a & 255) - 10) / 4", integers, 2);
+    check_optimizes_to("($a & 0xFFFFFF) * 256", "($a & 0xFFFFFF) << 8", integers, 2);
+    // The product could overflow
+    check_optimizes_to("$a * 256", "$a * 256", integers, 2);
+    check_optimizes_to("($a < $b) * 6", "($a < $b) * 6", integers, 2);
+}
+
+// Optimised and original trees agree on every binding when compiled and run
+void test_optimized_programs_agree() {
+    const char* exprs[] = {
+        "($a < $b) * 8 + ($a & 255) / 4 - ($a & 255) % 8",
+        "--$a + ~~$b * 1 + 0",
+        "(3 > 2 ? $a : $b) << (1 + 1)",
+        "$a ? ($b & 1023) % 16 : -(-$b)",
+    };
+    ExpressoParameterType integers[] = { { "a", VALUE_TYPE_INTEGER }, { "b", VALUE_TYPE_INTEGER } };
+    long long samples[] = { 0, 1, -1, 5, -77, 1000, 65535, 1LL << 40, -(1LL << 40) + 3 };
+    size_t sample_count = sizeof(samples) / sizeof(samples[0]);
+
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        ExpressoAst* ast = parse(exprs[i]);
+        ExpressoAst* optimized = expresso_ast_create();
+        expresso_optimize(ast, optimized, integers, 2);
+        ExpressoProgram* original = expresso_program_compile(ast, NULL);
+        ExpressoProgram* rewritten = expresso_program_compile(optimized, NULL);
+
+        for (size_t s = 0; s < sample_count * sample_count; s++) {
+            long long a = samples[s / sample_count];
+            long long b = samples[s % sample_count];
+            Value original_bindings[2], rewritten_bindings[2];
+            for (size_t p = 0; p < original->parameter_count; p++) {
+                original_bindings[p] = value_create_integer(original->parameters[p][0] == 'a' ? a : b);
+            }
+            for (size_t p = 0; p < rewritten->parameter_count; p++) {
+                rewritten_bindings[p] = value_create_integer(rewritten->parameters[p][0] == 'a' ? a : b);
+            }
+            Value expected = expresso_vm_run(original, original_bindings);
+            Value actual = expresso_vm_run(rewritten, rewritten_bindings);
+            ASSERT_TRUE(values_same(expected, actual), exprs[i]);
+            value_destroy(expected);
+            value_destroy(actual);
+        }
+
+        expresso_program_destroy(rewritten);
+        expresso_program_destroy(original);
+        expresso_ast_destroy(optimized);
+        expresso_ast_destroy(ast);
+    }
+}
+
+void test_dump() {
+    ExpressoAst* ast = parse("$a * (2 + 3) + (1 ? -$b : 0)");
+    ExpressoAst* optimized = expresso_ast_create();
+    expresso_optimize(ast, optimized, NULL, 0);
+
+    FILE* out = tmpfile();
+    ASSERT_TRUE(out != NULL, "Failed to create temporary file");
+    expresso_optimizer_dump(out, ast, optimized);
+    rewind(out);
+    char text[256] = "";
+    size_t length = fread(text, 1, sizeof(text) - 1, out);
+    text[length] = '\0';
+    fclose(out);
+
+    ASSERT_TRUE(strcmp(text, "before: (+ (* $a (+ 2 3)) (? 1 (- $b) 0))\n"
+                             "after:  (+ (* $a 5) (- $b))\n") == 0, "Dump text is incorrect");
+    expresso_ast_destroy(optimized);
+    expresso_ast_destroy(ast);
+}
+
+void test_deep_chains() {
+    // Far deeper than the rewriting recurses; the rest is copied as it is
+    const size_t terms = 200000;
+    char* expr = (char*)malloc(terms * 2);
+    for (size_t i = 0; i < terms; i++) {
+        expr[2 * i] = '1';
+        expr[2 * i + 1] = '-';
+    }
+    expr[terms * 2 - 1] = '\0';
+
+    ExpressoAst* ast = parse(expr);
+    ExpressoAst* optimized = expresso_ast_create();
+    expresso_optimize(ast, optimized, NULL, 0);
+    ASSERT_EQ(ast->count, optimized->count, "A deep chain should be copied node for node");
+
+    evaluator_set_max_depth(terms + 1);
+    Value result = evaluate_ast(optimized);
+    ASSERT_TRUE(value_is_integer(result) && value_as_integer(result) == 2 - (long long)terms,
+                "Deep chain result is incorrect");
+    evaluator_set_max_depth(0);
+
+    expresso_ast_destroy(optimized);
+    expresso_ast_destroy(ast);
+    free(expr);
+}
+
+int main() {
+    printf("Running optimizer unit tests...\n");
+    test_constant_folding_matches_evaluator();
+    test_failures_are_not_folded();
+    test_long_strings_are_not_folded();
+    test_constant_conditions_are_pruned();
+    test_identities();
+    test_strength_reduction();
+    test_optimized_programs_agree();
+    test_dump();
+    test_deep_chains();
+    printf("All optimizer unit tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "assert.h"
+#include "parse_cache.h"
+#include "fast_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ExpressoAst* parse(const char* expr) {
+    ExpressoAst* ast = expresso_ast_create();
+    ASSERT_TRUE(expresso_fast_parse(expr, ast, NULL), expr);
+    return ast;
+}
+
+static void check_key(const char* text, const char* expected) {
+    char key[128];
+    char assert_msg[256];
+    size_t length = parse_cache_normalize(text, key);
+    snprintf(assert_msg, sizeof(assert_msg), "'%s' should normalise to '%s', not '%s'", text, expected, key);
+    ASSERT_TRUE(strcmp(key, expected) == 0, assert_msg);
+    ASSERT_EQ(strlen(expected), length, assert_msg);
+}
+
+void test_normalize() {
+    check_key("  1 + 2 *\t3\n", "1+2*3");
+    check_key("( $a - -1 )", "($a--1)");
+    // Whitespace that separates tokens is kept
+    check_key("1 2", "1 2");
+    check_key("1 .5", "1 .5");
+    check_key("$a < < $b", "$a< <$b");
+    check_key("$a <   <= $b", "$a< <=$b");
+    check_key("! = 0", "! =0");
+    // Literals are kept as they are
+    check_key("\"a  b\" + ' '", "\"a  b\"+' '");
+    check_key("\"a \\\" b\"  +1", "\"a \\\" b\"+1");
+}
+
+void test_lookup_and_recency() {
+    ParseCache* cache = parse_cache_create(2, 1 << 20);
+    const char* keys[] = { "1+1", "2+2", "3+3" };
+
+    for (int i = 0; i < 2; i++) {
+        ASSERT_TRUE(parse_cache_lookup(cache, keys[i], 3) == NULL, "Empty cache should miss");
+        ASSERT_TRUE(parse_cache_insert(cache, keys[i], 3, parse(keys[i])), "Insertion should succeed");
+    }
+    const ExpressoAst* found = parse_cache_lookup(cache, keys[0], 3);
+    ASSERT_TRUE(found != NULL, "Inserted entry should hit");
+    ASSERT_EQ(1, found->nodes[found->nodes[found->root].children[0]].data.integer_value, "Cached tree is incorrect");
+
+    // 1+1 was used last, so 2+2 is the least recently used
+    ASSERT_TRUE(parse_cache_insert(cache, keys[2], 3, parse(keys[2])), "Insertion should succeed");
+    ASSERT_TRUE(parse_cache_lookup(cache, keys[1], 3) == NULL, "Least recently used entry should be evicted");
+    ASSERT_TRUE(parse_cache_lookup(cache, keys[0], 3) != NULL, "Recently used entry should survive");
+    ASSERT_TRUE(parse_cache_lookup(cache, keys[2], 3) != NULL, "New entry should hit");
+
+    ParseCacheStats stats;
+    parse_cache_get_stats(cache, &stats);
+    ASSERT_EQ(3, (int)stats.hits, "Hit count is incorrect");
+    ASSERT_EQ(3, (int)stats.misses, "Miss count is incorrect");
+    ASSERT_EQ(1, (int)stats.evictions, "Eviction count is incorrect");
+    ASSERT_EQ(2, (int)stats.entries, "Cache should stay within its entry limit");
+    parse_cache_destroy(cache);
+}
+
+void test_byte_limit() {
+    ExpressoAst* small = parse("1");
+    size_t one_entry;
+    ParseCache* cache = parse_cache_create(100, 1 << 20);
+    ASSERT_TRUE(parse_cache_insert(cache, "1", 1, small), "Insertion should succeed");
+    ParseCacheStats stats;
+    parse_cache_get_stats(cache, &stats);
+    one_entry = stats.bytes;
+    parse_cache_destroy(cache);
+
+    // Room for two such entries only
+    cache = parse_cache_create(100, 2 * one_entry + 1);
+    const char* keys[] = { "1", "2", "3" };
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(parse_cache_insert(cache, keys[i], 1, parse(keys[i])), "Insertion should succeed");
+    }
+    parse_cache_get_stats(cache, &stats);
+    ASSERT_EQ(2, (int)stats.entries, "Cache should stay within its byte limit");
+    ASSERT_TRUE(stats.bytes <= stats.max_bytes, "Byte count exceeds the limit");
+    ASSERT_TRUE(parse_cache_lookup(cache, "1", 1) == NULL, "Oldest entry should be evicted");
+
+    // An entry larger than the whole cache is refused and left to the caller
+    char text[1024];
+    memset(text, 'x', sizeof(text) - 1);
+    text[0] = text[sizeof(text) - 2] = '"';
+    text[sizeof(text) - 1] = '\0';
+    ExpressoAst* large = parse(text);
+    ASSERT_FALSE(parse_cache_insert(cache, "large", 5, large), "Oversized entry should be refused");
+    expresso_ast_destroy(large);
+    parse_cache_destroy(cache);
+}
+
+int main() {
+    printf("Running parse cache unit tests...\n");
+    test_normalize();
+    test_lookup_and_recency();
+    test_byte_limit();
+    printf("All parse cache unit tests passed!\n");
+    return 0;
+}
@@ -1,7 +1,10 @@
 #include "assert.h"
 #include "value.h"
+#include "operations.h"
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
 
 void test_value_create_integer() {
     Value v = value_create_integer(123);
@@ -27,27 +30,129 @@ void test_value_create_character() {
 void test_value_create_string() {
     Value v = value_create_string("hello");
     ASSERT_TRUE(value_is_string(v), "String value type check failed");
-    ASSERT_TRUE(strcmp("hello", value_c_str(v)) == 0, "String value content mismatch");
+    ASSERT_TRUE(strcmp("hello", value_c_str(&v)) == 0, "String value content mismatch");
     value_destroy(v);
 }
 
 void test_value_create_error() {
     Value v = value_create_error("Test Error");
     ASSERT_TRUE(value_is_error(v), "Error value type check failed");
-    ASSERT_TRUE(strcmp("Test Error", value_as_error_message(v)) == 0, "Error message content mismatch");
+    ASSERT_TRUE(strcmp("Test Error", value_as_error_message(&v)) == 0, "Error message content mismatch");
     value_destroy(v);
 }
 
+void test_value_error_codes() {
+    value_reset_allocation_stats();
+    Value v = value_create_error_code(EXPRESSO_ERROR_DIVISION_BY_ZERO);
+    ASSERT_TRUE(value_is_error(v), "Catalogued error type check failed");
+    ASSERT_EQ(EXPRESSO_ERROR_DIVISION_BY_ZERO, value_error_code(v), "Error code mismatch");
+    ASSERT_TRUE(strcmp("Division by zero.", value_as_error_message(&v)) == 0, "Catalogued message mismatch");
+    ASSERT_EQ(EXPRESSO_ERROR_CATEGORY_RUNTIME, expresso_error_category(value_error_code(v)), "Error category mismatch");
+    size_t start, length;
+    ASSERT_FALSE(value_error_span(v, &start, &length), "Error without a span reported one");
+
+    Value located = value_create_error_at(EXPRESSO_ERROR_EXPECTED_RPAREN, 6, 1);
+    ASSERT_TRUE(value_error_span(located, &start, &length), "Error span missing");
+    ASSERT_EQ(6, start, "Error span start mismatch");
+    ASSERT_EQ(1, length, "Error span length mismatch");
+    ASSERT_TRUE(strcmp("SyntaxError", expresso_error_category_name(expresso_error_category(value_error_code(located)))) == 0,
+                "Syntax error category name mismatch");
+    Value copy = value_copy(located);
+    ASSERT_TRUE(value_equals(located, copy), "Copied error should equal the original");
+    ASSERT_TRUE(value_equals(located, value_create_error_code(EXPRESSO_ERROR_EXPECTED_RPAREN)), "Errors should equal wherever reported");
+    ASSERT_FALSE(value_equals(v, located), "Different error codes should not be equal");
+    value_destroy(copy);
+
+    Value distant = value_create_error_at(EXPRESSO_ERROR_SYNTAX, (size_t)1 << 40, 1);
+    ASSERT_FALSE(value_error_span(distant, &start, &length), "Span beyond what can be stored should be dropped");
+    ASSERT_EQ(EXPRESSO_ERROR_SYNTAX, value_error_code(distant), "Error code lost with its span");
+
+    ValueAllocationStats stats;
+    value_allocation_stats(&stats);
+    ASSERT_EQ(0, stats.allocations, "Catalogued errors should not allocate");
+
+    Value custom = value_create_error("Made at run time");
+    ASSERT_EQ(EXPRESSO_ERROR_CUSTOM, value_error_code(custom), "Run-time message should be a custom error");
+    ASSERT_FALSE(value_equals(custom, v), "Custom error should not equal a catalogued one");
+    value_destroy(custom);
+    value_destroy(v);
+    value_destroy(located);
+    value_destroy(distant);
+}
+
 void test_value_copy_string() {
-    Value original = value_create_string("original");
+    Value original = value_create_string("text");
     Value copy = value_copy(original);
     ASSERT_TRUE(value_is_string(copy), "Copied value is not string");
-    ASSERT_TRUE(strcmp(value_c_str(original), value_c_str(copy)) == 0, "Copied string content mismatch");
-    ASSERT_TRUE(value_c_str(original) != value_c_str(copy), "Copied string is not a deep copy");
+    ASSERT_TRUE(strcmp(value_c_str(&original), value_c_str(&copy)) == 0, "Copied string content mismatch");
+    ASSERT_TRUE(value_c_str(&original) != value_c_str(&copy), "Short string copy should hold its own bytes");
     value_destroy(original);
     value_destroy(copy);
 }
 
+void test_value_string_storage() {
+    value_reset_allocation_stats();
+    ValueAllocationStats stats;
+
+    // Up to VALUE_INLINE_CAPACITY bytes live in the Value itself
+    const char* text = "sixteen bytes!!!";
+    Value short_string = value_create_string_from(text, VALUE_INLINE_CAPACITY);
+    ASSERT_EQ(VALUE_INLINE_CAPACITY, value_string_length(short_string), "Short string length mismatch");
+    value_allocation_stats(&stats);
+    ASSERT_EQ(0, stats.allocations, "Short string should not allocate");
+
+    // Longer strings are one shared buffer, so copies are O(1)
+    Value long_string = value_create_string_from(text, VALUE_INLINE_CAPACITY + 1);
+    Value copy = value_copy(long_string);
+    ASSERT_TRUE(value_c_str(&long_string) == value_c_str(&copy), "Long string copy should share its text");
+    value_destroy(long_string);
+    ASSERT_TRUE(strncmp(text, value_c_str(&copy), VALUE_INLINE_CAPACITY + 1) == 0, "Shared text should outlive the original");
+    value_allocation_stats(&stats);
+    ASSERT_EQ(1, stats.allocations, "Long string and its copy should allocate once");
+    ASSERT_EQ(0, stats.releases, "Shared text released while still referenced");
+    value_destroy(copy);
+    value_allocation_stats(&stats);
+    ASSERT_EQ(1, stats.releases, "Shared text should be released with its last reference");
+
+    // The cached length covers embedded NULs
+    Value with_nul = value_create_string_from("a\0b", 3);
+    Value other = value_create_string_from("a\0c", 3);
+    ASSERT_EQ(3, value_string_length(with_nul), "Length should include embedded NULs");
+    ASSERT_FALSE(value_equals(with_nul, other), "Bytes after a NUL should be compared");
+    value_destroy(short_string);
+}
+
+void test_value_encoding() {
+    // Integers round-trip at every width, including across any inline limit
+    long long integers[] = { 0, -1, 140737488355327LL, -140737488355328LL, 140737488355328LL,
+                             -140737488355329LL, LLONG_MAX, LLONG_MIN };
+    for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+        Value v = value_create_integer(integers[i]);
+        Value copy = value_copy(v);
+        ASSERT_TRUE(value_is_integer(v), "Integer value type mismatch");
+        ASSERT_EQ(integers[i], value_as_integer(v), "Integer should round-trip");
+        ASSERT_TRUE(value_equals(v, copy), "Integer copy should be equal");
+        value_destroy(v);
+        value_destroy(copy);
+    }
+
+    // Every double stays a float, NaNs and infinities included
+    double floats[] = { 0.0, -0.0, 1.5, -INFINITY, INFINITY, NAN, -NAN };
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        Value v = value_create_float(floats[i]);
+        ASSERT_TRUE(value_is_float(v), "Float value type mismatch");
+        double d = value_as_float(v);
+        ASSERT_TRUE(isnan(floats[i]) ? isnan(d) : memcmp(&d, &floats[i], sizeof d) == 0, "Float should round-trip");
+    }
+
+    Value c = value_create_character('\xFF');
+    ASSERT_TRUE(value_is_character(c) && value_as_character(c) == '\xFF', "Character should round-trip");
+
+#ifdef EXPRESSO_NAN_BOXING
+    ASSERT_EQ(8, sizeof(Value), "A NaN-boxed value should be one word");
+#endif
+}
+
 void test_value_equals() {
     Value i1 = value_create_integer(10);
     Value i2 = value_create_integer(10);
@@ -68,6 +173,118 @@ void test_value_equals() {
     value_destroy(s1); value_destroy(s2); value_destroy(s3);
 }
 
+// Floats negate, and are conditions that are true when not 0.0
+void test_value_float_operands() {
+    Value half = value_create_float(0.5);
+    Value zero = value_create_float(0.0);
+    Value negative_zero = value_create_float(-0.0);
+
+    Value negated = value_by_negating_value(half);
+    ASSERT_TRUE(value_is_float(negated) && value_as_float(negated) == -0.5, "Negated float is incorrect");
+    ASSERT_TRUE(value_is_condition(half) && value_is_condition(zero), "Floats should be conditions");
+    ASSERT_TRUE(value_is_true(half), "0.5 should be true");
+    ASSERT_FALSE(value_is_true(zero) || value_is_true(negative_zero), "0.0 and -0.0 should be false");
+
+    Value not_half = value_by_logical_negating_value(half);
+    ASSERT_TRUE(value_is_integer(not_half) && value_as_integer(not_half) == 0, "!0.5 should be 0");
+    Value both = value_by_logical_anding_values(half, zero);
+    ASSERT_TRUE(value_is_integer(both) && value_as_integer(both) == 0, "0.5 && 0.0 should be 0");
+    Value either = value_by_logical_oring_values(zero, half);
+    ASSERT_TRUE(value_is_integer(either) && value_as_integer(either) == 1, "0.0 || 0.5 should be 1");
+    ASSERT_EQ(VALUE_TYPE_FLOAT, value_result_type(EXPRESSO_OP_NEGATE, VALUE_TYPE_FLOAT, VALUE_TYPE_INTEGER),
+              "Negating a float should give a float");
+    ASSERT_EQ(VALUE_TYPE_INTEGER, value_result_type(EXPRESSO_OP_LOGICAL_OR, VALUE_TYPE_FLOAT, VALUE_TYPE_FLOAT),
+              "|| of floats should give an integer");
+}
+
+void test_value_concatenation() {
+    Value values[] = { value_create_integer(42), value_create_float(2.5), value_create_character('c'),
+                       value_create_string(" and more") };
+    Value head = value_create_string("n=");
+
+    Value pair = value_concatenate(head, values, 1);
+    ASSERT_TRUE(value_is_string(pair) && strcmp(value_c_str(&pair), "n=42") == 0, "String + integer is incorrect");
+    Value all = value_concatenate(head, values, 4);
+    ASSERT_TRUE(strcmp(value_c_str(&all), "n=422.5c and more") == 0, "Concatenation of each type is incorrect");
+    ASSERT_EQ(17, value_string_length(all), "Concatenation length is incorrect");
+
+    Value error = value_create_error_code(EXPRESSO_ERROR_DIVISION_BY_ZERO);
+    Value failed = value_concatenate(head, &error, 1);
+    ASSERT_EQ(EXPRESSO_ERROR_DIVISION_BY_ZERO, value_error_code(failed), "Concatenating an error should give that error");
+    value_destroy(failed);
+    failed = value_concatenate(values[0], &head, 1);
+    ASSERT_EQ(EXPRESSO_ERROR_TYPE, value_error_code(failed), "Only a string can be concatenated to");
+    value_destroy(failed);
+
+    value_destroy(pair);
+    value_destroy(all);
+    value_destroy(head);
+    value_destroy(values[3]);
+}
+
+void test_value_ropes() {
+    char text[VALUE_ROPE_MIN_LENGTH];
+    memset(text, 'x', sizeof text);
+    Value half = value_create_string_from(text, VALUE_ROPE_MIN_LENGTH / 2);
+    Value number = value_create_integer(7);
+
+    value_reset_allocation_stats();
+    ValueAllocationStats stats;
+
+    // Long concatenations hold their pieces, and join them when first read
+    Value rope = value_concatenate(half, &half, 1);
+    Value longer = value_concatenate(rope, &number, 1);
+    ASSERT_EQ(VALUE_ROPE_MIN_LENGTH + 1, value_string_length(longer), "Rope length is incorrect");
+    Value copy = value_copy(longer);
+    value_destroy(rope);
+    value_destroy(longer);
+
+    char expected[VALUE_ROPE_MIN_LENGTH + 2];
+    memset(expected, 'x', VALUE_ROPE_MIN_LENGTH);
+    strcpy(expected + VALUE_ROPE_MIN_LENGTH, "7");
+    Value flat = value_create_string(expected);
+    ASSERT_TRUE(value_equals(copy, flat), "Rope should equal its joined text");
+    ASSERT_TRUE(strcmp(value_c_str(&copy), expected) == 0, "Joined rope text is incorrect");
+    ASSERT_TRUE(value_c_str(&copy) == value_c_str(&copy), "A rope should be joined once");
+
+    // Every buffer goes with the last copy
+    value_destroy(copy);
+    value_destroy(flat);
+    value_allocation_stats(&stats);
+    ASSERT_EQ(stats.allocations, stats.releases, "Rope pieces should be released with the rope");
+
+    // Deep ropes of either shape are copied and released without recursing
+    for (int right_nested = 0; right_nested < 2; right_nested++) {
+        const size_t depth = 200000;
+        Value piece = value_create_string("ab");
+        Value rope = value_copy(half);
+        for (size_t i = 0; i < depth; i++) {
+            Value next = right_nested ? value_concatenate(piece, &rope, 1) : value_concatenate(rope, &piece, 1);
+            value_destroy(rope);
+            rope = next;
+        }
+        const char* joined = value_c_str(&rope);
+        ASSERT_EQ(VALUE_ROPE_MIN_LENGTH / 2 + 2 * depth, strlen(joined), "Deep rope length is incorrect");
+        ASSERT_TRUE(strncmp(joined + (right_nested ? 2 * depth : 0), text, VALUE_ROPE_MIN_LENGTH / 2) == 0,
+                    "Deep rope text is incorrect");
+        ASSERT_TRUE(strncmp(joined + (right_nested ? 0 : VALUE_ROPE_MIN_LENGTH / 2), "abab", 4) == 0,
+                    "Deep rope text is incorrect");
+
+        // Released before it is joined, too
+        Value unread = value_concatenate(rope, &piece, 1);
+        for (size_t i = 0; i < depth; i++) {
+            Value next = right_nested ? value_concatenate(piece, &unread, 1) : value_concatenate(unread, &piece, 1);
+            value_destroy(unread);
+            unread = next;
+        }
+        value_destroy(unread);
+        value_destroy(rope);
+        value_destroy(piece);
+    }
+    value_allocation_stats(&stats);
+    ASSERT_EQ(stats.allocations, stats.releases, "Deep ropes should be released");
+    value_destroy(half);
+}
 
 int main() {
     printf("Running Value type unit tests...\n");
@@ -76,8 +293,14 @@ int main() {
     test_value_create_character();
     test_value_create_string();
     test_value_create_error();
+    test_value_error_codes();
     test_value_copy_string();
+    test_value_string_storage();
+    test_value_encoding();
     test_value_equals();
+    test_value_float_operands();
+    test_value_concatenation();
+    test_value_ropes();
     printf("All Value type tests passed!\n");
     return 0;
 }
@@ -0,0 +1,153 @@
+#include "assert.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "evaluator.h"
+#include "parser_wrapper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ExpressoParserContext* parser_ctx;
+
+// Compile expr and check that the VM agrees with the tree walker
+static void check_matches_tree_walker(const char* expr) {
+    char assert_msg[160];
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, expr);
+    snprintf(assert_msg, sizeof(assert_msg), "Failed to parse '%s'", expr);
+    ASSERT_TRUE(tree != NULL, assert_msg);
+
+    const ExpressoAst* ast = expresso_tree_get_ast(tree);
+    ExpressoProgram* program = expresso_program_compile(ast, NULL);
+    snprintf(assert_msg, sizeof(assert_msg), "Failed to compile '%s'", expr);
+    ASSERT_TRUE(program != NULL, assert_msg);
+
+    Value expected = evaluate_ast(ast);
+    // Run twice: programs must be reusable
+    for (int run = 0; run < 2; run++) {
+        Value actual = expresso_vm_run(program, NULL);
+        snprintf(assert_msg, sizeof(assert_msg), "VM result differs for '%s'", expr);
+        ASSERT_TRUE(value_equals(expected, actual), assert_msg);
+        value_destroy(actual);
+    }
+
+    value_destroy(expected);
+    expresso_program_destroy(program);
+    expresso_tree_destroy(tree);
+}
+
+void test_vm_matches_tree_walker() {
+    const char* exprs[] = {
+        "42", "'a'", "\"str\"", "1 + 2 * 3", "(1 + 2) * 3", "10 - 4 - 3", "17 % 5 * 2",
+        "-(3) + +4", "!0", "~5", "1 << 3 >> 1", "3 < 5 == 1", "6 & 3 | 8 ^ 1",
+        "1 && 0 || 1", "1 ? 2 : 3", "0 ? 1 : 0 ? 2 : 3", "(1 ? 0 : 1) ? 4 : 5",
+        "\"a\" + \"b\"", "\"a\" ? 1 : 2", "'a' * 2", "1 + (2 ? 3 : 4) * 5",
+        "0 && 1 / 0", "2 || 1 / 0", "0 && \"s\"", "1 && \"s\"", "\"s\" || 1", "0 || 7", "1 + (0 || 0 && 1)",
+        "-1.5", "!0.0", "1.5 && 1", "0.0 || 1", "1.5 ? 2 : 3", "0.0 ? 2 : 3",
+        "\"a\" + 1", "\"a\" + 1 + 2.5 + 'c'", "1 + 2 + \"a\" + 3", "1 + \"a\" + 2", "\"a\" + (1 + 2) + \"b\"",
+        "\"a\" + 1 / 0 + \"b\"", "\"a\" + \"b\" - 1 + \"c\"", "1 << 70 + 0 * (\"a\" == \"b\")",
+        "9223372036854775808", "-9223372036854775808", "0xFFFFFFFFFFFFFFFF - 1",
+    };
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        check_matches_tree_walker(exprs[i]);
+    }
+}
+
+void test_vm_deep_stack() {
+    // Right-nested additions need one stack slot per level
+    char expr[4096] = "";
+    for (int i = 0; i < 200; i++) strcat(expr, "1+(");
+    strcat(expr, "1");
+    for (int i = 0; i < 200; i++) strcat(expr, ")");
+
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, expr);
+    ASSERT_TRUE(tree != NULL, "Failed to parse deep expression");
+    ExpressoProgram* program = expresso_program_compile(expresso_tree_get_ast(tree), NULL);
+    ASSERT_TRUE(program->max_stack > EXPRESSO_VM_INLINE_STACK, "Deep expression should need a heap stack");
+
+    Value result = expresso_vm_run(program, NULL);
+    ASSERT_TRUE(value_is_integer(result), "Deep expression result should be integer");
+    ASSERT_EQ(201, value_as_integer(result), "Deep expression sum failed");
+
+    expresso_program_destroy(program);
+    expresso_tree_destroy(tree);
+}
+
+void test_vm_deep_chain() {
+    // A chain of 50000 subtractions nests as deeply, one level per operator
+    const int terms = 50000;
+    char* expr = (char*)malloc(terms * 2);
+    ASSERT_TRUE(expr != NULL, "Failed to allocate deep chain");
+    for (int i = 0; i < terms; i++) {
+        expr[2 * i] = '1';
+        expr[2 * i + 1] = '-';
+    }
+    expr[terms * 2 - 1] = '\0';
+
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, expr);
+    ASSERT_TRUE(tree != NULL, "Failed to parse deep chain");
+    const ExpressoAst* ast = expresso_tree_get_ast(tree);
+    ExpressoErrorCode error = EXPRESSO_ERROR_NONE;
+    ExpressoProgram* program = expresso_program_compile(ast, &error);
+    ASSERT_TRUE(program != NULL, "Failed to compile deep chain");
+
+    Value result = expresso_vm_run(program, NULL);
+    ASSERT_TRUE(value_is_integer(result), "Deep chain result should be integer");
+    ASSERT_EQ(2 - terms, value_as_integer(result), "Deep chain difference failed");
+    value_destroy(result);
+    expresso_program_destroy(program);
+
+    // Trees the tree walker would refuse are not compiled either
+    evaluator_set_max_depth(100);
+    ASSERT_TRUE(expresso_program_compile(ast, &error) == NULL, "Compiling beyond the depth limit should fail");
+    ASSERT_EQ(EXPRESSO_ERROR_TOO_DEEP, error, "Compiling beyond the depth limit should report TOO_DEEP");
+    evaluator_set_max_depth(0);
+
+    expresso_tree_destroy(tree);
+    free(expr);
+}
+
+void test_vm_fuses_concatenation() {
+    // A chain of 1000 terms is added by one instruction into one string
+    char expr[16384] = "\"<\"";
+    for (int i = 0; i < 999; i++) strcat(expr, i % 2 ? " + 'x'" : " + \"abcdefghijklmnopq\"");
+
+    ExpressoParseTree* tree = expresso_parser_parse(parser_ctx, expr);
+    ASSERT_TRUE(tree != NULL, "Failed to parse concatenation chain");
+    const ExpressoAst* ast = expresso_tree_get_ast(tree);
+    ExpressoProgram* program = expresso_program_compile(ast, NULL);
+    ASSERT_EQ(EXPRESSO_OPCODE_ADD_CHAIN, program->code[program->code_size - 2 - sizeof(uint32_t)],
+              "Concatenation chain should be fused");
+
+    Value result = expresso_vm_run(program, NULL);
+    Value expected = evaluate_ast(ast);
+    ASSERT_EQ(1 + 500 * 17 + 499, value_string_length(result), "Concatenation chain length is incorrect");
+    ASSERT_TRUE(value_equals(expected, result), "Fused concatenation should match the tree walker");
+
+    value_destroy(expected);
+    value_destroy(result);
+    expresso_program_destroy(program);
+    expresso_tree_destroy(tree);
+}
+
+void test_vm_empty_program() {
+    ExpressoErrorCode error = EXPRESSO_ERROR_NONE;
+    ASSERT_TRUE(expresso_program_compile(NULL, &error) == NULL, "Compiling no tree should fail");
+    ASSERT_EQ(EXPRESSO_ERROR_EMPTY_TREE, error, "Compiling no tree should report an empty tree");
+    Value result = expresso_vm_run(NULL, NULL);
+    ASSERT_TRUE(value_is_error(result), "Running no program should be an error");
+    value_destroy(result);
+}
+
+int main() {
+    printf("Running VM unit tests...\n");
+    parser_ctx = expresso_parser_create();
+    expresso_parser_set_backend(parser_ctx, EXPRESSO_PARSER_BACKEND_FAST);
+    test_vm_matches_tree_walker();
+    test_vm_deep_stack();
+    test_vm_deep_chain();
+    test_vm_fuses_concatenation();
+    test_vm_empty_program();
+    expresso_parser_destroy(parser_ctx);
+    printf("All VM unit tests passed!\n");
+    return 0;
+}
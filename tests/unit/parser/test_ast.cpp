@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "ast.h"
+#include "parser_wrapper.h"
+#include <cstring>
+
+class AstLoweringTest : public ::testing::Test {
+protected:
+    void SetUp() override { ctx_ = expresso_parser_create(); }
+    void TearDown() override {
+        expresso_tree_destroy(tree_);
+        expresso_parser_destroy(ctx_);
+    }
+
+    const ExpressoAst* lower(const char* expr) {
+        expresso_tree_destroy(tree_);
+        tree_ = expresso_parser_parse(ctx_, expr);
+        return tree_ ? expresso_tree_get_ast(tree_) : nullptr;
+    }
+
+    ExpressoParserContext* ctx_ = nullptr;
+    ExpressoParseTree* tree_ = nullptr;
+};
+
+TEST(AstBuilderTest, NodesAreAppendedBottomUp) {
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoNodeIndex left = expresso_ast_add_integer(ast, 3);
+    ExpressoNodeIndex right = expresso_ast_add_string(ast, "abc", 3);
+    ExpressoNodeIndex sum = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, left, right);
+
+    ASSERT_EQ(3u, ast->count);
+    EXPECT_LT(left, sum);
+    EXPECT_LT(right, sum);
+    EXPECT_EQ(EXPRESSO_NODE_BINARY, ast->nodes[sum].kind);
+    EXPECT_EQ(EXPRESSO_OP_ADD, ast->nodes[sum].op);
+    EXPECT_STREQ("abc", expresso_ast_string(ast, &ast->nodes[right]));
+
+    expresso_ast_reset(ast);
+    EXPECT_EQ(0u, ast->count);
+    EXPECT_EQ(EXPRESSO_NODE_NONE, ast->root);
+    expresso_ast_destroy(ast);
+}
+
+TEST(AstBuilderTest, StringPoolSurvivesGrowth) {
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoNodeIndex first = expresso_ast_add_string(ast, "first", 5);
+    for (int i = 0; i < 1000; i++) {
+        expresso_ast_add_string(ast, "padding-padding", 15);
+    }
+    EXPECT_STREQ("first", expresso_ast_string(ast, &ast->nodes[first]));
+    expresso_ast_destroy(ast);
+}
+
+TEST(AstBuilderTest, SharingStoresIdenticalSubtreesOnce) {
+    ExpressoAst* ast = expresso_ast_create();
+    expresso_ast_set_sharing(ast, true);
+    ExpressoNodeIndex name = expresso_ast_add_parameter(ast, "a", 1);
+    ExpressoNodeIndex left = expresso_ast_add_binary(ast, EXPRESSO_OP_MULTIPLY, name, expresso_ast_add_integer(ast, 2));
+    size_t strings_size = ast->strings_size;
+    ExpressoNodeIndex right = expresso_ast_add_binary(ast, EXPRESSO_OP_MULTIPLY,
+                                                      expresso_ast_add_parameter(ast, "a", 1),
+                                                      expresso_ast_add_integer(ast, 2));
+    EXPECT_EQ(left, right);
+    EXPECT_EQ(strings_size, ast->strings_size);
+    EXPECT_NE(left, expresso_ast_add_binary(ast, EXPRESSO_OP_MULTIPLY, name, expresso_ast_add_float(ast, 2.0)));
+    ast->root = expresso_ast_add_binary(ast, EXPRESSO_OP_ADD, left, right);
+
+    ExpressoSharingStats stats;
+    expresso_ast_sharing_stats(ast, &stats);
+    EXPECT_EQ(9u, stats.nodes_added);
+    EXPECT_EQ(6u, stats.nodes_stored);
+    EXPECT_EQ(2u, stats.shared_nodes); // $a and $a * 2
+
+    EXPECT_TRUE(expresso_ast_is_shared(ast, left));
+    EXPECT_FALSE(expresso_ast_is_shared(ast, ast->root));
+    expresso_ast_destroy(ast);
+}
+
+TEST_F(AstLoweringTest, PrecedenceAndParenthesesShapeTheTree) {
+    const ExpressoAst* ast = lower("(3 + 5) * 2");
+    ASSERT_NE(nullptr, ast);
+
+    const ExpressoNode& root = ast->nodes[ast->root];
+    ASSERT_EQ(EXPRESSO_NODE_BINARY, root.kind);
+    EXPECT_EQ(EXPRESSO_OP_MULTIPLY, root.op);
+
+    const ExpressoNode& sum = ast->nodes[root.children[0]];
+    EXPECT_EQ(EXPRESSO_OP_ADD, sum.op);
+    EXPECT_EQ(3, ast->nodes[sum.children[0]].data.integer_value);
+    EXPECT_EQ(5, ast->nodes[sum.children[1]].data.integer_value);
+    EXPECT_EQ(2, ast->nodes[root.children[1]].data.integer_value);
+
+    // Parentheses leave no node behind
+    EXPECT_EQ(5u, ast->count);
+}
+
+TEST_F(AstLoweringTest, OperatorChainsFoldLeft) {
+    const ExpressoAst* ast = lower("10 - 4 - 3");
+    ASSERT_NE(nullptr, ast);
+
+    const ExpressoNode& root = ast->nodes[ast->root];
+    EXPECT_EQ(EXPRESSO_OP_SUBTRACT, root.op);
+    EXPECT_EQ(3, ast->nodes[root.children[1]].data.integer_value);
+    EXPECT_EQ(EXPRESSO_OP_SUBTRACT, ast->nodes[root.children[0]].op);
+}
+
+TEST_F(AstLoweringTest, LogicalOrTokenPairBecomesOneOperator) {
+    const ExpressoAst* ast = lower("1 || 0");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(EXPRESSO_OP_LOGICAL_OR, ast->nodes[ast->root].op);
+}
+
+TEST_F(AstLoweringTest, ConditionalHasThreeChildren) {
+    const ExpressoAst* ast = lower("1 ? 2 : 3");
+    ASSERT_NE(nullptr, ast);
+
+    const ExpressoNode& root = ast->nodes[ast->root];
+    ASSERT_EQ(EXPRESSO_NODE_CONDITIONAL, root.kind);
+    EXPECT_EQ(1, ast->nodes[root.children[0]].data.integer_value);
+    EXPECT_EQ(2, ast->nodes[root.children[1]].data.integer_value);
+    EXPECT_EQ(3, ast->nodes[root.children[2]].data.integer_value);
+}
+
+TEST_F(AstLoweringTest, LiteralPayloadsAreDecoded) {
+    const ExpressoAst* ast = lower("0x1F");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(31, ast->nodes[ast->root].data.integer_value);
+
+    ast = lower("\"hello\"");
+    ASSERT_NE(nullptr, ast);
+    ASSERT_EQ(EXPRESSO_NODE_STRING, ast->nodes[ast->root].kind);
+    EXPECT_STREQ("hello", expresso_ast_string(ast, &ast->nodes[ast->root]));
+
+    ast = lower("-'a'");
+    ASSERT_NE(nullptr, ast);
+    const ExpressoNode& root = ast->nodes[ast->root];
+    EXPECT_EQ(EXPRESSO_OP_NEGATE, root.op);
+    EXPECT_EQ('a', ast->nodes[root.children[0]].data.char_value);
+}
+
+TEST_F(AstLoweringTest, EscapesAreDecoded) {
+    const ExpressoAst* ast = lower("\"tab\\there\\\"\"");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_STREQ("tab\there\"", expresso_ast_string(ast, &ast->nodes[ast->root]));
+
+    ast = lower("'\\n'");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ('\n', ast->nodes[ast->root].data.char_value);
+}
+
+TEST_F(AstLoweringTest, OutOfRangeIntegerLiteralIsBigInteger) {
+    const ExpressoAst* ast = lower("9223372036854775807");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(EXPRESSO_NODE_INTEGER, ast->nodes[ast->root].kind);
+    EXPECT_EQ(9223372036854775807LL, ast->nodes[ast->root].data.integer_value);
+
+    ast = lower("9223372036854775808");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(EXPRESSO_NODE_BIGINT, ast->nodes[ast->root].kind);
+    EXPECT_STREQ("9223372036854775808", expresso_ast_string(ast, &ast->nodes[ast->root]));
+
+    ast = lower("0xFFFFFFFFFFFFFFFF");
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(EXPRESSO_NODE_BIGINT, ast->nodes[ast->root].kind);
+}
+
+TEST_F(AstLoweringTest, CharacterLiteralHoldsOneCharacter) {
+    EXPECT_EQ(nullptr, lower("'ab'"));
+    EXPECT_EQ(nullptr, lower("''"));
+    EXPECT_NE(nullptr, lower("'\\n'"));
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "literal.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static bool DecodeInteger(const std::string& text, long long* value) {
+    return expresso_literal_integer(text.data(), text.size(), value);
+}
+
+// strtod is correctly rounded in the C libraries we test on, so it is the
+// reference; the decoder is handed a span without a terminator
+static void ExpectSameAsStrtod(const std::string& text) {
+    SCOPED_TRACE(text);
+    std::string span = text + "999";
+    double value = -1.0;
+    ASSERT_TRUE(expresso_literal_float(span.data(), text.size(), &value));
+    double expected = strtod(text.c_str(), nullptr);
+    EXPECT_EQ(0, memcmp(&expected, &value, sizeof(value))) << value << " != " << expected;
+}
+
+TEST(LiteralTest, DecimalIntegersAreOverflowChecked) {
+    long long value = 0;
+    EXPECT_TRUE(DecodeInteger("0", &value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(DecodeInteger("00042", &value));
+    EXPECT_EQ(42, value);
+    EXPECT_TRUE(DecodeInteger("1234567890123456", &value));
+    EXPECT_EQ(1234567890123456LL, value);
+    EXPECT_TRUE(DecodeInteger("9223372036854775807", &value));
+    EXPECT_EQ(9223372036854775807LL, value);
+
+    EXPECT_FALSE(DecodeInteger("9223372036854775808", &value));
+    EXPECT_FALSE(DecodeInteger("18446744073709551616", &value));
+    EXPECT_FALSE(DecodeInteger("99999999999999999999999", &value));
+    EXPECT_FALSE(DecodeInteger("", &value));
+    EXPECT_FALSE(DecodeInteger("12a", &value));
+}
+
+TEST(LiteralTest, HexIntegersAreOverflowChecked) {
+    long long value = 0;
+    EXPECT_TRUE(DecodeInteger("0x1F", &value));
+    EXPECT_EQ(31, value);
+    EXPECT_TRUE(DecodeInteger("0xdeadBEEF", &value));
+    EXPECT_EQ(0xDEADBEEFLL, value);
+    EXPECT_TRUE(DecodeInteger("0x7FFFFFFFFFFFFFFF", &value));
+    EXPECT_EQ(9223372036854775807LL, value);
+    EXPECT_TRUE(DecodeInteger("0x0000000000000000001", &value));
+    EXPECT_EQ(1, value);
+
+    EXPECT_FALSE(DecodeInteger("0x8000000000000000", &value));
+    EXPECT_FALSE(DecodeInteger("0xFFFFFFFFFFFFFFFF", &value));
+    EXPECT_FALSE(DecodeInteger("0x10000000000000000", &value));
+    EXPECT_FALSE(DecodeInteger("0x1G", &value));
+}
+
+TEST(LiteralTest, IntegerSpellingsAreRecognizedWhateverTheirValue) {
+    const char* integers[] = { "0", "9223372036854775808", "0x1F", "0xFFFFFFFFFFFFFFFF", "99999999999999999999999" };
+    for (const char* text : integers) {
+        EXPECT_TRUE(expresso_literal_is_integer(text, strlen(text))) << text;
+    }
+    const char* others[] = { "", "0x", "12a", "0x1G", "1.5" };
+    for (const char* text : others) {
+        EXPECT_FALSE(expresso_literal_is_integer(text, strlen(text))) << text;
+    }
+}
+
+TEST(LiteralTest, FloatsAreCorrectlyRounded) {
+    const char* corpus[] = {
+        "0.0", ".5", "3.25", "0.1", "0.2", "0.3", "1.0", "000123.456000",
+        "0.30000000000000004", "9007199254740993.0", "9007199254740992.5", "9007199254740993.5",
+        "123456789012345678901234567890.5", "0.000000000000000000001234567890123456789012345",
+        "2.2250738585072011", "179769313486231570000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "00000000.0",
+    };
+    for (const char* text : corpus) {
+        ExpectSameAsStrtod(text);
+    }
+
+    // Beyond the double range: infinity, and subnormals down to zero
+    ExpectSameAsStrtod(std::string(400, '9') + ".0");
+    for (size_t zeros : { 300u, 307u, 320u, 322u, 323u, 324u, 400u }) {
+        ExpectSameAsStrtod("0." + std::string(zeros, '0') + "4940656458412465441765687928682213723651");
+    }
+}
+
+TEST(LiteralTest, LongAndHalfwayFloatsTakeTheSlowPath) {
+    // 2^-1074 * 1.5 and 2^53 + 1 spelled out exactly lie halfway between
+    // two doubles; a trailing digit decides them one way or the other
+    std::string halfway = "9007199254740993";
+    std::string tiny = "0." + std::string(323, '0') + "7410984687618698162648531893023320585475897039214331";
+    for (const std::string& text : { halfway + ".0", halfway + ".00000000000000000001", halfway + ".0" + std::string(30, '0'),
+                                     tiny, tiny + "1", tiny + std::string(40, '0') + "1" }) {
+        ExpectSameAsStrtod(text);
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (int i = 0; i < 20000; i++) {
+        std::string text;
+        size_t whole = next() % 30;
+        size_t fraction = 1 + next() % (i % 2 ? 40 : 400);
+        for (size_t d = 0; d < whole; d++) text += (char)('0' + next() % 10);
+        text += '.';
+        size_t zeros = i % 3 ? 0 : next() % fraction;
+        for (size_t d = 0; d < fraction; d++) text += d < zeros ? '0' : (char)('0' + next() % 10);
+        ExpectSameAsStrtod(text);
+        if (HasFailure()) break;
+    }
+}
+
+TEST(LiteralTest, MalformedFloatsAreRejected) {
+    double value;
+    EXPECT_FALSE(expresso_literal_float("", 0, &value));
+    EXPECT_FALSE(expresso_literal_float(".", 1, &value));
+    EXPECT_FALSE(expresso_literal_float("1.", 2, &value));
+    EXPECT_FALSE(expresso_literal_float("1.2.3", 5, &value));
+    EXPECT_TRUE(expresso_literal_float("12", 2, &value));
+    EXPECT_EQ(12.0, value);
+}
+
+TEST(LiteralTest, EscapesFollowC) {
+    const char text[] = "a\\n\\t\\\\\\'\\\"\\?\\x41\\101\\0\\.z";
+    char out[sizeof(text)];
+    size_t length = expresso_literal_unescape(text, sizeof(text) - 1, out);
+    const char expected[] = "a\n\t\\'\"?AA\0.z";
+    ASSERT_EQ(sizeof(expected) - 1, length);
+    EXPECT_EQ(0, memcmp(expected, out, length));
+
+    // A lone trailing backslash is kept, \x without digits is an 'x'
+    length = expresso_literal_unescape("\\xg\\", 4, out);
+    EXPECT_EQ(std::string("xg\\"), std::string(out, length));
+}
@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "parser_wrapper.h"
+#include "fast_parser.h"
+#include "evaluator.h"
+#include <random>
+#include <string>
+
+// Both backends must lower every input to the same native tree, and reject
+// the same invalid inputs.
+class ParserDifferentialTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        antlr_ = expresso_parser_create();
+        fast_ = expresso_parser_create();
+        expresso_parser_set_backend(fast_, EXPRESSO_PARSER_BACKEND_FAST);
+    }
+    void TearDown() override {
+        expresso_parser_destroy(antlr_);
+        expresso_parser_destroy(fast_);
+    }
+
+    void ExpectSameTree(const std::string& expr, bool evaluate) {
+        SCOPED_TRACE(expr);
+        ExpressoParseTree* expected = expresso_parser_parse(antlr_, expr.c_str());
+        ExpressoParseTree* actual = expresso_parser_parse(fast_, expr.c_str());
+        ASSERT_NE(nullptr, expected);
+        ASSERT_NE(nullptr, actual);
+
+        const ExpressoAst* a = expresso_tree_get_ast(expected);
+        const ExpressoAst* b = expresso_tree_get_ast(actual);
+        ASSERT_NE(nullptr, a);
+        ASSERT_NE(nullptr, b);
+        EXPECT_TRUE(expresso_ast_equal(a, a->root, b, b->root));
+
+        if (evaluate) {
+            Value x = evaluate_ast(a);
+            Value y = evaluate_ast(b);
+            EXPECT_TRUE(value_equals(x, y));
+            value_destroy(x);
+            value_destroy(y);
+        }
+
+        expresso_tree_destroy(expected);
+        expresso_tree_destroy(actual);
+    }
+
+    ExpressoParserContext* antlr_ = nullptr;
+    ExpressoParserContext* fast_ = nullptr;
+};
+
+TEST_F(ParserDifferentialTest, CorpusMatches) {
+    const char* corpus[] = {
+        "42", "0x1F", "3.25", ".5", "'a'", "'\\.'", "\"hello\"", "\"a\\\"b\"",
+        "'\\n'", "'\\''", "\"tab\\there\\x41\"", "0xFFFFFFFFFFFFFFFF", "9223372036854775807",
+        "9223372036854775808", "0x10000000000000000", "-9223372036854775808",
+        "123456789012345678901234.5", "0.000000000000000000000000000001",
+        "1 + 2 * 3", "(1 + 2) * 3", "10 - 4 - 3", "100 / 10 / 5", "17 % 5 * 2",
+        "1 << 2 >> 1", "1 < 2 == 3 > 4", "5 <= 5 != 6 >= 7",
+        "6 & 3 | 8 ^ 1", "1 | 2 | 4", "1 || 0 && 1", "1||0", "1 | | 0",
+        "!0", "~5", "-(-3)", "+4", "- - 2", "!!1",
+        "1 ? 2 : 3", "0 ? 1 : 1 ? 2 : 3", "(1 ? 0 : 1) ? 4 : 5",
+        "\"a\" + \"b\"", "-'a'", " \t( 7 ) ", "$price * $qty_2", "-$_x",
+    };
+    for (const char* expr : corpus) {
+        ExpectSameTree(expr, true);
+    }
+}
+
+TEST_F(ParserDifferentialTest, InvalidInputsRejected) {
+    const char* invalid[] = { "1 +", "(1", "1 ? 2", "* 3", "x", "'a", "\"open", "", "$",
+                              "'ab'", "''", "1 2", "(1))", "1 + 2 3", "$a $b",
+                              "1 @ + 2", "@", "1 + 2 #", "1 ? 2 : 3 :" };
+    for (const char* expr : invalid) {
+        SCOPED_TRACE(expr);
+        EXPECT_EQ(nullptr, expresso_parser_parse(antlr_, expr));
+        EXPECT_EQ(nullptr, expresso_parser_parse(fast_, expr));
+    }
+}
+
+TEST_F(ParserDifferentialTest, ErrorPositionsAreOffsetsIntoMultiLineInput) {
+    // Byte offsets into the whole input, not columns within a line
+    const struct { const char* expr; size_t position; } cases[] = {
+        { "1 +\n* 2", 4 }, { "1 +\n  @ 2", 6 }, { "(1 +\n2", 6 }, { "1\n+ 2\n3", 6 },
+    };
+    for (const auto& c : cases) {
+        SCOPED_TRACE(c.expr);
+        ExpressoSyntaxError error;
+        EXPECT_EQ(nullptr, expresso_parser_parse(antlr_, c.expr));
+        ASSERT_TRUE(expresso_parser_get_syntax_error(antlr_, &error));
+        EXPECT_EQ(c.position, error.position);
+        EXPECT_EQ(nullptr, expresso_parser_parse(fast_, c.expr));
+        ASSERT_TRUE(expresso_parser_get_syntax_error(fast_, &error));
+        EXPECT_EQ(c.position, error.position);
+    }
+}
+
+TEST_F(ParserDifferentialTest, FastParserRejectsTrailingInput) {
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoSyntaxError error;
+    EXPECT_FALSE(expresso_fast_parse("1 2", ast, &error));
+    EXPECT_EQ(2u, error.position);
+    EXPECT_EQ(nullptr, expresso_parser_parse(fast_, "(1))"));
+    EXPECT_FALSE(expresso_fast_parse("1 + 'ab'", ast, &error));
+    EXPECT_EQ(4u, error.position);
+    EXPECT_STREQ("Character literal must hold one character.", error.message);
+    expresso_ast_destroy(ast);
+}
+
+TEST_F(ParserDifferentialTest, FastParserLimitsBitwiseOrChains) {
+    // '|' is right-recursive, so a chain nests as deeply as it is long
+    std::string chain = "1";
+    for (int i = 0; i < 1000; i++) chain += "|1";
+    ExpressoAst* ast = expresso_ast_create();
+    ExpressoSyntaxError error;
+    EXPECT_TRUE(expresso_fast_parse(chain.c_str(), ast, &error));
+
+    for (int i = 0; i < 100000; i++) chain += "|1";
+    EXPECT_FALSE(expresso_fast_parse(chain.c_str(), ast, &error));
+    EXPECT_EQ(EXPRESSO_ERROR_PARSE_TOO_DEEP, error.code);
+    expresso_ast_destroy(ast);
+}
+
+// Random trees printed with random spacing and redundant parentheses. Only
+// the trees are compared, so overflow in the generated arithmetic is harmless.
+static std::string generate(std::mt19937& rng, int depth) {
+    static const char* binary[] = {
+        "*", "/", "%", "+", "-", "<<", ">>", "<", ">", "<=", ">=",
+        "==", "!=", "&", "^", "|", "&&", "||"
+    };
+    static const char* unary[] = { "+", "-", "!", "~" };
+    static const char* spaces[] = { "", " ", "  ", "\t" };
+
+    auto space = [&]() { return std::string(spaces[rng() % 4]); };
+    auto literal = [&]() { return std::to_string(rng() % 100); };
+
+    if (depth == 0) return literal();
+    switch (rng() % 6) {
+        case 0: return literal();
+        case 1: return std::string(unary[rng() % 4]) + space() + generate(rng, depth - 1);
+        case 2: return "(" + space() + generate(rng, depth - 1) + space() + ")";
+        case 3:
+            return generate(rng, depth - 1) + space() + "?" + space() + generate(rng, depth - 1) +
+                   space() + ":" + space() + generate(rng, depth - 1);
+        default: {
+            std::string op = binary[rng() % 18];
+            // Keep divisors literal and non-zero
+            std::string rhs = (op == "/" || op == "%") ? std::to_string(rng() % 99 + 1)
+                                                       : generate(rng, depth - 1);
+            return generate(rng, depth - 1) + space() + op + space() + rhs;
+        }
+    }
+}
+
+TEST_F(ParserDifferentialTest, RandomExpressionsMatch) {
+    std::mt19937 rng(20240531);
+    for (int i = 0; i < 2000; i++) {
+        ExpectSameTree(generate(rng, 5), false);
+    }
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "parser_wrapper.h"
+#include <string>
+
+class ParserWrapperTest : public ::testing::Test {
+protected:
+    void SetUp() override { ctx_ = expresso_parser_create(); }
+    void TearDown() override { expresso_parser_destroy(ctx_); }
+
+    ExpressoParserContext* ctx_ = nullptr;
+};
+
+TEST_F(ParserWrapperTest, SpanCoversSourceSpelling) {
+    const char* expr = "(3 +  5) * 2";
+    ExpressoParseTree* tree = expresso_parser_parse(ctx_, expr);
+    ASSERT_NE(nullptr, tree);
+
+    size_t length = 0;
+    const char* text = expresso_tree_get_text_span(tree, &length);
+    ASSERT_NE(nullptr, text);
+    EXPECT_EQ(std::string(expr), std::string(text, length));
+    EXPECT_STREQ(expr, expresso_tree_get_text(tree));
+
+    expresso_tree_destroy(tree);
+}
+
+TEST_F(ParserWrapperTest, ChildSpansPointIntoTheSameBuffer) {
+    ExpressoParseTree* tree = expresso_parser_parse(ctx_, "\"ab\" + \"cd\"");
+    ASSERT_NE(nullptr, tree);
+
+    size_t root_length = 0;
+    const char* root_text = expresso_tree_get_text_span(tree, &root_length);
+
+    // expression -> conditional -> ... -> additive
+    ExpressoParseTree* node = tree;
+    while (expresso_tree_get_type(node) != RuleAdditiveExpression) {
+        ExpressoParseTree* child = expresso_tree_get_child(node, 0);
+        ASSERT_NE(nullptr, child);
+        if (node != tree) expresso_tree_destroy(node);
+        node = child;
+    }
+    ExpressoParseTree* op = expresso_tree_get_child(node, 1);
+    size_t op_length = 0;
+    const char* op_text = expresso_tree_get_text_span(op, &op_length);
+    EXPECT_EQ(std::string("+"), std::string(op_text, op_length));
+    EXPECT_GE(op_text, root_text);
+    EXPECT_LT(op_text, root_text + root_length);
+
+    expresso_tree_destroy(op);
+    expresso_tree_destroy(node);
+    expresso_tree_destroy(tree);
+}
+
+TEST_F(ParserWrapperTest, NonAsciiStringLiteralsMapToByteOffsets) {
+    const char* expr = "\"h\xC3\xA9llo\" + \"w\"";
+    ExpressoParseTree* tree = expresso_parser_parse(ctx_, expr);
+    ASSERT_NE(nullptr, tree);
+    EXPECT_STREQ(expr, expresso_tree_get_text(tree));
+
+    const ExpressoAst* ast = expresso_tree_get_ast(tree);
+    ASSERT_NE(nullptr, ast);
+    const ExpressoNode& root = ast->nodes[ast->root];
+    EXPECT_STREQ("h\xC3\xA9llo", expresso_ast_string(ast, &ast->nodes[root.children[0]]));
+    EXPECT_STREQ("w", expresso_ast_string(ast, &ast->nodes[root.children[1]]));
+
+    expresso_tree_destroy(tree);
+}
+
+TEST_F(ParserWrapperTest, DeepParenthesesParse) {
+    std::string expr;
+    for (int i = 0; i < 200; i++) expr += "(";
+    expr += "7";
+    for (int i = 0; i < 200; i++) expr += ")";
+
+    ExpressoParseTree* tree = expresso_parser_parse(ctx_, expr.c_str());
+    ASSERT_NE(nullptr, tree);
+    size_t length = 0;
+    expresso_tree_get_text_span(tree, &length);
+    EXPECT_EQ(expr.size(), length);
+
+    const ExpressoAst* ast = expresso_tree_get_ast(tree);
+    ASSERT_NE(nullptr, ast);
+    EXPECT_EQ(1u, ast->count);
+    EXPECT_EQ(7, ast->nodes[ast->root].data.integer_value);
+
+    expresso_tree_destroy(tree);
+}
+
+TEST_F(ParserWrapperTest, InvalidInputFallsBackToFullLL) {
+    ExpressoParseTree* tree = expresso_parser_parse(ctx_, "1 + 2 * 3");
+    ASSERT_NE(nullptr, tree);
+    expresso_tree_destroy(tree);
+
+    EXPECT_EQ(nullptr, expresso_parser_parse(ctx_, "1 +"));
+
+    ExpressoParserStats stats;
+    expresso_parser_get_stats(ctx_, &stats);
+    EXPECT_EQ(1u, stats.sll_parses);
+    EXPECT_EQ(1u, stats.ll_fallbacks);
+    EXPECT_EQ(1u, stats.ll_failures);
+
+    expresso_parser_reset_stats(ctx_);
+    expresso_parser_get_stats(ctx_, &stats);
+    EXPECT_EQ(0u, stats.sll_parses + stats.ll_fallbacks + stats.ll_failures);
+}